@@ -0,0 +1,141 @@
+#include "asrchunker.h"
+
+#include <QFile>
+#include <vector>
+
+namespace
+{
+constexpr int WavHeaderBytes = 44; //  Header, wie ihn der WavWriterThread schreibt.
+constexpr int FrameMs = 20;        //  Länge eines Energie-Frames.
+constexpr int QuietMs = 500;       //  Länge des Fensters, in dem nach Stille gesucht wird.
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+AsrChunker::AsrChunker (
+    int sampleRate)
+    : m_sampleRate (sampleRate)
+    , m_overlapMs (1000)
+    , m_searchMs (15000)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+qint64 AsrChunker::sampleCount (
+    const QString &wavPath)
+{
+    QFile file (wavPath);
+    return qMax<qint64> (0, (file.size () - WavHeaderBytes) / qint64 (sizeof (qint16)));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QList<double> AsrChunker::frameEnergies (
+    const QString &wavPath) const
+{
+    QList<double> energies;
+    QFile file (wavPath);
+    if (!file.open (QIODevice::ReadOnly) || !file.seek (WavHeaderBytes))
+    {
+        return energies;
+    }
+
+    const int frameLength = m_sampleRate * FrameMs / 1000;
+    energies.reserve (sampleCount (wavPath) / frameLength + 1);
+
+    //  Die Datei wird in großen Blöcken gelesen; ein Frame kann über eine Blockgrenze reichen.
+    std::vector<qint16> buffer (32768);
+    double sum = 0.0;
+    int fill = 0;
+    qint64 bytes;
+    while ((bytes = file.read (reinterpret_cast<char *> (buffer.data ()),
+                               qint64 (buffer.size () * sizeof (qint16))))
+           > 0)
+    {
+        const qint64 count = bytes / qint64 (sizeof (qint16));
+        for (qint64 i = 0; i < count; ++i)
+        {
+            const double v = buffer[size_t (i)] / 32768.0;
+            sum += v * v;
+            if (++fill == frameLength)
+            {
+                energies.append (sum / frameLength);
+                sum = 0.0;
+                fill = 0;
+            }
+        }
+    }
+    return energies;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QList<AsrChunk> AsrChunker::plan (
+    const QString &wavPath, int chunkCount) const
+{
+    QList<AsrChunk> chunks;
+    const qint64 total = sampleCount (wavPath);
+    if (total <= 0)
+    {
+        return chunks;
+    }
+
+    const QList<double> energies = frameEnergies (wavPath);
+    const qint64 frameLength = m_sampleRate * FrameMs / 1000;
+    const qint64 frames = energies.size ();
+    chunkCount = int (qBound<qint64> (1, chunkCount, qMax<qint64> (1, frames / 100)));
+
+    //  Präfixsummen, damit die Energie jedes Fensters in konstanter Zeit verfügbar ist.
+    std::vector<double> prefix (size_t (frames) + 1, 0.0);
+    for (qint64 i = 0; i < frames; ++i)
+    {
+        prefix[size_t (i + 1)] = prefix[size_t (i)] + energies[i];
+    }
+
+    const qint64 quietFrames = QuietMs / FrameMs;
+    const qint64 searchFrames = qMin<qint64> (m_searchMs / FrameMs, frames / (2 * chunkCount));
+
+    //  Schnittstellen: das leiseste Fenster um jede gleichmäßig verteilte Zielposition.
+    QList<qint64> cuts = {0};
+    for (int k = 1; k < chunkCount; ++k)
+    {
+        const qint64 target = frames * k / chunkCount;
+        const qint64 first = qMax (cuts.last () / frameLength + 1, target - searchFrames);
+        const qint64 last = qMin (frames - quietFrames, target + searchFrames);
+
+        qint64 best = target;
+        double bestEnergy = -1.0;
+        for (qint64 f = first; f <= last; ++f)
+        {
+            const double energy = prefix[size_t (f + quietFrames)] - prefix[size_t (f)];
+            if (bestEnergy < 0.0 || energy < bestEnergy)
+            {
+                bestEnergy = energy;
+                best = f + quietFrames / 2;
+            }
+        }
+
+        const qint64 cut = best * frameLength;
+        if (cut > cuts.last () && cut < total)
+        {
+            cuts.append (cut);
+        }
+    }
+    cuts.append (total);
+
+    const qint64 overlap = qint64 (m_sampleRate) * m_overlapMs / 1000;
+    for (qsizetype i = 0; i + 1 < cuts.size (); ++i)
+    {
+        AsrChunk chunk;
+        chunk.coreStart = cuts[i];
+        chunk.coreEnd = cuts[i + 1];
+        chunk.start = qMax<qint64> (0, chunk.coreStart - overlap);
+        chunk.end = qMin (total, chunk.coreEnd + overlap);
+        chunks.append (chunk);
+    }
+    return chunks;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,78 @@
+/**
+ * @file asrchunker.h
+ * @brief Enthält die Deklaration des AsrChunker zum Aufteilen langer ASR-Dateien.
+ * @author Mike Wild
+ */
+#ifndef ASRCHUNKER_H
+#define ASRCHUNKER_H
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Ein Abschnitt einer ASR-Datei, der von einem Worker einzeln transkribiert wird.
+ *
+ * Jeder Abschnitt überlappt seine Nachbarn ein wenig, damit ein an der Schnittstelle
+ * liegendes Wort vollständig erfasst wird. Zuständig ist er aber nur für den Kernbereich:
+ * Beim Zusammenführen wird ein Segment genau dem Abschnitt zugeordnet, in dessen
+ * Kernbereich seine Mitte liegt. So entstehen an den Grenzen keine doppelten Segmente.
+ */
+struct AsrChunk
+{
+    qint64 start = 0;     ///< Erstes Sample des Abschnitts (inkl. Überlappung).
+    qint64 end = 0;       ///< Erstes Sample nach dem Abschnitt (inkl. Überlappung).
+    qint64 coreStart = 0; ///< Beginn des Bereichs, für den der Abschnitt zuständig ist.
+    qint64 coreEnd = 0;   ///< Ende des Bereichs, für den der Abschnitt zuständig ist.
+};
+
+/**
+ * @brief Teilt eine 16-kHz-Mono-PCM16-WAV-Datei an möglichst stillen Stellen auf.
+ *
+ * Die Datei wird einmal gelesen und die Energie in 20-ms-Frames bestimmt. Für jede
+ * Schnittstelle wird um die gleichmäßig verteilte Zielposition herum das leiseste
+ * 500-ms-Fenster gesucht und in dessen Mitte geschnitten. Die Abschnitte selbst werden
+ * nicht als Dateien geschrieben; der Worker liest nur den jeweiligen Sample-Bereich.
+ *
+ * @note Die Klasse liest die Datei synchron und sollte daher nicht im GUI-Thread
+ * verwendet werden (z.B. über QtConcurrent::run).
+ */
+class AsrChunker
+{
+public:
+    /**
+     * @brief Erstellt einen Chunker.
+     * @param sampleRate Die Abtastrate der Dateien in Hz.
+     */
+    explicit AsrChunker (int sampleRate = 16000);
+
+    /**
+     * @brief Plant die Abschnitte für eine Datei.
+     * @param wavPath Pfad der WAV-Datei (44-Byte-Header, PCM16, Mono).
+     * @param chunkCount Gewünschte Anzahl an Abschnitten.
+     * @return Die Abschnitte in zeitlicher Reihenfolge; leer, wenn die Datei nicht lesbar ist.
+     */
+    QList<AsrChunk> plan (const QString &wavPath, int chunkCount) const;
+
+    /**
+     * @brief Gibt die Länge der Audiodaten einer Datei in Samples zurück.
+     * @param wavPath Pfad der WAV-Datei (44-Byte-Header, PCM16, Mono).
+     */
+    static qint64 sampleCount (const QString &wavPath);
+
+    /** @brief Setzt die Überlappung zu den Nachbarabschnitten (Standard: 1000 ms). */
+    void setOverlapMs (int ms) { m_overlapMs = ms; }
+
+    /** @brief Setzt, wie weit um die Zielposition nach Stille gesucht wird (Standard: 15000 ms). */
+    void setSearchMs (int ms) { m_searchMs = ms; }
+
+private:
+    /** @brief Berechnet die mittlere Energie aller 20-ms-Frames der Datei. */
+    QList<double> frameEnergies (const QString &wavPath) const;
+
+    const int m_sampleRate; ///< Abtastrate in Hz.
+    int m_overlapMs;        ///< Überlappung zu den Nachbarabschnitten.
+    int m_searchMs;         ///< Suchbereich um die Zielposition (in jede Richtung).
+};
+
+#endif // ASRCHUNKER_H
@@ -1,27 +1,123 @@
 #include "asrprocessmanager.h"
+#include "asrworker.h"
+#include "processgovernor.h"
 
-#include <QRegularExpression>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonArray>
 #include <QSettings>
+#include <QTimer>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <limits>
+
+namespace
+{
+//  Ergebnis der Suche im AsrResultCache (im Hintergrund-Thread).
+struct CacheLookup
+{
+    QString key;                      //  Schlüssel der Datei (leer, wenn nicht lesbar).
+    bool hit = false;                 //  Ein Eintrag wurde gefunden.
+    QList<AsrRawSegment> segments;    //  Die gespeicherten Segmente.
+};
+
+//  Liest ein Segment aus einer "segment"-Nachricht eines Workers (Felder wie im Protokoll
+//  des AsrProtocolParser).
+AsrRawSegment rawSegmentFromJson (
+    const QJsonObject &message)
+{
+    AsrRawSegment segment;
+    segment.start = message.value ("start").toDouble ();
+    segment.end = message.value ("end").toDouble ();
+    segment.speaker = message.value ("speaker").toString ();
+    segment.text = message.value ("text").toString ();
+    segment.confidence = message.value ("confidence").toDouble (-1.0);
+    const QJsonArray words = message.value ("words").toArray ();
+    for (const QJsonValue &value : words)
+    {
+        const QJsonArray word = value.toArray ();
+        segment.words.append ({word.at (0).toDouble (),
+                               word.at (1).toDouble (),
+                               word.at (2).toString (),
+                               word.at (3).toDouble (-1.0)});
+    }
+    return segment;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+AsrModelChoice AsrModelChoice::fromSettings ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    AsrModelChoice choice;
+    choice.model = settings.value ("asr/model", "large").toString ();
+    if (settings.value ("asr/cascade", false).toBool ())
+    {
+        choice.draft = settings.value ("asr/draftModel", "small").toString ();
+        choice.escalateBelow = settings.value ("asr/escalateBelow", 0.6).toDouble ();
+    }
+    return choice;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString AsrModelChoice::cacheId () const
+{
+    //  Die Diarisierung gehört dazu: Andere Sprecher sind ein anderes Ergebnis.
+    if (draft.isEmpty ())
+    {
+        return QString ("whisper-%1+pyannote-3.0").arg (model);
+    }
+    return QString ("whisper-%1>%2@%3+pyannote-3.0").arg (draft, model).arg (escalateBelow, 0, 'f', 2);
+}
+
+//--------------------------------------------------------------------------------------------------
 
 AsrProcessManager::AsrProcessManager (
     QObject *parent)
     : QObject (parent)
     , m_process (new QProcess (this))
     , m_unknownCounter (0)
+    , m_idleTimer (new QTimer (this))
+    , m_job (JobKind::None)
+    , m_generation (0)
+    , m_nextId (0)
+    , m_poolSize (1)
+    , m_chunksDone (0)
+    , m_chunksOpen (false)
+    , m_streamEnded (false)
+    , m_streamId (-1)
 {
     //  Die Signale des internen QProcess-Objekts mit den Slots dieser Klasse verbinden.
     connect (m_process,
              &QProcess::readyReadStandardOutput,
              this,
              &AsrProcessManager::handleProcessOutput);
+    connect (m_process,
+             &QProcess::readyReadStandardError,
+             this,
+             &AsrProcessManager::handleProcessStderr);
     connect (m_process, &QProcess::finished, this, &AsrProcessManager::handleProcessFinished);
     connect (m_process, &QProcess::errorOccurred, this, &AsrProcessManager::handleProcessError);
+
+    m_idleTimer->setSingleShot (true);
+    connect (m_idleTimer, &QTimer::timeout, this, &AsrProcessManager::shutdownWorkers);
 }
 
 //--------------------------------------------------------------------------------------------------
 
 AsrProcessManager::~AsrProcessManager ()
 {
+    //  Die Worker beenden sich in ihrem eigenen Destruktor; ihre Signale sollen
+    //  den halb zerstörten Manager nicht mehr erreichen.
+    for (AsrWorker *worker : std::as_const (m_workers))
+    {
+        worker->disconnect (this);
+    }
+
     //  Stellt sicher, dass der Kind-Prozess beendet wird, wenn der Manager zerstört wird.
     if (m_process->state () != QProcess::NotRunning)
     {
@@ -34,7 +130,7 @@ AsrProcessManager::~AsrProcessManager ()
 //--------------------------------------------------------------------------------------------------
 
 void AsrProcessManager::startTranscription (
-    const QString &wavFilePath)
+    const QString &wavFilePath, const SpeechTimeline &timeline)
 {
     //  hier immer neu laden, falls Nutzer die Einstellung ändert.
     loadPaths ();
@@ -45,7 +141,7 @@ void AsrProcessManager::startTranscription (
         return;
     }
 
-    if (m_process->state () != QProcess::NotRunning)
+    if (m_job != JobKind::None || m_process->state () != QProcess::NotRunning)
     {
         emit finished (false, "Ein anderer Transkriptionsprozess läuft bereits.");
         return;
@@ -53,15 +149,136 @@ void AsrProcessManager::startTranscription (
 
     //  Setze den Zähler für jeden neuen Lauf zurück, um wieder bei UNKNOWN_0 zu beginnen.
     m_unknownCounter = 0;
+    m_timeline = timeline;
+
+    if (!m_timeline.isEmpty ())
+    {
+        qDebug () << "AsrProcessManager: Sprachanteil"
+                  << qRound (m_timeline.speechRatio () * 100.0) << "% -" << m_timeline.speechSeconds ()
+                  << "s von" << m_timeline.totalSeconds () << "s werden transkribiert.";
+    }
+
+    m_jobTimer.start ();
+    m_cacheKey.clear ();
+    m_cacheSegments.clear ();
+    m_models = AsrModelChoice::fromSettings ();
+
+    const AsrResultCache cache;
+    if (!cache.isEnabled ())
+    {
+        launchTranscription (wavFilePath);
+        return;
+    }
+
+    //  Zuerst wird im Hintergrund im Cache gesucht (das Hashen liest die ganze Datei); erst
+    //  bei einem Fehlschlag werden Python und die Modelle bemüht.
+    ++m_generation;
+    m_job = JobKind::Lookup;
+    m_jobPath = wavFilePath;
+    m_idleTimer->stop ();
+    const quint64 generation = m_generation;
+    auto *watcher = new QFutureWatcher<CacheLookup> (this);
+    connect (watcher,
+             &QFutureWatcher<CacheLookup>::finished,
+             this,
+             [this, watcher, generation, wavFilePath] ()
+             {
+                 const CacheLookup result = watcher->result ();
+                 watcher->deleteLater ();
+                 if (generation != m_generation)
+                 {
+                     return; //  Der Job wurde inzwischen abgebrochen.
+                 }
+
+                 AsrResultCache::countLookup (result.hit);
+                 if (!result.hit)
+                 {
+                     m_job = JobKind::None;
+                     m_cacheKey = result.key;
+                     launchTranscription (wavFilePath);
+                     return;
+                 }
 
-    QStringList args = {m_scriptPath, wavFilePath};
-    m_process->start (m_pythonPath, args);
+                 qDebug () << "AsrProcessManager:" << result.segments.size ()
+                           << "Segmente aus dem Cache, Python wird nicht gestartet.";
+                 for (const AsrRawSegment &segment : result.segments)
+                 {
+                     emit segmentReady (makeSegment (segment));
+                 }
+                 completeJob (AsrJobTiming ());
+             });
+    const QString models = m_models.cacheId ();
+    watcher->setFuture (QtConcurrent::run (
+        [cache, wavFilePath, models] ()
+        {
+            CacheLookup result;
+            result.key = AsrResultCache::keyFor (wavFilePath, models, AsrLanguage);
+            result.hit = cache.lookup (result.key, &result.segments);
+            return result;
+        }));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::launchTranscription (
+    const QString &wavFilePath)
+{
+    m_jobPath = wavFilePath;
+    m_timing = AsrJobTiming ();
+
+    if (!workerModeAvailable ())
+    {
+        shutdownWorkers ();
+        m_stderrTail.clear ();
+        m_parser.reset ();
+        QStringList args = {m_scriptPath, wavFilePath, "--model", m_models.model};
+        if (!m_models.draft.isEmpty ())
+        {
+            args << "--draft" << m_models.draft << "--escalate-below"
+                 << QString::number (m_models.escalateBelow, 'f', 2);
+        }
+        ProcessGovernor ().apply (m_process);
+        m_process->start (m_pythonPath, args);
+        return;
+    }
+
+    ++m_generation;
+    m_idleTimer->stop ();
+
+    //  Lange Aufnahmen werden auf mehrere Worker verteilt. Jeder Abschnitt soll mindestens
+    //  eine Minute lang sein; etwas mehr Abschnitte als Worker gleichen unterschiedlich
+    //  schnelle Abschnitte aus.
+    const int cores = ProcessGovernor ().threadBudget ();
+    const int pool = configuredPoolSize ();
+    const qint64 maxChunks = AsrChunker::sampleCount (wavFilePath) / (qint64 (MinChunkSeconds) * SampleRate);
+    const int chunkCount = int (qMin<qint64> (pool * 2, maxChunks));
+    if (pool > 1 && chunkCount >= 2)
+    {
+        m_job = JobKind::Chunked;
+        m_poolSize = pool;
+        startChunked (chunkCount);
+        return;
+    }
+
+    m_job = JobKind::Single;
+    m_poolSize = 1;
+    m_singleSegments.clear ();
+    m_queue.append (makeRequest ("transcribe", cores));
+    dispatch ();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void AsrProcessManager::stop ()
 {
+    //  Ein laufender Job kann im Worker nicht abgebrochen werden; die beschäftigten Worker
+    //  werden beendet und beim nächsten Job neu gestartet. Untätige Worker bleiben erhalten.
+    if (m_job != JobKind::None)
+    {
+        resetJob ();
+        return;
+    }
+
     if (m_process->state () != QProcess::NotRunning)
     {
         m_process->terminate ();
@@ -70,23 +287,850 @@ void AsrProcessManager::stop ()
 
 //--------------------------------------------------------------------------------------------------
 
-void AsrProcessManager::handleProcessOutput ()
+void AsrProcessManager::shutdownWorkers ()
+{
+    if (m_job != JobKind::None)
+    {
+        return;
+    }
+
+    for (AsrWorker *worker : std::as_const (m_workers))
+    {
+        worker->shutdown ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrProcessManager::beginStream ()
+{
+    loadPaths ();
+
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    if (!settings.value ("asr/streaming", true).toBool () || m_pythonPath.isEmpty ()
+        || !workerModeAvailable () || m_job != JobKind::None
+        || m_process->state () != QProcess::NotRunning)
+    {
+        return false;
+    }
+
+    ++m_generation;
+    m_unknownCounter = 0;
+    m_timeline = SpeechTimeline ();
+    m_streamSegments.clear ();
+    m_jobPath.clear ();
+    m_cacheKey.clear ();
+    m_cacheSegments.clear ();
+    m_models = AsrModelChoice::fromSettings ();
+    m_models.draft.clear (); //  Die Kaskade lohnt sich nur für ganze Dateien.
+    m_job = JobKind::Stream;
+    m_poolSize = 1;
+    m_streamEnded = false;
+    m_streamId = ++m_nextId;
+    m_idleTimer->stop ();
+
+    //  Die bereits gesendeten Samples ließen sich nach einem Absturz nicht wiederholen.
+    m_retries.insert (m_streamId, MaxRestarts);
+
+    //  Der Stream wird sofort eröffnet; lädt der Worker noch seine Modelle, sammelt er
+    //  die Samples so lange und holt die Transkription danach nach.
+    AsrWorker *worker = workerAt (0);
+    if (!worker->isRunning ())
+    {
+        worker->start (m_pythonPath, workerScriptPath ());
+        if (m_job != JobKind::Stream)
+        {
+            return false; //  Der Start ist sofort gescheitert (failJob() wurde bereits aufgerufen).
+        }
+    }
+    const QJsonObject request{{"cmd", "stream_start"}, {"id", m_streamId}, {"model", m_models.model}};
+    m_running.insert (worker, request);
+    worker->send (request);
+    qDebug () << "AsrProcessManager: Live-Transkription gestartet (Stream" << m_streamId << ").";
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::appendStreamAudio (
+    const QByteArray &pcm16)
+{
+    if (m_job != JobKind::Stream || m_streamEnded || pcm16.isEmpty ())
+    {
+        return;
+    }
+    workerAt (0)->send (QJsonObject{{"cmd", "audio"},
+                                    {"id", m_streamId},
+                                    {"pcm", QString::fromLatin1 (pcm16.toBase64 ())}});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::endStream (
+    const QString &wavFilePath)
+{
+    if (m_job != JobKind::Stream || m_streamEnded)
+    {
+        return;
+    }
+
+    //  Ab hier zählt die Zeit, die der Nutzer nach dem Ende der Aufnahme noch warten muss.
+    m_streamEnded = true;
+    m_jobPath = wavFilePath;
+    m_jobTimer.start ();
+    workerAt (0)->send (
+        QJsonObject{{"cmd", "stream_end"}, {"id", m_streamId}, {"path", wavFilePath}});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrProcessManager::beginSegments ()
+{
+    loadPaths ();
+
+    if (m_pythonPath.isEmpty () || !workerModeAvailable () || m_job != JobKind::None
+        || m_process->state () != QProcess::NotRunning)
+    {
+        return false;
+    }
+
+    ++m_generation;
+    m_unknownCounter = 0;
+    m_timeline = SpeechTimeline ();
+    m_jobPath.clear ();
+    m_cacheKey.clear ();
+    m_cacheSegments.clear ();
+    m_models = AsrModelChoice::fromSettings ();
+    m_timing = AsrJobTiming ();
+    m_idleTimer->stop ();
+
+    m_job = JobKind::Chunked;
+    m_poolSize = configuredPoolSize ();
+    m_chunks.clear ();
+    m_chunkSegments.clear ();
+    m_chunkOfRequest.clear ();
+    m_chunksDone = 0;
+    m_chunksOpen = true;
+    m_chunkTimer.start ();
+
+    qDebug () << "AsrProcessManager: Teildateien werden während der Aufnahme auf" << m_poolSize
+              << "Worker verteilt.";
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::addSegment (
+    const QString &path, double offsetSeconds)
+{
+    if (!isSegmenting ())
+    {
+        return;
+    }
+
+    //  Die Teildateien werden an Sprechpausen geschnitten und überlappen nicht; jedes
+    //  Segment einer Datei gehört daher zu ihr.
+    AsrChunk chunk;
+    chunk.start = qRound64 (offsetSeconds * SampleRate);
+    chunk.end = chunk.start + AsrChunker::sampleCount (path);
+    chunk.coreStart = chunk.start;
+    chunk.coreEnd = std::numeric_limits<qint64>::max ();
+
+    QJsonObject request = makeRequest ("transcribe",
+                                       qMax (1, ProcessGovernor ().threadBudget () / m_poolSize));
+    request.insert ("path", path);
+    request.insert ("diarize", false);
+    queueChunk (chunk, request);
+    dispatch ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::endSegments (
+    const QString &wavFilePath)
+{
+    if (!isSegmenting ())
+    {
+        return;
+    }
+
+    //  Ab hier zählt die Zeit, die der Nutzer nach dem Ende der Aufnahme noch warten muss.
+    m_chunksOpen = false;
+    m_jobPath = wavFilePath;
+    m_jobTimer.start ();
+    qDebug () << "AsrProcessManager: Aufnahme beendet," << m_chunksDone << "von" << m_chunks.size ()
+              << "Teildateien bereits transkribiert.";
+
+    if (m_chunksDone == m_chunks.size ())
+    {
+        mergeChunks ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AsrWorker *AsrProcessManager::workerAt (
+    int index)
+{
+    while (m_workers.size () <= index)
+    {
+        AsrWorker *worker = new AsrWorker (int (m_workers.size ()), this);
+        connect (worker,
+                 &AsrWorker::ready,
+                 this,
+                 [this] ()
+                 {
+                     dispatch ();
+                     if (m_job == JobKind::None)
+                     {
+                         startIdleTimer ();
+                     }
+                 });
+        connect (worker,
+                 &AsrWorker::messageReceived,
+                 this,
+                 [this, worker] (const QJsonObject &message)
+                 { handleWorkerMessage (worker, message); });
+        connect (worker,
+                 &AsrWorker::exited,
+                 this,
+                 [this, worker] (int exitCode, bool wasReady)
+                 { handleWorkerExited (worker, exitCode, wasReady); });
+        connect (worker,
+                 &AsrWorker::failedToStart,
+                 this,
+                 [this] (const QString &errorMsg)
+                 {
+                     if (m_job != JobKind::None)
+                     {
+                         failJob (errorMsg);
+                     }
+                 });
+        m_workers.append (worker);
+    }
+    return m_workers[index];
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrProcessManager::workerModeAvailable () const
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    return settings.value ("asr/persistentWorker", true).toBool ()
+           && QFileInfo::exists (workerScriptPath ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QJsonObject AsrProcessManager::makeRequest (
+    const QString &cmd, int threads)
+{
+    //  Die Anzahl der Torch-Threads wird bei jeder Anfrage gesetzt, da ein Worker sie
+    //  sonst vom vorherigen (ggf. aufgeteilten) Job behalten würde.
+    QJsonObject request{{"cmd", cmd},
+                        {"id", ++m_nextId},
+                        {"path", m_jobPath},
+                        {"threads", threads},
+                        {"model", m_models.model}};
+    if (!m_models.draft.isEmpty ())
+    {
+        request.insert ("draft", m_models.draft);
+        request.insert ("escalate_below", m_models.escalateBelow);
+    }
+    return request;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int AsrProcessManager::configuredPoolSize () const
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const int cores = ProcessGovernor ().threadBudget ();
+    return qBound (1, settings.value ("asr/parallelWorkers", 1).toInt (), cores);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::queueChunk (
+    const AsrChunk &chunk, QJsonObject request)
+{
+    const qint64 id = request.value ("id").toInteger ();
+    m_chunkOfRequest.insert (id, int (m_chunks.size ()));
+    m_chunks.append (chunk);
+    m_chunkSegments.append (QList<AsrRawSegment> ());
+    m_queue.append (request);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::dispatch ()
+{
+    for (int i = 0; i < m_poolSize && !m_queue.isEmpty (); ++i)
+    {
+        AsrWorker *worker = workerAt (i);
+        if (m_running.contains (worker))
+        {
+            continue;
+        }
+
+        //  Fehlende Worker werden gestartet; sie holen sich nach "ready" die nächste Anfrage.
+        if (!worker->isRunning ())
+        {
+            worker->start (m_pythonPath, workerScriptPath ());
+            continue;
+        }
+        if (!worker->isReady ())
+        {
+            continue;
+        }
+
+        const QJsonObject request = m_queue.takeFirst ();
+        m_running.insert (worker, request);
+        worker->send (request);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::startChunked (
+    int chunkCount)
+{
+    //  Das Planen liest die ganze Datei und läuft daher nicht im GUI-Thread. Wird der Job
+    //  in der Zwischenzeit abgebrochen, verfällt das Ergebnis.
+    const quint64 generation = m_generation;
+    const QString path = m_jobPath;
+    auto *watcher = new QFutureWatcher<QList<AsrChunk>> (this);
+    connect (watcher,
+             &QFutureWatcher<QList<AsrChunk>>::finished,
+             this,
+             [this, watcher, generation] ()
+             {
+                 watcher->deleteLater ();
+                 if (generation == m_generation)
+                 {
+                     queueChunks (watcher->result ());
+                 }
+             });
+    watcher->setFuture (
+        QtConcurrent::run ([path, chunkCount] () { return AsrChunker ().plan (path, chunkCount); }));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::queueChunks (
+    const QList<AsrChunk> &chunks)
+{
+    const int cores = ProcessGovernor ().threadBudget ();
+
+    //  Fand sich keine sinnvolle Schnittstelle, wird die Datei am Stück transkribiert.
+    if (chunks.size () < 2)
+    {
+        m_job = JobKind::Single;
+        m_poolSize = 1;
+        m_singleSegments.clear ();
+        m_queue.append (makeRequest ("transcribe", cores));
+        dispatch ();
+        return;
+    }
+
+    m_chunks.clear ();
+    m_chunkSegments.clear ();
+    m_chunkOfRequest.clear ();
+    m_chunksDone = 0;
+    m_chunksOpen = false;
+
+    //  Die Kerne werden auf die Worker aufgeteilt, damit sie sich nicht gegenseitig ausbremsen.
+    const int threads = qMax (1, cores / m_poolSize);
+    for (const AsrChunk &chunk : chunks)
+    {
+        QJsonObject request = makeRequest ("transcribe", threads);
+        request.insert ("start", chunk.start);
+        request.insert ("end", chunk.end);
+        request.insert ("diarize", false);
+        queueChunk (chunk, request);
+    }
+
+    qDebug () << "AsrProcessManager:" << chunks.size () << "Abschnitte auf" << m_poolSize
+              << "Worker mit je" << threads << "Threads verteilt.";
+    m_chunkTimer.start ();
+    dispatch ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::handleWorkerMessage (
+    AsrWorker *worker, const QJsonObject &message)
 {
-    //  Solange der Prozess lesbare Zeilen hat, verarbeiten wir sie.
-    while (m_process->canReadLine ())
+    const QString type = message.value ("type").toString ();
+
+    //  Nur Nachrichten zur Anfrage, die der Worker gerade bearbeitet, sind gültig;
+    //  alles andere stammt von einem abgebrochenen Job.
+    const auto it = m_running.constFind (worker);
+    if (it == m_running.constEnd ()
+        || message.value ("id").toInteger (-1) != it->value ("id").toInteger ())
     {
-        QByteArray lineBytes = m_process->readLine ().trimmed ();
-        if (!lineBytes.isEmpty ())
+        if (type == "error")
         {
-            QString line = QString::fromUtf8 (lineBytes);
-            MetaText segment = parseLine (line);
+            qWarning () << "AsrProcessManager: Worker meldet Fehler:"
+                        << message.value ("message").toString ();
+        }
+        return;
+    }
+
+    const QJsonObject request = *it;
+    const qint64 id = request.value ("id").toInteger ();
 
-            //  Nur erfolgreich geparste Segmente werden als gültig betrachtet und weitergeleitet.
-            if (!segment.Speaker.isEmpty ())
+    if (type == "segment")
+    {
+        AsrRawSegment raw = rawSegmentFromJson (message);
+
+        if (m_job == JobKind::Chunked)
+        {
+            //  Die Zeiten beziehen sich auf den Abschnitt. Ein Segment gehört zu dem Abschnitt,
+            //  in dessen Kernbereich seine Mitte liegt; so zählen die Überlappungen nur einmal.
+            const AsrChunk &chunk = m_chunks[m_chunkOfRequest.value (id)];
+            raw.shift (double (chunk.start) / SampleRate);
+            raw.speaker.clear ();
+            const double middle = (raw.start + raw.end) / 2.0 * SampleRate;
+            if (middle >= chunk.coreStart && middle < chunk.coreEnd)
             {
-                emit segmentReady (segment);
+                m_chunkSegments[m_chunkOfRequest.value (id)].append (raw);
             }
+            return;
         }
+
+        //  Ein Einzel-Job gibt seine Segmente erst mit "done" weiter. Stürzt der Worker vorher
+        //  ab, verwirft der Neustart sie, statt sie ein zweites Mal zu melden. Der Worker
+        //  schickt sie ohnehin erst unmittelbar vor "done".
+        if (m_job == JobKind::Single)
+        {
+            m_singleSegments.append (raw);
+            return;
+        }
+
+        MetaText segment = makeSegment (raw);
+        if (m_job == JobKind::Stream)
+        {
+            m_streamSegments.append ({segment.StartMs, segment.EndMs});
+        }
+        emit segmentReady (segment);
+    }
+    else if (type == "partial" && m_job == JobKind::Stream)
+    {
+        QList<MetaText> segments;
+        const QJsonArray parts = message.value ("segments").toArray ();
+        for (const QJsonValue &part : parts)
+        {
+            const QJsonObject p = part.toObject ();
+            segments.append (MetaText (qRound64 (p.value ("start").toDouble () * 1000.0),
+                                       qRound64 (p.value ("end").toDouble () * 1000.0),
+                                       QString (),
+                                       p.value ("text").toString ()));
+        }
+        emit partialSegments (segments);
+    }
+    else if (type == "progress")
+    {
+        emit progress (message.value ("stage").toString (), message.value ("fraction").toDouble ());
+    }
+    else if (type == "speaker")
+    {
+        //  Die Diarisierung am Ende liefert die Sprecher der bereits transkribierten Segmente.
+        const int index = message.value ("index").toInt (-1);
+        const QString speaker = message.value ("speaker").toString ();
+        if (m_job == JobKind::Chunked && index >= 0 && index < m_merged.size ())
+        {
+            m_merged[index].speaker = speaker;
+        }
+        else if (m_job == JobKind::Stream && index >= 0 && index < m_streamSegments.size ())
+        {
+            if (index < m_cacheSegments.size ())
+            {
+                m_cacheSegments[index].speaker = speaker;
+            }
+            emit segmentSpeakerChanged (m_streamSegments[index].first,
+                                        m_streamSegments[index].second,
+                                        speaker == "UNKNOWN"
+                                            ? QString ("UNKNOWN_%1").arg (m_unknownCounter++)
+                                            : speaker);
+        }
+    }
+    else if (type == "done")
+    {
+        m_running.remove (worker);
+        handleRequestDone (request, message.value ("timing").toObject ());
+    }
+    else if (type == "error")
+    {
+        //  Der Worker selbst ist intakt und bleibt für den nächsten Job erhalten.
+        const QString text = message.value ("message").toString ();
+        qWarning () << "AsrProcessManager: Worker meldet Fehler:" << text;
+        m_running.remove (worker);
+        failJob (text);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::handleRequestDone (
+    const QJsonObject &request, const QJsonObject &t)
+{
+    AsrJobTiming timing;
+    timing.load = t.value ("load").toDouble ();
+    timing.transcribe = t.value ("transcribe").toDouble ();
+    timing.diarize = t.value ("diarize").toDouble ();
+    timing.total = t.value ("total").toDouble ();
+    timing.tail = t.value ("tail").toDouble ();
+    timing.audio = t.value ("audio").toDouble ();
+    timing.escalated = t.value ("escalated").toDouble (-1.0);
+    timing.saved = t.value ("saved").toDouble ();
+
+    if (m_job != JobKind::Chunked)
+    {
+        for (const AsrRawSegment &segment : std::as_const (m_singleSegments))
+        {
+            emit segmentReady (makeSegment (segment));
+        }
+        m_singleSegments.clear ();
+        completeJob (timing);
+        return;
+    }
+
+    //  Die Worker laden ihre Modelle gleichzeitig; die Transkriptionszeiten werden summiert.
+    m_timing.load = qMax (m_timing.load, timing.load);
+    if (request.value ("cmd").toString () == "diarize")
+    {
+        m_timing.diarize = timing.diarize;
+        m_timing.total = m_timing.load + m_timing.transcribe + m_timing.diarize;
+        for (const AsrRawSegment &segment : std::as_const (m_merged))
+        {
+            emit segmentReady (makeSegment (segment));
+        }
+        completeJob (m_timing);
+        return;
+    }
+
+    m_timing.transcribe += timing.transcribe;
+    if (timing.escalated >= 0.0)
+    {
+        m_timing.audio += timing.audio;
+        m_timing.escalated = qMax (0.0, m_timing.escalated) + timing.escalated;
+        m_timing.saved += timing.saved;
+    }
+    if (++m_chunksDone == m_chunks.size () && !m_chunksOpen)
+    {
+        mergeChunks ();
+        return;
+    }
+    dispatch ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::mergeChunks ()
+{
+    const double wall = m_chunkTimer.elapsed () / 1000.0;
+    qDebug () << "AsrProcessManager:" << m_chunks.size () << "Abschnitte in" << wall
+              << "s transkribiert (Summe der Worker" << m_timing.transcribe << "s, Faktor"
+              << (wall > 0.0 ? m_timing.transcribe / wall : 0.0) << ")";
+
+    //  Die Abschnitte liegen in zeitlicher Reihenfolge und überschneiden sich nach dem
+    //  Filtern nicht mehr; sie können daher einfach aneinandergehängt werden.
+    m_merged.clear ();
+    QJsonArray segments;
+    for (const QList<AsrRawSegment> &chunk : std::as_const (m_chunkSegments))
+    {
+        for (const AsrRawSegment &segment : chunk)
+        {
+            m_merged.append (segment);
+            m_merged.last ().speaker = "UNKNOWN";
+            segments.append (QJsonObject{{"start", segment.start}, {"end", segment.end}});
+        }
+    }
+    m_chunkSegments.clear ();
+
+    if (m_merged.isEmpty ())
+    {
+        completeJob (m_timing);
+        return;
+    }
+
+    //  Die Sprecher werden einmalig für die ganze Datei bestimmt, damit SPEAKER_00 in
+    //  allen Abschnitten dieselbe Person bezeichnet.
+    QJsonObject request = makeRequest ("diarize", ProcessGovernor ().threadBudget ());
+    request.insert ("segments", segments);
+    m_queue.append (request);
+    dispatch ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::storeInCache ()
+{
+    const AsrResultCache cache;
+    if (!cache.isEnabled () || m_jobPath.isEmpty ())
+    {
+        return;
+    }
+
+    //  Der Schlüssel ist nur bekannt, wenn vorher im Cache gesucht wurde. Nach Live- und
+    //  Teildatei-Jobs wird er im Hintergrund aus der fertigen ASR-Datei berechnet.
+    const QString key = m_cacheKey;
+    const QString path = m_jobPath;
+    const QString models = m_models.cacheId ();
+    const QList<AsrRawSegment> segments = m_cacheSegments;
+    QThreadPool::globalInstance ()->start (
+        [cache, key, path, models, segments] ()
+        {
+            cache.store (key.isEmpty () ? AsrResultCache::keyFor (path, models, AsrLanguage) : key,
+                         segments);
+        });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::completeJob (
+    AsrJobTiming timing)
+{
+    timing.wall = m_jobTimer.elapsed () / 1000.0;
+    timing.unknownRate = unknownRate ();
+    qDebug () << "AsrProcessManager: ASR-Job - Laden" << timing.load << "s, Transkription"
+              << timing.transcribe << "s, Diarisierung" << timing.diarize << "s, gesamt"
+              << timing.wall << "s (Sprachanteil" << qRound (m_timeline.speechRatio () * 100.0)
+              << "%, ohne Sprecher" << qRound (qMax (0.0, timing.unknownRate) * 100.0) << "%)";
+
+    //  Ein Treffer im Cache muss nicht erneut gespeichert werden.
+    if (m_job != JobKind::Lookup)
+    {
+        storeInCache ();
+    }
+
+    logCascade (timing);
+
+    const bool wasStream = m_job == JobKind::Stream;
+    if (wasStream)
+    {
+        qDebug () << "AsrProcessManager: Nachlauf nach dem Ende der Aufnahme" << timing.tail
+                  << "s (Worker)," << timing.wall << "s (gesamt)";
+    }
+
+    resetJob ();
+    if (wasStream)
+    {
+        emit partialSegments (QList<MetaText> ());
+    }
+    emit jobTiming (timing);
+    emit finished (true, "");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::logCascade (
+    const AsrJobTiming &timing) const
+{
+    if (timing.escalated < 0.0)
+    {
+        return;
+    }
+    qDebug () << "AsrProcessManager: Kaskade" << m_models.draft << "->" << m_models.model << "-"
+              << timing.escalated << "s von" << timing.audio << "s erneut transkribiert ("
+              << qRound (timing.audio > 0.0 ? timing.escalated / timing.audio * 100.0 : 0.0)
+              << "%), ca." << timing.saved << "s gegenüber nur" << m_models.model << "gespart.";
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double AsrProcessManager::unknownRate () const
+{
+    if (m_cacheSegments.isEmpty ())
+    {
+        return -1.0;
+    }
+
+    //  Segmente ohne Sprecher (z.B. wenn die Diarisierung nach einer Teildatei ausblieb)
+    //  zählen wie UNKNOWN.
+    qsizetype unknown = 0;
+    for (const AsrRawSegment &segment : m_cacheSegments)
+    {
+        unknown += segment.speaker.isEmpty () || segment.speaker == "UNKNOWN";
+    }
+    return double (unknown) / m_cacheSegments.size ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::failJob (
+    const QString &errorMsg)
+{
+    const bool wasStream = m_job == JobKind::Stream;
+    const bool duringRecording = (wasStream && !m_streamEnded) || isSegmenting ();
+    resetJob ();
+
+    //  Bricht ein Stream bzw. die Verarbeitung der Teildateien noch während der Aufnahme
+    //  ab, wird die Aufnahme danach wie bisher vollständig transkribiert; eine
+    //  Fehlermeldung wäre hier verfrüht.
+    if (wasStream)
+    {
+        emit partialSegments (QList<MetaText> ());
+    }
+    if (duringRecording)
+    {
+        emit streamInterrupted (errorMsg);
+        return;
+    }
+    emit finished (false, errorMsg);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::resetJob ()
+{
+    //  Eine noch laufende Planung im Hintergrund verfällt damit.
+    ++m_generation;
+    m_job = JobKind::None;
+    m_queue.clear ();
+    m_retries.clear ();
+    m_chunks.clear ();
+    m_chunkOfRequest.clear ();
+    m_chunkSegments.clear ();
+    m_chunksOpen = false;
+    m_merged.clear ();
+    m_singleSegments.clear ();
+    m_streamSegments.clear ();
+
+    //  Worker, die noch an einer Anfrage arbeiten, werden beendet. Die Liste wird vorher
+    //  geleert, damit ihr Ende nicht als Absturz gewertet wird.
+    const QList<AsrWorker *> busy = m_running.keys ();
+    m_running.clear ();
+    for (AsrWorker *worker : busy)
+    {
+        worker->kill ();
+    }
+    startIdleTimer ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::handleWorkerExited (
+    AsrWorker *worker, int exitCode, bool wasReady)
+{
+    if (!m_running.contains (worker))
+    {
+        //  Konnte ein Worker seine Modelle nicht laden, würde ein Neustart daran nichts ändern.
+        if (!wasReady && m_job != JobKind::None)
+        {
+            failJob (QString ("ASR-Worker konnte nicht gestartet werden (Exit-Code %1).\nDetails: %2")
+                         .arg (exitCode)
+                         .arg (worker->stderrTail ()));
+        }
+        return;
+    }
+
+    //  Absturz während einer Anfrage: Der Worker wird neu gestartet und die Anfrage wiederholt.
+    const QJsonObject request = m_running.take (worker);
+    const qint64 id = request.value ("id").toInteger ();
+    const int retries = m_retries.value (id);
+    if (retries >= MaxRestarts)
+    {
+        failJob (QString ("ASR-Worker wiederholt abgestürzt (Exit-Code %1).\nDetails: %2")
+                     .arg (exitCode)
+                     .arg (worker->stderrTail ()));
+        return;
+    }
+
+    m_retries.insert (id, retries + 1);
+    qWarning () << "AsrProcessManager: ASR-Worker" << worker->index () << "abgestürzt (Exit-Code"
+                << exitCode << "), Neustart" << retries + 1 << "von" << MaxRestarts;
+
+    if (m_chunkOfRequest.contains (id))
+    {
+        m_chunkSegments[m_chunkOfRequest.value (id)].clear ();
+    }
+    else if (m_job == JobKind::Single)
+    {
+        m_unknownCounter = 0;
+        m_cacheSegments.clear ();
+        m_singleSegments.clear ();
+    }
+    m_queue.prepend (request);
+    dispatch ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::startIdleTimer ()
+{
+    //  Nach der Leerlaufzeit werden die Worker beendet, um den Speicher der Modelle freizugeben.
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const int idleSec = settings.value ("asr/workerIdleSec", 600).toInt ();
+    if (idleSec > 0)
+    {
+        m_idleTimer->start (idleSec * 1000);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::handleProcessOutput ()
+{
+    //  Der Parser arbeitet direkt auf den gelesenen Bytes; unvollständige Zeilen bleiben
+    //  bis zum nächsten Aufruf im Puffer.
+    m_parser.feed (m_process->readAllStandardOutput ());
+    while (m_parser.next (&m_event))
+    {
+        handleProtocolEvent (m_event);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::handleProtocolEvent (
+    const AsrEvent &event)
+{
+    switch (event.type)
+    {
+    case AsrEvent::Type::Hello:
+        if (event.protocol > AsrProtocolParser::Version)
+        {
+            qWarning () << "AsrProcessManager: ASR-Skript spricht Protokoll" << event.protocol
+                        << ", unterstützt wird" << AsrProtocolParser::Version;
+        }
+        qDebug () << "AsrProcessManager: Modell" << event.model << ", Sprache" << event.language;
+        break;
+    case AsrEvent::Type::Progress:
+        emit progress (event.stage, event.fraction);
+        break;
+    case AsrEvent::Type::Segment:
+        emit segmentReady (makeSegment (event.segment));
+        break;
+    case AsrEvent::Type::Error:
+        //  Das Skript beendet sich danach mit einem Fehlercode; die Meldung landet über
+        //  stderr in der Fehlermeldung.
+        qWarning () << "AsrProcessManager: ASR-Skript meldet Fehler:" << event.message;
+        break;
+    case AsrEvent::Type::Done:
+        m_timing.load = event.load;
+        m_timing.transcribe = event.transcribe;
+        m_timing.diarize = event.diarize;
+        m_timing.total = event.total;
+        m_timing.audio = event.audio;
+        m_timing.escalated = event.escalated;
+        m_timing.saved = event.saved;
+        break;
+    case AsrEvent::Type::Unknown:
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProcessManager::handleProcessStderr ()
+{
+    //  Nur das Ende der Diagnose-Ausgaben wird für Fehlermeldungen aufbewahrt.
+    m_stderrTail.append (m_process->readAllStandardError ());
+    if (m_stderrTail.size () > StderrTailBytes)
+    {
+        m_stderrTail = m_stderrTail.right (StderrTailBytes);
     }
 }
 
@@ -95,17 +1139,32 @@ void AsrProcessManager::handleProcessOutput ()
 void AsrProcessManager::handleProcessFinished (
     int exitCode, QProcess::ExitStatus exitStatus)
 {
+    //  Restliche Ausgaben (z.B. die letzte Fehlermeldung) noch einsammeln.
+    handleProcessOutput ();
+    handleProcessStderr ();
+
     //  exitStatus prüft, ob der Prozess normal beendet oder abgestürzt ist.
     //  exitCode prüft den von Python zurückgegebenen Fehlercode (Konvention: 0 = Erfolg).
+    AsrJobTiming timing = m_timing;
+    timing.wall = m_jobTimer.elapsed () / 1000.0;
+    timing.unknownRate = unknownRate ();
+    qDebug () << "AsrProcessManager: ASR-Job beendet nach" << timing.wall << "s (Transkription"
+              << timing.transcribe << "s, Diarisierung" << timing.diarize << "s parallel, Sprachanteil"
+              << qRound (m_timeline.speechRatio () * 100.0) << "%, ohne Sprecher"
+              << qRound (qMax (0.0, timing.unknownRate) * 100.0) << "%)";
+
     if (exitStatus == QProcess::NormalExit && exitCode == 0)
     {
+        logCascade (timing);
+        storeInCache ();
+        emit jobTiming (timing);
         emit finished (true, "");
     }
     else
     {
         // Bei einem Fehler wird der Standard-Error-Stream ausgelesen, um eine
         // nützliche Debug-Information an die UI weiterzugeben.
-        QString errorDetails = QString::fromUtf8 (m_process->readAllStandardError ());
+        QString errorDetails = QString::fromUtf8 (m_stderrTail);
         QString errorMsg = QString ("Prozess fehlgeschlagen mit Exit-Code %1.\nDetails: %2")
                                .arg (exitCode)
                                .arg (errorDetails.trimmed ());
@@ -118,6 +1177,12 @@ void AsrProcessManager::handleProcessFinished (
 void AsrProcessManager::handleProcessError (
     QProcess::ProcessError error)
 {
+    //  Abstürze und Lesefehler werden über handleProcessFinished() behandelt.
+    if (error != QProcess::FailedToStart)
+    {
+        return;
+    }
+
     //  Dieser Slot wird für Fehler beim Starten des Prozesses aufgerufen (z.B. "Programm nicht gefunden").
     QString errorMsg = QString ("Ein Fehler ist beim Starten des Prozesses aufgetreten: %1")
                            .arg (m_process->errorString ());
@@ -126,35 +1191,30 @@ void AsrProcessManager::handleProcessError (
 
 //--------------------------------------------------------------------------------------------------
 
-MetaText AsrProcessManager::parseLine (
-    const QString &line)
+MetaText AsrProcessManager::makeSegment (
+    const AsrRawSegment &raw)
 {
-    //  Dieser reguläre Ausdruck zerlegt die Ausgabezeile des Python-Skripts.
-    //  Beispiel: "[0.02s --> 1.55s] SPEAKER_00: Hallo Welt"
-    //  - Capture-Gruppe 1 (\d+\.\d+): Startzeit (z.B. "0.02")
-    //  - Capture-Gruppe 2 (\d+\.\d+): Endzeit (z.B. "1.55")
-    //  - Capture-Gruppe 3 ([A-Z0-9_]+): Sprecher-ID (z.B. "SPEAKER_00")
-    //  - Capture-Gruppe 4 (.*): Der eigentliche Text (z.B. "Hallo Welt")
-    QRegularExpression re (R"(\[(\d+\.\d+)s\s*-->\s*(\d+\.\d+)s\]\s*([A-Z0-9_]+):\s*(.*))");
-    QRegularExpressionMatch match = re.match (line);
+    m_cacheSegments.append (raw);
 
+    //  Bei einer verkürzten Sprachdatei werden die Zeiten auf die Original-Aufnahme zurückgerechnet.
     MetaText result;
-    if (match.hasMatch ())
+    result.StartMs = qRound64 (m_timeline.toOriginalSeconds (raw.start) * 1000.0);
+    result.EndMs = qRound64 (m_timeline.toOriginalSeconds (raw.end) * 1000.0);
+    result.Speaker = raw.speaker;
+    result.Text = raw.text;
+    result.Confidence = raw.confidence;
+    for (const AsrWord &word : raw.words)
     {
-        result.Start = match.captured (1);
-        result.End = match.captured (2);
-        result.Speaker = match.captured (3);
-        result.Text = match.captured (4);
-
-        //  Alle unbekannten Sprecher sollen einen eindeutigen Namen erhalten.
-        if (result.Speaker == "UNKNOWN")
-        {
-            result.Speaker = QString ("UNKNOWN_%1").arg (m_unknownCounter++);
-        }
+        result.Words.append ({word.text,
+                              qRound64 (m_timeline.toOriginalSeconds (word.start) * 1000.0),
+                              qRound64 (m_timeline.toOriginalSeconds (word.end) * 1000.0),
+                              word.probability});
     }
-    else
+
+    //  Alle unbekannten Sprecher sollen einen eindeutigen Namen erhalten.
+    if (result.Speaker == "UNKNOWN")
     {
-        qWarning () << "AsrProcessManager: Konnte Zeile nicht parsen:" << line;
+        result.Speaker = QString ("UNKNOWN_%1").arg (m_unknownCounter++);
     }
     return result;
 }
@@ -169,5 +1229,12 @@ void AsrProcessManager::loadPaths ()
     m_scriptPath = settings.value ("scriptPath").toString ();
 }
 
+//--------------------------------------------------------------------------------------------------
+
+QString AsrProcessManager::workerScriptPath () const
+{
+    return QFileInfo (m_scriptPath).dir ().filePath ("asr_worker.py");
+}
+
 //--------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------
@@ -6,17 +6,95 @@
 #ifndef ASRPROCESSMANAGER_H
 #define ASRPROCESSMANAGER_H
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
 #include <QObject>
 #include <QProcess>
+#include "asrchunker.h"
+#include "asrresultcache.h"
 #include "transcription.h"
+#include "voiceactivitydetector.h"
+
+class AsrWorker;
+class QTimer;
+
+/**
+ * @brief Die Zeitmessung eines ASR-Jobs, aufgeteilt nach Phasen (in Sekunden).
+ */
+struct AsrJobTiming
+{
+    double load = 0.0;       ///< Laden der Modelle (nur beim ersten Job eines Workers > 0).
+    double transcribe = 0.0; ///< Transkription mit Whisper (bei Abschnitten: Summe aller Worker).
+    double diarize = 0.0;    ///< Sprecher-Diarisierung mit pyannote.
+    double total = 0.0;      ///< Summe aus Sicht des Workers.
+    double tail = 0.0;       ///< Nur Live-Streams: Nachlauf nach dem Ende der Aufnahme.
+    double wall = 0.0;       ///< Wanduhrzeit vom Start des Jobs bis zum Ergebnis (aus Sicht der Anwendung).
+    double unknownRate = -1; ///< Anteil der Segmente ohne erkannten Sprecher (-1 = keine Segmente).
+    double audio = 0.0;      ///< Nur Kaskade: Dauer der transkribierten Audiodaten.
+    double escalated = -1;   ///< Nur Kaskade: davon vom großen Modell erneut transkribiert (-1 = ohne Kaskade).
+    double saved = 0.0;      ///< Nur Kaskade: geschätzte Ersparnis gegenüber nur dem großen Modell.
+};
+
+/**
+ * @brief Die Wahl der Whisper-Modelle für einen ASR-Job.
+ *
+ * Mit einem Entwurfsmodell ("asr/cascade") transkribiert zuerst das kleine Modell die ganze
+ * Datei; nur Bereiche mit Segmenten unter @c escalateBelow Konfidenz transkribiert das große
+ * Modell erneut, und seine Segmente ersetzen dort die des kleinen.
+ */
+struct AsrModelChoice
+{
+    QString model;              ///< Modell für das Endergebnis ("asr/model", Standard "large").
+    QString draft;              ///< Kleines Modell für den ersten Durchgang (leer = ohne Kaskade).
+    double escalateBelow = 0.6; ///< Konfidenz, unter der das große Modell erneut transkribiert.
+
+    /** @brief Liest die Modellwahl aus den Einstellungen. */
+    static AsrModelChoice fromSettings ();
+
+    /** @brief Gibt die Bezeichnung der Modelle für den Cache-Schlüssel zurück. */
+    QString cacheId () const;
+};
 
 /**
- * @brief Steuert den externen Python-Prozess für die Spracherkennung (ASR).
+ * @brief Steuert die externen Python-Prozesse für die Spracherkennung (ASR).
+ *
+ * Standardmäßig werden langlebige Worker (AsrWorker, asr_worker.py) verwendet, die Whisper
+ * und pyannote nur einmal laden und anschließend Jobs über ein zeilenbasiertes
+ * JSON-Protokoll auf stdin/stdout entgegennehmen. Der Manager startet die Worker bei
+ * Bedarf, wiederholt eine Anfrage nach einem Absturz einmal mit einem neu gestarteten
+ * Worker und beendet alle Worker nach einer einstellbaren Leerlaufzeit.
+ *
+ * Lange Aufnahmen können auf mehrere Worker verteilt werden ("asr/parallelWorkers" > 1):
+ * Der AsrChunker teilt die Datei an stillen Stellen in überlappende Abschnitte, die Worker
+ * transkribieren sie parallel, und die Segmente werden mit dem Zeitversatz ihres
+ * Abschnitts ohne Doppelungen an den Grenzen zusammengeführt. Die Sprecher werden danach
+ * einmalig für die ganze Datei bestimmt, damit sie über alle Abschnitte einheitlich sind.
+ *
+ * Dasselbe Verfahren verarbeitet auch die Teildateien, die der WavWriterThread im
+ * segmentierten Modus während der Aufnahme abschließt (beginSegments()): Jede Teildatei
+ * wird sofort transkribiert, sodass nach dem Ende der Aufnahme nur noch die letzte
+ * Teildatei und die Sprecherzuordnung ausstehen.
+ *
+ * Während einer Aufnahme kann der erste Worker außerdem im Live-Modus laufen (beginStream()):
+ * Die ASR-Samples werden fortlaufend übertragen, endgültige Segmente kommen über
+ * segmentReady() und vorläufige über partialSegments() zurück. Nach endStream() muss
+ * nur noch das letzte Fenster transkribiert werden; die Sprecher werden dann per
+ * segmentSpeakerChanged() nachgetragen.
  *
- * Diese Klasse kapselt die gesamte Logik für das Starten des ASR-Skripts,
- * die Kommunikation über Standard-I/O und die Fehlerbehandlung. Sie arbeitet
- * vollständig asynchron und kommuniziert ihren Zustand über Signale mit dem
- * Rest der Anwendung (z.B. dem MainWindow).
+ * Der einmalige Prozess (run_asr.py) liefert seine Ergebnisse im JSON-Zeilen-Protokoll des
+ * AsrProtocolParser (Segmente mit Wort-Zeitstempeln und Konfidenz, Fortschritt, Sprache);
+ * die Worker verwenden dieselben Felder in ihren "segment"-Nachrichten.
+ *
+ * Fertige Ergebnisse landen im AsrResultCache. startTranscription() sucht dort zuerst (im
+ * Hintergrund) nach derselben Datei; bei einem Treffer werden die gespeicherten Segmente
+ * ohne Python-Aufruf ausgegeben.
+ *
+ * Fehlt das Worker-Skript oder ist "asr/persistentWorker" deaktiviert, wird wie bisher
+ * für jede Aufnahme das konfigurierte Skript (run_asr.py) als eigener Prozess gestartet.
+ *
+ * Die Klasse arbeitet vollständig asynchron und kommuniziert ihren Zustand über Signale
+ * mit dem Rest der Anwendung (z.B. dem MainWindow).
  */
 class AsrProcessManager : public QObject
 {
@@ -29,52 +107,155 @@ public:
     explicit AsrProcessManager (QObject *parent = nullptr);
 
     /**
-     * @brief Destruktor. Stellt sicher, dass ein laufender Prozess beendet wird.
+     * @brief Destruktor. Stellt sicher, dass alle laufenden Prozesse beendet werden.
      */
     ~AsrProcessManager ();
 
+    /** @brief Gibt an, ob gerade eine Live-Transkription läuft bzw. abgeschlossen wird. */
+    bool isStreaming () const { return m_job == JobKind::Stream; }
+
+    /** @brief Gibt an, ob gerade Teildateien einer laufenden Aufnahme transkribiert werden. */
+    bool isSegmenting () const { return m_job == JobKind::Chunked && m_chunksOpen; }
+
 public slots:
     /**
      * @brief Startet den ASR-Prozess für die angegebene WAV-Datei.
      *
-     * Stellt sicher, dass nicht bereits ein Prozess läuft und übergibt den
-     * Dateipfad als Argument an das Python-Skript.
+     * Im Worker-Modus wird der Job an einen laufenden Worker übergeben bzw. der Worker
+     * zuerst gestartet; lange Dateien werden ggf. auf mehrere Worker verteilt.
+     * Es kann immer nur ein Job gleichzeitig laufen.
      * @param wavFilePath Der absolute Pfad zur 16-kHz-Mono-WAV-Datei, die verarbeitet werden soll.
+     * @param timeline Ist die Datei auf die Sprachbereiche verkürzt, bildet die Timeline die
+     *        Zeitstempel der Segmente auf die Original-Aufnahme ab. Leer = unverkürzte Datei.
      * @note Dies ist ein öffentlicher Slot, der z.B. von der MainWindow aufgerufen wird.
      */
-    void startTranscription (const QString &wavFilePath);
+    void startTranscription (const QString &wavFilePath,
+                             const SpeechTimeline &timeline = SpeechTimeline ());
 
     /**
-     * @brief Stoppt den laufenden ASR-Prozess, falls einer aktiv ist.
+     * @brief Stoppt den laufenden ASR-Job, falls einer aktiv ist.
      *
      * Nützlich, wenn eine neue Aufnahme gestartet wird, während eine alte
-     * Transkription noch läuft.
+     * Transkription noch läuft. Da ein Job im Worker nicht abgebrochen werden kann,
+     * werden die beteiligten Worker dabei beendet und beim nächsten Job neu gestartet.
      */
     void stop ();
 
+    /**
+     * @brief Beendet alle untätigen Worker und gibt damit den Speicher der Modelle frei.
+     */
+    void shutdownWorkers ();
+
+    /**
+     * @brief Startet eine Live-Transkription für die beginnende Aufnahme.
+     *
+     * Setzt den Worker-Modus und die Einstellung "asr/streaming" voraus.
+     * @return true, wenn der Stream gestartet wurde; sonst muss nach der Aufnahme
+     *         wie bisher startTranscription() aufgerufen werden.
+     */
+    bool beginStream ();
+
+    /**
+     * @brief Überträgt neue Samples an den laufenden Stream.
+     * @param pcm16 PCM16-Samples (16 kHz, Mono), wie sie in die ASR-Datei geschrieben werden.
+     */
+    void appendStreamAudio (const QByteArray &pcm16);
+
+    /**
+     * @brief Schließt den Stream nach dem Ende der Aufnahme ab.
+     *
+     * Der Worker transkribiert den Rest und ordnet anschließend anhand der vollständigen
+     * Datei die Sprecher zu. Danach wird finished() gesendet.
+     * @param wavFilePath Die vollständige ASR-Datei der Aufnahme (für die Diarisierung).
+     */
+    void endStream (const QString &wavFilePath);
+
+    /**
+     * @brief Bereitet die Transkription von Teildateien der beginnenden Aufnahme vor.
+     *
+     * Setzt den Worker-Modus voraus. Die Teildateien werden mit addSegment() übergeben
+     * und parallel auf bis zu "asr/parallelWorkers" Worker verteilt.
+     * @return true, wenn der Job angelegt wurde; sonst muss nach der Aufnahme
+     *         wie bisher startTranscription() aufgerufen werden.
+     */
+    bool beginSegments ();
+
+    /**
+     * @brief Übergibt eine abgeschlossene Teildatei zur Transkription.
+     * @param path Pfad der Teildatei (16 kHz, Mono, PCM16).
+     * @param offsetSeconds Beginn der Teildatei innerhalb der Aufnahme in Sekunden.
+     */
+    void addSegment (const QString &path, double offsetSeconds);
+
+    /**
+     * @brief Schließt die Teildateien nach dem Ende der Aufnahme ab.
+     *
+     * Sobald alle Teildateien transkribiert sind, werden die Sprecher anhand der
+     * vollständigen Datei bestimmt und die Segmente gesendet. Danach folgt finished().
+     * @param wavFilePath Die vollständige ASR-Datei der Aufnahme (für die Diarisierung).
+     */
+    void endSegments (const QString &wavFilePath);
+
 signals:
     /**
      * @brief Wird für jedes erkannte und geparste Textsegment gesendet.
-     *
-     * Das Python-Skript gibt die Segmente zeilenweise aus; dieses Signal wird
-     * für jede erfolgreich geparste Zeile emittiert.
      * @param segment Das vollständig geparste Segment mit Zeitstempeln, Sprecher und Text.
      */
     void segmentReady (const MetaText &segment);
 
     /**
-     * @brief Wird gesendet, wenn der ASR-Prozess (erfolgreich oder nicht) abgeschlossen ist.
-     * @param success true, wenn der Prozess ohne Fehler (Exit-Code 0) beendet wurde.
-     * @param errorMsg Eine Fehlermeldung, falls der Prozess fehlschlug. Enthält
-     * typischerweise den Standard-Error-Stream des Prozesses für Debugging.
+     * @brief Wird gesendet, wenn der ASR-Job (erfolgreich oder nicht) abgeschlossen ist.
+     * @param success true, wenn der Job ohne Fehler beendet wurde.
+     * @param errorMsg Eine Fehlermeldung, falls der Job fehlschlug. Enthält
+     * typischerweise die letzte Ausgabe auf dem Standard-Error-Stream für Debugging.
      */
     void finished (bool success, const QString &errorMsg);
 
+    /**
+     * @brief Wird nach jedem erfolgreichen Job vor finished() mit der Zeitmessung gesendet.
+     * @param timing Die Dauer der einzelnen Phasen und der Anteil unbekannter Sprecher.
+     */
+    void jobTiming (const AsrJobTiming &timing);
+
+    /**
+     * @brief Liefert die vorläufigen Segmente eines Live-Streams.
+     * @param segments Ersetzt die zuvor gesendeten vorläufigen Segmente (leer = keine).
+     */
+    void partialSegments (const QList<MetaText> &segments);
+
+    /**
+     * @brief Trägt nach dem Ende eines Live-Streams den Sprecher eines Segments nach.
+     * @param startMs Beginn des Segments in ms, wie mit segmentReady() gesendet.
+     * @param endMs Ende des Segments in ms.
+     * @param speaker Der von der Diarisierung ermittelte Sprecher.
+     */
+    void segmentSpeakerChanged (qint64 startMs, qint64 endMs, const QString &speaker);
+
+    /**
+     * @brief Wird gesendet, wenn ein Live-Stream oder die Verarbeitung der Teildateien
+     * während der Aufnahme abbricht.
+     *
+     * Die Aufnahme läuft weiter; isStreaming() und isSegmenting() sind danach false, sodass die Aufnahme
+     * anschließend wie bisher vollständig transkribiert werden kann.
+     * @param errorMsg Beschreibung des Fehlers.
+     */
+    void streamInterrupted (const QString &errorMsg);
+
+    /**
+     * @brief Meldet den Fortschritt einer Phase, sofern das Skript ihn liefert.
+     * @param stage Die Phase ("load", "transcribe", "diarize").
+     * @param fraction Anteil 0..1.
+     */
+    void progress (const QString &stage, double fraction);
+
 private slots:
-    // Interne Slots zur Behandlung der Signale von QProcess
+    // Interne Slots zur Behandlung der Signale des einmaligen QProcess (ohne Worker)
     /** @brief Interner Slot, der aufgerufen wird, wenn der Prozess Daten auf stdout ausgibt. */
     void handleProcessOutput ();
 
+    /** @brief Interner Slot, der die Diagnose-Ausgaben des Prozesses (stderr) sammelt. */
+    void handleProcessStderr ();
+
     /** @brief Interner Slot, der aufgerufen wird, wenn der Prozess sich beendet. */
     void handleProcessFinished (int exitCode, QProcess::ExitStatus exitStatus);
 
@@ -82,22 +263,142 @@ private slots:
     void handleProcessError (QProcess::ProcessError error);
 
 private:
+    /** @brief Art des aktuellen Jobs im Worker-Modus. */
+    enum class JobKind
+    {
+        None,    ///< Kein Job aktiv.
+        Lookup,  ///< Suche im AsrResultCache, danach ggf. Single oder Chunked.
+        Single,  ///< Eine Datei auf einem Worker.
+        Chunked, ///< Eine Datei in Abschnitten auf mehreren Workern.
+        Stream   ///< Live-Transkription während der Aufnahme (immer auf dem ersten Worker).
+    };
+
+    /** @brief Gibt den Worker mit dem Index zurück und legt ihn bei Bedarf an. */
+    AsrWorker *workerAt (int index);
+
+    /** @brief Prüft, ob der Worker-Modus aktiviert und das Worker-Skript vorhanden ist. */
+    bool workerModeAvailable () const;
+
+    /** @brief Erstellt eine Anfrage für die aktuelle Datei mit neuer ID. */
+    QJsonObject makeRequest (const QString &cmd, int threads);
+
+    /** @brief Liest "asr/parallelWorkers", begrenzt auf die Anzahl der Kerne. */
+    int configuredPoolSize () const;
+
+    /** @brief Reiht einen Abschnitt als Anfrage ein (Sample-Bereich bzw. ganze Teildatei). */
+    void queueChunk (const AsrChunk &chunk, QJsonObject request);
+
+    /** @brief Verteilt wartende Anfragen auf bereite Worker und startet fehlende Worker. */
+    void dispatch ();
+
+    /** @brief Plant die Abschnitte der aktuellen Datei im Hintergrund und reiht sie danach ein. */
+    void startChunked (int chunkCount);
+
+    /** @brief Reiht die geplanten Abschnitte als Anfragen ein. */
+    void queueChunks (const QList<AsrChunk> &chunks);
+
+    /** @brief Wertet eine Protokollnachricht eines Workers aus. */
+    void handleWorkerMessage (AsrWorker *worker, const QJsonObject &message);
+
+    /** @brief Behandelt das Ende eines Worker-Prozesses (ggf. Wiederholung der Anfrage). */
+    void handleWorkerExited (AsrWorker *worker, int exitCode, bool wasReady);
+
+    /** @brief Eine Anfrage wurde vom Worker mit "done" abgeschlossen. */
+    void handleRequestDone (const QJsonObject &request, const QJsonObject &timing);
+
+    /** @brief Führt die Abschnitte zusammen und startet die Diarisierung der ganzen Datei. */
+    void mergeChunks ();
+
+    /** @brief Startet die eigentliche Transkription (nach einem Fehlschlag im Cache). */
+    void launchTranscription (const QString &wavFilePath);
+
+    /** @brief Legt die Segmente des abgeschlossenen Jobs im Hintergrund im Cache ab. */
+    void storeInCache ();
+
+    /** @brief Schließt den aktuellen Job erfolgreich ab. */
+    void completeJob (AsrJobTiming timing);
+
+    /** @brief Protokolliert den erneut transkribierten Anteil und die Ersparnis der Kaskade. */
+    void logCascade (const AsrJobTiming &timing) const;
+
+    /** @brief Gibt den Anteil der Segmente des Jobs ohne erkannten Sprecher zurück (-1 = keine). */
+    double unknownRate () const;
+
+    /** @brief Beendet den aktuellen Job mit einem Fehler. */
+    void failJob (const QString &errorMsg);
+
+    /** @brief Setzt den Job-Zustand zurück und beendet die noch beschäftigten Worker. */
+    void resetJob ();
+
+    /** @brief Startet den Leerlauf-Timer mit "asr/workerIdleSec" (0 = Worker bleiben aktiv). */
+    void startIdleTimer ();
+
+    /** @brief Behandelt eine Nachricht des einmaligen Prozesses (Protokoll oder altes Zeilenformat). */
+    void handleProtocolEvent (const AsrEvent &event);
+
     /**
-     * @brief Parst eine einzelne Ausgabezeile des Python-Skripts in ein MetaText-Objekt.
-     * @param line Die zu parsende Zeile im Format "[start]s --> [end]s] SPEAKER: Text".
-     * @return Ein gefülltes MetaText-Objekt. Wenn das Parsen fehlschlägt, ist das Objekt leer.
+     * @brief Erstellt ein Segment; rechnet die Zeiten über die Timeline auf die
+     * Original-Aufnahme um und vergibt eindeutige Namen für unbekannte Sprecher.
+     * Die Rohdaten werden zusätzlich für den Cache gesammelt.
      */
-    MetaText parseLine (const QString &line);
+    MetaText makeSegment (const AsrRawSegment &raw);
 
     /**
      * @brief Lädt den Python- und den Skript-Pfad aus den globalen Einstellungen
      */
     void loadPaths ();
 
-    QProcess *m_process;  ///< Zeiger auf das QProcess-Objekt, das das Python-Skript ausführt.
+    /** @brief Gibt den Pfad des Worker-Skripts zurück (neben dem konfigurierten ASR-Skript). */
+    QString workerScriptPath () const;
+
+    static constexpr int MaxRestarts = 1;        ///< Wiederholungen pro Anfrage nach einem Absturz.
+    static constexpr int StderrTailBytes = 4096; ///< Umfang der aufbewahrten stderr-Ausgabe.
+    static constexpr int SampleRate = 16000;     ///< Abtastrate der ASR-Dateien.
+    static constexpr int MinChunkSeconds = 60;   ///< Kürzere Abschnitte lohnen das Aufteilen nicht.
+    //  Sprache, wie sie asr_worker.py und run_asr.py verwenden; sie ist Teil des
+    //  Cache-Schlüssels und muss bei einer Änderung der Skripte mitgezogen werden.
+    static constexpr const char *AsrLanguage = "de"; ///< Sprache der Transkription.
+
+    QProcess *m_process;  ///< Einmaliger Prozess für den Betrieb ohne Worker.
     QString m_pythonPath; ///< Pfad zum Python-Interpreter der virtuellen Umgebung.
     QString m_scriptPath; ///< Pfad zum ASR-Python-Skript.
     int m_unknownCounter; ///< Zähler für die Benennung von unbekannten Sprechern (UNKNOWN_0, UNKNOWN_1, ...).
+    SpeechTimeline m_timeline; ///< Abbildung der Zeitstempel auf die Original-Aufnahme.
+    QElapsedTimer m_jobTimer;  ///< Misst die Laufzeit des aktuellen ASR-Jobs.
+    QByteArray m_stderrTail;   ///< Die letzten Bytes der stderr-Ausgabe des einmaligen Prozesses.
+    AsrProtocolParser m_parser; ///< Zerlegt die stdout-Ausgabe des einmaligen Prozesses.
+    AsrEvent m_event;          ///< Wiederverwendete Nachricht des Parsers.
+    QString m_cacheKey;        ///< Cache-Schlüssel der aktuellen Datei (leer = noch nicht berechnet).
+    QList<AsrRawSegment> m_cacheSegments; ///< Rohdaten der Segmente für den Cache.
+    AsrModelChoice m_models;   ///< Die Modellwahl des aktuellen Jobs.
+
+    // Worker-Modus
+    QList<AsrWorker *> m_workers;              ///< Alle bisher angelegten Worker.
+    QTimer *m_idleTimer;                       ///< Beendet die Worker nach der Leerlaufzeit.
+    JobKind m_job;                             ///< Art des aktuellen Jobs.
+    quint64 m_generation;                      ///< Wird bei jedem Job erhöht (für Hintergrundaufgaben).
+    qint64 m_nextId;                           ///< Zuletzt vergebene Anfrage-ID.
+    QString m_jobPath;                         ///< Die Datei des aktuellen Jobs.
+    int m_poolSize;                            ///< Anzahl der Worker für den aktuellen Job.
+    QList<QJsonObject> m_queue;                ///< Anfragen, die auf einen bereiten Worker warten.
+    QHash<AsrWorker *, QJsonObject> m_running; ///< Die Anfrage, die jeder Worker gerade bearbeitet.
+    QHash<qint64, int> m_retries;              ///< Wiederholungen je Anfrage-ID.
+    AsrJobTiming m_timing;                     ///< Zeitmessung eines aufgeteilten Jobs bzw. des einmaligen Prozesses.
+
+    // Aufgeteilte Jobs
+    QList<AsrChunk> m_chunks;                    ///< Die geplanten Abschnitte.
+    QHash<qint64, int> m_chunkOfRequest;         ///< Index des Abschnitts je Anfrage-ID.
+    QList<QList<AsrRawSegment>> m_chunkSegments; ///< Die Segmente je Abschnitt.
+    int m_chunksDone;                            ///< Anzahl der fertigen Abschnitte.
+    bool m_chunksOpen;                           ///< Es können noch Teildateien hinzukommen.
+    QElapsedTimer m_chunkTimer;                  ///< Misst die Dauer der parallelen Phase.
+    QList<AsrRawSegment> m_merged;               ///< Zusammengeführte Segmente aller Abschnitte.
+    QList<AsrRawSegment> m_singleSegments;       ///< Segmente eines Einzel-Jobs bis "done".
+
+    // Live-Stream
+    bool m_streamEnded;        ///< endStream() wurde aufgerufen.
+    qint64 m_streamId;         ///< Anfrage-ID des Streams.
+    QList<QPair<qint64, qint64>> m_streamSegments; ///< Start/Ende (ms) der endgültigen Segmente in Sendereihenfolge.
 };
 
 #endif // ASRPROCESSMANAGER_H
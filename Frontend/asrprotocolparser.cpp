@@ -0,0 +1,650 @@
+#include "asrprotocolparser.h"
+
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+constexpr int MaxMantissaDigits = 19; //  Mehr Stellen passen nicht verlustfrei in quint64.
+
+//  Zehnerpotenzen, die als double exakt darstellbar sind.
+constexpr double Pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+//  Überspringt Leerraum und gibt die erste andere Position zurück.
+const char *skipSpace (
+    const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+    {
+        ++p;
+    }
+    return p;
+}
+
+//  Liest eine Zahl im JSON-Format (unabhängig vom eingestellten Locale, anders als strtod).
+const char *parseNumber (
+    const char *p, const char *end, double *out)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
+    {
+        if (digits < MaxMantissaDigits)
+        {
+            mantissa = mantissa * 10 + quint64 (*p - '0');
+            digits += mantissa > 0 ? 1 : 0;
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
+        {
+            if (digits < MaxMantissaDigits)
+            {
+                mantissa = mantissa * 10 + quint64 (*p - '0');
+                digits += mantissa > 0 ? 1 : 0;
+                --exponent;
+            }
+        }
+    }
+    if (!any)
+    {
+        return nullptr;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negativeExp = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negativeExp = *p == '-';
+            ++p;
+        }
+        int value = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            value = qMin (value * 10 + (*p - '0'), 10000);
+        }
+        exponent += negativeExp ? -value : value;
+    }
+
+    double result = double (mantissa);
+    if (exponent < 0)
+    {
+        result = -exponent <= 22 ? result / Pow10[-exponent] : result * std::pow (10.0, exponent);
+    }
+    else if (exponent > 0)
+    {
+        result = exponent <= 22 ? result * Pow10[exponent] : result * std::pow (10.0, exponent);
+    }
+    *out = negative ? -result : result;
+    return p;
+}
+
+//  Liest einen String ohne Dekodierung; nur für Schlüssel und feste Werte ohne Escapes gedacht.
+const char *stringSlice (
+    const char *p, const char *end, const char **begin, const char **stop)
+{
+    if (p >= end || *p != '"')
+    {
+        return nullptr;
+    }
+    *begin = ++p;
+    while (p < end && *p != '"')
+    {
+        p += *p == '\\' ? 2 : 1;
+    }
+    if (p >= end)
+    {
+        return nullptr;
+    }
+    *stop = p;
+    return p + 1;
+}
+
+//  Vergleicht einen String-Ausschnitt mit einem Literal.
+template <qsizetype N>
+bool sliceIs (
+    const char *begin, const char *stop, const char (&literal)[N])
+{
+    return stop - begin == N - 1 && std::memcmp (begin, literal, N - 1) == 0;
+}
+
+//  Überspringt einen beliebigen JSON-Wert (für unbekannte Schlüssel).
+const char *skipValue (
+    const char *p, const char *end)
+{
+    p = skipSpace (p, end);
+    if (p >= end)
+    {
+        return nullptr;
+    }
+    if (*p == '"')
+    {
+        const char *b = nullptr;
+        const char *e = nullptr;
+        return stringSlice (p, end, &b, &e);
+    }
+    if (*p == '{' || *p == '[')
+    {
+        int depth = 0;
+        while (p < end)
+        {
+            if (*p == '"')
+            {
+                const char *b = nullptr;
+                const char *e = nullptr;
+                p = stringSlice (p, end, &b, &e);
+                if (!p)
+                {
+                    return nullptr;
+                }
+                continue;
+            }
+            if (*p == '{' || *p == '[')
+            {
+                ++depth;
+            }
+            else if ((*p == '}' || *p == ']') && --depth == 0)
+            {
+                return p + 1;
+            }
+            ++p;
+        }
+        return nullptr;
+    }
+    if (*p == '-' || (*p >= '0' && *p <= '9'))
+    {
+        double ignored = 0.0;
+        return parseNumber (p, end, &ignored);
+    }
+    while (p < end && *p >= 'a' && *p <= 'z') //  true, false, null
+    {
+        ++p;
+    }
+    return p;
+}
+
+//  Hängt einen Unicode-Codepoint als UTF-8 an.
+void appendUtf8 (
+    QByteArray &out, uint code)
+{
+    if (code < 0x80)
+    {
+        out.append (char (code));
+    }
+    else if (code < 0x800)
+    {
+        out.append (char (0xC0 | (code >> 6)));
+        out.append (char (0x80 | (code & 0x3F)));
+    }
+    else if (code < 0x10000)
+    {
+        out.append (char (0xE0 | (code >> 12)));
+        out.append (char (0x80 | ((code >> 6) & 0x3F)));
+        out.append (char (0x80 | (code & 0x3F)));
+    }
+    else
+    {
+        out.append (char (0xF0 | (code >> 18)));
+        out.append (char (0x80 | ((code >> 12) & 0x3F)));
+        out.append (char (0x80 | ((code >> 6) & 0x3F)));
+        out.append (char (0x80 | (code & 0x3F)));
+    }
+}
+
+//  Liest vier Hex-Ziffern einer \u-Sequenz.
+bool parseHex4 (
+    const char *p, const char *end, uint *out)
+{
+    if (end - p < 4)
+    {
+        return false;
+    }
+    uint value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        const char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+        {
+            value |= uint (c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            value |= uint (c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            value |= uint (c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    *out = value;
+    return true;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrRawSegment::shift (
+    double seconds)
+{
+    start += seconds;
+    end += seconds;
+    for (AsrWord &word : words)
+    {
+        word.start += seconds;
+        word.end += seconds;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProtocolParser::feed (
+    const QByteArray &data)
+{
+    m_buffer.append (data);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrProtocolParser::next (
+    AsrEvent *event)
+{
+    while (m_pos < m_buffer.size ())
+    {
+        const char *data = m_buffer.constData ();
+        const char *begin = data + m_pos;
+        const char *newline
+            = static_cast<const char *> (std::memchr (begin, '\n', size_t (m_buffer.size () - m_pos)));
+        if (!newline)
+        {
+            break;
+        }
+        m_pos = newline - data + 1;
+
+        const char *end = newline;
+        while (end > begin && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+        {
+            --end;
+        }
+        begin = skipSpace (begin, end);
+        if (begin == end)
+        {
+            continue;
+        }
+
+        if (parseLine (begin, end, event))
+        {
+            return true;
+        }
+        qWarning () << "AsrProtocolParser: Konnte Zeile nicht parsen:"
+                    << QByteArray (begin, qMin<qsizetype> (end - begin, 200));
+    }
+
+    //  Gelesene Zeilen werden erst entfernt, wenn keine vollständige Zeile mehr übrig ist;
+    //  so wird der Puffer pro Datenblock höchstens einmal verschoben.
+    m_buffer.remove (0, m_pos);
+    m_pos = 0;
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrProtocolParser::reset ()
+{
+    m_buffer.clear ();
+    m_pos = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrProtocolParser::parseLine (
+    const char *begin, const char *end, AsrEvent *event)
+{
+    //  Die Felder werden geleert statt neu angelegt, damit ihr Speicher erhalten bleibt.
+    event->type = AsrEvent::Type::Unknown;
+    event->protocol = 0;
+    event->language.clear ();
+    event->model.clear ();
+    event->stage.clear ();
+    event->fraction = 0.0;
+    event->segment.start = 0.0;
+    event->segment.end = 0.0;
+    event->segment.speaker.clear ();
+    event->segment.text.clear ();
+    event->segment.confidence = -1.0;
+    event->segment.words.clear ();
+    event->message.clear ();
+    event->load = event->transcribe = event->diarize = event->total = 0.0;
+    event->audio = event->saved = 0.0;
+    event->escalated = -1.0;
+
+    if (begin < end && *begin == '{')
+    {
+        return parseJson (begin, end, event);
+    }
+    if (begin < end && *begin == '[')
+    {
+        return parseLegacy (begin, end, event);
+    }
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrProtocolParser::parseJson (
+    const char *p, const char *end, AsrEvent *event)
+{
+    p = skipSpace (p + 1, end);
+    while (p && p < end && *p != '}')
+    {
+        const char *keyBegin = nullptr;
+        const char *keyEnd = nullptr;
+        p = stringSlice (p, end, &keyBegin, &keyEnd);
+        if (!p)
+        {
+            return false;
+        }
+        p = skipSpace (p, end);
+        if (p >= end || *p != ':')
+        {
+            return false;
+        }
+        p = skipSpace (p + 1, end);
+
+        double number = 0.0;
+        if (sliceIs (keyBegin, keyEnd, "type"))
+        {
+            const char *b = nullptr;
+            const char *e = nullptr;
+            p = stringSlice (p, end, &b, &e);
+            if (sliceIs (b, e, "segment"))
+            {
+                event->type = AsrEvent::Type::Segment;
+            }
+            else if (sliceIs (b, e, "progress"))
+            {
+                event->type = AsrEvent::Type::Progress;
+            }
+            else if (sliceIs (b, e, "hello"))
+            {
+                event->type = AsrEvent::Type::Hello;
+            }
+            else if (sliceIs (b, e, "done"))
+            {
+                event->type = AsrEvent::Type::Done;
+            }
+            else if (sliceIs (b, e, "error"))
+            {
+                event->type = AsrEvent::Type::Error;
+            }
+        }
+        else if (sliceIs (keyBegin, keyEnd, "start"))
+        {
+            p = parseNumber (p, end, &event->segment.start);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "end"))
+        {
+            p = parseNumber (p, end, &event->segment.end);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "speaker"))
+        {
+            p = parseString (p, end, &event->segment.speaker);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "text"))
+        {
+            p = parseString (p, end, &event->segment.text);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "confidence") && *p != 'n')
+        {
+            p = parseNumber (p, end, &event->segment.confidence);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "words") && *p == '[')
+        {
+            //  Jedes Wort ist ein Array [start, end, "text", wahrscheinlichkeit].
+            p = skipSpace (p + 1, end);
+            while (p && p < end && *p == '[')
+            {
+                AsrWord word;
+                p = parseNumber (skipSpace (p + 1, end), end, &word.start);
+                p = p ? skipSpace (p, end) : nullptr;
+                p = p && *p == ',' ? parseNumber (skipSpace (p + 1, end), end, &word.end) : nullptr;
+                p = p ? skipSpace (p, end) : nullptr;
+                p = p && *p == ',' ? parseString (skipSpace (p + 1, end), end, &word.text) : nullptr;
+                p = p ? skipSpace (p, end) : nullptr;
+                if (p && *p == ',')
+                {
+                    p = skipSpace (p + 1, end);
+                    p = *p == 'n' ? skipValue (p, end) : parseNumber (p, end, &word.probability);
+                    p = p ? skipSpace (p, end) : nullptr;
+                }
+                if (!p || *p != ']')
+                {
+                    return false;
+                }
+                event->segment.words.append (word);
+                p = skipSpace (p + 1, end);
+                if (p < end && *p == ',')
+                {
+                    p = skipSpace (p + 1, end);
+                }
+            }
+            if (!p || p >= end || *p != ']')
+            {
+                return false;
+            }
+            ++p;
+        }
+        else if (sliceIs (keyBegin, keyEnd, "fraction"))
+        {
+            p = parseNumber (p, end, &event->fraction);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "stage"))
+        {
+            p = parseString (p, end, &event->stage);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "protocol"))
+        {
+            p = parseNumber (p, end, &number);
+            event->protocol = int (number);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "language"))
+        {
+            p = parseString (p, end, &event->language);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "model"))
+        {
+            p = parseString (p, end, &event->model);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "load"))
+        {
+            p = parseNumber (p, end, &event->load);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "transcribe"))
+        {
+            p = parseNumber (p, end, &event->transcribe);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "diarize"))
+        {
+            p = parseNumber (p, end, &event->diarize);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "total"))
+        {
+            p = parseNumber (p, end, &event->total);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "audio"))
+        {
+            p = parseNumber (p, end, &event->audio);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "escalated"))
+        {
+            p = parseNumber (p, end, &event->escalated);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "saved"))
+        {
+            p = parseNumber (p, end, &event->saved);
+        }
+        else if (sliceIs (keyBegin, keyEnd, "message"))
+        {
+            p = parseString (p, end, &event->message);
+        }
+        else
+        {
+            p = skipValue (p, end);
+        }
+
+        p = p ? skipSpace (p, end) : nullptr;
+        if (p && p < end && *p == ',')
+        {
+            p = skipSpace (p + 1, end);
+        }
+    }
+    return p && p < end && event->type != AsrEvent::Type::Unknown;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrProtocolParser::parseLegacy (
+    const char *p, const char *end, AsrEvent *event)
+{
+    //  Beispiel: "[0.02s --> 1.55s] SPEAKER_00: Hallo Welt"
+    p = parseNumber (skipSpace (p + 1, end), end, &event->segment.start);
+    if (!p || p >= end || *p != 's')
+    {
+        return false;
+    }
+    p = skipSpace (p + 1, end);
+    if (end - p < 3 || std::memcmp (p, "-->", 3) != 0)
+    {
+        return false;
+    }
+    p = parseNumber (skipSpace (p + 3, end), end, &event->segment.end);
+    if (!p || end - p < 2 || p[0] != 's' || p[1] != ']')
+    {
+        return false;
+    }
+    p = skipSpace (p + 2, end);
+
+    //  Die Sprecher-ID besteht aus Großbuchstaben, Ziffern und Unterstrichen.
+    const char *speaker = p;
+    while (p < end && ((*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '_'))
+    {
+        ++p;
+    }
+    if (p == speaker || p >= end || *p != ':')
+    {
+        return false;
+    }
+    event->segment.speaker = QString::fromLatin1 (speaker, p - speaker);
+    p = skipSpace (p + 1, end);
+    event->segment.text = QString::fromUtf8 (p, end - p);
+    event->type = AsrEvent::Type::Segment;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const char *AsrProtocolParser::parseString (
+    const char *p, const char *end, QString *out)
+{
+    if (p >= end || *p != '"')
+    {
+        return nullptr;
+    }
+    const char *begin = ++p;
+    while (p < end && *p != '"' && *p != '\\')
+    {
+        ++p;
+    }
+    if (p < end && *p == '"')
+    {
+        //  Häufigster Fall: keine Escape-Sequenzen, direkt aus dem Puffer dekodieren.
+        *out = QString::fromUtf8 (begin, p - begin);
+        return p + 1;
+    }
+
+    m_scratch.resize (0);
+    m_scratch.append (begin, p - begin);
+    while (p < end && *p != '"')
+    {
+        if (*p != '\\')
+        {
+            m_scratch.append (*p++);
+            continue;
+        }
+        if (++p >= end)
+        {
+            return nullptr;
+        }
+        switch (*p)
+        {
+        case 'n':
+            m_scratch.append ('\n');
+            break;
+        case 't':
+            m_scratch.append ('\t');
+            break;
+        case 'r':
+            m_scratch.append ('\r');
+            break;
+        case 'b':
+            m_scratch.append ('\b');
+            break;
+        case 'f':
+            m_scratch.append ('\f');
+            break;
+        case 'u':
+        {
+            uint code = 0;
+            if (!parseHex4 (p + 1, end, &code))
+            {
+                return nullptr;
+            }
+            p += 4;
+            //  Zeichen außerhalb der BMP kommen als Surrogat-Paar.
+            uint low = 0;
+            if (code >= 0xD800 && code < 0xDC00 && end - p > 6 && p[1] == '\\' && p[2] == 'u'
+                && parseHex4 (p + 3, end, &low) && low >= 0xDC00 && low < 0xE000)
+            {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                p += 6;
+            }
+            appendUtf8 (m_scratch, code);
+            break;
+        }
+        default: //  \" \\ \/
+            m_scratch.append (*p);
+            break;
+        }
+        ++p;
+    }
+    if (p >= end)
+    {
+        return nullptr;
+    }
+    *out = QString::fromUtf8 (m_scratch);
+    return p + 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
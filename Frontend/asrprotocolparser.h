@@ -0,0 +1,138 @@
+/**
+ * @file asrprotocolparser.h
+ * @brief Enthält die Deklaration des AsrProtocolParser für die Ausgabe der ASR-Skripte.
+ * @author Mike Wild
+ */
+#ifndef ASRPROTOCOLPARSER_H
+#define ASRPROTOCOLPARSER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Ein Wort mit Zeitstempeln, wie es das ASR-Skript liefert (Zeiten in Sekunden).
+ */
+struct AsrWord
+{
+    double start = 0.0;        ///< Beginn des Wortes.
+    double end = 0.0;          ///< Ende des Wortes.
+    QString text;              ///< Das Wort (inkl. führendem Leerzeichen, wie von Whisper).
+    double probability = -1.0; ///< Wahrscheinlichkeit 0..1 (-1 = unbekannt).
+};
+
+/**
+ * @brief Ein Segment, wie es das ASR-Skript bzw. der Worker geliefert hat.
+ *
+ * Die Zeiten beziehen sich auf die transkribierte Datei; Umrechnung über die SpeechTimeline
+ * und Nummerierung unbekannter Sprecher erfolgen erst im AsrProcessManager.
+ */
+struct AsrRawSegment
+{
+    double start = 0.0;       ///< Startzeit in Sekunden.
+    double end = 0.0;         ///< Endzeit in Sekunden.
+    QString speaker;          ///< Der Sprecher, wie vom Skript geliefert (z.B. "UNKNOWN").
+    QString text;             ///< Der erkannte Text.
+    double confidence = -1.0; ///< Konfidenz des Segments 0..1 (-1 = unbekannt).
+    QList<AsrWord> words;     ///< Wort-Zeitstempel (leer, wenn nicht geliefert).
+
+    /** @brief Verschiebt Segment und Wörter um @p seconds (z.B. auf die ganze Datei). */
+    void shift (double seconds);
+};
+
+/**
+ * @brief Eine Nachricht des ASR-Protokolls.
+ */
+struct AsrEvent
+{
+    /** @brief Art der Nachricht. */
+    enum class Type
+    {
+        Unknown,  ///< Unbekannte oder ungültige Nachricht.
+        Hello,    ///< Protokollversion, Sprache und Modell.
+        Progress, ///< Fortschritt einer Phase.
+        Segment,  ///< Ein fertiges Segment (auch aus dem alten Zeilenformat).
+        Done,     ///< Die Datei ist vollständig verarbeitet.
+        Error     ///< Das Skript meldet einen Fehler.
+    };
+
+    Type type = Type::Unknown; ///< Art der Nachricht.
+    int protocol = 0;          ///< Hello: Protokollversion.
+    QString language;          ///< Hello: Sprache der Transkription.
+    QString model;             ///< Hello: verwendetes Modell.
+    QString stage;             ///< Progress: Phase ("transcribe", "diarize", ...).
+    double fraction = 0.0;     ///< Progress: Anteil 0..1.
+    AsrRawSegment segment;     ///< Segment: die Daten.
+    QString message;           ///< Error: die Meldung.
+    double load = 0.0;         ///< Done: Laden der Modelle in Sekunden.
+    double transcribe = 0.0;   ///< Done: Transkription in Sekunden.
+    double diarize = 0.0;      ///< Done: Diarisierung in Sekunden (läuft parallel zur Transkription).
+    double total = 0.0;        ///< Done: Wanduhrzeit des Skripts in Sekunden.
+    double audio = 0.0;        ///< Done, nur Kaskade: Dauer der Aufnahme in Sekunden.
+    double escalated = -1.0;   ///< Done, nur Kaskade: erneut transkribierte Sekunden (-1 = ohne Kaskade).
+    double saved = 0.0;        ///< Done, nur Kaskade: geschätzte Ersparnis in Sekunden.
+};
+
+/**
+ * @brief Zerlegt die Ausgabe der ASR-Skripte inkrementell in Nachrichten.
+ *
+ * Das Protokoll (Version 1) besteht aus JSON-Zeilen, z.B.:
+ * @code
+ * {"type": "hello", "protocol": 1, "language": "de", "model": "large"}
+ * {"type": "progress", "stage": "transcribe", "fraction": 0.5}
+ * {"type": "segment", "start": 0.02, "end": 1.55, "speaker": "SPEAKER_00", "text": "Hallo Welt",
+ *  "confidence": 0.91, "words": [[0.02, 0.6, " Hallo", 0.98], [0.6, 1.55, " Welt", 0.95]]}
+ * {"type": "done", "load": 9.1, "transcribe": 41.7, "diarize": 18.2, "total": 52.4,
+ *  "unknown_rate": 0.03, "audio": 600.0, "escalated": 84.5, "saved": 112.3}
+ * @endcode
+ * Zeilen im alten Format "[0.02s --> 1.55s] SPEAKER_00: Hallo Welt" werden weiterhin als
+ * Segment erkannt.
+ *
+ * Die Daten werden mit feed() so angehängt, wie sie vom QProcess kommen; next() liefert die
+ * vollständigen Zeilen. Gelesen wird direkt auf den Bytes des Puffers ohne QRegularExpression
+ * und ohne QJsonDocument; QStrings entstehen nur für die Felder der Nachricht.
+ */
+class AsrProtocolParser
+{
+public:
+    static constexpr int Version = 1; ///< Die unterstützte Protokollversion.
+
+    /** @brief Hängt neue Daten an den Puffer an. */
+    void feed (const QByteArray &data);
+
+    /**
+     * @brief Liest die nächste vollständige Nachricht.
+     * @param event Wird mit der Nachricht überschrieben (Speicher wird wiederverwendet).
+     * @return false, wenn keine vollständige Zeile mehr im Puffer steht.
+     */
+    bool next (AsrEvent *event);
+
+    /** @brief Verwirft den Puffer (z.B. vor einem neuen Prozess). */
+    void reset ();
+
+    /**
+     * @brief Zerlegt eine einzelne Zeile (ohne Zeilenumbruch).
+     * @return false, wenn die Zeile weder gültiges JSON noch das alte Format ist.
+     */
+    bool parseLine (const char *begin, const char *end, AsrEvent *event);
+
+private:
+    /** @brief Liest eine JSON-Zeile; @p p zeigt auf die öffnende Klammer. */
+    bool parseJson (const char *p, const char *end, AsrEvent *event);
+
+    /** @brief Liest eine Zeile im alten Format "[start s --> end s] SPEAKER: Text". */
+    bool parseLegacy (const char *p, const char *end, AsrEvent *event);
+
+    /**
+     * @brief Liest einen JSON-String ab dem öffnenden Anführungszeichen.
+     * @param out Erhält den dekodierten Inhalt.
+     * @return Zeiger hinter das schließende Anführungszeichen oder nullptr bei einem Fehler.
+     */
+    const char *parseString (const char *p, const char *end, QString *out);
+
+    QByteArray m_buffer;  ///< Empfangene, noch nicht gelesene Daten.
+    qsizetype m_pos = 0;  ///< Lese-Position im Puffer.
+    QByteArray m_scratch; ///< Puffer zum Dekodieren von Strings mit Escape-Sequenzen.
+};
+
+#endif // ASRPROTOCOLPARSER_H
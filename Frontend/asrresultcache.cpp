@@ -0,0 +1,227 @@
+#include "asrresultcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+
+namespace
+{
+constexpr int FormatVersion = 2;        //  Ändert sich das Format, verfallen alle Einträge.
+constexpr int ReadBlockBytes = 1 << 20; //  Blockgröße beim Hashen der WAV-Datei.
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+AsrResultCache::AsrResultCache ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const QString defaultDir
+        = QDir (QStandardPaths::writableLocation (QStandardPaths::CacheLocation)).filePath ("asr");
+    m_directory = settings.value ("asrCache/path", defaultDir).toString ();
+    m_maxBytes = qMax (0, settings.value ("asrCache/maxMB", 64).toInt ()) * qint64 (1024 * 1024);
+    m_maxAgeDays = qMax (0, settings.value ("asrCache/maxAgeDays", 90).toInt ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString AsrResultCache::keyFor (
+    const QString &wavPath, const QString &model, const QString &language)
+{
+    QFile file (wavPath);
+    if (!file.open (QIODevice::ReadOnly))
+    {
+        return QString ();
+    }
+
+    //  Modell und Sprache gehören zum Schlüssel: Dieselbe Aufnahme mit anderen Modellen ist
+    //  ein anderes Ergebnis.
+    QCryptographicHash hash (QCryptographicHash::Sha256);
+    hash.addData (QString ("v%1\n%2\n%3\n").arg (FormatVersion).arg (model, language).toUtf8 ());
+    while (!file.atEnd ())
+    {
+        const QByteArray block = file.read (ReadBlockBytes);
+        if (block.isEmpty ())
+        {
+            return QString ();
+        }
+        hash.addData (block);
+    }
+    return QString::fromLatin1 (hash.result ().toHex ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrResultCache::lookup (
+    const QString &key, QList<AsrRawSegment> *segments) const
+{
+    if (!isEnabled () || key.isEmpty ())
+    {
+        return false;
+    }
+
+    QFile file (entryPath (key));
+    if (!file.open (QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson (file.readAll ()).object ();
+    if (root.value ("version").toInt () != FormatVersion || root.value ("key").toString () != key)
+    {
+        return false;
+    }
+
+    segments->clear ();
+    const QJsonArray array = root.value ("segments").toArray ();
+    for (const QJsonValue &value : array)
+    {
+        const QJsonObject object = value.toObject ();
+        AsrRawSegment segment;
+        segment.start = object.value ("start").toDouble ();
+        segment.end = object.value ("end").toDouble ();
+        segment.speaker = object.value ("speaker").toString ();
+        segment.text = object.value ("text").toString ();
+        segment.confidence = object.value ("confidence").toDouble (-1.0);
+        const QJsonArray words = object.value ("words").toArray ();
+        for (const QJsonValue &w : words)
+        {
+            const QJsonArray word = w.toArray ();
+            segment.words.append ({word.at (0).toDouble (),
+                                   word.at (1).toDouble (),
+                                   word.at (2).toString (),
+                                   word.at (3).toDouble (-1.0)});
+        }
+        segments->append (segment);
+    }
+
+    //  Die Änderungszeit dient als Zeitpunkt der letzten Benutzung für evict().
+    file.setFileTime (QDateTime::currentDateTime (), QFileDevice::FileModificationTime);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsrResultCache::store (
+    const QString &key, const QList<AsrRawSegment> &segments) const
+{
+    if (!isEnabled () || key.isEmpty () || !QDir ().mkpath (m_directory))
+    {
+        return false;
+    }
+
+    QJsonArray array;
+    for (const AsrRawSegment &segment : segments)
+    {
+        QJsonArray words;
+        for (const AsrWord &word : segment.words)
+        {
+            words.append (QJsonArray{word.start, word.end, word.text, word.probability});
+        }
+        array.append (QJsonObject{{"start", segment.start},
+                                  {"end", segment.end},
+                                  {"speaker", segment.speaker},
+                                  {"text", segment.text},
+                                  {"confidence", segment.confidence},
+                                  {"words", words}});
+    }
+    const QJsonObject root{{"version", FormatVersion},
+                           {"key", key},
+                           {"created", QDateTime::currentDateTime ().toString (Qt::ISODate)},
+                           {"segments", array}};
+
+    //  Mehrere Manager können gleichzeitig speichern; QSaveFile ersetzt den Eintrag atomar.
+    QSaveFile file (entryPath (key));
+    if (!file.open (QIODevice::WriteOnly)
+        || file.write (QJsonDocument (root).toJson (QJsonDocument::Compact)) < 0 || !file.commit ())
+    {
+        qWarning () << "AsrResultCache: Eintrag konnte nicht gespeichert werden:" << file.errorString ();
+        return false;
+    }
+
+    evict ();
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrResultCache::evict () const
+{
+    //  Neueste (zuletzt benutzte) Einträge zuerst; alles jenseits der Grenzen wird gelöscht.
+    const QFileInfoList entries = QDir (m_directory).entryInfoList ({"*.json"}, QDir::Files, QDir::Time);
+    const QDateTime oldest = QDateTime::currentDateTime ().addDays (-m_maxAgeDays);
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries)
+    {
+        total += entry.size ();
+        if (total > m_maxBytes || (m_maxAgeDays > 0 && entry.lastModified () < oldest))
+        {
+            QFile::remove (entry.absoluteFilePath ());
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrResultCache::clear () const
+{
+    const QFileInfoList entries = QDir (m_directory).entryInfoList ({"*.json"}, QDir::Files);
+    for (const QFileInfo &entry : entries)
+    {
+        QFile::remove (entry.absoluteFilePath ());
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrResultCache::countLookup (
+    bool hit)
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const QString key = hit ? "asrCache/hits" : "asrCache/misses";
+    settings.setValue (key, settings.value (key, 0).toLongLong () + 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+qint64 AsrResultCache::hits ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    return settings.value ("asrCache/hits", 0).toLongLong ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+qint64 AsrResultCache::misses ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    return settings.value ("asrCache/misses", 0).toLongLong ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrResultCache::resetCounters ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    settings.remove ("asrCache/hits");
+    settings.remove ("asrCache/misses");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString AsrResultCache::entryPath (
+    const QString &key) const
+{
+    return QDir (m_directory).filePath (key + ".json");
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,98 @@
+/**
+ * @file asrresultcache.h
+ * @brief Enthält die Deklaration des AsrResultCache für bereits transkribierte ASR-Dateien.
+ * @author Mike Wild
+ */
+#ifndef ASRRESULTCACHE_H
+#define ASRRESULTCACHE_H
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include "asrprotocolparser.h"
+
+/**
+ * @brief Inhaltsadressierter Zwischenspeicher für ASR-Ergebnisse.
+ *
+ * Gespeichert werden die Rohdaten der Segmente (AsrRawSegment) vor der Umrechnung über die
+ * SpeechTimeline und vor der Nummerierung unbekannter Sprecher; beides wird beim Abruf neu
+ * angewendet.
+ *
+ * Der Schlüssel ist ein SHA-256 über den Inhalt der ASR-WAV-Datei sowie Modell und Sprache;
+ * dieselbe Aufnahme wird damit nach einem Absturz, einer Wiederherstellung oder einer
+ * erneuten Transkription ohne Python-Aufruf wiedergefunden. Jeder Eintrag ist eine kleine
+ * JSON-Datei im Verzeichnis "asrCache/path" (Standard: "asr" im Cache-Verzeichnis der
+ * Anwendung).
+ *
+ * Nach jedem Speichern werden die am längsten nicht mehr benutzten Einträge entfernt, bis
+ * "asrCache/maxMB" eingehalten ist (0 schaltet den Cache ab); Einträge älter als
+ * "asrCache/maxAgeDays" (0 = unbegrenzt) verfallen ebenfalls. Treffer und Fehlschläge werden
+ * in "asrCache/hits" bzw. "asrCache/misses" gezählt.
+ *
+ * Die Einstellungen werden im Konstruktor gelesen; die übrigen Methoden greifen nur auf
+ * Dateien zu und dürfen (auf einer Kopie) in einem Hintergrund-Thread laufen.
+ */
+class AsrResultCache
+{
+public:
+    /** @brief Erstellt den Cache mit den aktuellen Einstellungen. */
+    AsrResultCache ();
+
+    /** @brief Gibt an, ob der Cache eingeschaltet ist ("asrCache/maxMB" > 0). */
+    bool isEnabled () const { return m_maxBytes > 0; }
+
+    /** @brief Gibt das Verzeichnis der Einträge zurück. */
+    QString directory () const { return m_directory; }
+
+    /**
+     * @brief Berechnet den Schlüssel einer ASR-Datei.
+     * @param wavPath Pfad der ASR-WAV-Datei.
+     * @param model Bezeichnung der verwendeten Modelle.
+     * @param language Sprache der Transkription.
+     * @return Der Schlüssel als Hex-String; leer, wenn die Datei nicht lesbar ist.
+     * @note Liest die ganze Datei; nicht im GUI-Thread aufrufen.
+     */
+    static QString keyFor (const QString &wavPath, const QString &model, const QString &language);
+
+    /**
+     * @brief Sucht einen Eintrag und markiert ihn als benutzt.
+     * @param key Der Schlüssel aus keyFor().
+     * @param segments Erhält bei einem Treffer die gespeicherten Segmente.
+     * @return true bei einem Treffer.
+     */
+    bool lookup (const QString &key, QList<AsrRawSegment> *segments) const;
+
+    /**
+     * @brief Speichert die Segmente einer Datei und hält danach die Grenzen ein.
+     * @return false, wenn der Eintrag nicht geschrieben werden konnte.
+     */
+    bool store (const QString &key, const QList<AsrRawSegment> &segments) const;
+
+    /** @brief Entfernt veraltete Einträge und die ältesten, bis die Größengrenze passt. */
+    void evict () const;
+
+    /** @brief Entfernt alle Einträge. */
+    void clear () const;
+
+    /** @brief Zählt einen Treffer bzw. Fehlschlag in den Einstellungen. */
+    static void countLookup (bool hit);
+
+    /** @brief Gibt die gezählten Treffer zurück. */
+    static qint64 hits ();
+
+    /** @brief Gibt die gezählten Fehlschläge zurück. */
+    static qint64 misses ();
+
+    /** @brief Setzt beide Zähler zurück. */
+    static void resetCounters ();
+
+private:
+    /** @brief Gibt den Pfad der Eintragsdatei zu einem Schlüssel zurück. */
+    QString entryPath (const QString &key) const;
+
+    QString m_directory; ///< Verzeichnis der Einträge.
+    qint64 m_maxBytes;   ///< Größengrenze aller Einträge (0 = Cache aus).
+    int m_maxAgeDays;    ///< Einträge, die länger nicht benutzt wurden, verfallen (0 = nie).
+};
+
+#endif // ASRRESULTCACHE_H
@@ -0,0 +1,251 @@
+#include "asrworker.h"
+#include "processgovernor.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QTimer>
+
+AsrWorker::AsrWorker (
+    int index, QObject *parent)
+    : QObject (parent)
+    , m_index (index)
+    , m_process (new QProcess (this))
+    , m_healthTimer (new QTimer (this))
+    , m_ready (false)
+    , m_closing (false)
+    , m_awaitingPong (false)
+{
+    connect (m_process, &QProcess::readyReadStandardOutput, this, &AsrWorker::handleOutput);
+    connect (m_process, &QProcess::readyReadStandardError, this, &AsrWorker::handleStderr);
+    connect (m_process, &QProcess::finished, this, &AsrWorker::handleFinished);
+    connect (m_process, &QProcess::errorOccurred, this, &AsrWorker::handleError);
+    connect (m_process,
+             &QProcess::started,
+             this,
+             [this] ()
+             {
+                 //  Bis der Prozess tatsächlich läuft, werden die Anfragen zurückgehalten.
+                 if (!m_outbox.isEmpty ())
+                 {
+                     m_process->write (m_outbox);
+                     m_outbox.clear ();
+                 }
+             });
+
+    m_healthTimer->setInterval (HealthIntervalMs);
+    connect (m_healthTimer, &QTimer::timeout, this, &AsrWorker::onHealthCheck);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AsrWorker::~AsrWorker ()
+{
+    //  Während des Zerstörens sollen keine Signale mehr an den Manager gehen.
+    m_process->disconnect (this);
+    if (m_process->state () == QProcess::NotRunning)
+    {
+        return;
+    }
+
+    //  Der Worker wird zuerst höflich gebeten, sich zu beenden.
+    shutdown ();
+    if (!m_process->waitForFinished (1000))
+    {
+        m_process->terminate ();
+        m_process->waitForFinished (1000);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::start (
+    const QString &pythonPath, const QString &scriptPath)
+{
+    //  Ein Worker, der sich gerade beendet, wird erst abgewartet.
+    if (m_process->state () != QProcess::NotRunning)
+    {
+        if (!m_process->waitForFinished (2000))
+        {
+            kill ();
+        }
+    }
+
+    m_ready = false;
+    m_closing = false;
+    m_awaitingPong = false;
+    m_outbox.clear ();
+    m_stderrTail.clear ();
+
+    qDebug () << "AsrWorker" << m_index << ": Starte" << scriptPath;
+    ProcessGovernor ().apply (m_process);
+    m_process->start (pythonPath, {scriptPath});
+    m_healthTimer->start ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::send (
+    const QJsonObject &command)
+{
+    QByteArray line = QJsonDocument (command).toJson (QJsonDocument::Compact);
+    line.append ('\n');
+
+    if (m_process->state () != QProcess::Running)
+    {
+        m_outbox.append (line);
+        return;
+    }
+    m_process->write (line);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::shutdown ()
+{
+    if (m_process->state () == QProcess::NotRunning)
+    {
+        return;
+    }
+
+    qDebug () << "AsrWorker" << m_index << ": Beende Worker.";
+    m_closing = true;
+    send (QJsonObject{{"cmd", "shutdown"}});
+    m_process->closeWriteChannel ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::kill ()
+{
+    if (m_process->state () == QProcess::NotRunning)
+    {
+        return;
+    }
+
+    m_process->kill ();
+
+    //  Damit ein direkt folgender Job einen neuen Prozess startet.
+    m_process->waitForFinished (1000);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::handleOutput ()
+{
+    while (m_process->canReadLine ())
+    {
+        const QByteArray line = m_process->readLine ().trimmed ();
+        if (line.isEmpty ())
+        {
+            continue;
+        }
+
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson (line, &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject ())
+        {
+            qWarning () << "AsrWorker" << m_index << ": Ungültige Nachricht:" << line;
+            continue;
+        }
+
+        const QJsonObject message = doc.object ();
+        const QString type = message.value ("type").toString ();
+        if (type == "pong")
+        {
+            m_awaitingPong = false;
+        }
+        else if (type == "ready")
+        {
+            m_ready = true;
+            const double load = message.value ("load").toDouble ();
+            qDebug () << "AsrWorker" << m_index << ": bereit, Modelle geladen in" << load << "s";
+            emit ready (load);
+        }
+        else
+        {
+            emit messageReceived (message);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::handleStderr ()
+{
+    //  Die Diagnose-Ausgaben werden protokolliert; nur das Ende wird für Fehlermeldungen aufbewahrt.
+    const QByteArray data = m_process->readAllStandardError ();
+    m_stderrTail.append (data);
+    if (m_stderrTail.size () > StderrTailBytes)
+    {
+        m_stderrTail = m_stderrTail.right (StderrTailBytes);
+    }
+
+    for (const QByteArray &line : data.split ('\n'))
+    {
+        if (!line.trimmed ().isEmpty ())
+        {
+            qDebug () << "asr_worker" << m_index << ":" << line.trimmed ();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::handleFinished (
+    int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED (exitStatus)
+
+    //  Restliche Ausgaben (z.B. die letzte Fehlermeldung) noch einsammeln.
+    handleStderr ();
+
+    const bool wasReady = m_ready;
+    m_ready = false;
+    m_closing = false;
+    m_healthTimer->stop ();
+    qDebug () << "AsrWorker" << m_index << ": beendet (Exit-Code" << exitCode << ").";
+    emit exited (exitCode, wasReady);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::handleError (
+    QProcess::ProcessError error)
+{
+    //  Abstürze und Lesefehler werden über handleFinished() behandelt.
+    if (error != QProcess::FailedToStart)
+    {
+        return;
+    }
+
+    m_ready = false;
+    m_healthTimer->stop ();
+    emit failedToStart (QString ("Ein Fehler ist beim Starten des Prozesses aufgetreten: %1")
+                            .arg (m_process->errorString ()));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsrWorker::onHealthCheck ()
+{
+    if (m_process->state () != QProcess::Running)
+    {
+        return;
+    }
+
+    //  Der Worker beantwortet Pings aus einem eigenen Thread, auch während eines Jobs.
+    //  Bleibt eine Antwort ein ganzes Intervall aus, gilt er als hängend und wird beendet;
+    //  der Manager startet ihn dann ggf. für den laufenden Job neu.
+    if (m_awaitingPong)
+    {
+        qWarning () << "AsrWorker" << m_index << ": antwortet nicht, wird beendet.";
+        m_process->kill ();
+        return;
+    }
+
+    m_awaitingPong = true;
+    send (QJsonObject{{"cmd", "ping"}, {"id", m_index}});
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,132 @@
+/**
+ * @file asrworker.h
+ * @brief Enthält die Deklaration der AsrWorker-Klasse.
+ * @author Mike Wild
+ */
+#ifndef ASRWORKER_H
+#define ASRWORKER_H
+
+#include <QJsonObject>
+#include <QObject>
+#include <QProcess>
+
+class QTimer;
+
+/**
+ * @brief Ein langlebiger ASR-Worker-Prozess (asr_worker.py).
+ *
+ * Kapselt den QProcess und das zeilenbasierte JSON-Protokoll: Anfragen werden als JSON-Zeile
+ * auf stdin geschrieben (bis zum Start des Prozesses zurückgehalten), Antworten von stdout
+ * geparst. "ready" und "pong" werden hier ausgewertet, alle übrigen Nachrichten über
+ * messageReceived() weitergegeben. Ein Health-Check sendet regelmäßig einen Ping und beendet den
+ * Prozess, wenn der vorherige unbeantwortet blieb.
+ *
+ * Welche Jobs ein Worker bearbeitet, entscheidet der AsrProcessManager.
+ */
+class AsrWorker : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor.
+     * @param index Nummer des Workers im Pool (nur für Log-Ausgaben).
+     * @param parent Das QObject-Elternteil für die automatische Speicherverwaltung.
+     */
+    explicit AsrWorker (int index, QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor. Bittet den Prozess, sich zu beenden, und erzwingt es notfalls.
+     */
+    ~AsrWorker ();
+
+    /**
+     * @brief Startet den Worker-Prozess; nach dem Laden der Modelle wird ready() gesendet.
+     * @param pythonPath Der Python-Interpreter.
+     * @param scriptPath Das Worker-Skript.
+     */
+    void start (const QString &pythonPath, const QString &scriptPath);
+
+    /**
+     * @brief Gibt an, ob der Prozess gestartet ist (auch während die Modelle laden).
+     * @note Ein Worker, der nach shutdown() noch ausläuft, gilt nicht mehr als laufend.
+     */
+    bool isRunning () const { return m_process->state () != QProcess::NotRunning && !m_closing; }
+
+    /** @brief Gibt an, ob der Worker seine Modelle geladen hat und Anfragen bearbeitet. */
+    bool isReady () const { return m_ready; }
+
+    /** @brief Gibt die Nummer des Workers im Pool zurück. */
+    int index () const { return m_index; }
+
+    /**
+     * @brief Schreibt eine Anfrage als JSON-Zeile auf stdin des Workers.
+     * @param command Die Anfrage, z.B. {"cmd": "transcribe", ...}.
+     */
+    void send (const QJsonObject &command);
+
+    /** @brief Bittet den Worker, sich nach der aktuellen Anfrage zu beenden. */
+    void shutdown ();
+
+    /** @brief Beendet den Prozess sofort und wartet kurz auf sein Ende. */
+    void kill ();
+
+    /** @brief Gibt die letzten Zeilen der stderr-Ausgabe zurück (für Fehlermeldungen). */
+    QString stderrTail () const { return QString::fromUtf8 (m_stderrTail).trimmed (); }
+
+signals:
+    /**
+     * @brief Der Worker hat seine Modelle geladen und nimmt Anfragen an.
+     * @param loadSeconds Dauer des Ladens in Sekunden.
+     */
+    void ready (double loadSeconds);
+
+    /**
+     * @brief Eine Protokollnachricht des Workers (außer "ready" und "pong").
+     * @param message Die geparste JSON-Nachricht.
+     */
+    void messageReceived (const QJsonObject &message);
+
+    /**
+     * @brief Der Prozess hat sich beendet (regulär, per kill() oder durch einen Absturz).
+     * @param exitCode Der Exit-Code des Prozesses.
+     * @param wasReady true, wenn der Worker seine Modelle vorher erfolgreich geladen hatte.
+     */
+    void exited (int exitCode, bool wasReady);
+
+    /**
+     * @brief Der Prozess konnte nicht gestartet werden.
+     * @param errorMsg Beschreibung des Fehlers.
+     */
+    void failedToStart (const QString &errorMsg);
+
+private slots:
+    /** @brief Liest alle vollständigen Zeilen von stdout und wertet sie aus. */
+    void handleOutput ();
+
+    /** @brief Sammelt die Diagnose-Ausgaben des Prozesses (stderr). */
+    void handleStderr ();
+
+    /** @brief Wird aufgerufen, wenn der Prozess sich beendet. */
+    void handleFinished (int exitCode, QProcess::ExitStatus exitStatus);
+
+    /** @brief Wird aufgerufen, wenn beim Starten des Prozesses ein Fehler auftritt. */
+    void handleError (QProcess::ProcessError error);
+
+    /** @brief Sendet einen Ping bzw. beendet den Prozess, wenn der letzte unbeantwortet blieb. */
+    void onHealthCheck ();
+
+private:
+    static constexpr int HealthIntervalMs = 30000; ///< Abstand der Pings an den Worker.
+    static constexpr int StderrTailBytes = 4096;   ///< Umfang der aufbewahrten stderr-Ausgabe.
+
+    const int m_index;       ///< Nummer des Workers im Pool.
+    QProcess *m_process;     ///< Der Worker-Prozess.
+    QTimer *m_healthTimer;   ///< Löst die regelmäßigen Pings aus.
+    bool m_ready;            ///< Die Modelle sind geladen.
+    bool m_closing;          ///< shutdown() wurde gesendet, der Prozess läuft noch aus.
+    bool m_awaitingPong;     ///< Der letzte Ping ist noch unbeantwortet.
+    QByteArray m_outbox;     ///< Anfragen, die vor dem Start des Prozesses gesendet wurden.
+    QByteArray m_stderrTail; ///< Die letzten Bytes der stderr-Ausgabe.
+};
+
+#endif // ASRWORKER_H
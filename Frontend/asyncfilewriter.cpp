@@ -0,0 +1,358 @@
+#include "asyncfilewriter.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+AsyncFileWriter::~AsyncFileWriter ()
+{
+    close ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsyncFileWriter::open (
+    const QString &path, qint64 bufferBytes, qint64 preallocateBytes)
+{
+    close ();
+
+    //  Ungepuffert, da die Daten ohnehin in den eigenen Puffern gesammelt werden.
+    m_file.setFileName (path);
+    if (!m_file.open (QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+    {
+        qWarning () << "AsyncFileWriter: Datei kann nicht geöffnet werden:" << path
+                    << m_file.errorString ();
+        return false;
+    }
+
+    //  Die Puffer werden nur bei geänderter Größe neu angelegt; so findet beim
+    //  Schreiben selbst keine Allokation statt.
+    if (m_capacity != bufferBytes)
+    {
+        m_capacity = qMax<qint64> (1, bufferBytes);
+        m_buffers[0].assign (size_t (m_capacity), 0);
+        m_buffers[1].assign (size_t (m_capacity), 0);
+    }
+    m_current = 0;
+    m_fill = 0;
+    m_appended = 0;
+    m_preallocateStep = preallocateBytes;
+    m_allocated = 0;
+    m_written = 0;
+
+    {
+        QMutexLocker locker (&m_mutex);
+        m_queue.clear ();
+        m_queue.reserve (8);
+        m_busy[0] = false;
+        m_busy[1] = false;
+        m_inFlight = 0;
+        m_stop = false;
+        m_error = false;
+        m_latencies.assign (MaxLatencySamples, 0.0f);
+        m_latencyCount = 0;
+        m_bytesWritten = 0;
+        m_writeSeconds = 0.0;
+        m_stalls = 0;
+    }
+
+    m_thread = QThread::create ([this] () { ioLoop (); });
+    m_thread->setObjectName ("AsyncFileWriter");
+    m_thread->start ();
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsyncFileWriter::append (
+    const void *data, qint64 bytes)
+{
+    if (!m_thread)
+    {
+        return;
+    }
+
+    const char *src = static_cast<const char *> (data);
+    while (bytes > 0)
+    {
+        if (m_fill == 0)
+        {
+            waitForBuffer ();
+        }
+
+        const qint64 n = qMin (bytes, m_capacity - m_fill);
+        std::memcpy (m_buffers[m_current].data () + m_fill, src, size_t (n));
+        m_fill += n;
+        m_appended += n;
+        src += n;
+        bytes -= n;
+
+        if (m_fill == m_capacity)
+        {
+            submit ();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsyncFileWriter::submit ()
+{
+    if (!m_thread || m_fill == 0)
+    {
+        return;
+    }
+
+    Request request;
+    request.offset = m_appended - m_fill;
+    request.data = m_buffers[m_current].data ();
+    request.bytes = m_fill;
+    request.buffer = m_current;
+    {
+        QMutexLocker locker (&m_mutex);
+        m_busy[m_current] = true;
+    }
+    enqueue (std::move (request));
+
+    //  Ab jetzt wird der andere Puffer gefüllt; ob er frei ist, prüft erst das nächste append().
+    m_current ^= 1;
+    m_fill = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsyncFileWriter::writeAt (
+    qint64 offset, const QByteArray &data)
+{
+    if (!m_thread || data.isEmpty ())
+    {
+        return;
+    }
+
+    Request request;
+    request.offset = offset;
+    request.owned = data;
+    request.data = request.owned.constData ();
+    request.bytes = data.size ();
+    enqueue (std::move (request));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsyncFileWriter::close ()
+{
+    if (!m_thread)
+    {
+        return true;
+    }
+
+    submit ();
+
+    //  Der I/O-Thread arbeitet die Warteschlange vollständig ab und beendet sich dann.
+    {
+        QMutexLocker locker (&m_mutex);
+        m_stop = true;
+        m_requestCond.wakeAll ();
+    }
+    m_thread->wait ();
+    delete m_thread;
+    m_thread = nullptr;
+
+#ifdef Q_OS_LINUX
+    //  Gibt den reservierten, aber nicht beschriebenen Platz hinter dem Dateiende wieder frei;
+    //  sonst belegt jede Datei bis zu einer Schrittweite unsichtbaren Speicherplatz.
+    if (m_allocated > m_written)
+    {
+        const int fd = m_file.handle ();
+        if (::fallocate (fd,
+                         FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                         m_written,
+                         m_allocated - m_written)
+                != 0
+            && ::ftruncate (fd, off_t (m_written)) != 0)
+        {
+            qWarning () << "AsyncFileWriter: Reservierung kann nicht freigegeben werden:"
+                        << m_file.fileName () << std::strerror (errno);
+        }
+        m_allocated = 0;
+    }
+#endif
+
+    m_file.close ();
+
+    QMutexLocker locker (&m_mutex);
+    return !m_error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AsyncFileWriter::Statistics AsyncFileWriter::statistics () const
+{
+    QMutexLocker locker (&m_mutex);
+
+    Statistics stats;
+    stats.bytes = m_bytesWritten;
+    stats.writes = m_latencyCount;
+    stats.stalls = m_stalls;
+    stats.bytesPerSecond = m_writeSeconds > 0.0 ? m_bytesWritten / m_writeSeconds : 0.0;
+
+    const int count = qMin (m_latencyCount, MaxLatencySamples);
+    if (count == 0)
+    {
+        return stats;
+    }
+
+    std::vector<float> sorted (m_latencies.begin (), m_latencies.begin () + count);
+    std::sort (sorted.begin (), sorted.end ());
+    const auto percentile = [&sorted] (double p)
+    { return double (sorted[size_t (p * (sorted.size () - 1) + 0.5)]); };
+    stats.p50Ms = percentile (0.50);
+    stats.p95Ms = percentile (0.95);
+    stats.p99Ms = percentile (0.99);
+    stats.maxMs = double (sorted.back ());
+    return stats;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsyncFileWriter::waitForBuffer ()
+{
+    QMutexLocker locker (&m_mutex);
+    if (!m_busy[m_current])
+    {
+        return;
+    }
+
+    //  Beide Puffer sind unterwegs: Die Platte ist langsamer als der Datenstrom.
+    ++m_stalls;
+    while (m_busy[m_current])
+    {
+        m_doneCond.wait (&m_mutex);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsyncFileWriter::enqueue (
+    Request request)
+{
+    QMutexLocker locker (&m_mutex);
+    m_queue.append (std::move (request));
+    ++m_inFlight;
+    m_requestCond.wakeOne ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AsyncFileWriter::ioLoop ()
+{
+    for (;;)
+    {
+        Request request;
+        {
+            QMutexLocker locker (&m_mutex);
+            while (m_queue.isEmpty () && !m_stop)
+            {
+                m_requestCond.wait (&m_mutex);
+            }
+            if (m_queue.isEmpty ())
+            {
+                return;
+            }
+            request = m_queue.takeFirst ();
+        }
+
+        QElapsedTimer timer;
+        timer.start ();
+        const bool ok = perform (request);
+        const double ms = timer.nsecsElapsed () / 1e6;
+
+        QMutexLocker locker (&m_mutex);
+        if (!ok)
+        {
+            m_error = true;
+        }
+        if (request.buffer >= 0)
+        {
+            m_busy[request.buffer] = false;
+            m_latencies[size_t (m_latencyCount % MaxLatencySamples)] = float (ms);
+            ++m_latencyCount;
+            m_bytesWritten += request.bytes;
+            m_writeSeconds += ms / 1000.0;
+        }
+        --m_inFlight;
+        m_doneCond.wakeAll ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AsyncFileWriter::perform (
+    const Request &request)
+{
+#ifdef Q_OS_UNIX
+    const int fd = m_file.handle ();
+
+#ifdef Q_OS_LINUX
+    //  Reserviert den Platz in großen Schritten vorab, ohne die Dateigröße zu ändern.
+    //  Unterstützt das Dateisystem das nicht, wird die Reservierung abgeschaltet.
+    const qint64 end = request.offset + request.bytes;
+    if (m_preallocateStep > 0 && end > m_allocated)
+    {
+        const qint64 target = end + m_preallocateStep;
+        if (::fallocate (fd, FALLOC_FL_KEEP_SIZE, m_allocated, target - m_allocated) == 0)
+        {
+            m_allocated = target;
+        }
+        else
+        {
+            m_preallocateStep = 0;
+        }
+    }
+#endif
+
+    qint64 done = 0;
+    while (done < request.bytes)
+    {
+        const ssize_t n = ::pwrite (fd,
+                                    request.data + done,
+                                    size_t (request.bytes - done),
+                                    off_t (request.offset + done));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            qWarning () << "AsyncFileWriter: Schreibfehler in" << m_file.fileName () << ":"
+                        << std::strerror (errno);
+            return false;
+        }
+        done += n;
+    }
+    m_written = qMax (m_written, request.offset + request.bytes);
+    return true;
+#else
+    //  Ohne pwrite: Positionieren und Schreiben über die (ungepufferte) QFile.
+    if (!m_file.seek (request.offset) || m_file.write (request.data, request.bytes) != request.bytes)
+    {
+        qWarning () << "AsyncFileWriter: Schreibfehler in" << m_file.fileName () << ":"
+                    << m_file.errorString ();
+        return false;
+    }
+    return true;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
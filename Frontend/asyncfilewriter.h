@@ -0,0 +1,167 @@
+/**
+ * @file asyncfilewriter.h
+ * @brief Enthält die Deklaration des AsyncFileWriter zum asynchronen Schreiben von Dateien.
+ * @author Mike Wild
+ */
+#ifndef ASYNCFILEWRITER_H
+#define ASYNCFILEWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <vector>
+
+class QThread;
+
+/**
+ * @brief Schreibt eine Datei über einen eigenen I/O-Thread mit zwei festen Puffern.
+ *
+ * Der Aufrufer (z.B. der WavWriterThread) kopiert seine Daten mit append() in den
+ * aktuellen Puffer. Ist der Puffer voll oder wird submit() aufgerufen, übernimmt der
+ * I/O-Thread ihn und schreibt ihn positionsgenau (pwrite) auf die Platte, während der
+ * Aufrufer bereits den zweiten Puffer füllt. Gewartet wird nur, wenn beide Puffer
+ * gleichzeitig unterwegs sind; solche Wartezeiten werden als "stalls" gezählt.
+ *
+ * Unter Linux wird der Speicherplatz vorab in größeren Schritten reserviert
+ * (fallocate mit FALLOC_FL_KEEP_SIZE), damit das Dateisystem die Datei nicht bei jedem
+ * Schreibzugriff vergrößern muss. Die sichtbare Dateigröße bleibt dabei die der
+ * tatsächlich geschriebenen Daten; den unbenutzten Rest gibt close() wieder frei.
+ *
+ * Nach jedem Schreibzugriff wird dessen Dauer erfasst; statistics() liefert daraus
+ * Perzentile und den Durchsatz.
+ *
+ * @note append(), submit(), writeAt() und close() dürfen nur aus einem Thread aufgerufen werden.
+ */
+class AsyncFileWriter
+{
+public:
+    /**
+     * @brief Kennzahlen einer Datei seit dem letzten open().
+     */
+    struct Statistics
+    {
+        qint64 bytes = 0;            ///< Geschriebene Nutzdaten in Bytes.
+        int writes = 0;              ///< Anzahl der Schreibzugriffe.
+        int stalls = 0;              ///< Wie oft der Aufrufer auf einen freien Puffer warten musste.
+        double p50Ms = 0.0;          ///< Median der Dauer eines Schreibzugriffs.
+        double p95Ms = 0.0;          ///< 95. Perzentil der Dauer eines Schreibzugriffs.
+        double p99Ms = 0.0;          ///< 99. Perzentil der Dauer eines Schreibzugriffs.
+        double maxMs = 0.0;          ///< Längster Schreibzugriff.
+        double bytesPerSecond = 0.0; ///< Durchsatz während der Schreibzugriffe.
+    };
+
+    /**
+     * @brief Standard-Konstruktor. Die Puffer werden erst mit open() angelegt.
+     */
+    AsyncFileWriter () = default;
+
+    /**
+     * @brief Destruktor. Schließt eine noch offene Datei (inkl. aller ausstehenden Daten).
+     */
+    ~AsyncFileWriter ();
+
+    AsyncFileWriter (const AsyncFileWriter &) = delete;
+    AsyncFileWriter &operator= (const AsyncFileWriter &) = delete;
+
+    /**
+     * @brief Legt die Datei neu an und startet den I/O-Thread.
+     * @param path Pfad der Datei (wird überschrieben).
+     * @param bufferBytes Größe jedes der beiden Puffer.
+     * @param preallocateBytes Schrittweite der Vorab-Reservierung (0 = keine).
+     * @return true, wenn die Datei geöffnet werden konnte.
+     */
+    bool open (const QString &path, qint64 bufferBytes, qint64 preallocateBytes = 64 * 1024 * 1024);
+
+    /**
+     * @brief Hängt Daten an das Dateiende an.
+     *
+     * Die Daten werden in den aktuellen Puffer kopiert; ein voller Puffer wird
+     * automatisch an den I/O-Thread übergeben.
+     */
+    void append (const void *data, qint64 bytes);
+
+    /**
+     * @brief Übergibt den aktuellen Puffer an den I/O-Thread, auch wenn er nicht voll ist.
+     */
+    void submit ();
+
+    /**
+     * @brief Schreibt Daten an eine feste Position (z.B. einen aktualisierten Header).
+     *
+     * Die Anfrage wird nach allen zuvor übergebenen Puffern ausgeführt.
+     */
+    void writeAt (qint64 offset, const QByteArray &data);
+
+    /**
+     * @brief Schreibt alle ausstehenden Daten, beendet den I/O-Thread und schließt die Datei.
+     * @return true, wenn alle Schreibzugriffe erfolgreich waren.
+     */
+    bool close ();
+
+    /** @brief Gibt an, ob gerade eine Datei geöffnet ist. */
+    bool isOpen () const { return m_thread != nullptr; }
+
+    /** @brief Gibt den Pfad der (zuletzt) geöffneten Datei zurück. */
+    QString fileName () const { return m_file.fileName (); }
+
+    /** @brief Gibt die Anzahl der mit append() angehängten Bytes zurück. */
+    qint64 size () const { return m_appended; }
+
+    /** @brief Gibt die Kennzahlen seit dem letzten open() zurück (threadsicher). */
+    Statistics statistics () const;
+
+private:
+    /** @brief Ein Auftrag an den I/O-Thread. */
+    struct Request
+    {
+        qint64 offset = 0;   ///< Zielposition in der Datei.
+        const char *data = nullptr; ///< Zu schreibende Daten.
+        qint64 bytes = 0;    ///< Anzahl der Bytes.
+        int buffer = -1;     ///< Index des Puffers, oder -1 bei eigenen Daten (owned).
+        QByteArray owned;    ///< Eigene Kopie der Daten für writeAt().
+    };
+
+    /** @brief Wartet, bis der aktuelle Puffer vom I/O-Thread freigegeben wurde. */
+    void waitForBuffer ();
+
+    /** @brief Stellt einen Auftrag in die Warteschlange des I/O-Threads. */
+    void enqueue (Request request);
+
+    /** @brief Die Schleife des I/O-Threads. */
+    void ioLoop ();
+
+    /** @brief Führt einen Schreibauftrag aus (im I/O-Thread). */
+    bool perform (const Request &request);
+
+    static constexpr int MaxLatencySamples = 4096; ///< Anzahl der aufbewahrten Messwerte.
+
+    QFile m_file;                    ///< Die Datei (ungepuffert geöffnet).
+    QThread *m_thread = nullptr;     ///< Der I/O-Thread.
+    std::vector<char> m_buffers[2];  ///< Die beiden Schreibpuffer.
+    qint64 m_capacity = 0;           ///< Größe eines Puffers.
+    int m_current = 0;               ///< Index des Puffers, der gerade gefüllt wird.
+    qint64 m_fill = 0;               ///< Füllstand des aktuellen Puffers.
+    qint64 m_appended = 0;           ///< Dateiende aus Sicht des Aufrufers.
+    qint64 m_preallocateStep = 0;    ///< Schrittweite der Vorab-Reservierung.
+    qint64 m_allocated = 0;          ///< Bisher reservierter Bereich (nur I/O-Thread).
+    qint64 m_written = 0;            ///< Tatsächliches Dateiende (nur I/O-Thread).
+
+    // Gemeinsamer Zustand (geschützt durch m_mutex)
+    mutable QMutex m_mutex;
+    QWaitCondition m_requestCond;    ///< Weckt den I/O-Thread bei neuen Aufträgen.
+    QWaitCondition m_doneCond;       ///< Weckt den Aufrufer, wenn ein Auftrag erledigt ist.
+    QList<Request> m_queue;          ///< Ausstehende Aufträge.
+    bool m_busy[2] = {false, false}; ///< Puffer, die gerade geschrieben werden.
+    int m_inFlight = 0;              ///< Angenommene, noch nicht erledigte Aufträge.
+    bool m_stop = false;             ///< Der I/O-Thread soll sich nach der Warteschlange beenden.
+    bool m_error = false;            ///< Ein Schreibzugriff ist fehlgeschlagen.
+    std::vector<float> m_latencies;  ///< Dauer der letzten Schreibzugriffe in ms (Ringpuffer).
+    int m_latencyCount = 0;          ///< Anzahl aller erfassten Schreibzugriffe.
+    qint64 m_bytesWritten = 0;       ///< Geschriebene Nutzdaten.
+    double m_writeSeconds = 0.0;     ///< Summe der Dauer aller Schreibzugriffe.
+    int m_stalls = 0;                ///< Wartezeiten des Aufrufers.
+};
+
+#endif // ASYNCFILEWRITER_H
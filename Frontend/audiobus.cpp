@@ -0,0 +1,395 @@
+#include "audiobus.h"
+
+#include <QDebug>
+
+namespace
+{
+//  Rundet auf die nächste Zweierpotenz auf, damit Indizes per Bitmaske statt Modulo
+//  berechnet werden können.
+size_t nextPowerOfTwo (
+    size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+AudioBusReader::AudioBusReader (
+    AudioBus *bus, int capacity)
+    : m_bus (bus)
+{
+    //  Ein Slot bleibt immer frei, um "voll" von "leer" unterscheiden zu können.
+    size_t size = nextPowerOfTwo (size_t (qMax (capacity, 1)) + 1);
+    m_slots.assign (size, nullptr);
+    m_mask = size - 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool AudioBusReader::push (
+    AudioBlock *block)
+{
+    //  Wird ausschließlich vom Producer-Thread aufgerufen.
+    const size_t head = m_head.load (std::memory_order_relaxed);
+    const size_t next = (head + 1) & m_mask;
+    if (next == m_tail.load (std::memory_order_acquire))
+    {
+        //  Der Leser kommt nicht hinterher. Der Block wird für ihn verworfen,
+        //  anstatt den Producer (und damit die Aufnahme) zu blockieren.
+        m_dropped.fetch_add (1, std::memory_order_relaxed);
+        return false;
+    }
+
+    m_slots[head] = block;
+    m_head.store (next, std::memory_order_release);
+
+    int depth = queueDepth ();
+    if (depth > m_maxDepth.load (std::memory_order_relaxed))
+    {
+        m_maxDepth.store (depth, std::memory_order_relaxed);
+    }
+
+    //  Weckt einen eventuell in waitPop() schlafenden Consumer auf.
+    m_available.release ();
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AudioBlock *AudioBusReader::pop ()
+{
+    const size_t tail = m_tail.load (std::memory_order_relaxed);
+    if (tail == m_head.load (std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    AudioBlock *block = m_slots[tail];
+    m_tail.store ((tail + 1) & m_mask, std::memory_order_release);
+    return block;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const AudioBlock *AudioBusReader::tryPop ()
+{
+    //  Hält den Semaphor-Zähler synchron zur Anzahl der wartenden Blöcke.
+    if (!m_available.tryAcquire ())
+    {
+        return nullptr;
+    }
+    return pop ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const AudioBlock *AudioBusReader::waitPop (
+    int timeoutMs)
+{
+    //  Der Semaphor wird nur zum Schlafen verwendet; die Daten selbst laufen lock-frei.
+    if (!m_available.tryAcquire (1, timeoutMs))
+    {
+        return nullptr;
+    }
+    return pop ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBusReader::release (
+    const AudioBlock *block)
+{
+    if (block)
+    {
+        m_bus->releaseRef (const_cast<AudioBlock *> (block));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBusReader::wakeUp ()
+{
+    //  Ein zusätzlicher Semaphor-Zähler lässt waitPop() sofort mit nullptr zurückkehren.
+    m_available.release ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int AudioBusReader::queueDepth () const
+{
+    const size_t head = m_head.load (std::memory_order_acquire);
+    const size_t tail = m_tail.load (std::memory_order_acquire);
+    return int ((head - tail) & m_mask);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBusReader::resetStatistics ()
+{
+    m_dropped.store (0, std::memory_order_relaxed);
+    m_maxDepth.store (0, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+AudioBus::AudioBus (
+    int blockCount, int framesPerBlock, int channels)
+    : m_blockCount (qMax (blockCount, 1))
+    , m_framesPerBlock (qMax (framesPerBlock, 1))
+    , m_channels (qMax (channels, 1))
+{
+    //  Der gesamte Sample-Speicher wird einmalig und zusammenhängend alloziert.
+    //  Zur Laufzeit finden auf dem Audio-Pfad keine Allokationen mehr statt.
+    m_storage.assign (size_t (m_blockCount) * m_framesPerBlock * m_channels, 0.0f);
+    m_blocks.reset (new AudioBlock[m_blockCount]);
+
+    size_t freeSize = nextPowerOfTwo (size_t (m_blockCount));
+    m_freeCells.reset (new FreeCell[freeSize]);
+    m_freeMask = freeSize - 1;
+    for (size_t i = 0; i < freeSize; ++i)
+    {
+        m_freeCells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+
+    for (auto &reader : m_readers)
+    {
+        reader.store (nullptr, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < m_blockCount; ++i)
+    {
+        AudioBlock &block = m_blocks[i];
+        block.data = m_storage.data () + size_t (i) * m_framesPerBlock * m_channels;
+        block.capacity = m_framesPerBlock;
+        block.channels = m_channels;
+        pushFree (&block);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AudioBus::~AudioBus ()
+{
+    for (auto &slot : m_readers)
+    {
+        delete slot.exchange (nullptr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AudioBusReader *AudioBus::subscribe (
+    int queueCapacity)
+{
+    for (auto &slot : m_readers)
+    {
+        if (slot.load (std::memory_order_acquire) == nullptr)
+        {
+            auto *reader = new AudioBusReader (this,
+                                               queueCapacity > 0 ? queueCapacity : m_blockCount);
+            slot.store (reader, std::memory_order_release);
+            return reader;
+        }
+    }
+
+    qWarning () << "AudioBus: Maximale Anzahl an Lesern erreicht.";
+    return nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBus::unsubscribe (
+    AudioBusReader *reader)
+{
+    if (!reader)
+    {
+        return;
+    }
+
+    for (auto &slot : m_readers)
+    {
+        if (slot.load (std::memory_order_acquire) == reader)
+        {
+            slot.store (nullptr, std::memory_order_release);
+
+            //  Noch wartende Blöcke gehen zurück an den Pool.
+            while (AudioBlock *block = reader->pop ())
+            {
+                releaseRef (block);
+            }
+            delete reader;
+            return;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AudioBlock *AudioBus::acquire ()
+{
+    AudioBlock *block = popFree ();
+    if (!block)
+    {
+        //  Alle Blöcke sind noch bei den Lesern in Benutzung.
+        m_overruns.fetch_add (1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    block->frames = 0;
+    block->refCount.store (1, std::memory_order_relaxed); //  Der Producer hält den Block.
+    return block;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBus::publish (
+    AudioBlock *block)
+{
+    if (!block)
+    {
+        return;
+    }
+
+    block->sequence = m_nextSequence++;
+
+    //  Jeder Leser erhält eine Referenz. Der Zähler wird vor dem Einreihen erhöht, da der
+    //  Leser den Block sofort wieder freigeben könnte.
+    for (auto &slot : m_readers)
+    {
+        AudioBusReader *reader = slot.load (std::memory_order_acquire);
+        if (!reader)
+        {
+            continue;
+        }
+
+        block->refCount.fetch_add (1, std::memory_order_relaxed);
+        if (!reader->push (block))
+        {
+            block->refCount.fetch_sub (1, std::memory_order_relaxed);
+            m_dropped.fetch_add (1, std::memory_order_relaxed);
+        }
+    }
+
+    m_published.fetch_add (1, std::memory_order_relaxed);
+
+    //  Der Producer gibt seine eigene Referenz ab.
+    releaseRef (block);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int AudioBus::freeBlocks () const
+{
+    const size_t enq = m_freeEnqueue.load (std::memory_order_acquire);
+    const size_t deq = m_freeDequeue.load (std::memory_order_acquire);
+    return int (enq - deq);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBus::resetStatistics ()
+{
+    m_overruns.store (0, std::memory_order_relaxed);
+    m_published.store (0, std::memory_order_relaxed);
+    m_dropped.store (0, std::memory_order_relaxed);
+    for (auto &slot : m_readers)
+    {
+        if (AudioBusReader *reader = slot.load (std::memory_order_acquire))
+        {
+            reader->resetStatistics ();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBus::releaseRef (
+    AudioBlock *block)
+{
+    //  acq_rel stellt sicher, dass alle Zugriffe der Leser abgeschlossen sind,
+    //  bevor der Block vom Producer wiederverwendet wird.
+    if (block->refCount.fetch_sub (1, std::memory_order_acq_rel) == 1)
+    {
+        pushFree (block);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioBus::pushFree (
+    AudioBlock *block)
+{
+    //  Gebundene MPMC-Queue nach Dmitry Vyukov: Jede Zelle trägt eine Sequenznummer,
+    //  über die Schreiber und Leser ohne Mutex erkennen, ob die Zelle frei ist.
+    size_t pos = m_freeEnqueue.load (std::memory_order_relaxed);
+    FreeCell *cell;
+    for (;;)
+    {
+        cell = &m_freeCells[pos & m_freeMask];
+        const size_t seq = cell->sequence.load (std::memory_order_acquire);
+        const intptr_t diff = intptr_t (seq) - intptr_t (pos);
+        if (diff == 0)
+        {
+            if (m_freeEnqueue.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            //  Kann nicht auftreten, da die Freiliste alle Blöcke des Pools fassen kann.
+            qWarning () << "AudioBus: Freiliste übergelaufen.";
+            return;
+        }
+        else
+        {
+            pos = m_freeEnqueue.load (std::memory_order_relaxed);
+        }
+    }
+
+    cell->block = block;
+    cell->sequence.store (pos + 1, std::memory_order_release);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AudioBlock *AudioBus::popFree ()
+{
+    size_t pos = m_freeDequeue.load (std::memory_order_relaxed);
+    FreeCell *cell;
+    for (;;)
+    {
+        cell = &m_freeCells[pos & m_freeMask];
+        const size_t seq = cell->sequence.load (std::memory_order_acquire);
+        const intptr_t diff = intptr_t (seq) - intptr_t (pos + 1);
+        if (diff == 0)
+        {
+            if (m_freeDequeue.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return nullptr; //  Pool leer.
+        }
+        else
+        {
+            pos = m_freeDequeue.load (std::memory_order_relaxed);
+        }
+    }
+
+    AudioBlock *block = cell->block;
+    cell->sequence.store (pos + m_freeMask + 1, std::memory_order_release);
+    return block;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,241 @@
+/**
+ * @file audiobus.h
+ * @brief Enthält die Deklaration des AudioBus, eines lock-freien Verteilers für Audio-Blöcke.
+ * @author Mike Wild
+ */
+#ifndef AUDIOBUS_H
+#define AUDIOBUS_H
+
+#include <QSemaphore>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class AudioBus;
+
+/**
+ * @brief Ein vorab allozierter, referenzgezählter Block interleavter Audio-Samples.
+ *
+ * Blöcke gehören immer dem Pool des AudioBus. Der Producer (CaptureThread) füllt einen
+ * Block direkt, veröffentlicht ihn und jeder Consumer gibt ihn nach dem Lesen über
+ * AudioBusReader::release() wieder frei. Erst wenn alle Leser fertig sind, wandert der
+ * Block zurück in den Pool. Es wird also weder kopiert noch auf dem Heap alloziert.
+ */
+struct AudioBlock
+{
+    float *data = nullptr; ///< Zeiger in den Sample-Speicher des Pools (interleaved).
+    int frames = 0;        ///< Anzahl der gültigen Frames in diesem Block.
+    int capacity = 0;      ///< Maximale Anzahl an Frames, die der Block aufnehmen kann.
+    int channels = 0;      ///< Anzahl der Kanäle pro Frame.
+    quint64 sequence = 0;  ///< Laufende Nummer des Blocks seit dem Anlegen des Busses.
+
+    /** @brief Gibt die Anzahl der gültigen float-Werte (Frames * Kanäle) zurück. */
+    qsizetype samples () const { return qsizetype (frames) * channels; }
+
+private:
+    friend class AudioBus;
+    friend class AudioBusReader;
+    std::atomic<int> refCount{0}; ///< Anzahl der Halter (Producer + Leser), die den Block noch nutzen.
+};
+
+/**
+ * @brief Die Leseseite des AudioBus für genau einen Consumer-Thread.
+ *
+ * Jeder Leser besitzt eine eigene Single-Producer/Single-Consumer-Warteschlange mit
+ * Zeigern auf die Blöcke des Pools. Dadurch können mehrere Consumer (z.B. WavWriterThread,
+ * ein Pegelmesser oder eine spätere Analyse-Stufe) denselben Block lesen, ohne sich
+ * gegenseitig zu blockieren. Ist die Warteschlange eines Lesers voll, wird der Block für
+ * diesen Leser verworfen und gezählt; der Producer wird nie blockiert.
+ */
+class AudioBusReader
+{
+public:
+    /**
+     * @brief Holt den nächsten Block, ohne zu warten.
+     * @return Der Block oder nullptr, wenn keine Daten vorliegen.
+     */
+    const AudioBlock *tryPop ();
+
+    /**
+     * @brief Wartet höchstens @p timeoutMs Millisekunden auf den nächsten Block.
+     * @param timeoutMs Die maximale Wartezeit in Millisekunden.
+     * @return Der Block oder nullptr bei Timeout bzw. nach wakeUp().
+     */
+    const AudioBlock *waitPop (int timeoutMs);
+
+    /**
+     * @brief Gibt einen zuvor gelesenen Block zurück an den Bus.
+     * @param block Der Block, der nicht mehr benötigt wird.
+     */
+    void release (const AudioBlock *block);
+
+    /**
+     * @brief Weckt einen in waitPop() wartenden Consumer vorzeitig auf.
+     * @note Thread-sicher; wird z.B. beim Beenden einer Schreib-Session verwendet.
+     */
+    void wakeUp ();
+
+    /** @brief Anzahl der Blöcke, die aktuell auf diesen Leser warten. */
+    int queueDepth () const;
+
+    /** @brief Höchste beobachtete Warteschlangen-Tiefe seit resetStatistics(). */
+    int maxQueueDepth () const { return m_maxDepth.load (std::memory_order_relaxed); }
+
+    /** @brief Anzahl der Blöcke, die wegen einer vollen Warteschlange verworfen wurden. */
+    quint64 droppedBlocks () const { return m_dropped.load (std::memory_order_relaxed); }
+
+    /** @brief Setzt die Zähler dieses Lesers zurück. */
+    void resetStatistics ();
+
+private:
+    friend class AudioBus;
+
+    AudioBusReader (AudioBus *bus, int capacity);
+
+    /** @brief Vom Producer aufgerufen; legt einen Block in die Warteschlange. */
+    bool push (AudioBlock *block);
+
+    /** @brief Entnimmt einen Block aus der Warteschlange (nur Consumer-Thread). */
+    AudioBlock *pop ();
+
+    AudioBus *m_bus;                       ///< Der Bus, zu dem dieser Leser gehört.
+    std::vector<AudioBlock *> m_slots;     ///< Ringpuffer der wartenden Blöcke.
+    size_t m_mask;                         ///< Bitmaske für die Ringpuffer-Indizes (Kapazität - 1).
+    alignas (64) std::atomic<size_t> m_head{0}; ///< Schreibposition (nur Producer).
+    alignas (64) std::atomic<size_t> m_tail{0}; ///< Leseposition (nur Consumer).
+    QSemaphore m_available;                ///< Zählt die veröffentlichten Blöcke für waitPop().
+    std::atomic<quint64> m_dropped{0};     ///< Zähler für verworfene Blöcke.
+    std::atomic<int> m_maxDepth{0};        ///< Höchste beobachtete Warteschlangen-Tiefe.
+};
+
+/**
+ * @brief Ein lock-freier Single-Producer-Bus mit gepoolten, referenzgezählten Audio-Blöcken.
+ *
+ * Der AudioBus ersetzt die frühere Übergabe von QList<float> über Qt-Signale. Alle Blöcke
+ * werden beim Anlegen einmalig alloziert. Der Producer holt sich mit acquire() einen freien
+ * Block, füllt ihn und verteilt ihn mit publish() an alle angemeldeten Leser (Fan-out).
+ * Ist der Pool erschöpft, zählt der Bus einen Overrun und der Producer verwirft den Block.
+ *
+ * @note acquire() und publish() dürfen nur von einem einzigen Thread aufgerufen werden.
+ * subscribe() und unsubscribe() sind nur erlaubt, solange keine Aufnahme läuft.
+ */
+class AudioBus
+{
+public:
+    static constexpr int MaxReaders = 8; ///< Maximale Anzahl gleichzeitiger Leser.
+
+    /**
+     * @brief Legt den Bus und seinen Block-Pool an.
+     * @param blockCount Anzahl der Blöcke im Pool.
+     * @param framesPerBlock Kapazität eines Blocks in Frames.
+     * @param channels Anzahl der Kanäle pro Frame.
+     */
+    AudioBus (int blockCount, int framesPerBlock, int channels);
+    ~AudioBus ();
+
+    AudioBus (const AudioBus &) = delete;
+    AudioBus &operator= (const AudioBus &) = delete;
+
+    /**
+     * @brief Meldet einen neuen Leser an.
+     * @param queueCapacity Länge der Warteschlange in Blöcken (0 = Poolgröße).
+     * @return Der neue Leser (gehört dem Bus) oder nullptr, wenn MaxReaders erreicht ist.
+     */
+    AudioBusReader *subscribe (int queueCapacity = 0);
+
+    /**
+     * @brief Meldet einen Leser ab, gibt seine wartenden Blöcke frei und löscht ihn.
+     * @param reader Der abzumeldende Leser.
+     */
+    void unsubscribe (AudioBusReader *reader);
+
+    /**
+     * @brief Holt einen freien Block aus dem Pool (nur Producer-Thread).
+     * @return Ein leerer Block oder nullptr, wenn der Pool erschöpft ist (Overrun).
+     */
+    AudioBlock *acquire ();
+
+    /**
+     * @brief Verteilt einen gefüllten Block an alle Leser (nur Producer-Thread).
+     *
+     * Nach dem Aufruf darf der Producer den Block nicht mehr verwenden.
+     * @param block Der zuvor mit acquire() geholte und gefüllte Block.
+     */
+    void publish (AudioBlock *block);
+
+    /** @brief Gibt die Kapazität eines Blocks in Frames zurück. */
+    int framesPerBlock () const { return m_framesPerBlock; }
+
+    /** @brief Gibt die Anzahl der Kanäle pro Frame zurück. */
+    int channels () const { return m_channels; }
+
+    /** @brief Gibt die Gesamtzahl der Blöcke im Pool zurück. */
+    int blockCount () const { return m_blockCount; }
+
+    /** @brief Anzahl der Blöcke, die aktuell frei im Pool liegen. */
+    int freeBlocks () const;
+
+    /** @brief Anzahl der acquire()-Aufrufe, die wegen eines leeren Pools fehlschlugen. */
+    quint64 overruns () const { return m_overruns.load (std::memory_order_relaxed); }
+
+    /** @brief Anzahl der bisher veröffentlichten Blöcke. */
+    quint64 publishedBlocks () const { return m_published.load (std::memory_order_relaxed); }
+
+    /**
+     * @brief Anzahl der Blöcke, die für einen Leser verworfen wurden (Summe aller Leser).
+     * @note Wird nur von resetStatistics() des Busses zurückgesetzt, nicht von den Lesern.
+     */
+    quint64 droppedBlocks () const { return m_dropped.load (std::memory_order_relaxed); }
+
+    /** @brief Setzt die Zähler des Busses und aller Leser zurück. */
+    void resetStatistics ();
+
+    /**
+     * @brief Gibt den zusammenhängenden Sample-Speicher des Pools zurück.
+     * @note Nützlich, um den Speicher z.B. per mlock() im RAM zu halten.
+     */
+    float *storage () { return m_storage.data (); }
+
+    /** @brief Größe des Sample-Speichers des Pools in Bytes. */
+    size_t storageBytes () const { return m_storage.size () * sizeof (float); }
+
+private:
+    friend class AudioBusReader;
+
+    /** @brief Gibt einen Halter eines Blocks frei; der letzte legt ihn zurück in den Pool. */
+    void releaseRef (AudioBlock *block);
+
+    /** @brief Legt einen Block in die Freiliste (von beliebigen Threads aufrufbar). */
+    void pushFree (AudioBlock *block);
+
+    /** @brief Entnimmt einen Block aus der Freiliste (nur Producer-Thread). */
+    AudioBlock *popFree ();
+
+    /** @brief Eine Zelle der gebundenen Multi-Producer/Multi-Consumer-Freiliste. */
+    struct FreeCell
+    {
+        std::atomic<size_t> sequence{0};
+        AudioBlock *block = nullptr;
+    };
+
+    const int m_blockCount;     ///< Anzahl der Blöcke im Pool.
+    const int m_framesPerBlock; ///< Kapazität eines Blocks in Frames.
+    const int m_channels;       ///< Anzahl der Kanäle pro Frame.
+
+    std::vector<float> m_storage;              ///< Zusammenhängender Speicher aller Blöcke.
+    std::unique_ptr<AudioBlock[]> m_blocks;    ///< Die Block-Verwaltungsstrukturen.
+    std::unique_ptr<FreeCell[]> m_freeCells;   ///< Ringpuffer der Freiliste.
+    size_t m_freeMask;                         ///< Bitmaske der Freiliste (Kapazität - 1).
+    alignas (64) std::atomic<size_t> m_freeEnqueue{0}; ///< Schreibposition der Freiliste.
+    alignas (64) std::atomic<size_t> m_freeDequeue{0}; ///< Leseposition der Freiliste.
+
+    std::array<std::atomic<AudioBusReader *>, MaxReaders> m_readers; ///< Angemeldete Leser.
+    quint64 m_nextSequence = 0;              ///< Nächste Blocknummer (nur Producer-Thread).
+    std::atomic<quint64> m_overruns{0};      ///< Zähler für fehlgeschlagene acquire()-Aufrufe.
+    std::atomic<quint64> m_published{0};     ///< Zähler für veröffentlichte Blöcke.
+    std::atomic<quint64> m_dropped{0};       ///< Zähler für bei Lesern verworfene Blöcke.
+};
+
+#endif // AUDIOBUS_H
@@ -1,7 +1,11 @@
 #include "audiofactory.h"
+#include "replaycapturethread.h"
 #include <qglobal.h>
 
+#include <QSettings>
+
 #if defined(Q_OS_LINUX)
+#include "pulseasynccapturethread.h"
 #include "pulsecapturethread.h"
 #elif defined(Q_OS_WIN)
 #include "wincapturethread.h"
@@ -12,8 +16,23 @@
 CaptureThread *AudioFactory::createThread (
     QObject *parent)
 {
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const QString backend = settings.value ("audio/backend").toString ();
+
+    //  "replay" speist WAV-Dateien statt Live-Geräten ein und ist auf allen Plattformen verfügbar.
+    if (backend == "replay")
+    {
+        return new ReplayCaptureThread (parent);
+    }
+
 #if defined(Q_OS_LINUX)
-    return new PulseCaptureThread (parent);
+    //  "pulse-async" (Standard) nutzt die asynchrone libpulse-API, "pulse-simple" das
+    //  bisherige Backend mit pactl und pa_simple (z.B. für Vergleichsmessungen).
+    if (backend == "pulse-simple")
+    {
+        return new PulseCaptureThread (parent);
+    }
+    return new PulseAsyncCaptureThread (parent);
 #elif defined(Q_OS_WIN)
     return new WinCaptureThread (parent);
 #else
@@ -29,7 +29,9 @@ public:
      * @brief Erstellt eine Instanz der korrekten, plattformspezifischen CaptureThread-Klasse.
      *
      * Diese Methode verwendet Präprozessor-Direktiven, um zur Kompilierzeit die passende
-     * Thread-Implementierung für das Zielbetriebssystem auszuwählen.
+     * Thread-Implementierung für das Zielbetriebssystem auszuwählen. Der Settings-Schlüssel
+     * "audio/backend" wählt unter Linux zwischen den PulseAudio-Backends; mit "replay" wird
+     * auf allen Plattformen der ReplayCaptureThread (WAV-Dateien statt Geräten) verwendet.
      * @param parent Das QObject-Elternteil für den neuen Thread, um die Speicherverwaltung zu gewährleisten.
      * @return Ein Zeiger auf den neu erstellten CaptureThread oder nullptr, wenn die Plattform nicht unterstützt wird.
      */
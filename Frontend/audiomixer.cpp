@@ -0,0 +1,409 @@
+#include "audiomixer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AUDIOMIXER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+//  GCC und Clang erzeugen AVX2-Code nur in Funktionen, die explizit dafür markiert sind.
+//  So bleibt der Rest des Programms auf dem SSE2-Basisniveau lauffähig.
+#if defined(AUDIOMIXER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AUDIOMIXER_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#else
+#define AUDIOMIXER_TARGET_AVX2
+#endif
+
+namespace
+{
+constexpr double Pi = 3.14159265358979323846;
+
+//  --- Skalare Kernel (Fallback für alle Plattformen) ---
+
+void scaleScalar (
+    float *out, const float *in, float gain, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        out[i] = gain * in[i];
+    }
+}
+
+void accumulateScalar (
+    float *out, const float *in, float gain, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        out[i] += gain * in[i];
+    }
+}
+
+void clampScalar (
+    float *data, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        data[i] = std::min (1.0f, std::max (-1.0f, data[i]));
+    }
+}
+
+#if defined(AUDIOMIXER_X86)
+//  --- SSE2-Kernel (4 Samples pro Schritt) ---
+
+void scaleSse2 (
+    float *out, const float *in, float gain, int n)
+{
+    const __m128 g = _mm_set1_ps (gain);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm_storeu_ps (out + i, _mm_mul_ps (g, _mm_loadu_ps (in + i)));
+    }
+    scaleScalar (out + i, in + i, gain, n - i);
+}
+
+void accumulateSse2 (
+    float *out, const float *in, float gain, int n)
+{
+    const __m128 g = _mm_set1_ps (gain);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 acc = _mm_loadu_ps (out + i);
+        _mm_storeu_ps (out + i, _mm_add_ps (acc, _mm_mul_ps (g, _mm_loadu_ps (in + i))));
+    }
+    accumulateScalar (out + i, in + i, gain, n - i);
+}
+
+void clampSse2 (
+    float *data, int n)
+{
+    const __m128 lo = _mm_set1_ps (-1.0f);
+    const __m128 hi = _mm_set1_ps (1.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm_storeu_ps (data + i, _mm_min_ps (hi, _mm_max_ps (lo, _mm_loadu_ps (data + i))));
+    }
+    clampScalar (data + i, n - i);
+}
+
+//  --- AVX2-Kernel (8 Samples pro Schritt) ---
+
+AUDIOMIXER_TARGET_AVX2 void scaleAvx2 (
+    float *out, const float *in, float gain, int n)
+{
+    const __m256 g = _mm256_set1_ps (gain);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps (out + i, _mm256_mul_ps (g, _mm256_loadu_ps (in + i)));
+    }
+    scaleScalar (out + i, in + i, gain, n - i);
+}
+
+AUDIOMIXER_TARGET_AVX2 void accumulateAvx2 (
+    float *out, const float *in, float gain, int n)
+{
+    const __m256 g = _mm256_set1_ps (gain);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 acc = _mm256_loadu_ps (out + i);
+        _mm256_storeu_ps (out + i, _mm256_add_ps (acc, _mm256_mul_ps (g, _mm256_loadu_ps (in + i))));
+    }
+    accumulateScalar (out + i, in + i, gain, n - i);
+}
+
+AUDIOMIXER_TARGET_AVX2 void clampAvx2 (
+    float *data, int n)
+{
+    const __m256 lo = _mm256_set1_ps (-1.0f);
+    const __m256 hi = _mm256_set1_ps (1.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps (data + i,
+                          _mm256_min_ps (hi, _mm256_max_ps (lo, _mm256_loadu_ps (data + i))));
+    }
+    clampScalar (data + i, n - i);
+}
+
+//  Prüft zur Laufzeit, ob CPU und Betriebssystem AVX2 unterstützen.
+bool cpuHasAvx2 ()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid (info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid (info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv (0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex (info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports ("avx2");
+#endif
+}
+#endif
+
+//  Die zur Laufzeit gewählte Kernel-Variante.
+struct Kernels
+{
+    void (*scale) (float *, const float *, float, int);
+    void (*accumulate) (float *, const float *, float, int);
+    void (*clamp) (float *, int);
+    const char *name;
+};
+
+const Kernels &kernels ()
+{
+    //  Die Auswahl erfolgt einmalig beim ersten Aufruf (thread-sicher seit C++11).
+    static const Kernels selected = [] () -> Kernels
+    {
+#if defined(AUDIOMIXER_X86)
+        if (cpuHasAvx2 ())
+        {
+            return {scaleAvx2, accumulateAvx2, clampAvx2, "AVX2"};
+        }
+        return {scaleSse2, accumulateSse2, clampSse2, "SSE2"};
+#else
+        return {scaleScalar, accumulateScalar, clampScalar, "Skalar"};
+#endif
+    }();
+    return selected;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+void HighPassFilter::reset (
+    int sampleRate)
+{
+    m_sampleRate = sampleRate;
+    m_appliedCutoff = -1.0f; //  Erzwingt die Neuberechnung im nächsten Block.
+    m_state.fill (State ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void HighPassFilter::updateCoefficients (
+    float hz)
+{
+    //  Biquad-Hochpass nach dem "Audio EQ Cookbook" (R. Bristow-Johnson) mit Q = 1/sqrt(2).
+    const double w0 = 2.0 * Pi * std::clamp<double> (hz, 1.0, 0.45 * m_sampleRate) / m_sampleRate;
+    const double alpha = std::sin (w0) / (2.0 * std::sqrt (0.5));
+    const double cosw = std::cos (w0);
+    const double a0 = 1.0 + alpha;
+
+    m_b0 = float ((1.0 + cosw) / 2.0 / a0);
+    m_b1 = float (-(1.0 + cosw) / a0);
+    m_b2 = m_b0;
+    m_a1 = float (-2.0 * cosw / a0);
+    m_a2 = float ((1.0 - alpha) / a0);
+    m_appliedCutoff = hz;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void HighPassFilter::process (
+    float *data, int frames, int channels)
+{
+    const float cutoff = m_cutoff.load (std::memory_order_relaxed);
+    if (cutoff != m_appliedCutoff)
+    {
+        updateCoefficients (cutoff);
+    }
+
+    const int filtered = std::min (channels, MaxChannels);
+    for (int c = 0; c < filtered; ++c)
+    {
+        State &s = m_state[c];
+        float *p = data + c;
+        for (int i = 0; i < frames; ++i, p += channels)
+        {
+            const float x = *p;
+            const float y = m_b0 * x + m_b1 * s.x1 + m_b2 * s.x2 - m_a1 * s.y1 - m_a2 * s.y2;
+            s.x2 = s.x1;
+            s.x1 = x;
+            s.y2 = s.y1;
+            s.y1 = y;
+            *p = y;
+        }
+
+        //  Bei Stille klingt der Zustand in den denormalen Zahlenbereich ab, was auf x86
+        //  sehr langsam ist. Winzige Werte werden daher einmal pro Block auf 0 gesetzt.
+        for (float *v : {&s.x1, &s.x2, &s.y1, &s.y2})
+        {
+            if (std::fabs (*v) < 1e-15f)
+            {
+                *v = 0.0f;
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Limiter::reset (
+    int sampleRate)
+{
+    m_gain = 1.0f;
+    //  Release-Zeitkonstante von 50 ms.
+    m_release = float (1.0 - std::exp (-1.0 / (0.05 * sampleRate)));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Limiter::process (
+    float *data, int frames, int channels)
+{
+    const float threshold = m_threshold.load (std::memory_order_relaxed);
+
+    for (int i = 0; i < frames; ++i)
+    {
+        float *frame = data + i * channels;
+
+        //  Der Spitzenwert über alle Kanäle bestimmt die Verstärkung, damit das Stereobild erhalten bleibt.
+        float peak = 0.0f;
+        for (int c = 0; c < channels; ++c)
+        {
+            peak = std::max (peak, std::fabs (frame[c]));
+        }
+
+        //  Die Verstärkung erholt sich exponentiell in Richtung 1, wird aber sofort
+        //  (ohne Attack-Zeit) reduziert, sobald der Spitzenwert die Schwelle überschreiten würde.
+        m_gain += m_release * (1.0f - m_gain);
+        if (peak * m_gain > threshold)
+        {
+            m_gain = threshold / peak;
+        }
+
+        for (int c = 0; c < channels; ++c)
+        {
+            frame[c] *= m_gain;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+AudioMixer::AudioMixer (
+    int sources, int channels)
+    : m_sources (std::max (sources, 1))
+    , m_channels (std::max (channels, 1))
+    , m_gains (new std::atomic<float>[size_t (m_sources)])
+{
+    for (int i = 0; i < m_sources; ++i)
+    {
+        m_gains[i].store (1.0f, std::memory_order_relaxed);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioMixer::setGain (
+    int source, float gain)
+{
+    if (source >= 0 && source < m_sources)
+    {
+        m_gains[source].store (gain, std::memory_order_relaxed);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+float AudioMixer::gain (
+    int source) const
+{
+    return (source >= 0 && source < m_sources) ? m_gains[source].load (std::memory_order_relaxed)
+                                               : 0.0f;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AudioDspStage *AudioMixer::addStage (
+    std::unique_ptr<AudioDspStage> stage)
+{
+    m_stages.push_back (std::move (stage));
+    return m_stages.back ().get ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioMixer::reset (
+    int sampleRate)
+{
+    for (auto &stage : m_stages)
+    {
+        stage->reset (sampleRate);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void AudioMixer::process (
+    const float *const *inputs, float *out, int frames)
+{
+    const Kernels &k = kernels ();
+    const int n = frames * m_channels;
+
+    //  Die erste vorhandene Quelle wird skaliert in den Zielpuffer geschrieben,
+    //  alle weiteren werden aufaddiert. So entfällt ein separates Nullen des Puffers.
+    bool first = true;
+    for (int s = 0; s < m_sources; ++s)
+    {
+        if (!inputs[s])
+        {
+            continue;
+        }
+        const float g = m_gains[s].load (std::memory_order_relaxed);
+        if (first)
+        {
+            k.scale (out, inputs[s], g, n);
+            first = false;
+        }
+        else
+        {
+            k.accumulate (out, inputs[s], g, n);
+        }
+    }
+    if (first)
+    {
+        std::fill (out, out + n, 0.0f);
+    }
+
+    for (auto &stage : m_stages)
+    {
+        if (stage->isEnabled ())
+        {
+            stage->process (out, frames, m_channels);
+        }
+    }
+
+    //  Begrenzung auf [-1.0, 1.0] verhindert Übersteuerung (Clipping) in den Ausgabedateien.
+    k.clamp (out, n);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const char *AudioMixer::kernelName ()
+{
+    return kernels ().name;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,166 @@
+/**
+ * @file audiomixer.h
+ * @brief Enthält die Deklaration des AudioMixer und der Echtzeit-DSP-Stufen.
+ * @author Mike Wild
+ */
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Basisklasse für eine Verarbeitungsstufe in der DSP-Kette des AudioMixer.
+ *
+ * Eine Stufe arbeitet in-place auf interleavten float-Samples. process() wird im
+ * Echtzeit-Thread aufgerufen und darf daher weder allozieren noch blockieren.
+ * Parameter werden über atomare Werte gesetzt und von der Stufe blockweise übernommen.
+ */
+class AudioDspStage
+{
+public:
+    virtual ~AudioDspStage () = default;
+
+    /**
+     * @brief Setzt den internen Zustand zurück (z.B. zu Beginn einer Aufnahme).
+     * @param sampleRate Die Abtastrate der folgenden Daten.
+     */
+    virtual void reset (int sampleRate) = 0;
+
+    /**
+     * @brief Verarbeitet einen Block in-place.
+     * @param data Interleavte Samples.
+     * @param frames Anzahl der Frames.
+     * @param channels Anzahl der Kanäle pro Frame.
+     */
+    virtual void process (float *data, int frames, int channels) = 0;
+
+    /** @brief Gibt an, ob die Stufe aktiv ist. Inaktive Stufen werden übersprungen. */
+    bool isEnabled () const { return m_enabled.load (std::memory_order_relaxed); }
+
+    /** @brief Aktiviert oder deaktiviert die Stufe (thread-sicher, lock-frei). */
+    void setEnabled (bool enabled) { m_enabled.store (enabled, std::memory_order_relaxed); }
+
+protected:
+    static constexpr int MaxChannels = 8; ///< Maximale Kanalzahl für den Filterzustand.
+
+private:
+    std::atomic<bool> m_enabled{false}; ///< Stufen sind standardmäßig deaktiviert.
+};
+
+/**
+ * @brief Ein Hochpassfilter 2. Ordnung (Biquad nach RBJ) gegen Rumpeln und Gleichanteil.
+ */
+class HighPassFilter : public AudioDspStage
+{
+public:
+    /**
+     * @brief Setzt die Grenzfrequenz (thread-sicher). Die Koeffizienten werden im nächsten Block neu berechnet.
+     * @param hz Die Grenzfrequenz in Hz.
+     */
+    void setCutoff (float hz) { m_cutoff.store (hz, std::memory_order_relaxed); }
+
+    void reset (int sampleRate) override;
+    void process (float *data, int frames, int channels) override;
+
+private:
+    /** @brief Berechnet die Filterkoeffizienten für die aktuelle Grenzfrequenz. */
+    void updateCoefficients (float hz);
+
+    /** @brief Der Filterzustand eines Kanals (Direktform I). */
+    struct State
+    {
+        float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+    };
+
+    std::atomic<float> m_cutoff{80.0f}; ///< Gewünschte Grenzfrequenz in Hz.
+    float m_appliedCutoff = -1.0f;      ///< Grenzfrequenz, für die die Koeffizienten gelten.
+    int m_sampleRate = 48000;           ///< Abtastrate in Hz.
+    float m_b0 = 1.0f, m_b1 = 0.0f, m_b2 = 0.0f, m_a1 = 0.0f, m_a2 = 0.0f; ///< Koeffizienten.
+    std::array<State, MaxChannels> m_state; ///< Zustand je Kanal.
+};
+
+/**
+ * @brief Ein einfacher Peak-Limiter mit sofortigem Attack und exponentiellem Release.
+ *
+ * Verhindert hartes Clipping bei hohen Gain-Werten, indem die Verstärkung kurzzeitig
+ * so weit reduziert wird, dass der Spitzenwert die Schwelle nicht überschreitet.
+ */
+class Limiter : public AudioDspStage
+{
+public:
+    /** @brief Setzt die Schwelle als linearen Wert (thread-sicher), z.B. 0.9. */
+    void setThreshold (float threshold) { m_threshold.store (threshold, std::memory_order_relaxed); }
+
+    void reset (int sampleRate) override;
+    void process (float *data, int frames, int channels) override;
+
+private:
+    std::atomic<float> m_threshold{0.9f}; ///< Maximal erlaubter Spitzenwert.
+    float m_gain = 1.0f;                  ///< Aktuelle Verstärkung des Limiters.
+    float m_release = 0.0f;               ///< Release-Koeffizient pro Frame.
+};
+
+/**
+ * @brief Mischt N Quellen mit individuellem Gain, wendet die DSP-Kette an und begrenzt das Ergebnis.
+ *
+ * Die inneren Schleifen (Skalieren, Akkumulieren, Begrenzen) liegen als SSE2-, AVX2- und
+ * skalare Varianten vor; die passende Variante wird einmalig zur Laufzeit anhand der
+ * CPU gewählt. Der Mixer arbeitet direkt im Zielpuffer und alloziert nach dem
+ * Konstruktor keinen Speicher mehr. Gains sind atomar und können jederzeit aus einem
+ * anderen Thread geändert werden.
+ */
+class AudioMixer
+{
+public:
+    /**
+     * @brief Erstellt einen Mixer.
+     * @param sources Anzahl der Eingangsquellen.
+     * @param channels Anzahl der interleavten Kanäle pro Frame (für alle Quellen gleich).
+     */
+    AudioMixer (int sources, int channels);
+
+    /**
+     * @brief Setzt den Gain einer Quelle (thread-sicher, lock-frei).
+     * @param source Index der Quelle.
+     * @param gain Der lineare Verstärkungsfaktor.
+     */
+    void setGain (int source, float gain);
+
+    /** @brief Gibt den aktuellen Gain einer Quelle zurück. */
+    float gain (int source) const;
+
+    /**
+     * @brief Hängt eine Stufe an die DSP-Kette an. Der Mixer übernimmt den Besitz.
+     * @note Darf nur aufgerufen werden, solange process() nicht läuft.
+     * @return Die Stufe, um später Parameter setzen zu können.
+     */
+    AudioDspStage *addStage (std::unique_ptr<AudioDspStage> stage);
+
+    /**
+     * @brief Setzt alle Stufen zurück (z.B. zu Beginn einer Aufnahme).
+     * @param sampleRate Die Abtastrate der folgenden Daten.
+     */
+    void reset (int sampleRate);
+
+    /**
+     * @brief Mischt einen Block.
+     * @param inputs Ein Zeiger je Quelle auf interleavte Samples; nullptr steht für Stille.
+     * @param out Der Zielpuffer (frames * channels Werte); darf nicht mit einem Eingang überlappen.
+     * @param frames Anzahl der Frames.
+     */
+    void process (const float *const *inputs, float *out, int frames);
+
+    /** @brief Gibt den Namen der zur Laufzeit gewählten Kernel-Variante zurück. */
+    static const char *kernelName ();
+
+private:
+    const int m_sources;                                  ///< Anzahl der Quellen.
+    const int m_channels;                                 ///< Kanäle pro Frame.
+    std::unique_ptr<std::atomic<float>[]> m_gains;        ///< Gain je Quelle.
+    std::vector<std::unique_ptr<AudioDspStage>> m_stages; ///< Die DSP-Kette in Reihenfolge.
+};
+
+#endif // AUDIOMIXER_H
@@ -0,0 +1,408 @@
+#include "batchrunner.h"
+#include "asrprocessmanager.h"
+#include "databasemanager.h"
+#include "polyphaseresampler.h"
+#include "taggeneratormanager.h"
+#include "transcription.h"
+#include "wavfilereader.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+constexpr int AsrSampleRate = 16000; //  Abtastrate der ASR-Dateien.
+constexpr int ConvertFrames = 16384; //  Frames je Leseschritt beim Umwandeln.
+
+//  Ergebnis der Umwandlung in einem Hintergrund-Thread.
+struct PrepareResult
+{
+    bool ok = false;
+    double audioSeconds = 0.0;
+    QString error;
+};
+
+//  44-Byte-Header für 16-bit PCM, mono, 16 kHz (das Format des WavWriterThread für die ASR).
+QByteArray asrWavHeader (
+    qint64 dataBytes)
+{
+    QByteArray header;
+    QDataStream out (&header, QIODevice::WriteOnly);
+    out.setByteOrder (QDataStream::LittleEndian);
+    out.writeRawData ("RIFF", 4);
+    out << quint32 (36 + dataBytes);
+    out.writeRawData ("WAVE", 4);
+    out.writeRawData ("fmt ", 4);
+    out << quint32 (16) << quint16 (1) << quint16 (1) << quint32 (AsrSampleRate)
+        << quint32 (AsrSampleRate * 2) << quint16 (2) << quint16 (16);
+    out.writeRawData ("data", 4);
+    out << quint32 (dataBytes);
+    return header;
+}
+
+//  Wandelt eine beliebige WAV-Datei in das ASR-Format um (Downmix, Abtastratenwandlung, 16 bit).
+PrepareResult convertToAsrWav (
+    const QString &source, const QString &target)
+{
+    PrepareResult result;
+    WavFileReader reader;
+    if (!reader.open (source))
+    {
+        result.error = reader.errorString ();
+        return result;
+    }
+
+    QFile out (target);
+    if (!out.open (QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        result.error = out.errorString ();
+        return result;
+    }
+    out.write (asrWavHeader (0));
+
+    const int channels = reader.channels ();
+    std::unique_ptr<PolyphaseResampler> resampler;
+    if (reader.sampleRate () != AsrSampleRate)
+    {
+        resampler = std::make_unique<PolyphaseResampler> (reader.sampleRate (), AsrSampleRate, 1);
+    }
+
+    std::vector<float> input (size_t (ConvertFrames) * size_t (channels));
+    std::vector<float> mono (ConvertFrames);
+    std::vector<float> resampled (resampler ? size_t (resampler->maxOutputFrames (ConvertFrames)) : 0);
+    std::vector<qint16> pcm;
+    qint64 dataBytes = 0;
+    int frames = 0;
+    while ((frames = reader.readFrames (input.data (), ConvertFrames)) > 0)
+    {
+        for (int i = 0; i < frames; ++i)
+        {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c)
+            {
+                sum += input[size_t (i) * channels + c];
+            }
+            mono[i] = sum / float (channels);
+        }
+
+        const float *samples = mono.data ();
+        int count = frames;
+        if (resampler)
+        {
+            count = resampler->process (mono.data (), frames, resampled.data ());
+            samples = resampled.data ();
+        }
+
+        pcm.resize (size_t (count));
+        for (int i = 0; i < count; ++i)
+        {
+            pcm[size_t (i)] = qint16 (std::lround (qBound (-1.0f, samples[i], 1.0f) * 32767.0f));
+        }
+        const qint64 bytes = qint64 (count) * qint64 (sizeof (qint16));
+        if (out.write (reinterpret_cast<const char *> (pcm.data ()), bytes) != bytes)
+        {
+            result.error = out.errorString ();
+            return result;
+        }
+        dataBytes += bytes;
+    }
+
+    out.seek (0);
+    out.write (asrWavHeader (dataBytes));
+    result.ok = out.error () == QFile::NoError;
+    result.error = out.errorString ();
+    result.audioSeconds = double (dataBytes / 2) / AsrSampleRate;
+    return result;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+BatchRunner::BatchRunner (
+    const Options &options, DatabaseManager *database, QObject *parent)
+    : QObject (parent)
+    , m_options (options)
+    , m_database (database)
+    , m_out (stdout)
+{
+    for (const QString &file : m_options.files)
+    {
+        Item item;
+        item.path = file;
+        m_items.append (item);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BatchRunner::start ()
+{
+    m_timer.start ();
+    if (m_items.isEmpty () || !m_tempDir.isValid ())
+    {
+        m_out << "Keine Dateien zu verarbeiten." << Qt::endl;
+        QMetaObject::invokeMethod (this, [this] () { emit finished (m_failures); }, Qt::QueuedConnection);
+        return;
+    }
+
+    //  Jeder Platz erhält einen eigenen ASR-Manager; die Worker bleiben zwischen den
+    //  Dateien eines Platzes geladen.
+    const int slotCount = qBound (1, m_options.parallel, int (m_items.size ()));
+    for (int i = 0; i < slotCount; ++i)
+    {
+        Slot slot;
+        slot.asr = new AsrProcessManager (this);
+        slot.tagger = new TagGeneratorManager (this);
+        m_slots.append (slot);
+
+        connect (slot.asr,
+                 &AsrProcessManager::jobTiming,
+                 this,
+                 [this, i] (const AsrJobTiming &timing)
+                 {
+                     if (m_slots[i].item >= 0)
+                     {
+                         Item &item = m_items[m_slots[i].item];
+                         item.unknownRate = timing.unknownRate;
+                         if (timing.escalated >= 0.0 && timing.audio > 0.0)
+                         {
+                             item.escalated = timing.escalated / timing.audio;
+                             item.saved = timing.saved;
+                         }
+                     }
+                 });
+        connect (slot.asr,
+                 &AsrProcessManager::finished,
+                 this,
+                 [this, i] (bool ok, const QString &error) { transcribed (i, ok, error); });
+        connect (slot.tagger,
+                 &TagGeneratorManager::tagsReady,
+                 this,
+                 [this, i] (const QStringList &tags, bool ok, const QString &error)
+                 {
+                     Item &item = m_items[m_slots[i].item];
+                     if (ok)
+                     {
+                         item.script->setTags (tags);
+                     }
+                     else
+                     {
+                         item.problems.append ("tags: " + error);
+                     }
+                     tagged (i);
+                 });
+    }
+
+    m_out << "Verarbeite " << m_items.size () << " Dateien auf " << slotCount << " Plätzen." << Qt::endl;
+    for (int i = 0; i < slotCount; ++i)
+    {
+        startNext (i);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BatchRunner::startNext (
+    int slot)
+{
+    Slot &s = m_slots[slot];
+    s.item = -1;
+    if (m_next >= m_items.size ())
+    {
+        //  Erst wenn alle Plätze frei sind, ist der Durchlauf beendet.
+        s.asr->shutdownWorkers ();
+        if (m_done == m_items.size ())
+        {
+            m_out << QString ("Fertig: %1 Dateien, %2 fehlerhaft, %3 s Audio in %4 s (RTF %5)")
+                         .arg (m_items.size ())
+                         .arg (m_failures)
+                         .arg (m_audioSeconds, 0, 'f', 1)
+                         .arg (m_timer.elapsed () / 1000.0, 0, 'f', 1)
+                         .arg (m_audioSeconds > 0.0 ? m_timer.elapsed () / 1000.0 / m_audioSeconds : 0.0,
+                               0,
+                               'f',
+                               3)
+                  << Qt::endl;
+            emit finished (m_failures);
+        }
+        return;
+    }
+
+    const int index = m_next++;
+    s.item = index;
+    Item &item = m_items[index];
+    item.asrPath = m_tempDir.filePath (QString ("%1.wav").arg (index));
+    item.script = new Transcription (this);
+    item.total.start ();
+    item.phase.start ();
+
+    //  Die Umwandlung läuft im Thread-Pool, damit die Ereignisschleife frei bleibt.
+    const QString source = item.path;
+    const QString target = item.asrPath;
+    auto *watcher = new QFutureWatcher<PrepareResult> (this);
+    connect (watcher,
+             &QFutureWatcher<PrepareResult>::finished,
+             this,
+             [this, watcher, slot] ()
+             {
+                 const PrepareResult result = watcher->result ();
+                 watcher->deleteLater ();
+                 prepared (slot, result.ok, result.audioSeconds, result.error);
+             });
+    watcher->setFuture (QtConcurrent::run ([source, target] () { return convertToAsrWav (source, target); }));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BatchRunner::prepared (
+    int slot, bool ok, double audioSeconds, const QString &error)
+{
+    Slot &s = m_slots[slot];
+    Item &item = m_items[s.item];
+    item.prepare = item.phase.elapsed () / 1000.0;
+    item.audioSeconds = audioSeconds;
+    if (!ok)
+    {
+        item.problems.append ("wav: " + error);
+        complete (slot);
+        return;
+    }
+
+    const QFileInfo info (item.path);
+    item.script->setName (info.completeBaseName ());
+    item.script->setDateTime (info.lastModified ());
+
+    //  Die Segmente werden direkt in das Transkript dieser Datei geschrieben; die
+    //  Verbindungen enden mit dem Transkript.
+    connect (s.asr, &AsrProcessManager::segmentReady, item.script, &Transcription::add);
+    connect (s.asr,
+             &AsrProcessManager::segmentSpeakerChanged,
+             item.script,
+             &Transcription::changeSpeakerForSegment);
+
+    item.phase.start ();
+    s.asr->startTranscription (item.asrPath);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BatchRunner::transcribed (
+    int slot, bool ok, const QString &error)
+{
+    Slot &s = m_slots[slot];
+    if (s.item < 0)
+    {
+        return;
+    }
+    Item &item = m_items[s.item];
+    item.asr = item.phase.elapsed () / 1000.0;
+    QFile::remove (item.asrPath);
+
+    if (!ok)
+    {
+        item.problems.append ("asr: " + error);
+        complete (slot);
+        return;
+    }
+
+    if (!m_options.tags || item.script->text ().isEmpty ())
+    {
+        tagged (slot);
+        return;
+    }
+
+    item.phase.start ();
+    s.tagger->generateTagsFor (item.script);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BatchRunner::tagged (
+    int slot)
+{
+    Item &item = m_items[m_slots[slot].item];
+    if (m_options.tags)
+    {
+        item.tags = item.phase.elapsed () / 1000.0;
+    }
+
+    if (m_database)
+    {
+        item.phase.start ();
+        if (!m_database->saveNewTranscription (item.script, item.script->name ()))
+        {
+            item.problems.append ("db: Titel vorhanden oder Speichern fehlgeschlagen");
+        }
+        item.database = item.phase.elapsed () / 1000.0;
+    }
+    complete (slot);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BatchRunner::complete (
+    int slot)
+{
+    Item &item = m_items[m_slots[slot].item];
+
+    if (!m_options.jsonDirectory.isEmpty () && item.problems.isEmpty ())
+    {
+        const QString path = QDir (m_options.jsonDirectory)
+                                 .filePath (QFileInfo (item.path).completeBaseName () + ".json");
+        QFile file (path);
+        if (!file.open (QIODevice::WriteOnly | QIODevice::Truncate)
+            || file.write (item.script->toJson ().toJson (QJsonDocument::Indented)) < 0)
+        {
+            item.problems.append ("json: " + file.errorString ());
+        }
+    }
+
+    ++m_done;
+    if (!item.problems.isEmpty ())
+    {
+        ++m_failures;
+    }
+    m_audioSeconds += item.audioSeconds;
+
+    const double total = item.total.elapsed () / 1000.0;
+    m_out << QString ("[%1/%2] %3 | Audio %4 s | wav %5 s | asr %6 s | tags %7 s | db %8 s | "
+                      "gesamt %9 s | RTF %10 | ohne Sprecher %11")
+                 .arg (m_done)
+                 .arg (m_items.size ())
+                 .arg (QFileInfo (item.path).fileName ())
+                 .arg (item.audioSeconds, 0, 'f', 1)
+                 .arg (item.prepare, 0, 'f', 1)
+                 .arg (item.asr, 0, 'f', 1)
+                 .arg (item.tags, 0, 'f', 1)
+                 .arg (item.database, 0, 'f', 1)
+                 .arg (total, 0, 'f', 1)
+                 .arg (item.audioSeconds > 0.0 ? total / item.audioSeconds : 0.0, 0, 'f', 3)
+                 .arg (item.unknownRate < 0.0 ? QString ("-")
+                                              : QString ("%1 %").arg (item.unknownRate * 100.0, 0, 'f', 1));
+    if (item.escalated >= 0.0)
+    {
+        m_out << QString (" | Kaskade %1 % erneut, %2 s gespart")
+                     .arg (item.escalated * 100.0, 0, 'f', 1)
+                     .arg (item.saved, 0, 'f', 1);
+    }
+    if (!item.problems.isEmpty ())
+    {
+        m_out << " | FEHLER: " << item.problems.join ("; ");
+    }
+    m_out << Qt::endl;
+
+    m_slots[slot].asr->disconnect (item.script);
+    item.script->deleteLater ();
+    item.script = nullptr;
+    startNext (slot);
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
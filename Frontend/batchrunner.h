@@ -0,0 +1,123 @@
+/**
+ * @file batchrunner.h
+ * @brief Enthält die Deklaration des BatchRunner für die Stapelverarbeitung ohne Oberfläche.
+ * @author Mike Wild
+ */
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+class AsrProcessManager;
+class DatabaseManager;
+class TagGeneratorManager;
+class Transcription;
+
+/**
+ * @brief Verarbeitet eine Liste von WAV-Dateien ohne Oberfläche: ASR, Tags und Datenbank.
+ *
+ * Jede Datei wird zunächst in einem Hintergrund-Thread in das ASR-Format (16 kHz, mono,
+ * 16 bit) umgewandelt, dann transkribiert, anschließend getaggt und zuletzt mit
+ * DatabaseManager::saveNewTranscription() gespeichert. Bis zu @c parallel Dateien laufen
+ * gleichzeitig, jede auf einem eigenen AsrProcessManager (und damit eigenen Workern).
+ *
+ * Nach jeder Datei wird eine Zeile mit der Dauer jeder Phase auf stdout ausgegeben,
+ * am Ende eine Zusammenfassung. Der BatchRunner erzeugt keine Widgets und ist für den
+ * Betrieb mit einer QCoreApplication gedacht (siehe climain.cpp).
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief Die Einstellungen eines Durchlaufs. */
+    struct Options
+    {
+        QStringList files;     ///< Die zu verarbeitenden WAV-Dateien.
+        int parallel = 1;      ///< Anzahl gleichzeitig verarbeiteter Dateien.
+        bool tags = true;      ///< Tags erzeugen.
+        bool database = true;  ///< Ergebnisse in der Datenbank speichern.
+        QString jsonDirectory; ///< Verzeichnis für die Transkripte als JSON (leer = keine).
+    };
+
+    /**
+     * @brief Konstruktor.
+     * @param options Die Einstellungen des Durchlaufs.
+     * @param database Die (bereits verbundene) Datenbank oder nullptr ohne Datenbank.
+     * @param parent Das QObject-Elternteil für die Speicherverwaltung.
+     */
+    BatchRunner (const Options &options, DatabaseManager *database, QObject *parent = nullptr);
+
+    /**
+     * @brief Startet die Verarbeitung; das Ende wird über finished() gemeldet.
+     */
+    void start ();
+
+signals:
+    /**
+     * @brief Alle Dateien sind verarbeitet.
+     * @param failures Anzahl der Dateien, bei denen ein Schritt fehlgeschlagen ist.
+     */
+    void finished (int failures);
+
+private:
+    /** @brief Zustand und Zeitmessung einer Datei. */
+    struct Item
+    {
+        QString path;                    ///< Die Eingabedatei.
+        QString asrPath;                 ///< Die umgewandelte ASR-Datei im temporären Verzeichnis.
+        Transcription *script = nullptr; ///< Das entstehende Transkript.
+        double audioSeconds = 0.0;       ///< Länge der Aufnahme.
+        double prepare = 0.0;            ///< Umwandlung in Sekunden.
+        double asr = 0.0;                ///< Transkription in Sekunden.
+        double tags = 0.0;               ///< Tag-Erzeugung in Sekunden.
+        double database = 0.0;           ///< Speichern in der Datenbank in Sekunden.
+        double unknownRate = -1.0;       ///< Anteil der Segmente ohne Sprecher (-1 = keine).
+        double escalated = -1.0;         ///< Kaskade: erneut transkribierter Anteil (-1 = ohne Kaskade).
+        double saved = 0.0;              ///< Kaskade: geschätzte Ersparnis in Sekunden.
+        QElapsedTimer total;             ///< Misst die Gesamtdauer.
+        QElapsedTimer phase;             ///< Misst die aktuelle Phase.
+        QStringList problems;            ///< Fehlgeschlagene Schritte.
+    };
+
+    /** @brief Ein Verarbeitungsplatz mit eigenem ASR-Manager und Tag-Generator. */
+    struct Slot
+    {
+        AsrProcessManager *asr = nullptr;      ///< ASR-Manager dieses Platzes.
+        TagGeneratorManager *tagger = nullptr; ///< Tag-Generator dieses Platzes.
+        int item = -1;                         ///< Index der aktuellen Datei (-1 = frei).
+    };
+
+    /** @brief Weist dem Platz die nächste Datei zu oder beendet den Durchlauf. */
+    void startNext (int slot);
+
+    /** @brief Die Umwandlung ist fertig; startet die Transkription. */
+    void prepared (int slot, bool ok, double audioSeconds, const QString &error);
+
+    /** @brief Die Transkription ist fertig; startet die Tag-Erzeugung. */
+    void transcribed (int slot, bool ok, const QString &error);
+
+    /** @brief Die Tags sind fertig; speichert das Ergebnis. */
+    void tagged (int slot);
+
+    /** @brief Speichert JSON und Datenbank-Eintrag, gibt die Zeile aus und gibt den Platz frei. */
+    void complete (int slot);
+
+    Options m_options;             ///< Die Einstellungen.
+    DatabaseManager *m_database;   ///< Die Datenbank (nullptr = keine).
+    QTemporaryDir m_tempDir;       ///< Verzeichnis für die umgewandelten Dateien.
+    QList<Item> m_items;           ///< Alle Dateien.
+    QList<Slot> m_slots;           ///< Die Verarbeitungsplätze.
+    int m_next = 0;                ///< Index der nächsten unbearbeiteten Datei.
+    int m_done = 0;                ///< Anzahl der fertigen Dateien.
+    int m_failures = 0;            ///< Anzahl der Dateien mit Fehlern.
+    double m_audioSeconds = 0.0;   ///< Summe der Audiodauer.
+    QElapsedTimer m_timer;         ///< Misst den gesamten Durchlauf.
+    QTextStream m_out;             ///< Ausgabe auf stdout.
+};
+
+#endif // BATCHRUNNER_H
@@ -1,13 +1,60 @@
 #include "capturethread.h"
+#include "processgovernor.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <ctime>
 
 CaptureThread::CaptureThread (
     QObject *parent)
     : QThread (parent)
     , m_active (false)
     , m_shutdown (false)
+    , m_bus (PoolBlocks, BlockFrames, BlockChannels)
+    , m_mixer (2, BlockChannels)
 {
+    //  Die DSP-Kette wird einmalig aufgebaut; die Stufen sind zunächst deaktiviert
+    //  und werden über setHighPass() bzw. setLimiter() zugeschaltet.
+    m_highPass = static_cast<HighPassFilter *> (
+        m_mixer.addStage (std::make_unique<HighPassFilter> ()));
+    m_limiter = static_cast<Limiter *> (m_mixer.addStage (std::make_unique<Limiter> ()));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void CaptureThread::setGains (
+    float sysGain, float micGain)
+{
+    m_mixer.setGain (0, sysGain);
+    m_mixer.setGain (1, micGain);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void CaptureThread::setHighPass (
+    bool enabled, float cutoffHz)
+{
+    m_highPass->setCutoff (cutoffHz);
+    m_highPass->setEnabled (enabled);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void CaptureThread::setLimiter (
+    bool enabled, float threshold)
+{
+    m_limiter->setThreshold (threshold);
+    m_limiter->setEnabled (enabled);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void CaptureThread::mix (
+    const float *sys, const float *mic, float *out, int frames)
+{
+    const float *inputs[] = {sys, mic};
+    m_mixer.process (inputs, out, frames);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -52,6 +99,13 @@ void CaptureThread::shutdown ()
 
 void CaptureThread::run ()
 {
+    //  Läuft Whisper gleichzeitig auf allen Kernen, darf der Aufnahme-Thread nicht warten
+    //  müssen. Der Pool bleibt für die ganze Lebensdauer des Threads im RAM gesperrt; die
+    //  Priorität gilt nur während einer Aufnahme.
+    const bool realtime = wantsRealtimePriority ()
+                          && QSettings ("SS2025FP_T2", "AudioTranskriptor").value ("audio/realtime", true).toBool ();
+    const bool locked = realtime && ProcessGovernor::lockMemory (m_bus.storage (), m_bus.storageBytes ());
+
     // Die äußere Schleife hält den Thread am Leben, bis shutdown() aufgerufen wird.
     while (!m_shutdown.load ())
     {
@@ -73,6 +127,15 @@ void CaptureThread::run ()
         }
 
         // --- Zustand: Initialisierung ---
+        // Start- und Stoppzeit sowie die CPU-Zeit des Prozesses werden je Session geloggt,
+        // damit sich die Backends direkt miteinander vergleichen lassen.
+        QElapsedTimer phaseTimer;
+        phaseTimer.start ();
+        const std::clock_t cpuStart = std::clock ();
+
+        //  Alle Backends liefern 48 kHz; die Filterzustände beginnen bei jeder Session neu.
+        m_mixer.reset (48000);
+
         if (!initializeCapture ())
         {
             // Wenn die plattformspezifische Initialisierung fehlschlägt,
@@ -81,20 +144,61 @@ void CaptureThread::run ()
             continue;
         }
 
+        const qint64 startMs = phaseTimer.elapsed ();
+        m_bus.resetStatistics ();
+        m_xruns.store (0, std::memory_order_relaxed);
+        const bool governed = ProcessGovernor ().isEnabled ();
+        bool underLoad = ProcessGovernor::runningProcesses () > 0;
+        if (realtime && !ProcessGovernor::elevateCurrentThread (RealtimePriority))
+        {
+            qWarning () << "CaptureThread: Keine erhöhte Priorität erlaubt (RLIMIT_RTPRIO, RealtimeKit).";
+        }
         emit started ();
+        QElapsedTimer sessionTimer;
+        sessionTimer.start ();
 
         // --- Zustand: Aktive Aufnahme ---
         // Die innere Schleife läuft, solange die Aufnahme aktiv ist.
         while (m_active.load ())
         {
             captureLoopIteration (); // Die eigentliche, plattformspezifische Arbeit.
+            underLoad = underLoad || ProcessGovernor::runningProcesses () > 0;
         }
 
         // --- Zustand: Aufräumen ---
         // Die Aufnahme wurde durch stopCapture() beendet.
+        const qint64 sessionMs = sessionTimer.elapsed ();
+        if (realtime)
+        {
+            ProcessGovernor::resetCurrentThread ();
+        }
+        phaseTimer.restart ();
         cleanupCapture ();
+        const qint64 stopMs = phaseTimer.elapsed ();
+        const double cpuMs = 1000.0 * double (std::clock () - cpuStart) / CLOCKS_PER_SEC;
+
+        qDebug () << metaObject ()->className () << "- Mixer:" << AudioMixer::kernelName () << ", Start:" << startMs << "ms, Stopp:" << stopMs
+                  << "ms, Aufnahme:" << sessionMs << "ms, Prozess-CPU:" << qRound (cpuMs)
+                  << "ms, Auslastung in %:" << (sessionMs > 0 ? qRound (100.0 * cpuMs / sessionMs) : 0);
+
+        if (m_bus.overruns () > 0)
+        {
+            qWarning () << "CaptureThread:" << m_bus.overruns ()
+                        << "Blöcke verworfen, da der AudioBus-Pool erschöpft war.";
+        }
+
+        //  Xruns unter ASR-Last werden getrennt nach Governor an/aus gesammelt.
+        const quint64 xruns = m_bus.overruns () + m_bus.droppedBlocks () + m_xruns.load ();
+        qDebug () << metaObject ()->className () << "- Xruns:" << xruns << ", Python-Last:" << underLoad
+                  << ", Governor:" << governed;
+        ProcessGovernor::recordSession (sessionMs / 1000.0, xruns, underLoad, governed);
         emit stopped ();
     }
+
+    if (locked)
+    {
+        ProcessGovernor::unlockMemory (m_bus.storage (), m_bus.storageBytes ());
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
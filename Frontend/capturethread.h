@@ -10,6 +10,8 @@
 #include <QThread>
 #include <QWaitCondition>
 #include <atomic>
+#include "audiobus.h"
+#include "audiomixer.h"
 
 /**
  * @brief Eine abstrakte Basisklasse für Threads, die Audio in Echtzeit aufnehmen.
@@ -19,6 +21,11 @@
  * definiert das Grundgerüst des Ablaufs, während plattformspezifische Details
  * (Initialisierung, die eigentliche Aufnahmeschleife und das Aufräumen)
  * von abgeleiteten Klassen implementiert werden müssen.
+ *
+ * Mit "audio/realtime" (Standard: an) fordert der Thread beim Start eine Echtzeit-Priorität
+ * an und sperrt den Speicher des AudioBus im RAM (siehe ProcessGovernor). Am Ende jeder
+ * Aufnahme werden die Xruns (Overruns, bei Lesern verworfene Blöcke und Meldungen des
+ * Backends) für den Vergleich mit und ohne Governor verbucht.
  */
 class CaptureThread : public QThread
 {
@@ -54,13 +61,37 @@ public:
      */
     void shutdown ();
 
-signals:
     /**
-     * @brief Wird gesendet, wenn ein neuer Block von Audio-Daten (PCM-Samples) bereitsteht.
-     * @param chunk Eine Liste von float-Werten, die die Audio-Samples repräsentieren.
+     * @brief Gibt den AudioBus zurück, über den die aufgenommenen Blöcke verteilt werden.
+     *
+     * Consumer (z.B. der WavWriterThread) melden sich mit AudioBus::subscribe() an,
+     * solange keine Aufnahme läuft. Jeder Block enthält interleavte Stereo-Samples
+     * (32-bit float, 48 kHz).
+     * @return Zeiger auf den Bus; gehört dem CaptureThread.
+     */
+    AudioBus *audioBus () { return &m_bus; }
+
+    /**
+     * @brief Setzt die Verstärkungsfaktoren für System-Audio und Mikrofon.
+     * @note Thread-sicher und lock-frei; wirkt auch während einer laufenden Aufnahme.
+     */
+    void setGains (float sysGain, float micGain);
+
+    /**
+     * @brief Aktiviert oder deaktiviert den Hochpassfilter der DSP-Kette.
+     * @param enabled true, um den Filter zu aktivieren.
+     * @param cutoffHz Die Grenzfrequenz in Hz.
      */
-    void pcmChunkReady (QList<float> chunk);
+    void setHighPass (bool enabled, float cutoffHz);
 
+    /**
+     * @brief Aktiviert oder deaktiviert den Limiter der DSP-Kette.
+     * @param enabled true, um den Limiter zu aktivieren.
+     * @param threshold Der maximal erlaubte Spitzenwert (linear, z.B. 0.9).
+     */
+    void setLimiter (bool enabled, float threshold);
+
+signals:
     /**
      * @brief Wird gesendet, unmittelbar nachdem die plattformspezifische Initialisierung
      * erfolgreich war und die Aufnahmeschleife beginnt.
@@ -101,11 +132,66 @@ protected:
      */
     virtual void cleanupCapture () = 0;
 
+    /**
+     * @brief Gibt an, ob der Thread eine Echtzeit-Priorität anfordern soll ("audio/realtime").
+     *
+     * Backends, deren Schleife ohne zu blockieren durchläuft, müssen false liefern: Unter
+     * RealtimeKit würde der Thread sonst nach RLIMIT_RTTIME beendet.
+     */
+    virtual bool wantsRealtimePriority () const { return true; }
+
+    /**
+     * @brief Hilfsfunktion für abgeleitete Klassen: holt einen freien Block aus dem Pool.
+     *
+     * Ist der Pool erschöpft (die Consumer kommen nicht hinterher), wird nullptr
+     * zurückgegeben und der Overrun im Bus gezählt.
+     * @return Ein leerer Block mit Platz für AudioBus::framesPerBlock() Frames oder nullptr.
+     */
+    AudioBlock *acquireBlock () { return m_bus.acquire (); }
+
+    /**
+     * @brief Hilfsfunktion für abgeleitete Klassen: veröffentlicht einen gefüllten Block.
+     * @param block Der Block; block->frames muss gesetzt sein.
+     */
+    void publishBlock (AudioBlock *block) { m_bus.publish (block); }
+
+    /**
+     * @brief Hilfsfunktion für abgeleitete Klassen: zählt einen Xrun des Geräts.
+     *
+     * Für Überläufe und Lücken, die das Backend selbst meldet (z.B. der Server hat Daten
+     * verworfen, weil sie nicht rechtzeitig gelesen wurden).
+     * @note Lock-frei; darf aus jedem Thread aufgerufen werden.
+     */
+    void countXrun () { m_xruns.fetch_add (1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Hilfsfunktion für abgeleitete Klassen: mischt System- und Mikrofon-Audio.
+     *
+     * Wendet die Gains und die DSP-Kette an und begrenzt das Ergebnis auf [-1.0, 1.0].
+     * @param sys Interleavte Stereo-Samples des System-Audios (nullptr = Stille).
+     * @param mic Interleavte Stereo-Samples des Mikrofons (nullptr = Stille).
+     * @param out Der Zielpuffer, z.B. AudioBlock::data.
+     * @param frames Anzahl der Frames.
+     */
+    void mix (const float *sys, const float *mic, float *out, int frames);
+
+    static constexpr int BlockFrames = 1024;  ///< Frames pro Block (ca. 21 ms bei 48 kHz).
+    static constexpr int BlockChannels = 2;   ///< Kanäle pro Frame (Stereo).
+    static constexpr int PoolBlocks = 256;    ///< Blöcke im Pool (ca. 5,5 s Audio).
+    static constexpr int RealtimePriority = 20; ///< SCHED_FIFO-Priorität des Aufnahme-Threads.
+
     // Synchronisationsobjekte für die Steuerung des Threads von außen
     QMutex m_mutex;                 ///< Schützt den Zugriff auf den Zustand des Threads.
     QWaitCondition m_waitCondition; ///< Lässt den Thread schlafen, wenn er inaktiv ist.
     std::atomic<bool> m_active;     ///< Steuert die innere Aufnahmeschleife (start/stop).
     std::atomic<bool> m_shutdown;   ///< Signalisiert dem Thread, sich komplett zu beenden.
+
+private:
+    AudioBus m_bus;           ///< Lock-freier Verteiler der aufgenommenen Audio-Blöcke.
+    AudioMixer m_mixer;       ///< Mischt System- und Mikrofon-Audio inkl. DSP-Kette.
+    HighPassFilter *m_highPass; ///< Hochpass-Stufe der DSP-Kette (gehört m_mixer).
+    Limiter *m_limiter;       ///< Limiter-Stufe der DSP-Kette (gehört m_mixer).
+    std::atomic<quint64> m_xruns{0}; ///< Vom Backend gemeldete Xruns der laufenden Aufnahme.
 };
 
 #endif // CAPTURETHREAD_H
@@ -0,0 +1,431 @@
+/**
+ * @file climain.cpp
+ * @brief Der Einstiegspunkt der Stapelverarbeitung ohne Oberfläche (AudioTranskriptorCli).
+ * @author Mike Wild
+ */
+#include "asrprotocolparser.h"
+#include "batchrunner.h"
+#include "databasemanager.h"
+#include "polyphaseresampler.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*
+ * Beispiel:
+ *
+ *   AudioTranskriptorCli -j 2 --json-dir ./out aufnahmen/
+ *   AudioTranskriptorCli --benchmark-parser 100000
+ *   AudioTranskriptorCli --benchmark-resampler 600
+ *
+ * Verwendet dieselben Einstellungen (Python-Pfad, Datenbank, jobs/maxParallel) wie die
+ * Oberfläche; diese müssen also vorher einmal über den Einstellungs-Assistenten gesetzt
+ * worden sein.
+ * */
+
+namespace
+{
+/**
+ * @brief Misst das Zerlegen von @p lines synthetischen ASR-Zeilen.
+ *
+ * Verglichen werden der frühere Weg (je Zeile QString, trimmed() und eine neue
+ * QRegularExpression), der AsrProtocolParser auf dem alten Format und auf JSON-Zeilen sowie
+ * QJsonDocument auf denselben JSON-Zeilen.
+ */
+int runParserBenchmark (
+    int lines, QTextStream &out)
+{
+    QByteArray legacy;
+    QByteArray json;
+    for (int i = 0; i < lines; ++i)
+    {
+        const double start = i * 2.5;
+        legacy += QString ("[%1s --> %2s] SPEAKER_%3: Das ist Satz Nummer %4 der Besprechung.\n")
+                      .arg (start, 0, 'f', 2)
+                      .arg (start + 2.4, 0, 'f', 2)
+                      .arg (i % 4, 2, 10, QChar ('0'))
+                      .arg (i)
+                      .toUtf8 ();
+        json += QString ("{\"type\": \"segment\", \"start\": %1, \"end\": %2, \"speaker\": "
+                         "\"SPEAKER_%3\", \"text\": \"Das ist Satz Nummer %4 der Besprechung.\", "
+                         "\"confidence\": 0.87, \"words\": [[%1, %5, \" Das\", 0.99], "
+                         "[%5, %2, \" ist\", 0.97]]}\n")
+                    .arg (start, 0, 'f', 2)
+                    .arg (start + 2.4, 0, 'f', 2)
+                    .arg (i % 4, 2, 10, QChar ('0'))
+                    .arg (i)
+                    .arg (start + 0.4, 0, 'f', 2)
+                    .toUtf8 ();
+    }
+
+    //  Die Summen verhindern, dass der Compiler die Schleifen wegoptimiert, und dienen als
+    //  Plausibilitätsprüfung (alle Varianten müssen dieselbe Zahl Segmente finden).
+    QElapsedTimer timer;
+    auto report = [&] (const char *name, int segments) {
+        const double ns = double (timer.nsecsElapsed ()) / qMax (1, lines);
+        out << QString ("%1 %2 ns/Zeile (%3 Segmente)").arg (name, -26).arg (ns, 8, 'f', 1).arg (segments)
+            << Qt::endl;
+    };
+
+    timer.start ();
+    int found = 0;
+    for (const QByteArray &raw : legacy.split ('\n'))
+    {
+        const QString line = QString::fromUtf8 (raw).trimmed ();
+        QRegularExpression re (R"(\[(\d+\.\d+)s\s*-->\s*(\d+\.\d+)s\]\s*([A-Z0-9_]+):\s*(.*))");
+        QRegularExpressionMatch match = re.match (line);
+        if (match.hasMatch ())
+        {
+            const double start = match.captured (1).toDouble ();
+            const double end = match.captured (2).toDouble ();
+            found += end >= start && !match.captured (3).isEmpty () && !match.captured (4).isEmpty ();
+        }
+    }
+    report ("Regex (bisher)", found);
+
+    AsrProtocolParser parser;
+    AsrEvent event;
+    timer.start ();
+    found = 0;
+    parser.feed (legacy);
+    while (parser.next (&event))
+    {
+        found += event.type == AsrEvent::Type::Segment;
+    }
+    report ("Parser, altes Format", found);
+
+    parser.reset ();
+    timer.start ();
+    found = 0;
+    parser.feed (json);
+    while (parser.next (&event))
+    {
+        found += event.type == AsrEvent::Type::Segment && event.segment.words.size () == 2;
+    }
+    report ("Parser, JSON-Zeilen", found);
+
+    timer.start ();
+    found = 0;
+    for (const QByteArray &raw : json.split ('\n'))
+    {
+        const QJsonObject object = QJsonDocument::fromJson (raw).object ();
+        found += object.value ("type").toString () == "segment";
+    }
+    report ("QJsonDocument, JSON-Zeilen", found);
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * @brief Misst den PolyphaseResampler: Rechenzeit je Audiosekunde sowie für 48 -> 16 kHz
+ *        die Welligkeit im Durchlassbereich und die Dämpfung im Sperrbereich.
+ *
+ * Zum Vergleich läuft der frühere Weg der ASR-Datei mit (jedes dritte Sample ohne
+ * Tiefpass). Die Rechenzeit wird über @p seconds Sekunden Rauschen in Blöcken zu 2048
+ * Frames gemessen, wie sie der Audio-Bus liefert.
+ */
+int runResamplerBenchmark (
+    int seconds, QTextStream &out)
+{
+    constexpr double Pi = 3.14159265358979323846;
+    constexpr int Block = 2048;
+
+    //  Pseudozufälliges Rauschen (LCG), damit jeder Lauf dieselben Daten verarbeitet.
+    auto noise = [] (int samples) {
+        std::vector<float> data (size_t (samples));
+        quint32 state = 12345;
+        for (float &value : data)
+        {
+            state = state * 1664525u + 1013904223u;
+            value = float (state >> 8) / float (1 << 24) - 0.5f;
+        }
+        return data;
+    };
+
+    //  Das Schreiben in sink verhindert, dass der Compiler die Schleifen wegoptimiert.
+    QElapsedTimer timer;
+    volatile float sink = 0.0f;
+    auto reportTime = [&] (const QString &name) {
+        const double ms = double (timer.nsecsElapsed ()) / 1e6 / qMax (1, seconds);
+        out << QString ("%1 %2 ms je Audiosekunde").arg (name, -34).arg (ms, 7, 'f', 3) << Qt::endl;
+    };
+
+    out << "Kernel: " << PolyphaseResampler::kernelName () << Qt::endl;
+
+    const struct
+    {
+        int inRate;
+        int outRate;
+        int channels;
+    } paths[] = {{48000, 16000, 1}, {44100, 48000, 2}, {48000, 44100, 2}};
+    for (const auto &path : paths)
+    {
+        PolyphaseResampler resampler (path.inRate, path.outRate, path.channels);
+        const std::vector<float> input = noise (path.inRate * path.channels);
+        std::vector<float> output (size_t (resampler.maxOutputFrames (Block) * path.channels));
+
+        timer.start ();
+        for (int second = 0; second < seconds; ++second)
+        {
+            for (int frame = 0; frame < path.inRate; frame += Block)
+            {
+                const int frames = std::min (Block, path.inRate - frame);
+                const int written = resampler.process (input.data () + size_t (frame) * path.channels,
+                                                       frames,
+                                                       output.data ());
+                sink = written > 0 ? output[0] : 0.0f;
+            }
+        }
+        reportTime (QString ("Polyphase %1 -> %2 Hz %3, %4 Taps")
+                        .arg (path.inRate)
+                        .arg (path.outRate)
+                        .arg (path.channels == 1 ? "Mono" : "Stereo")
+                        .arg (resampler.tapsPerPhase ()));
+    }
+
+    {
+        const std::vector<float> input = noise (48000);
+        std::vector<float> output (16000);
+        timer.start ();
+        for (int second = 0; second < seconds; ++second)
+        {
+            for (int i = 0; i < 16000; ++i)
+            {
+                output[size_t (i)] = input[size_t (i) * 3];
+            }
+            sink = output[0];
+        }
+        reportTime ("Jedes dritte Sample (bisher)");
+    }
+
+    //  Frequenzgang 48 -> 16 kHz mit Sinustönen: Jeder Ton wird 1,1 s lang gewandelt und der
+    //  Effektivwert über genau eine Sekunde der Ausgabe (nach dem Einschwingen) gemessen. Die
+    //  Frequenzen sind ganzzahlig, damit das Messfenster ganze Perioden enthält; auch die in
+    //  den Durchlassbereich gespiegelten Töne des Sperrbereichs. Vielfache von 8 kHz werden
+    //  ausgelassen, weil sie auf Gleichanteil bzw. Nyquist fallen.
+    constexpr double Amplitude = 0.5;
+    constexpr int InFrames = 52800;
+    constexpr int Skip = 800;
+    constexpr int Window = 16000;
+    std::vector<float> tone (InFrames);
+    std::vector<float> output (size_t (PolyphaseResampler (48000, 16000, 1).maxOutputFrames (InFrames)));
+    auto gainDb = [&] (int frequency, bool polyphase) {
+        for (int i = 0; i < InFrames; ++i)
+        {
+            tone[size_t (i)] = float (Amplitude * std::sin (2.0 * Pi * frequency * i / 48000.0));
+        }
+        int written = 0;
+        if (polyphase)
+        {
+            PolyphaseResampler resampler (48000, 16000, 1);
+            written = resampler.process (tone.data (), InFrames, output.data ());
+        }
+        else
+        {
+            for (int i = 0; i * 3 < InFrames; ++i)
+            {
+                output[size_t (written++)] = tone[size_t (i) * 3];
+            }
+        }
+        if (written < Skip + Window)
+        {
+            return 0.0;
+        }
+        double energy = 0.0;
+        for (int i = Skip; i < Skip + Window; ++i)
+        {
+            energy += double (output[size_t (i)]) * output[size_t (i)];
+        }
+        const double rms = std::sqrt (energy / Window);
+        return 20.0 * std::log10 (std::max (rms, 1e-12) / (Amplitude / std::sqrt (2.0)));
+    };
+
+    //  Durchlassbereich bis 5,4 kHz: Dort endet bei der Standard-Filterlänge die Flanke,
+    //  die bei 8 kHz den Sperrbereich erreicht.
+    out << Qt::endl << "48 -> 16 kHz, Durchlass 50-5400 Hz, Sperrbereich 8025-23975 Hz:" << Qt::endl;
+    for (const bool polyphase : {true, false})
+    {
+        double passMin = 1e9;
+        double passMax = -1e9;
+        for (int frequency = 50; frequency <= 5400; frequency += 50)
+        {
+            const double gain = gainDb (frequency, polyphase);
+            passMin = std::min (passMin, gain);
+            passMax = std::max (passMax, gain);
+        }
+        double stopMax = -1e9;
+        for (int frequency = 8025; frequency < 24000; frequency += 50)
+        {
+            stopMax = std::max (stopMax, gainDb (frequency, polyphase));
+        }
+        out << QString ("%1 Welligkeit %2 dB, Sperrdämpfung %3 dB")
+                   .arg (polyphase ? "Polyphase" : "Jedes dritte Sample (bisher)", -34)
+                   .arg (passMax - passMin, 0, 'f', 4)
+                   .arg (-stopMax, 0, 'f', 1)
+            << Qt::endl;
+    }
+    return 0;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+int main (
+    int argc, char *argv[])
+{
+    QCoreApplication app (argc, argv);
+    app.setApplicationName ("AudioTranskriptor");
+    app.setOrganizationName ("SS2025FP_T2");
+
+    QTextStream err (stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription (
+        QCoreApplication::translate ("main",
+                                     "Transkribiert WAV-Dateien ohne Oberfläche, erzeugt Tags und "
+                                     "speichert die Ergebnisse in der Datenbank."));
+    parser.addHelpOption ();
+    parser.addPositionalArgument ("pfade",
+                                  QCoreApplication::translate ("main", "WAV-Dateien oder Verzeichnisse."),
+                                  "<pfad...>");
+
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const QCommandLineOption jobsOption (
+        {"j", "jobs"},
+        QCoreApplication::translate ("main", "Anzahl gleichzeitig verarbeiteter Dateien."),
+        "anzahl",
+        QString::number (settings.value ("jobs/maxParallel", 1).toInt ()));
+    const QCommandLineOption recursiveOption (
+        {"r", "recursive"},
+        QCoreApplication::translate ("main", "Verzeichnisse rekursiv durchsuchen."));
+    const QCommandLineOption noTagsOption (
+        "no-tags", QCoreApplication::translate ("main", "Keine Tags erzeugen."));
+    const QCommandLineOption noDbOption (
+        "no-db", QCoreApplication::translate ("main", "Nichts in der Datenbank speichern."));
+    const QCommandLineOption jsonOption (
+        "json-dir",
+        QCoreApplication::translate ("main", "Transkripte zusätzlich als JSON in diesem Verzeichnis ablegen."),
+        "verzeichnis");
+    const QCommandLineOption benchmarkOption (
+        "benchmark-parser",
+        QCoreApplication::translate ("main",
+                                     "Misst das Zerlegen der ASR-Ausgabe mit dieser Anzahl synthetischer "
+                                     "Zeilen und beendet sich."),
+        "zeilen");
+    const QCommandLineOption resamplerBenchmarkOption (
+        "benchmark-resampler",
+        QCoreApplication::translate ("main",
+                                     "Misst Rechenzeit und Frequenzgang des Resamplers mit dieser Anzahl "
+                                     "Audiosekunden und beendet sich."),
+        "sekunden");
+    parser.addOptions ({jobsOption,
+                        recursiveOption,
+                        noTagsOption,
+                        noDbOption,
+                        jsonOption,
+                        benchmarkOption,
+                        resamplerBenchmarkOption});
+    parser.process (app);
+
+    if (parser.isSet (benchmarkOption))
+    {
+        QTextStream out (stdout);
+        return runParserBenchmark (qMax (1, parser.value (benchmarkOption).toInt ()), out);
+    }
+    if (parser.isSet (resamplerBenchmarkOption))
+    {
+        QTextStream out (stdout);
+        return runResamplerBenchmark (qMax (1, parser.value (resamplerBenchmarkOption).toInt ()), out);
+    }
+
+    //  Ohne Oberfläche kann der Einstellungs-Assistent nicht helfen; die Python-Umgebung
+    //  muss bereits eingerichtet sein.
+    if (!QFile::exists (settings.value ("pythonPath").toString ()))
+    {
+        err << QCoreApplication::translate ("main",
+                                            "Kein gültiger Python-Pfad konfiguriert. Bitte zuerst die "
+                                            "Anwendung starten und die Einrichtung abschließen.")
+            << Qt::endl;
+        return 1;
+    }
+
+    BatchRunner::Options options;
+    const QDirIterator::IteratorFlags flags = parser.isSet (recursiveOption)
+                                                  ? QDirIterator::Subdirectories
+                                                  : QDirIterator::NoIteratorFlags;
+    for (const QString &path : parser.positionalArguments ())
+    {
+        const QFileInfo info (path);
+        if (info.isDir ())
+        {
+            QStringList found;
+            QDirIterator it (path, {"*.wav", "*.WAV"}, QDir::Files, flags);
+            while (it.hasNext ())
+            {
+                found.append (it.next ());
+            }
+            found.sort ();
+            options.files.append (found);
+        }
+        else if (info.isFile ())
+        {
+            options.files.append (info.absoluteFilePath ());
+        }
+        else
+        {
+            err << QCoreApplication::translate ("main", "Nicht gefunden: %1").arg (path) << Qt::endl;
+        }
+    }
+    if (options.files.isEmpty ())
+    {
+        parser.showHelp (1);
+    }
+
+    options.parallel = qMax (1, parser.value (jobsOption).toInt ());
+    options.tags = !parser.isSet (noTagsOption);
+    options.database = !parser.isSet (noDbOption);
+    options.jsonDirectory = parser.value (jsonOption);
+    if (!options.jsonDirectory.isEmpty () && !QDir ().mkpath (options.jsonDirectory))
+    {
+        err << QCoreApplication::translate ("main", "Verzeichnis kann nicht angelegt werden: %1")
+                   .arg (options.jsonDirectory)
+            << Qt::endl;
+        return 1;
+    }
+
+    DatabaseManager database;
+    if (options.database && !database.connectToSupabase ())
+    {
+        err << QCoreApplication::translate ("main",
+                                            "Keine Verbindung zur Datenbank. Mit --no-db lässt sich "
+                                            "ohne Datenbank arbeiten.")
+            << Qt::endl;
+        return 1;
+    }
+
+    BatchRunner runner (options, options.database ? &database : nullptr);
+    QObject::connect (&runner,
+                      &BatchRunner::finished,
+                      &app,
+                      [] (int failures) { QCoreApplication::exit (failures > 0 ? 2 : 0); });
+    runner.start ();
+    return app.exec ();
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
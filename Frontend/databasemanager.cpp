@@ -1,8 +1,8 @@
 #include "databasemanager.h"
+#include "keywordextractor.h"
 #include "transcription.h"
 
 #include <QDebug>
-#include <QMessageBox>
 #include <QSettings>
 #include <QSqlDatabase>
 #include <QSqlError>
@@ -74,12 +74,43 @@ bool DatabaseManager::connectToSupabase ()
     }
 
     qDebug () << "Verbindung zu Supabase PostgreSQL hergestellt.";
+    m_hasSegmentIds = ensureSegmentIdColumn (db);
     m_connected = true;
     return true;
 }
 
 //--------------------------------------------------------------------------------------------------
 
+bool DatabaseManager::ensureSegmentIdColumn (
+    QSqlDatabase &db)
+{
+    // Die stabile Segment-ID bekommt eine eigene Spalte; der Primärschlüssel id bleibt
+    // der Sequenz überlassen. Ältere Aussagen haben dort NULL und erhalten ihre ID beim
+    // nächsten Speichern.
+    QSqlQuery alter (db);
+    if (!alter.exec ("ALTER TABLE aussagen ADD COLUMN IF NOT EXISTS segment_id BIGINT"))
+    {
+        qWarning () << "Spalte segment_id konnte nicht angelegt werden:"
+                    << alter.lastError ().text ();
+    }
+
+    // Fehlen die Rechte für ALTER TABLE, kann die Spalte trotzdem schon existieren
+    QSqlQuery check (db);
+    if (check.exec (R"(
+        SELECT 1 FROM information_schema.columns
+        WHERE table_name = 'aussagen' AND column_name = 'segment_id'
+    )")
+        && check.next ())
+    {
+        return true;
+    }
+
+    qWarning () << "Segment-IDs werden nicht in der Datenbank gespeichert.";
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 QSqlDatabase DatabaseManager::getDatabase ()
 {
     return QSqlDatabase::database ("supabase");
@@ -116,16 +147,17 @@ QMap<QString, Transcription *> DatabaseManager::loadAllTranscriptions ()
     QSqlQuery query (getDatabase ());
 
     // Komplexe SQL-Abfrage mit JOINs auf Besprechungen, Aussagen und Sprecher
-    const QString sql = R"(
+    const QString sql = QString (R"(
         SELECT b.id AS besprechung_id, b.titel AS title, b.created_at AS start_time,
-               a.zeit_start AS start, a.zeit_ende AS end,
+               %1 AS segment_id, a.zeit_start AS start, a.zeit_ende AS end,
                s.name AS speaker_name,
                a.verarbeiteter_text, a.roher_text, a.tags
         FROM besprechungen b
         JOIN aussagen a ON b.id = a.besprechungen_id
         JOIN sprecher s ON a.sprecher_id = s.id
         ORDER BY b.id, a.zeit_start
-    )";
+    )")
+                            .arg (m_hasSegmentIds ? "a.segment_id" : "NULL");
 
     // SQL ausführen und bei Fehler abbrechen
     if (!query.exec (sql))
@@ -147,9 +179,10 @@ QMap<QString, Transcription *> DatabaseManager::loadAllTranscriptions ()
             map.insert (title, t);
         }
         Transcription *t = map[title];
-        // Zeitstempel der einzelnen Segment starten und enden
-        QString start = query.value ("start").toDateTime ().toString (Qt::ISODate);
-        QString end = query.value ("end").toDateTime ().toString (Qt::ISODate);
+        // Zeitstempel der einzelnen Segmente: gespeichert als Zeitpunkt ab der Epoche,
+        // gemeint ist die Zeit ab Beginn der Aufnahme
+        qint64 start = query.value ("start").toDateTime ().toMSecsSinceEpoch ();
+        qint64 end = query.value ("end").toDateTime ().toMSecsSinceEpoch ();
         // Falls verarbeiteter Text leer, rohen Text nehmen
         QString speaker = query.value ("speaker_name").toString ();
         QString processed = query.value ("verarbeiteter_text").toString ();
@@ -162,10 +195,18 @@ QMap<QString, Transcription *> DatabaseManager::loadAllTranscriptions ()
         // MetaText Objekt mit allen Infos erzeugen
         MetaText mt (start, end, speaker, finalText);
         mt.Tags = tags;
+        // Stabile Segment-ID (NULL bei älteren Aussagen → add() vergibt eine neue)
+        mt.Id = query.value ("segment_id").toULongLong ();
         // Segment zur Transcription hinzufügen
         t->add (mt);
     }
 
+    // Korpus der Tag-Vorschläge mit allen geladenen Meetings aktualisieren
+    for (const Transcription *t : std::as_const (map))
+    {
+        KeywordExtractor::shared ().addTranscription (t);
+    }
+
     return map;
 }
 //--------------------------------------------------------------------------------------------------
@@ -228,12 +269,12 @@ void DatabaseManager::loadMeetingTranscriptions (
     // Aussagen zu dem Meeting laden, Spalte für Text wird dynamisch übergeben
     QSqlQuery stmtQuery (db);
     stmtQuery.prepare (QString (R"(
-        SELECT id, zeit_start, zeit_ende, %1, sprecher_id
+        SELECT id, zeit_start, zeit_ende, %1, sprecher_id, %2 AS segment_id
         FROM aussagen
         WHERE besprechungen_id = :id
         ORDER BY zeit_start
     )")
-                           .arg (textColumn));
+                           .arg (textColumn, m_hasSegmentIds ? "segment_id" : "NULL"));
     stmtQuery.bindValue (":id", meetingId);
 
     if (!stmtQuery.exec ())
@@ -257,17 +298,15 @@ void DatabaseManager::loadMeetingTranscriptions (
         int speakerId = stmtQuery.value ("sprecher_id").toInt ();
 
         QString speakerName = getSpeakerName (speakerId, meetingId, db);
-        MetaText segment (QString::number (start.toSecsSinceEpoch ()),
-                          QString::number (end.toSecsSinceEpoch ()),
-                          speakerName,
-                          text);
+        MetaText segment (start.toMSecsSinceEpoch (), end.toMSecsSinceEpoch (), speakerName, text);
+        segment.Id = stmtQuery.value ("segment_id").toULongLong ();
         m_script->add (segment);
     }
     // Falls kein bearbeiteter Text vorhanden und der textColumn "verarbeiteter_text" war,
-    // wird nochmal mit "roher_text" nachgeladen und Hinweis angezeigt
+    // wird nochmal mit "roher_text" nachgeladen und ein Hinweis gemeldet (Anzeige im MainWindow)
     if (!hasText && textColumn == "verarbeiteter_text")
     {
-        QMessageBox::warning (nullptr, "Hinweis", "Kein bearbeiteter Text gefunden.");
+        emit notice ("Kein bearbeiteter Text gefunden.");
         m_script->setViewMode (TranscriptionViewMode::Original);
         loadMeetingTranscriptions (meetingTitle, "roher_text", m_script);
     }
@@ -340,6 +379,25 @@ bool DatabaseManager::saveNewTranscription (
         return false;
     }
 
+    // Wird ein geladenes Meeting unter neuem Titel gespeichert, gehören die Segment-IDs
+    // schon dem Original; die Kopie bekommt dann neue IDs.
+    if (m_hasSegmentIds)
+    {
+        QStringList segmentIds;
+        for (const MetaText &segment : script->getMetaTexts ())
+        {
+            segmentIds << QString::number (segment.Id);
+        }
+        QSqlQuery idQuery (db);
+        idQuery.prepare (
+            "SELECT 1 FROM aussagen WHERE segment_id = ANY(CAST(:ids AS BIGINT[])) LIMIT 1");
+        idQuery.bindValue (":ids", "{" + segmentIds.join (",") + "}");
+        if (idQuery.exec () && idQuery.next ())
+        {
+            script->renewSegmentIds ();
+        }
+    }
+
     // Alle Segmente der Transkription in die DB einfügen
     for (const MetaText &segment : script->getMetaTexts ())
     {
@@ -366,13 +424,18 @@ bool DatabaseManager::saveNewTranscription (
 
         // Aussage (Segment) einfügen
         QSqlQuery insertStmt (db);
-        insertStmt.prepare (R"(
-            INSERT INTO aussagen (besprechungen_id, zeit_start, zeit_ende, roher_text, sprecher_id, tags)
-            VALUES (:mid, TO_TIMESTAMP(:start), TO_TIMESTAMP(:end), :text, :sid, :tags)
-        )");
-
-        qint64 startSeconds = segment.Start.toLongLong ();
-        qint64 endSeconds = segment.End.toLongLong ();
+        // Die Segment-ID kommt in eine eigene Spalte, die ID der Aussage vergibt die Datenbank
+        insertStmt.prepare (QString (R"(
+            INSERT INTO aussagen
+                (besprechungen_id, zeit_start, zeit_ende, roher_text, sprecher_id, tags%1)
+            VALUES (:mid, TO_TIMESTAMP(:start), TO_TIMESTAMP(:end), :text, :sid, :tags%2)
+        )")
+                                .arg (m_hasSegmentIds ? ", segment_id" : "",
+                                      m_hasSegmentIds ? ", :segment_id" : ""));
+
+        // TO_TIMESTAMP erwartet Sekunden; die Nachkommastellen behalten die Millisekunden
+        double startSeconds = segment.StartMs / 1000.0;
+        double endSeconds = segment.EndMs / 1000.0;
 
         insertStmt.bindValue (":mid", newMeetingId);
         insertStmt.bindValue (":start", startSeconds);
@@ -380,6 +443,10 @@ bool DatabaseManager::saveNewTranscription (
         insertStmt.bindValue (":text", segment.Text);
         insertStmt.bindValue (":sid", speakerId);
         insertStmt.bindValue (":tags", pgArray);
+        if (m_hasSegmentIds)
+        {
+            insertStmt.bindValue (":segment_id", qint64 (segment.Id));
+        }
 
         if (!insertStmt.exec ())
         {
@@ -389,6 +456,8 @@ bool DatabaseManager::saveNewTranscription (
     }
     // Titel der Transkription setzen
     script->setName (newTitle);
+    // Neues Meeting in den Korpus der Tag-Vorschläge aufnehmen
+    KeywordExtractor::shared ().addTranscription (script);
     return true;
 }
 
@@ -455,15 +524,17 @@ bool DatabaseManager::updateTranscription (
         }
     }
     // Schritt 5: UPSERT-Abfrage vorbereiten für Einfügen/Aktualisieren von Aussagen
+    // (die Segment-ID wird auch bei bestehenden Aussagen geschrieben, damit sie danach
+    // mit dem Transkript übereinstimmt)
     QSqlQuery upsertQuery (db);
-    upsertQuery.prepare (R"(
+    upsertQuery.prepare (QString (R"(
     INSERT INTO aussagen (
         besprechungen_id,
         zeit_start,
         zeit_ende,
         verarbeiteter_text,
         sprecher_id,
-        tags
+        tags%1
     )
     VALUES (
         :besprechungen_id,
@@ -471,14 +542,18 @@ bool DatabaseManager::updateTranscription (
         :zeit_ende,
         :text,
         :sprecher_id,
-        :tags
+        :tags%2
     )
     ON CONFLICT (besprechungen_id, zeit_start, zeit_ende)
     DO UPDATE SET
         verarbeiteter_text = EXCLUDED.verarbeiteter_text,
         sprecher_id = EXCLUDED.sprecher_id,
-        tags = EXCLUDED.tags
-        )");
+        tags = EXCLUDED.tags%3
+        )")
+                             .arg (m_hasSegmentIds ? ",\n        segment_id" : "",
+                                   m_hasSegmentIds ? ",\n        :segment_id" : "",
+                                   m_hasSegmentIds ? ",\n        segment_id = EXCLUDED.segment_id"
+                                                   : ""));
 
     // Alle Segmente der Transkription durchgehen und einzeln in die Datenbank schreiben
     for (const MetaText &segment : m_script->getMetaTexts ())
@@ -533,8 +608,8 @@ bool DatabaseManager::updateTranscription (
         }
 
         // Schritt 7: Zeitinformationen des Segments in QDateTime umwandeln
-        QDateTime start = QDateTime::fromSecsSinceEpoch (segment.Start.toLongLong ());
-        QDateTime end = QDateTime::fromSecsSinceEpoch (segment.End.toLongLong ());
+        QDateTime start = QDateTime::fromMSecsSinceEpoch (segment.StartMs);
+        QDateTime end = QDateTime::fromMSecsSinceEpoch (segment.EndMs);
 
         // Schritt 8: Tags (QStringList) in PostgreSQL-kompatibles text[] Literal konvertieren
         QStringList escapedTags;
@@ -553,6 +628,10 @@ bool DatabaseManager::updateTranscription (
         upsertQuery.bindValue (":text", segment.Text);
         upsertQuery.bindValue (":sprecher_id", speakerId != -1 ? speakerId : QVariant ());
         upsertQuery.bindValue (":tags", pgArray);
+        if (m_hasSegmentIds)
+        {
+            upsertQuery.bindValue (":segment_id", qint64 (segment.Id));
+        }
 
         // Schritt 10: Abfrage ausführen
         if (!upsertQuery.exec ())
@@ -561,6 +640,8 @@ bool DatabaseManager::updateTranscription (
             return false;
         }
     }
+    // Geänderten Text im Korpus der Tag-Vorschläge ersetzen
+    KeywordExtractor::shared ().addTranscription (m_script);
     // Wenn alle Aussagen erfolgreich aktualisiert/eingefügt wurden → Erfolg zurückgeben
     return true;
 }
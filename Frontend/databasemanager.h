@@ -119,8 +119,23 @@ public:
     int getSpeakerId(const QString &speakerName, int meetingId, QSqlDatabase &db);
 
 
+signals:
+    /**
+     * @brief Meldet einen Hinweis für den Benutzer (z.B. fehlender bearbeiteter Text).
+     * @note Der DatabaseManager zeigt selbst nichts an, damit er auch ohne Oberfläche läuft.
+     * @param message Der Hinweistext.
+     */
+    void notice(const QString &message);
+
 private:
+    /**
+     * @brief Ergänzt die Tabelle aussagen bei Bedarf um die Spalte segment_id (stabile Segment-ID).
+     * @return true, wenn die Spalte vorhanden ist.
+     */
+    bool ensureSegmentIdColumn(QSqlDatabase &db);
+
     bool m_connected = false; // Flag, um anzuzeigen, ob die Datenbankverbindung funktioniert
+    bool m_hasSegmentIds = false; // Flag, ob aussagen.segment_id existiert (sonst ohne Segment-IDs)
 };
 
 #endif // DATABASEMANAGER_H
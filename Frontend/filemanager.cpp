@@ -1,10 +1,57 @@
 #include "filemanager.h"
+#include "flacencoder.h"
+#include "flacfilereader.h"
+#include "wavfilereader.h"
 
+#include <QDataStream>
+#include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QJsonParseError>
+#include <QRegularExpression>
 #include <QSettings>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+constexpr int ExportFrames = 16384; //  Frames je Lese-/Schreibschritt beim Umwandeln.
+
+//  WAV-Header für Integer-PCM mit JUNK-Platzhalter, der ab 4 GB zum ds64-Chunk (RF64) wird.
+QByteArray pcmWavHeader (
+    qint64 dataBytes, int sampleRate, int channels, int bitsPerSample)
+{
+    QByteArray header;
+    QDataStream out (&header, QIODevice::WriteOnly);
+    out.setByteOrder (QDataStream::LittleEndian);
+
+    const int frameBytes = channels * (bitsPerSample / 8);
+    const quint64 riffSize = quint64 (72 + dataBytes);
+    const bool rf64 = riffSize > 0xFFFFFFFFull;
+
+    out.writeRawData (rf64 ? "RF64" : "RIFF", 4);
+    out << quint32 (rf64 ? 0xFFFFFFFFu : riffSize);
+    out.writeRawData ("WAVE", 4);
+    out.writeRawData (rf64 ? "ds64" : "JUNK", 4);
+    out << quint32 (28);
+    out << quint64 (rf64 ? riffSize : 0);
+    out << quint64 (rf64 ? dataBytes : 0);
+    out << quint64 (rf64 ? dataBytes / frameBytes : 0);
+    out << quint32 (0);
+    out.writeRawData ("fmt ", 4);
+    out << quint32 (16);
+    out << quint16 (1); //  Integer-PCM.
+    out << quint16 (channels);
+    out << quint32 (sampleRate);
+    out << quint32 (sampleRate * frameBytes);
+    out << quint16 (frameBytes);
+    out << quint16 (bitsPerSample);
+    out.writeRawData ("data", 4);
+    out << quint32 (rf64 ? 0xFFFFFFFFu : quint32 (dataBytes));
+    return header;
+}
+} // namespace
 
 FileManager::FileManager (
     QObject *parent)
@@ -33,6 +80,104 @@ QString FileManager::getTempWavPath (
     return ergWav;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+QString FileManager::sessionsDirectory () const
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const QString stdPath = QDir::temp ().filePath ("meeting_sessions");
+    return settings.value ("audio/sessionPath", stdPath).toString ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString FileManager::createSessionDirectory (
+    const QString &sessionId) const
+{
+    QDir root (sessionsDirectory ());
+    if (!root.mkpath (sessionId))
+    {
+        qWarning () << "FileManager: Sitzungsverzeichnis kann nicht angelegt werden:"
+                    << root.filePath (sessionId);
+        return QString ();
+    }
+    return root.filePath (sessionId);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString FileManager::jobQueuePath () const
+{
+    QDir root (sessionsDirectory ());
+    root.mkpath (".");
+    return root.filePath ("jobs.json");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString FileManager::sessionWavPath (
+    const QString &sessionDirectory, bool forAsr) const
+{
+    return QDir (sessionDirectory).filePath (QFileInfo (getTempWavPath (forAsr)).fileName ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QStringList FileManager::cleanupSessions (
+    int keep, const QStringList &protectedDirectories) const
+{
+    QStringList removed;
+    if (keep <= 0)
+    {
+        return removed;
+    }
+
+    //  Die Verzeichnisnamen sind Zeitstempel; absteigend sortiert stehen die neuesten vorne.
+    //  Alles, was nicht wie eine Sitzungskennung heißt, wird nie angefasst, falls
+    //  "audio/sessionPath" auf einen Ordner mit anderen Daten zeigt.
+    static const QRegularExpression sessionName (
+        R"(^\d{4}-\d{2}-\d{2}_\d{2}-\d{2}-\d{2}(-\d{3})?(_\d+)?$)");
+    QDir root (sessionsDirectory ());
+    const QStringList entries = root.entryList (QDir::Dirs | QDir::NoDotAndDotDot,
+                                                QDir::Name | QDir::Reversed)
+                                    .filter (sessionName);
+    //  Geschützt ist ein Verzeichnis, wenn einer der Pfade es selbst ist oder darin liegt.
+    QStringList protectedPaths;
+    for (const QString &path : protectedDirectories)
+    {
+        if (!path.isEmpty ())
+        {
+            protectedPaths << QDir::cleanPath (QFileInfo (path).absoluteFilePath ());
+        }
+    }
+    const auto isProtected = [&protectedPaths] (const QString &directory)
+    {
+        const QString clean = QDir::cleanPath (QFileInfo (directory).absoluteFilePath ());
+        return std::any_of (protectedPaths.cbegin (),
+                            protectedPaths.cend (),
+                            [&clean] (const QString &path)
+                            { return path == clean || path.startsWith (clean + '/'); });
+    };
+
+    for (int i = keep; i < entries.size (); ++i)
+    {
+        const QString path = root.filePath (entries[i]);
+        if (isProtected (path))
+        {
+            continue;
+        }
+        if (QDir (path).removeRecursively ())
+        {
+            removed.append (path);
+        }
+        else
+        {
+            qWarning () << "FileManager: Sitzungsverzeichnis kann nicht gelöscht werden:" << path;
+        }
+    }
+    return removed;
+}
+
 //--------------------------------------------------------------------------------------------------
 /*
 QString FileManager::getMeetingsDirectory () const
@@ -133,5 +278,105 @@ bool FileManager::saveJson (
     return true;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+bool FileManager::exportAudio (
+    const QString &source, const QString &target) const
+{
+    const bool sourceFlac = source.endsWith (".flac", Qt::CaseInsensitive);
+    const bool targetFlac = target.endsWith (".flac", Qt::CaseInsensitive);
+    QFile::remove (target);
+
+    //  Gleiches Format: Die Datei wird unverändert kopiert.
+    if (sourceFlac == targetFlac)
+    {
+        return QFile::copy (source, target);
+    }
+
+    if (targetFlac)
+    {
+        //  WAV -> FLAC mit der eingestellten Kompressionsstufe.
+        WavFileReader reader;
+        if (!reader.open (source))
+        {
+            qWarning () << "FileManager: WAV-Datei kann nicht gelesen werden:" << reader.errorString ();
+            return false;
+        }
+        const int level = QSettings ("SS2025FP_T2", "AudioTranskriptor").value ("audio/flacLevel", 5).toInt ();
+        FlacEncoder encoder;
+        if (!encoder.open (target, reader.sampleRate (), reader.channels (), 24, level))
+        {
+            return false;
+        }
+        std::vector<float> buffer (size_t (ExportFrames) * size_t (reader.channels ()));
+        int frames = 0;
+        while ((frames = reader.readFrames (buffer.data (), ExportFrames)) > 0)
+        {
+            encoder.encode (buffer.data (), frames);
+        }
+        return encoder.finish ();
+    }
+
+    //  FLAC -> WAV: Die Samples werden verlustfrei als Integer-PCM in ihrer Bittiefe geschrieben.
+    FlacFileReader reader;
+    if (!reader.open (source))
+    {
+        qWarning () << "FileManager: FLAC-Datei kann nicht gelesen werden:" << reader.errorString ();
+        return false;
+    }
+    if (reader.bitsPerSample () != 16 && reader.bitsPerSample () != 24)
+    {
+        qWarning () << "FileManager: Nicht unterstützte Bittiefe:" << reader.bitsPerSample ();
+        return false;
+    }
+
+    QFile out (target);
+    if (!out.open (QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning () << "FileManager: Konnte Datei zum Schreiben nicht öffnen:" << target
+                    << out.errorString ();
+        return false;
+    }
+
+    const int channels = reader.channels ();
+    const int sampleBytes = reader.bitsPerSample () / 8;
+    out.write (pcmWavHeader (0, reader.sampleRate (), channels, reader.bitsPerSample ()));
+
+    std::vector<int32_t> samples (size_t (ExportFrames) * size_t (channels));
+    QByteArray bytes;
+    qint64 dataBytes = 0;
+    int frames = 0;
+    while ((frames = reader.readFrames (samples.data (), ExportFrames)) > 0)
+    {
+        const qint64 count = qint64 (frames) * channels;
+        bytes.resize (qsizetype (count * sampleBytes));
+        char *dst = bytes.data ();
+        for (qint64 i = 0; i < count; ++i)
+        {
+            const uint32_t v = uint32_t (samples[size_t (i)]);
+            for (int b = 0; b < sampleBytes; ++b)
+            {
+                *dst++ = char (v >> (8 * b));
+            }
+        }
+        if (out.write (bytes) != bytes.size ())
+        {
+            qWarning () << "FileManager: Schreibfehler:" << out.errorString ();
+            return false;
+        }
+        dataBytes += bytes.size ();
+    }
+
+    if (!reader.errorString ().isEmpty ())
+    {
+        qWarning () << "FileManager: FLAC-Datei fehlerhaft:" << reader.errorString ();
+        return false;
+    }
+
+    out.seek (0);
+    out.write (pcmWavHeader (dataBytes, reader.sampleRate (), channels, reader.bitsPerSample ()));
+    return out.error () == QFile::NoError;
+}
+
 //--------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------
@@ -36,6 +36,51 @@ public:
      */
     QString getTempWavPath (bool forAsr = false) const;
 
+    /**
+     * @brief Gibt das Verzeichnis zurück, unter dem die Aufnahme-Sitzungen liegen.
+     * @note Einstellbar über "audio/sessionPath"; Standard ist ein Unterordner im Temp-Verzeichnis.
+     * @return Der vollständige Verzeichnispfad.
+     */
+    QString sessionsDirectory () const;
+
+    /**
+     * @brief Legt das Verzeichnis einer neuen Aufnahme-Sitzung an.
+     * @param sessionId Die Kennung der Sitzung (wird zum Verzeichnisnamen).
+     * @return Der vollständige Verzeichnispfad, bei einem Fehler ein leerer String.
+     */
+    QString createSessionDirectory (const QString &sessionId) const;
+
+    /**
+     * @brief Gibt den Pfad der Datei zurück, in der der JobScheduler seine Warteschlange speichert.
+     * @note Die Datei liegt im Sitzungsverzeichnis, das bei Bedarf angelegt wird.
+     * @return Der vollständige Dateipfad.
+     */
+    QString jobQueuePath () const;
+
+    /**
+     * @brief Gibt den Pfad einer Aufnahmedatei innerhalb eines Sitzungsverzeichnisses zurück.
+     *
+     * Die Dateinamen entsprechen denen aus getTempWavPath(), sodass Einstellungen wie
+     * "wavPath" weiterhin den Namen der Dateien bestimmen.
+     * @param sessionDirectory Das Verzeichnis der Sitzung.
+     * @param forAsr Wenn true, wird der Pfad für die heruntergesampelte ASR-Version zurückgegeben.
+     * @return Der vollständige Dateipfad.
+     */
+    QString sessionWavPath (const QString &sessionDirectory, bool forAsr = false) const;
+
+    /**
+     * @brief Löscht die Verzeichnisse alter Sitzungen.
+     *
+     * Die Sitzungen werden nach ihrer Kennung (Zeitstempel) sortiert; die neuesten
+     * @p keep bleiben erhalten, ebenso alle Verzeichnisse aus @p protectedDirectories.
+     * Berücksichtigt werden nur Verzeichnisse, deren Name eine Sitzungskennung ist
+     * ("yyyy-MM-dd_HH-mm-ss", optional mit Millisekunden und Zähler).
+     * @param keep Anzahl der zu behaltenden Sitzungen (0 = alle behalten).
+     * @param protectedDirectories Verzeichnisse (oder Dateien darin), die noch benutzt werden.
+     * @return Die gelöschten Verzeichnisse.
+     */
+    QStringList cleanupSessions (int keep, const QStringList &protectedDirectories) const;
+
     /*
      * @brief Gibt den Pfad zum Verzeichnis zurück, in dem alle Meeting-Transkripte gespeichert werden.
      * @note Stellt bei der ersten Ausführung sicher, dass das Verzeichnis existiert.
@@ -83,6 +128,19 @@ public:
      * @return true bei Erfolg, andernfalls false.
      */
     bool saveJson (const QString &filePath, const QJsonDocument &doc) const;
+
+    /**
+     * @brief Speichert eine Aufnahme unter einem neuen Pfad, ggf. in einem anderen Format.
+     *
+     * Stimmen die Endungen (.wav bzw. .flac) überein, wird die Datei kopiert. Andernfalls
+     * wird eine WAV-Datei als FLAC (24 bit) kodiert bzw. eine FLAC-Datei als PCM-WAV in
+     * ihrer ursprünglichen Bittiefe dekodiert. Die Methode ist für den Aufruf aus einem
+     * Hintergrund-Thread gedacht (QtConcurrent).
+     * @param source Die vorhandene Aufnahme (.wav oder .flac).
+     * @param target Der Zielpfad; die Endung bestimmt das Format.
+     * @return true bei Erfolg, andernfalls false.
+     */
+    bool exportAudio (const QString &source, const QString &target) const;
 };
 
 #endif // FILEMANAGER_H
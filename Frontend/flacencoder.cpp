@@ -0,0 +1,728 @@
+#include "flacencoder.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+//  Prüfsummen des FLAC-Frames: CRC-8 (Polynom 0x07) über den Frame-Header,
+//  CRC-16 (Polynom 0x8005) über den gesamten Frame.
+struct CrcTables
+{
+    uint8_t crc8[256];
+    uint16_t crc16[256];
+
+    CrcTables ()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            uint8_t c8 = uint8_t (i);
+            uint16_t c16 = uint16_t (i << 8);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                c8 = uint8_t ((c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1);
+                c16 = uint16_t ((c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1);
+            }
+            crc8[i] = c8;
+            crc16[i] = c16;
+        }
+    }
+};
+
+const CrcTables &crcTables ()
+{
+    static const CrcTables tables;
+    return tables;
+}
+
+uint8_t crc8 (
+    const uint8_t *data, size_t size)
+{
+    const CrcTables &t = crcTables ();
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = t.crc8[crc ^ data[i]];
+    }
+    return crc;
+}
+
+uint16_t crc16 (
+    const uint8_t *data, size_t size)
+{
+    const CrcTables &t = crcTables ();
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = uint16_t ((crc << 8) ^ t.crc16[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+//  Abbildung vorzeichenbehafteter Restwerte auf nicht-negative Zahlen (0, -1, 1, -2, ...).
+inline uint32_t zigzag (
+    int32_t r)
+{
+    return (uint32_t (r) << 1) ^ uint32_t (r >> 31);
+}
+
+//  Optimaler Rice-Parameter für eine Partition mit @p count Werten und der Summe @p sum.
+inline int riceParameter (
+    uint64_t sum, int count)
+{
+    int k = 0;
+    while (k < 30 && (uint64_t (count) << (k + 1)) <= sum)
+    {
+        ++k;
+    }
+    return k;
+}
+
+//  Geschätzte Bits einer Partition mit Parameter k (Unär-Teil + Stoppbit + k Bits je Wert).
+inline qint64 riceBits (
+    uint64_t sum, int count, int k)
+{
+    return qint64 (count) * (k + 1) + qint64 (sum >> k);
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacEncoder::BitWriter::clear ()
+{
+    m_bytes.clear ();
+    m_accu = 0;
+    m_bits = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacEncoder::BitWriter::write (
+    uint32_t value, int bits)
+{
+    if (bits <= 0)
+    {
+        return;
+    }
+    m_accu = (m_accu << bits) | (value & mask (bits));
+    m_bits += bits;
+    while (m_bits >= 8)
+    {
+        m_bits -= 8;
+        m_bytes.push_back (uint8_t (m_accu >> m_bits));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacEncoder::BitWriter::writeUnary (
+    uint32_t zeros)
+{
+    while (zeros >= 32)
+    {
+        write (0, 32);
+        zeros -= 32;
+    }
+    write (1, int (zeros) + 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacEncoder::BitWriter::alignToByte ()
+{
+    if (m_bits > 0)
+    {
+        write (0, 8 - m_bits);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+FlacEncoder::~FlacEncoder ()
+{
+    if (isOpen ())
+    {
+        finish ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacEncoder::open (
+    const QString &path, int sampleRate, int channels, int bitsPerSample, int level)
+{
+    if (isOpen ())
+    {
+        finish ();
+    }
+
+    if (channels < 1 || channels > 8 || (bitsPerSample != 16 && bitsPerSample != 24))
+    {
+        qWarning () << "FlacEncoder: Nicht unterstütztes Format:" << channels << "Kanäle,"
+                    << bitsPerSample << "bit";
+        return false;
+    }
+
+    m_file.setFileName (path);
+    if (!m_file.open (QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning () << "FlacEncoder: Datei kann nicht geöffnet werden:" << path
+                    << m_file.errorString ();
+        return false;
+    }
+
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+    m_bps = bitsPerSample;
+
+    //  Die Stufen lehnen sich an die von libFLAC an: Die unteren Stufen verwenden kurze
+    //  Blöcke und wählen den Prädiktor per Heuristik, die oberen bewerten jeden Prädiktor
+    //  exakt und teilen das Restsignal feiner auf.
+    static const int partitionOrders[9] = {2, 2, 3, 3, 4, 5, 6, 6, 8};
+    level = qBound (0, level, 8);
+    m_blockSize = level <= 2 ? 1152 : 4096;
+    m_maxPartitionOrder = partitionOrders[level];
+    m_exhaustive = level >= 3;
+    m_stereoSearch = level >= 1;
+
+    m_block.assign (size_t (m_channels), std::vector<int32_t> (size_t (m_blockSize)));
+    m_mid.assign (size_t (m_blockSize), 0);
+    m_side.assign (size_t (m_blockSize), 0);
+    m_residual.assign (size_t (m_blockSize), 0);
+    m_partitionSums.assign (size_t (1) << m_maxPartitionOrder, 0);
+    m_md5Bytes.assign (size_t (m_blockSize) * size_t (m_channels) * size_t (m_bps / 8), 0);
+    m_md5.reset ();
+    m_blockFill = 0;
+    m_totalFrames = 0;
+    m_frameNumber = 0;
+    m_minFrameBytes = 0;
+    m_maxFrameBytes = 0;
+    m_failed = false;
+
+    //  "fLaC" + Kopf des (einzigen und damit letzten) Metadatenblocks STREAMINFO.
+    QByteArray header ("fLaC");
+    header.append (char (0x80));
+    header.append (char (0));
+    header.append (char (0));
+    header.append (char (34));
+    header.append (streamInfo ());
+    m_bytesWritten = m_file.write (header);
+    if (m_bytesWritten != header.size ())
+    {
+        m_failed = true;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacEncoder::encode (
+    const float *samples, qint64 frames)
+{
+    if (!isOpen ())
+    {
+        return false;
+    }
+
+    const float scale = float ((1 << (m_bps - 1)) - 1);
+    for (qint64 f = 0; f < frames; ++f)
+    {
+        for (int ch = 0; ch < m_channels; ++ch)
+        {
+            const float v = qBound (-1.0f, *samples++, 1.0f);
+            m_block[size_t (ch)][size_t (m_blockFill)] = int32_t (std::lrint (v * scale));
+        }
+        if (++m_blockFill == m_blockSize)
+        {
+            encodeBlock (m_blockSize);
+            m_blockFill = 0;
+        }
+    }
+    m_totalFrames += frames;
+    return !m_failed;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacEncoder::finish ()
+{
+    if (!isOpen ())
+    {
+        return false;
+    }
+
+    if (m_blockFill > 0)
+    {
+        encodeBlock (m_blockFill);
+        m_blockFill = 0;
+    }
+
+    //  Jetzt stehen Länge, Frame-Größen und MD5-Summe fest.
+    if (!m_file.seek (8) || m_file.write (streamInfo ()) != 34)
+    {
+        m_failed = true;
+    }
+    m_file.close ();
+    return !m_failed;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacEncoder::encodeBlock (
+    int blockSize)
+{
+    //  MD5 über die Samples als vorzeichenbehaftete Little-Endian-Werte, Kanäle interleavt.
+    const int sampleBytes = m_bps / 8;
+    uint8_t *md5 = m_md5Bytes.data ();
+    for (int i = 0; i < blockSize; ++i)
+    {
+        for (int ch = 0; ch < m_channels; ++ch)
+        {
+            const uint32_t v = uint32_t (m_block[size_t (ch)][size_t (i)]);
+            for (int b = 0; b < sampleBytes; ++b)
+            {
+                *md5++ = uint8_t (v >> (8 * b));
+            }
+        }
+    }
+    m_md5.addData (QByteArrayView (reinterpret_cast<const char *> (m_md5Bytes.data ()),
+                                   qsizetype (md5 - m_md5Bytes.data ())));
+
+    //  --- Kanal-Dekorrelation und Prädiktorwahl ---
+    //  Kanal-Zuordnung: 0..7 = unabhängig (Anzahl - 1), 8 = links/Seite,
+    //  9 = Seite/rechts, 10 = Mitte/Seite.
+    int assignment = m_channels - 1;
+    const int32_t *signals[8] = {};
+    int bps[8] = {};
+    SubframePlan plans[8];
+    for (int ch = 0; ch < m_channels; ++ch)
+    {
+        signals[ch] = m_block[size_t (ch)].data ();
+        bps[ch] = m_bps;
+    }
+
+    if (m_channels == 2 && m_stereoSearch)
+    {
+        const int32_t *left = signals[0];
+        const int32_t *right = signals[1];
+        for (int i = 0; i < blockSize; ++i)
+        {
+            m_mid[size_t (i)] = (left[i] + right[i]) >> 1;
+            m_side[size_t (i)] = left[i] - right[i];
+        }
+
+        const SubframePlan l = planSubframe (left, blockSize, m_bps);
+        const SubframePlan r = planSubframe (right, blockSize, m_bps);
+        const SubframePlan m = planSubframe (m_mid.data (), blockSize, m_bps);
+        const SubframePlan s = planSubframe (m_side.data (), blockSize, m_bps + 1);
+
+        const qint64 costs[4] = {l.bits + r.bits, l.bits + s.bits, s.bits + r.bits, m.bits + s.bits};
+        const int best = int (std::min_element (costs, costs + 4) - costs);
+        switch (best)
+        {
+        case 0:
+            plans[0] = l;
+            plans[1] = r;
+            break;
+        case 1:
+            assignment = 8;
+            signals[1] = m_side.data ();
+            bps[1] = m_bps + 1;
+            plans[0] = l;
+            plans[1] = s;
+            break;
+        case 2:
+            assignment = 9;
+            signals[0] = m_side.data ();
+            bps[0] = m_bps + 1;
+            plans[0] = s;
+            plans[1] = r;
+            break;
+        default:
+            assignment = 10;
+            signals[0] = m_mid.data ();
+            signals[1] = m_side.data ();
+            bps[1] = m_bps + 1;
+            plans[0] = m;
+            plans[1] = s;
+            break;
+        }
+    }
+    else
+    {
+        for (int ch = 0; ch < m_channels; ++ch)
+        {
+            plans[ch] = planSubframe (signals[ch], blockSize, m_bps);
+        }
+    }
+
+    //  --- Frame-Header ---
+    m_writer.clear ();
+    m_writer.write (0x3FFE, 14); //  Sync-Code.
+    m_writer.write (0, 1);       //  Reserviert.
+    m_writer.write (0, 1);       //  Feste Blockgröße.
+
+    int blockCode = 7; //  Blockgröße folgt als 16-bit-Wert am Ende des Headers.
+    static const int commonSizes[] = {192, 576, 1152, 2304, 4608, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768};
+    static const int commonCodes[] = {1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, 14, 15};
+    for (int i = 0; i < int (std::size (commonSizes)); ++i)
+    {
+        if (commonSizes[i] == blockSize)
+        {
+            blockCode = commonCodes[i];
+        }
+    }
+    if (blockCode == 7 && blockSize <= 256)
+    {
+        blockCode = 6;
+    }
+    m_writer.write (uint32_t (blockCode), 4);
+
+    int rateCode = 0; //  Abtastrate aus STREAMINFO.
+    static const int commonRates[] = {88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000};
+    for (int i = 0; i < int (std::size (commonRates)); ++i)
+    {
+        if (commonRates[i] == m_sampleRate)
+        {
+            rateCode = i + 1;
+        }
+    }
+    m_writer.write (uint32_t (rateCode), 4);
+    m_writer.write (uint32_t (assignment), 4);
+    m_writer.write (m_bps == 16 ? 4u : 6u, 3);
+    m_writer.write (0, 1);
+
+    //  Frame-Nummer im erweiterten UTF-8-Format.
+    const uint32_t n = m_frameNumber;
+    if (n < 0x80)
+    {
+        m_writer.write (n, 8);
+    }
+    else
+    {
+        int extra = n < 0x800 ? 1 : n < 0x10000 ? 2 : n < 0x200000 ? 3 : n < 0x4000000 ? 4 : 5;
+        const uint32_t lead = (0xFF00u >> (extra + 1)) & 0xFFu;
+        m_writer.write (lead | (n >> (6 * extra)), 8);
+        while (extra-- > 0)
+        {
+            m_writer.write (0x80 | ((n >> (6 * extra)) & 0x3F), 8);
+        }
+    }
+    if (blockCode == 6)
+    {
+        m_writer.write (uint32_t (blockSize - 1), 8);
+    }
+    else if (blockCode == 7)
+    {
+        m_writer.write (uint32_t (blockSize - 1), 16);
+    }
+    m_writer.write (crc8 (m_writer.bytes ().data (), m_writer.bytes ().size ()), 8);
+
+    //  --- Subframes und Frame-Ende ---
+    for (int ch = 0; ch < m_channels; ++ch)
+    {
+        writeSubframe (signals[ch], blockSize, bps[ch], plans[ch]);
+    }
+    m_writer.alignToByte ();
+    m_writer.write (crc16 (m_writer.bytes ().data (), m_writer.bytes ().size ()), 16);
+
+    const std::vector<uint8_t> &frame = m_writer.bytes ();
+    const qint64 written = m_file.write (reinterpret_cast<const char *> (frame.data ()),
+                                         qint64 (frame.size ()));
+    if (written != qint64 (frame.size ()))
+    {
+        m_failed = true;
+        return false;
+    }
+
+    const quint32 frameBytes = quint32 (frame.size ());
+    m_minFrameBytes = m_frameNumber == 0 ? frameBytes : qMin (m_minFrameBytes, frameBytes);
+    m_maxFrameBytes = qMax (m_maxFrameBytes, frameBytes);
+    m_bytesWritten += written;
+    ++m_frameNumber;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+FlacEncoder::SubframePlan FlacEncoder::planSubframe (
+    const int32_t *signal, int blockSize, int bps)
+{
+    SubframePlan plan;
+
+    //  Stille (bzw. ein konstanter Wert) wird als einzelner Wert gespeichert.
+    if (std::all_of (signal + 1, signal + blockSize, [signal] (int32_t v) { return v == signal[0]; }))
+    {
+        plan.type = 0;
+        plan.bits = 8 + bps;
+        return plan;
+    }
+
+    plan.type = 1;
+    plan.bits = 8 + qint64 (blockSize) * bps;
+
+    const int maxOrder = qMin (MaxFixedOrder, blockSize - 1);
+    int firstOrder = 0;
+    int lastOrder = maxOrder;
+    //  Die Heuristik rechnet immer alle Ordnungen bis MaxFixedOrder und liest dafür vier Werte
+    //  zurück; sehr kurze (letzte) Blöcke werden daher vollständig durchprobiert.
+    if (!m_exhaustive && maxOrder == MaxFixedOrder)
+    {
+        //  Heuristik: Die Ordnung mit der kleinsten Betragssumme des Restsignals gewinnt.
+        uint64_t sums[MaxFixedOrder + 1] = {};
+        for (int i = maxOrder; i < blockSize; ++i)
+        {
+            const int64_t e0 = signal[i];
+            const int64_t e1 = e0 - signal[i - 1];
+            const int64_t e2 = e1 - (int64_t (signal[i - 1]) - signal[i - 2]);
+            const int64_t e3 = e2 - (int64_t (signal[i - 1]) - 2 * int64_t (signal[i - 2]) + signal[i - 3]);
+            const int64_t e4 = e3
+                               - (int64_t (signal[i - 1]) - 3 * int64_t (signal[i - 2])
+                                  + 3 * int64_t (signal[i - 3]) - signal[i - 4]);
+            const int64_t e[5] = {e0, e1, e2, e3, e4};
+            for (int o = 0; o <= maxOrder; ++o)
+            {
+                sums[o] += uint64_t (e[o] < 0 ? -e[o] : e[o]);
+            }
+        }
+        firstOrder = int (std::min_element (sums, sums + maxOrder + 1) - sums);
+        lastOrder = firstOrder;
+    }
+
+    for (int order = firstOrder; order <= lastOrder; ++order)
+    {
+        computeResidual (signal, blockSize, order, m_residual.data ());
+        int partitionOrder = 0;
+        const qint64 bits = 8 + qint64 (order) * bps + 6
+                            + planRice (m_residual.data (), blockSize, order, partitionOrder);
+        if (bits < plan.bits)
+        {
+            plan.type = 2;
+            plan.order = order;
+            plan.partitionOrder = partitionOrder;
+            plan.bits = bits;
+        }
+    }
+    return plan;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacEncoder::computeResidual (
+    const int32_t *signal, int blockSize, int order, int32_t *residual)
+{
+    //  Die festen Prädiktoren sind die Differenzen 0. bis 4. Ordnung.
+    const int32_t *x = signal;
+    switch (order)
+    {
+    case 0:
+        std::copy (x, x + blockSize, residual);
+        break;
+    case 1:
+        for (int i = 1; i < blockSize; ++i)
+        {
+            residual[i] = int32_t (int64_t (x[i]) - x[i - 1]);
+        }
+        break;
+    case 2:
+        for (int i = 2; i < blockSize; ++i)
+        {
+            residual[i] = int32_t (int64_t (x[i]) - 2 * int64_t (x[i - 1]) + x[i - 2]);
+        }
+        break;
+    case 3:
+        for (int i = 3; i < blockSize; ++i)
+        {
+            residual[i] = int32_t (int64_t (x[i]) - 3 * int64_t (x[i - 1]) + 3 * int64_t (x[i - 2])
+                                   - x[i - 3]);
+        }
+        break;
+    default:
+        for (int i = 4; i < blockSize; ++i)
+        {
+            residual[i] = int32_t (int64_t (x[i]) - 4 * int64_t (x[i - 1]) + 6 * int64_t (x[i - 2])
+                                   - 4 * int64_t (x[i - 3]) + x[i - 4]);
+        }
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+qint64 FlacEncoder::planRice (
+    const int32_t *residual, int blockSize, int order, int &partitionOrder)
+{
+    //  Die Partitionen müssen die Blockgröße ohne Rest teilen und mehr Werte enthalten,
+    //  als der Prädiktor zum Anlaufen benötigt.
+    int maxOrder = m_maxPartitionOrder;
+    while (maxOrder > 0 && ((blockSize & ((1 << maxOrder) - 1)) != 0 || (blockSize >> maxOrder) <= order))
+    {
+        --maxOrder;
+    }
+
+    //  Die Summen werden einmal für die feinste Aufteilung gebildet und für die gröberen
+    //  Aufteilungen paarweise zusammengefasst.
+    int partitions = 1 << maxOrder;
+    const int partitionSize = blockSize >> maxOrder;
+    for (int p = 0; p < partitions; ++p)
+    {
+        const int start = p == 0 ? order : p * partitionSize;
+        const int end = (p + 1) * partitionSize;
+        uint64_t sum = 0;
+        for (int i = start; i < end; ++i)
+        {
+            sum += zigzag (residual[i]);
+        }
+        m_partitionSums[size_t (p)] = sum;
+    }
+
+    qint64 bestBits = std::numeric_limits<qint64>::max ();
+    for (int po = maxOrder; po >= 0; --po)
+    {
+        partitions = 1 << po;
+        const int size = blockSize >> po;
+        qint64 bits = 0;
+        int maxParam = 0;
+        for (int p = 0; p < partitions; ++p)
+        {
+            const int count = p == 0 ? size - order : size;
+            const uint64_t sum = m_partitionSums[size_t (p)];
+            const int k = riceParameter (sum, count);
+            maxParam = qMax (maxParam, k);
+            bits += riceBits (sum, count, k);
+        }
+        //  Parameter über 14 erfordern die Variante mit 5-bit-Parametern.
+        bits += qint64 (partitions) * (maxParam > 14 ? 5 : 4);
+        if (bits < bestBits)
+        {
+            bestBits = bits;
+            partitionOrder = po;
+        }
+
+        for (int p = 0; p < partitions / 2; ++p)
+        {
+            m_partitionSums[size_t (p)] = m_partitionSums[size_t (2 * p)] + m_partitionSums[size_t (2 * p + 1)];
+        }
+    }
+    return bestBits;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacEncoder::writeSubframe (
+    const int32_t *signal, int blockSize, int bps, const SubframePlan &plan)
+{
+    m_writer.write (0, 1); //  Füllbit.
+    if (plan.type == 0)
+    {
+        m_writer.write (0x00, 6);
+        m_writer.write (0, 1); //  Keine "wasted bits".
+        m_writer.writeSigned (signal[0], bps);
+        return;
+    }
+    if (plan.type == 1)
+    {
+        m_writer.write (0x01, 6);
+        m_writer.write (0, 1);
+        for (int i = 0; i < blockSize; ++i)
+        {
+            m_writer.writeSigned (signal[i], bps);
+        }
+        return;
+    }
+
+    m_writer.write (uint32_t (0x08 | plan.order), 6);
+    m_writer.write (0, 1);
+    for (int i = 0; i < plan.order; ++i)
+    {
+        m_writer.writeSigned (signal[i], bps); //  Anlaufwerte.
+    }
+    computeResidual (signal, blockSize, plan.order, m_residual.data ());
+    writeResidual (m_residual.data (), blockSize, plan.order, plan.partitionOrder);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacEncoder::writeResidual (
+    const int32_t *residual, int blockSize, int order, int partitionOrder)
+{
+    const int partitions = 1 << partitionOrder;
+    const int size = blockSize >> partitionOrder;
+
+    int params[256];
+    int maxParam = 0;
+    for (int p = 0; p < partitions; ++p)
+    {
+        const int start = p == 0 ? order : p * size;
+        const int end = (p + 1) * size;
+        uint64_t sum = 0;
+        for (int i = start; i < end; ++i)
+        {
+            sum += zigzag (residual[i]);
+        }
+        params[p] = riceParameter (sum, end - start);
+        maxParam = qMax (maxParam, params[p]);
+    }
+
+    const bool rice2 = maxParam > 14;
+    m_writer.write (rice2 ? 1u : 0u, 2);
+    m_writer.write (uint32_t (partitionOrder), 4);
+    for (int p = 0; p < partitions; ++p)
+    {
+        const int k = params[p];
+        m_writer.write (uint32_t (k), rice2 ? 5 : 4);
+
+        const int start = p == 0 ? order : p * size;
+        const int end = (p + 1) * size;
+        for (int i = start; i < end; ++i)
+        {
+            const uint32_t u = zigzag (residual[i]);
+            const uint32_t q = u >> k;
+            if (q + 1 + uint32_t (k) <= 32)
+            {
+                //  Häufigster Fall: Unär-Teil, Stoppbit und Rest in einem Schreibzugriff.
+                m_writer.write ((1u << k) | (u & ((1u << k) - 1u)), int (q) + 1 + k);
+            }
+            else
+            {
+                m_writer.writeUnary (q);
+                m_writer.write (u, k);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QByteArray FlacEncoder::streamInfo () const
+{
+    BitWriter w;
+    w.write (uint32_t (m_blockSize), 16); //  Kleinste Blockgröße (ohne den letzten Block).
+    w.write (uint32_t (m_blockSize), 16); //  Größte Blockgröße.
+    w.write (m_minFrameBytes, 24);
+    w.write (m_maxFrameBytes, 24);
+    w.write (uint32_t (m_sampleRate), 20);
+    w.write (uint32_t (m_channels - 1), 3);
+    w.write (uint32_t (m_bps - 1), 5);
+    w.write (uint32_t (quint64 (m_totalFrames) >> 32) & 0x0F, 4);
+    w.write (uint32_t (m_totalFrames & 0xFFFFFFFF), 32);
+
+    QByteArray info (reinterpret_cast<const char *> (w.bytes ().data ()), qsizetype (w.bytes ().size ()));
+
+    //  Die MD5-Summe ist erst nach dem letzten Block bekannt; bis dahin steht 0 ("unbekannt").
+    if (isOpen () && m_blockFill == 0 && m_frameNumber > 0)
+    {
+        info.append (m_md5.result ());
+    }
+    else
+    {
+        info.append (QByteArray (16, '\0'));
+    }
+    return info;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,169 @@
+/**
+ * @file flacencoder.h
+ * @brief Enthält die Deklaration des FlacEncoder zum verlustfreien Kodieren von Audio-Daten.
+ * @author Mike Wild
+ */
+#ifndef FLACENCODER_H
+#define FLACENCODER_H
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Kodiert interleavte float-Samples fortlaufend in eine FLAC-Datei.
+ *
+ * Die Samples werden auf die eingestellte Bittiefe (16 oder 24 bit) quantisiert und in
+ * Blöcken fester Größe kodiert. Je Kanal wird der günstigste der festen Prädiktoren
+ * (Ordnung 0 bis 4) gewählt und das Restsignal Rice-kodiert; bei Stereo wird zusätzlich
+ * die günstigste Kanal-Dekorrelation (links/rechts, links/Seite, Seite/rechts, Mitte/Seite)
+ * bestimmt. Die Kompressionsstufe (0 bis 8) steuert, wie gründlich gesucht wird.
+ *
+ * Die Anzahl der Samples und die MD5-Summe im STREAMINFO-Block werden bei finish()
+ * eingetragen. Die Klasse ist nicht threadsicher; für das Kodieren im Hintergrund
+ * siehe FlacFileWriter.
+ */
+class FlacEncoder
+{
+public:
+    /**
+     * @brief Standard-Konstruktor.
+     */
+    FlacEncoder () = default;
+
+    /**
+     * @brief Destruktor. Schließt eine noch offene Datei mit finish().
+     */
+    ~FlacEncoder ();
+
+    FlacEncoder (const FlacEncoder &) = delete;
+    FlacEncoder &operator= (const FlacEncoder &) = delete;
+
+    /**
+     * @brief Legt die Datei an und schreibt den (vorläufigen) STREAMINFO-Block.
+     * @param path Pfad der FLAC-Datei (wird überschrieben).
+     * @param sampleRate Abtastrate in Hz.
+     * @param channels Anzahl der Kanäle (1 bis 8).
+     * @param bitsPerSample Bittiefe der kodierten Samples (16 oder 24).
+     * @param level Kompressionsstufe von 0 (schnell) bis 8 (klein).
+     * @return true, wenn die Datei geöffnet werden konnte.
+     */
+    bool open (const QString &path, int sampleRate, int channels, int bitsPerSample = 24, int level = 5);
+
+    /**
+     * @brief Kodiert interleavte Samples im Bereich [-1.0, 1.0].
+     * @param samples Zeiger auf frames * channels() float-Werte.
+     * @param frames Anzahl der Frames.
+     * @return false, wenn beim Schreiben ein Fehler aufgetreten ist.
+     */
+    bool encode (const float *samples, qint64 frames);
+
+    /**
+     * @brief Kodiert den letzten, ggf. unvollständigen Block, trägt STREAMINFO ein und schließt die Datei.
+     * @return true, wenn die Datei vollständig geschrieben wurde.
+     */
+    bool finish ();
+
+    /** @brief Gibt an, ob gerade eine Datei geöffnet ist. */
+    bool isOpen () const { return m_file.isOpen (); }
+
+    /** @brief Pfad der (zuletzt) geöffneten Datei. */
+    QString fileName () const { return m_file.fileName (); }
+
+    /** @brief Anzahl der bisher übergebenen Frames. */
+    qint64 frames () const { return m_totalFrames; }
+
+    /** @brief Anzahl der bisher geschriebenen Bytes (inkl. Header). */
+    qint64 bytesWritten () const { return m_bytesWritten; }
+
+    /** @brief Anzahl der Kanäle. */
+    int channels () const { return m_channels; }
+
+private:
+    /** @brief Schreibt einzelne Bits in einen Byte-Puffer (MSB zuerst). */
+    class BitWriter
+    {
+    public:
+        /** @brief Leert den Puffer, ohne die Kapazität freizugeben. */
+        void clear ();
+        /** @brief Schreibt die unteren @p bits Bits von @p value (bits <= 32). */
+        void write (uint32_t value, int bits);
+        /** @brief Schreibt einen vorzeichenbehafteten Wert mit @p bits Bits. */
+        void writeSigned (int32_t value, int bits) { write (uint32_t (value) & mask (bits), bits); }
+        /** @brief Schreibt @p zeros Null-Bits gefolgt von einer Eins. */
+        void writeUnary (uint32_t zeros);
+        /** @brief Füllt bis zur nächsten Byte-Grenze mit Nullen auf. */
+        void alignToByte ();
+        /** @brief Die bisher vollständig geschriebenen Bytes. */
+        std::vector<uint8_t> &bytes () { return m_bytes; }
+
+    private:
+        static uint32_t mask (int bits) { return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1u; }
+
+        std::vector<uint8_t> m_bytes; ///< Fertige Bytes.
+        uint64_t m_accu = 0;          ///< Noch nicht ausgegebene Bits.
+        int m_bits = 0;               ///< Anzahl der Bits in m_accu.
+    };
+
+    /** @brief Ergebnis der Suche nach der günstigsten Kodierung eines Kanals. */
+    struct SubframePlan
+    {
+        int type = 0;           ///< 0 = konstant, 1 = verbatim, 2 = fester Prädiktor.
+        int order = 0;          ///< Ordnung des festen Prädiktors.
+        int partitionOrder = 0; ///< Rice-Partitionsordnung.
+        qint64 bits = 0;        ///< Geschätzte Größe in Bits.
+    };
+
+    /** @brief Kodiert den gesammelten Block als einen FLAC-Frame. */
+    bool encodeBlock (int blockSize);
+
+    /** @brief Bestimmt die günstigste Kodierung eines Kanals. */
+    SubframePlan planSubframe (const int32_t *signal, int blockSize, int bps);
+
+    /** @brief Berechnet das Restsignal eines festen Prädiktors. */
+    static void computeResidual (const int32_t *signal, int blockSize, int order, int32_t *residual);
+
+    /** @brief Bestimmt Partitionsordnung und Größe der Rice-Kodierung eines Restsignals. */
+    qint64 planRice (const int32_t *residual, int blockSize, int order, int &partitionOrder);
+
+    /** @brief Schreibt einen Kanal gemäß @p plan. */
+    void writeSubframe (const int32_t *signal, int blockSize, int bps, const SubframePlan &plan);
+
+    /** @brief Schreibt ein Restsignal mit partitionierter Rice-Kodierung. */
+    void writeResidual (const int32_t *residual, int blockSize, int order, int partitionOrder);
+
+    /** @brief Erzeugt den STREAMINFO-Block. */
+    QByteArray streamInfo () const;
+
+    static constexpr int MaxFixedOrder = 4; ///< Höchste Ordnung der festen Prädiktoren.
+
+    QFile m_file;                 ///< Die Zieldatei.
+    int m_sampleRate = 0;         ///< Abtastrate in Hz.
+    int m_channels = 0;           ///< Anzahl der Kanäle.
+    int m_bps = 24;               ///< Bittiefe der kodierten Samples.
+    int m_blockSize = 4096;       ///< Frames pro FLAC-Frame.
+    int m_maxPartitionOrder = 5;  ///< Höchste Rice-Partitionsordnung.
+    bool m_exhaustive = true;     ///< Alle Prädiktoren exakt bewerten statt per Heuristik.
+    bool m_stereoSearch = true;   ///< Kanal-Dekorrelation bei Stereo ausprobieren.
+    bool m_failed = false;        ///< Ein Schreibzugriff ist fehlgeschlagen.
+
+    std::vector<std::vector<int32_t>> m_block; ///< Gesammelte Samples je Kanal.
+    int m_blockFill = 0;          ///< Anzahl der Frames im aktuellen Block.
+    std::vector<int32_t> m_mid;   ///< Mitte-Kanal (Stereo).
+    std::vector<int32_t> m_side;  ///< Seite-Kanal (Stereo).
+    std::vector<int32_t> m_residual; ///< Wiederverwendeter Puffer für Restsignale.
+    std::vector<uint64_t> m_partitionSums; ///< Summen der Restbeträge je Partition.
+    std::vector<uint8_t> m_md5Bytes; ///< Samples eines Blocks im Format der MD5-Prüfsumme.
+    QCryptographicHash m_md5 {QCryptographicHash::Md5}; ///< MD5 über alle Samples.
+    BitWriter m_writer;           ///< Baut den aktuellen Frame auf.
+
+    qint64 m_totalFrames = 0;     ///< Anzahl aller übergebenen Frames.
+    quint32 m_frameNumber = 0;    ///< Nummer des nächsten Frames.
+    quint32 m_minFrameBytes = 0;  ///< Kleinster geschriebener Frame.
+    quint32 m_maxFrameBytes = 0;  ///< Größter geschriebener Frame.
+    qint64 m_bytesWritten = 0;    ///< Geschriebene Bytes.
+};
+
+#endif // FLACENCODER_H
@@ -0,0 +1,564 @@
+#include "flacfilereader.h"
+
+#include <cstring>
+
+namespace
+{
+constexpr size_t ReadChunkBytes = 256 * 1024; //  Lesegröße beim Nachfüllen des Puffers.
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacFileReader::open (
+    const QString &path)
+{
+    close ();
+    m_file.setFileName (path);
+    if (!m_file.open (QIODevice::ReadOnly))
+    {
+        m_error = QString ("Datei kann nicht geöffnet werden: %1").arg (path);
+        return false;
+    }
+
+    m_buffer.clear ();
+    m_bitPos = 0;
+    m_fileAtEnd = false;
+    m_endOfStream = false;
+    fillBuffer (4);
+    if (m_buffer.size () < 4 || std::memcmp (m_buffer.data (), "fLaC", 4) != 0)
+    {
+        close ();
+        return fail ("Keine gültige FLAC-Datei.");
+    }
+    m_bitPos = 32;
+
+    //  --- Metadatenblöcke: STREAMINFO auswerten, alle anderen überspringen ---
+    bool haveStreamInfo = false;
+    for (;;)
+    {
+        fillBuffer (4);
+        const bool last = readBits (1) != 0;
+        const uint32_t type = readBits (7);
+        const uint32_t length = readBits (24);
+        fillBuffer (length);
+        if ((m_bitPos >> 3) + length > m_buffer.size ())
+        {
+            close ();
+            return fail ("Metadaten sind unvollständig.");
+        }
+
+        if (type == 0 && length >= 34)
+        {
+            readBits (16); //  Kleinste Blockgröße.
+            m_maxBlockSize = int (readBits (16));
+            readBits (24); //  Kleinster Frame.
+            m_maxFrameBytes = readBits (24);
+            m_sampleRate = int (readBits (20));
+            m_channels = int (readBits (3)) + 1;
+            m_bitsPerSample = int (readBits (5)) + 1;
+            m_totalFrames = qint64 (readBits (4)) << 32;
+            m_totalFrames |= readBits (32);
+            m_bitPos += size_t (length - 18) * 8; //  MD5-Summe und ggf. Erweiterungen.
+            haveStreamInfo = true;
+        }
+        else
+        {
+            m_bitPos += size_t (length) * 8;
+        }
+
+        if (last)
+        {
+            break;
+        }
+    }
+
+    if (!haveStreamInfo || m_sampleRate <= 0 || m_bitsPerSample < 4 || m_bitsPerSample > 32)
+    {
+        close ();
+        return fail ("STREAMINFO fehlt oder ist ungültig.");
+    }
+
+    m_decoded.assign (size_t (m_channels), std::vector<int32_t> (size_t (qMax (m_maxBlockSize, 16))));
+    m_blockSize = 0;
+    m_blockPos = 0;
+    m_framesRead = 0;
+    m_error.clear ();
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacFileReader::close ()
+{
+    if (m_file.isOpen ())
+    {
+        m_file.close ();
+    }
+    m_buffer.clear ();
+    m_bitPos = 0;
+    m_totalFrames = 0;
+    m_framesRead = 0;
+    m_blockSize = 0;
+    m_blockPos = 0;
+    m_endOfStream = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int FlacFileReader::readFrames (
+    int32_t *out, int maxFrames)
+{
+    if (!isOpen () || maxFrames <= 0)
+    {
+        return 0;
+    }
+
+    int done = 0;
+    while (done < maxFrames)
+    {
+        if (m_blockPos >= m_blockSize)
+        {
+            if (m_endOfStream || !decodeFrame ())
+            {
+                break;
+            }
+        }
+
+        const int n = qMin (maxFrames - done, m_blockSize - m_blockPos);
+        for (int i = 0; i < n; ++i)
+        {
+            for (int ch = 0; ch < m_channels; ++ch)
+            {
+                *out++ = m_decoded[size_t (ch)][size_t (m_blockPos + i)];
+            }
+        }
+        m_blockPos += n;
+        done += n;
+    }
+    m_framesRead += done;
+    return done;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int FlacFileReader::readFrames (
+    float *out, int maxFrames)
+{
+    //  Die Ganzzahlen werden im Zielpuffer selbst dekodiert und dort in float umgewandelt;
+    //  beide Typen sind gleich groß.
+    static_assert (sizeof (float) == sizeof (int32_t), "float und int32_t müssen gleich groß sein");
+    int32_t *ints = reinterpret_cast<int32_t *> (out);
+    const int frames = readFrames (ints, maxFrames);
+
+    const float scale = 1.0f / float (1u << (m_bitsPerSample - 1));
+    const qint64 count = qint64 (frames) * m_channels;
+    for (qint64 i = 0; i < count; ++i)
+    {
+        int32_t v;
+        std::memcpy (&v, out + i, sizeof v);
+        out[i] = float (v) * scale;
+    }
+    return frames;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacFileReader::fillBuffer (
+    size_t bytes)
+{
+    //  Bereits gelesene Bytes werden erst verworfen, wenn nachgelesen werden muss.
+    const size_t consumed = m_bitPos >> 3;
+    if (m_fileAtEnd || m_buffer.size () >= consumed + bytes)
+    {
+        return;
+    }
+    if (consumed > 0)
+    {
+        m_buffer.erase (m_buffer.begin (), m_buffer.begin () + qint64 (consumed));
+        m_bitPos -= consumed * 8;
+    }
+
+    while (!m_fileAtEnd && m_buffer.size () < bytes)
+    {
+        const size_t old = m_buffer.size ();
+        const size_t want = qMax (ReadChunkBytes, bytes - old);
+        m_buffer.resize (old + want);
+        const qint64 got = m_file.read (reinterpret_cast<char *> (m_buffer.data () + old), qint64 (want));
+        m_buffer.resize (old + size_t (qMax<qint64> (0, got)));
+        if (got <= 0)
+        {
+            m_fileAtEnd = true;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+uint32_t FlacFileReader::readBits (
+    int bits)
+{
+    uint64_t value = 0;
+    for (int remaining = bits; remaining > 0;)
+    {
+        const size_t byte = m_bitPos >> 3;
+        if (byte >= m_buffer.size ())
+        {
+            //  Über das Pufferende hinaus wird mit Nullen gelesen; decodeFrame() erkennt
+            //  das an der Position und bricht ab.
+            value <<= remaining;
+            m_bitPos += size_t (remaining);
+            break;
+        }
+        const int offset = int (m_bitPos & 7);
+        const int take = qMin (remaining, 8 - offset);
+        const uint32_t chunk = (m_buffer[byte] >> (8 - offset - take)) & ((1u << take) - 1u);
+        value = (value << take) | chunk;
+        m_bitPos += size_t (take);
+        remaining -= take;
+    }
+    return uint32_t (value);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int32_t FlacFileReader::readSigned (
+    int bits)
+{
+    if (bits == 0)
+    {
+        return 0;
+    }
+    const uint32_t v = readBits (bits);
+    const int shift = 32 - bits;
+    return int32_t (v << shift) >> shift;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+uint32_t FlacFileReader::readUnary ()
+{
+    uint32_t zeros = 0;
+    for (;;)
+    {
+        const size_t byte = m_bitPos >> 3;
+        if (byte >= m_buffer.size ())
+        {
+            return zeros;
+        }
+        const int offset = int (m_bitPos & 7);
+        const uint8_t rest = uint8_t (m_buffer[byte] << offset);
+        if (rest == 0)
+        {
+            //  Der Rest des Bytes enthält nur Nullen.
+            zeros += uint32_t (8 - offset);
+            m_bitPos += size_t (8 - offset);
+            continue;
+        }
+        int lead = 0;
+        while (!(rest & (0x80 >> lead)))
+        {
+            ++lead;
+        }
+        zeros += uint32_t (lead);
+        m_bitPos += size_t (lead) + 1;
+        return zeros;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacFileReader::decodeFrame ()
+{
+    //  Ein Frame ist höchstens so groß wie in STREAMINFO angegeben; ohne Angabe wird
+    //  großzügig für einen unkomprimierten Block gepuffert.
+    const size_t worstCase = size_t (qMax (m_maxBlockSize, 4096)) * size_t (m_channels) * 5 + 64;
+    fillBuffer (qMax (size_t (m_maxFrameBytes), worstCase));
+    if ((m_bitPos >> 3) + 2 > m_buffer.size ())
+    {
+        m_endOfStream = true;
+        return false;
+    }
+
+    //  --- Frame-Header ---
+    const uint32_t sync = readBits (14);
+    readBits (1); //  Reserviert.
+    readBits (1); //  Feste oder variable Blockgröße; für das Lesen unerheblich.
+    if (sync != 0x3FFE)
+    {
+        m_endOfStream = true;
+        return fail ("Ungültiger Frame (Sync-Code fehlt).");
+    }
+
+    const uint32_t blockCode = readBits (4);
+    const uint32_t rateCode = readBits (4);
+    const uint32_t assignment = readBits (4);
+    const uint32_t sizeCode = readBits (3);
+    readBits (1);
+
+    //  Frame- bzw. Sample-Nummer im erweiterten UTF-8-Format überspringen.
+    const uint32_t lead = readBits (8);
+    for (uint32_t mask = 0x80; (lead & mask) && mask > 0x01; mask >>= 1)
+    {
+        if (mask != 0x80)
+        {
+            readBits (8);
+        }
+    }
+
+    int blockSize = 0;
+    if (blockCode == 1)
+    {
+        blockSize = 192;
+    }
+    else if (blockCode >= 2 && blockCode <= 5)
+    {
+        blockSize = 576 << (blockCode - 2);
+    }
+    else if (blockCode == 6)
+    {
+        blockSize = int (readBits (8)) + 1;
+    }
+    else if (blockCode == 7)
+    {
+        blockSize = int (readBits (16)) + 1;
+    }
+    else if (blockCode >= 8)
+    {
+        blockSize = 256 << (blockCode - 8);
+    }
+    if (rateCode == 12)
+    {
+        readBits (8);
+    }
+    else if (rateCode == 13 || rateCode == 14)
+    {
+        readBits (16);
+    }
+    readBits (8); //  CRC-8 des Headers.
+
+    static const int sampleSizes[8] = {0, 8, 12, 0, 16, 20, 24, 32};
+    const int bps = sizeCode == 0 ? m_bitsPerSample : sampleSizes[sizeCode];
+    const int channels = assignment < 8 ? int (assignment) + 1 : 2;
+    if (blockSize <= 0 || bps == 0 || channels != m_channels || assignment > 10)
+    {
+        m_endOfStream = true;
+        return fail ("Nicht unterstützter Frame-Header.");
+    }
+    if (size_t (blockSize) > m_decoded[0].size ())
+    {
+        for (std::vector<int32_t> &channel : m_decoded)
+        {
+            channel.resize (size_t (blockSize));
+        }
+    }
+
+    //  --- Subframes; der Seitenkanal hat ein Bit mehr ---
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        const bool side = (assignment == 8 && ch == 1) || (assignment == 9 && ch == 0)
+                          || (assignment == 10 && ch == 1);
+        if (!decodeSubframe (m_decoded[size_t (ch)].data (), blockSize, bps + (side ? 1 : 0)))
+        {
+            m_endOfStream = true;
+            return false;
+        }
+    }
+
+    //  --- Kanal-Dekorrelation rückgängig machen ---
+    int32_t *a = m_decoded[0].data ();
+    int32_t *b = channels > 1 ? m_decoded[1].data () : nullptr;
+    for (int i = 0; assignment >= 8 && i < blockSize; ++i)
+    {
+        if (assignment == 8) //  links/Seite
+        {
+            b[i] = a[i] - b[i];
+        }
+        else if (assignment == 9) //  Seite/rechts
+        {
+            a[i] = a[i] + b[i];
+        }
+        else //  Mitte/Seite
+        {
+            const int32_t side = b[i];
+            const int32_t mid = int32_t (uint32_t (a[i]) << 1) | (side & 1);
+            a[i] = (mid + side) >> 1;
+            b[i] = (mid - side) >> 1;
+        }
+    }
+
+    alignToByte ();
+    readBits (16); //  CRC-16 des Frames.
+    if ((m_bitPos >> 3) > m_buffer.size ())
+    {
+        m_endOfStream = true;
+        return fail ("Frame ist unvollständig (Datei abgeschnitten?).");
+    }
+
+    m_blockSize = blockSize;
+    m_blockPos = 0;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacFileReader::decodeSubframe (
+    int32_t *out, int blockSize, int bps)
+{
+    readBits (1); //  Füllbit.
+    const uint32_t type = readBits (6);
+
+    //  "Wasted bits": Alle Samples waren um k Bits nach links verschoben.
+    int wasted = 0;
+    if (readBits (1))
+    {
+        wasted = int (readUnary ()) + 1;
+        bps -= wasted;
+    }
+
+    if (type == 0)
+    {
+        const int32_t value = readSigned (bps);
+        std::fill (out, out + blockSize, value);
+    }
+    else if (type == 1)
+    {
+        for (int i = 0; i < blockSize; ++i)
+        {
+            out[i] = readSigned (bps);
+        }
+    }
+    else if (type >= 8 && type <= 12)
+    {
+        //  Fester Prädiktor der Ordnung 0 bis 4.
+        const int order = int (type & 7);
+        for (int i = 0; i < order; ++i)
+        {
+            out[i] = readSigned (bps);
+        }
+        if (!decodeResidual (out, blockSize, order))
+        {
+            return false;
+        }
+        for (int i = order; i < blockSize; ++i)
+        {
+            int64_t p = 0;
+            switch (order)
+            {
+            case 1:
+                p = out[i - 1];
+                break;
+            case 2:
+                p = 2 * int64_t (out[i - 1]) - out[i - 2];
+                break;
+            case 3:
+                p = 3 * int64_t (out[i - 1]) - 3 * int64_t (out[i - 2]) + out[i - 3];
+                break;
+            case 4:
+                p = 4 * int64_t (out[i - 1]) - 6 * int64_t (out[i - 2]) + 4 * int64_t (out[i - 3])
+                    - out[i - 4];
+                break;
+            default:
+                break;
+            }
+            out[i] = int32_t (out[i] + p);
+        }
+    }
+    else if (type >= 32)
+    {
+        //  LPC mit gespeicherten, quantisierten Koeffizienten.
+        const int order = int (type & 31) + 1;
+        for (int i = 0; i < order; ++i)
+        {
+            out[i] = readSigned (bps);
+        }
+        const int precision = int (readBits (4)) + 1;
+        const int shift = readSigned (5);
+        int32_t coefs[32];
+        for (int i = 0; i < order; ++i)
+        {
+            coefs[i] = readSigned (precision);
+        }
+        if (precision > 15 || shift < 0 || !decodeResidual (out, blockSize, order))
+        {
+            return fail ("Ungültiger LPC-Subframe.");
+        }
+        for (int i = order; i < blockSize; ++i)
+        {
+            int64_t sum = 0;
+            for (int j = 0; j < order; ++j)
+            {
+                sum += int64_t (coefs[j]) * out[i - 1 - j];
+            }
+            out[i] = int32_t (out[i] + (sum >> shift));
+        }
+    }
+    else
+    {
+        return fail (QString ("Unbekannter Subframe-Typ %1.").arg (type));
+    }
+
+    if (wasted > 0)
+    {
+        for (int i = 0; i < blockSize; ++i)
+        {
+            out[i] = int32_t (uint32_t (out[i]) << wasted);
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacFileReader::decodeResidual (
+    int32_t *out, int blockSize, int order)
+{
+    const uint32_t method = readBits (2);
+    if (method > 1)
+    {
+        return fail ("Unbekannte Restsignal-Kodierung.");
+    }
+    const int paramBits = method == 0 ? 4 : 5;
+    const uint32_t escape = method == 0 ? 15 : 31;
+    const int partitionOrder = int (readBits (4));
+    const int partitions = 1 << partitionOrder;
+    const int size = blockSize >> partitionOrder;
+    if ((size << partitionOrder) != blockSize || size < order)
+    {
+        return fail ("Ungültige Partitionierung des Restsignals.");
+    }
+
+    int i = order;
+    for (int p = 0; p < partitions; ++p)
+    {
+        const int end = (p + 1) * size;
+        const uint32_t k = readBits (paramBits);
+        if (k == escape)
+        {
+            //  Unkodierte Werte mit fester Bitbreite.
+            const int bits = int (readBits (5));
+            for (; i < end; ++i)
+            {
+                out[i] = readSigned (bits);
+            }
+            continue;
+        }
+        for (; i < end; ++i)
+        {
+            const uint32_t u = (readUnary () << k) | readBits (int (k));
+            out[i] = int32_t (u >> 1) ^ -int32_t (u & 1);
+        }
+    }
+    return (m_bitPos >> 3) <= m_buffer.size () || fail ("Frame ist unvollständig.");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacFileReader::fail (
+    const QString &message)
+{
+    m_error = message;
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,130 @@
+/**
+ * @file flacfilereader.h
+ * @brief Enthält die Deklaration des FlacFileReader zum blockweisen Lesen von FLAC-Dateien.
+ * @author Mike Wild
+ */
+#ifndef FLACFILEREADER_H
+#define FLACFILEREADER_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Dekodiert FLAC-Dateien blockweise zu interleavten float-Samples.
+ *
+ * Die Schnittstelle entspricht der des WavFileReader, sodass beide Leser austauschbar
+ * verwendet werden können. Unterstützt werden alle Subframe-Typen (konstant, verbatim,
+ * feste Prädiktoren und LPC) sowie die Stereo-Dekorrelation; dekodiert wird immer nur
+ * ein FLAC-Frame auf einmal, der Speicherbedarf ist also unabhängig von der Dateilänge.
+ */
+class FlacFileReader
+{
+public:
+    /**
+     * @brief Standard-Konstruktor.
+     */
+    FlacFileReader () = default;
+
+    /**
+     * @brief Öffnet eine FLAC-Datei und liest deren STREAMINFO-Block.
+     * @param path Der Pfad zur Datei.
+     * @return true, wenn die Datei gültig ist und gelesen werden kann.
+     */
+    bool open (const QString &path);
+
+    /**
+     * @brief Schließt die Datei.
+     */
+    void close ();
+
+    /**
+     * @brief Liest bis zu @p maxFrames Frames ab der aktuellen Position.
+     * @param out Ziel-Array mit Platz für maxFrames * channels() float-Werte.
+     * @param maxFrames Die maximale Anzahl an Frames.
+     * @return Die Anzahl der gelesenen Frames (0 am Dateiende oder bei einem Fehler).
+     */
+    int readFrames (float *out, int maxFrames);
+
+    /**
+     * @brief Liest bis zu @p maxFrames Frames als Ganzzahlen in der Bittiefe der Datei.
+     * @param out Ziel-Array mit Platz für maxFrames * channels() Werten.
+     * @param maxFrames Die maximale Anzahl an Frames.
+     * @return Die Anzahl der gelesenen Frames (0 am Dateiende oder bei einem Fehler).
+     */
+    int readFrames (int32_t *out, int maxFrames);
+
+    /** @brief Gibt an, ob eine Datei geöffnet ist. */
+    bool isOpen () const { return m_file.isOpen (); }
+
+    /** @brief Abtastrate der Datei in Hz. */
+    int sampleRate () const { return m_sampleRate; }
+
+    /** @brief Anzahl der Kanäle der Datei. */
+    int channels () const { return m_channels; }
+
+    /** @brief Bittiefe der Samples. */
+    int bitsPerSample () const { return m_bitsPerSample; }
+
+    /** @brief Gesamtzahl der Frames in der Datei (0, wenn im Header nicht angegeben). */
+    qint64 frames () const { return m_totalFrames; }
+
+    /** @brief Anzahl der bereits gelesenen Frames. */
+    qint64 position () const { return m_framesRead; }
+
+    /** @brief Gibt an, ob alle Frames gelesen wurden. */
+    bool atEnd () const { return m_endOfStream && m_blockPos >= m_blockSize; }
+
+    /** @brief Beschreibung des letzten Fehlers. */
+    QString errorString () const { return m_error; }
+
+private:
+    /** @brief Stellt sicher, dass mindestens @p bytes ungelesene Bytes gepuffert sind (soweit vorhanden). */
+    void fillBuffer (size_t bytes);
+
+    /** @brief Liest die nächsten @p bits Bits (bits <= 32) als vorzeichenlosen Wert. */
+    uint32_t readBits (int bits);
+
+    /** @brief Liest die nächsten @p bits Bits als vorzeichenbehafteten Wert. */
+    int32_t readSigned (int bits);
+
+    /** @brief Zählt Null-Bits bis zur nächsten Eins (die mitgelesen wird). */
+    uint32_t readUnary ();
+
+    /** @brief Springt zur nächsten Byte-Grenze. */
+    void alignToByte () { m_bitPos = (m_bitPos + 7) & ~size_t (7); }
+
+    /** @brief Dekodiert den nächsten FLAC-Frame in m_decoded. */
+    bool decodeFrame ();
+
+    /** @brief Dekodiert einen Subframe in @p out. */
+    bool decodeSubframe (int32_t *out, int blockSize, int bps);
+
+    /** @brief Dekodiert ein Rice-kodiertes Restsignal ab Position @p order in @p out. */
+    bool decodeResidual (int32_t *out, int blockSize, int order);
+
+    /** @brief Setzt die Fehlermeldung und gibt false zurück. */
+    bool fail (const QString &message);
+
+    QFile m_file;                  ///< Das Dateihandle.
+    QString m_error;               ///< Beschreibung des letzten Fehlers.
+    int m_sampleRate = 0;          ///< Abtastrate in Hz.
+    int m_channels = 0;            ///< Anzahl der Kanäle.
+    int m_bitsPerSample = 0;       ///< Bittiefe der Samples.
+    int m_maxBlockSize = 0;        ///< Größte Blockgröße laut STREAMINFO.
+    qint64 m_maxFrameBytes = 0;    ///< Größter Frame laut STREAMINFO (0 = unbekannt).
+    qint64 m_totalFrames = 0;      ///< Anzahl der Frames laut STREAMINFO.
+    qint64 m_framesRead = 0;       ///< Anzahl der bereits gelesenen Frames.
+
+    std::vector<uint8_t> m_buffer; ///< Gepufferte, noch nicht vollständig gelesene Bytes der Datei.
+    size_t m_bitPos = 0;           ///< Leseposition in m_buffer in Bits.
+    bool m_fileAtEnd = false;      ///< Die Datei wurde vollständig in den Puffer gelesen.
+    bool m_endOfStream = false;    ///< Es folgen keine weiteren Frames.
+
+    std::vector<std::vector<int32_t>> m_decoded; ///< Samples des aktuellen Frames je Kanal.
+    int m_blockSize = 0;           ///< Anzahl der Frames im aktuellen FLAC-Frame.
+    int m_blockPos = 0;            ///< Bereits ausgegebene Frames des aktuellen FLAC-Frames.
+};
+
+#endif // FLACFILEREADER_H
@@ -0,0 +1,187 @@
+#include "flacfilewriter.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+#include <cstring>
+
+//--------------------------------------------------------------------------------------------------
+
+FlacFileWriter::~FlacFileWriter ()
+{
+    close ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacFileWriter::open (
+    const QString &path, int sampleRate, int channels, int level, qint64 bufferSamples)
+{
+    close ();
+
+    if (!m_encoder.open (path, sampleRate, channels, 24, level))
+    {
+        return false;
+    }
+    m_path = path;
+    m_sampleRate = sampleRate;
+    m_channels = channels;
+
+    //  Die Puffer werden nur bei geänderter Größe neu angelegt; so findet beim
+    //  Übergeben der Samples keine Allokation statt.
+    const qint64 capacity = qMax<qint64> (channels, bufferSamples - bufferSamples % channels);
+    if (m_buffers.size () != size_t (BufferCount) || qint64 (m_buffers[0].capacity ()) < capacity)
+    {
+        m_buffers.assign (size_t (BufferCount), std::vector<float> ());
+        for (std::vector<float> &buffer : m_buffers)
+        {
+            buffer.reserve (size_t (capacity));
+        }
+    }
+
+    {
+        QMutexLocker locker (&m_mutex);
+        m_free.clear ();
+        m_filled.clear ();
+        m_free.reserve (BufferCount);
+        m_filled.reserve (BufferCount);
+        for (int i = 0; i < BufferCount; ++i)
+        {
+            m_free.append (i);
+        }
+        m_stop = false;
+        m_error = false;
+        m_stats = Statistics ();
+    }
+
+    m_thread = QThread::create ([this] () { encodeLoop (); });
+    m_thread->setObjectName ("FlacFileWriter");
+    m_thread->start ();
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacFileWriter::append (
+    const float *samples, qint64 count)
+{
+    if (!m_thread)
+    {
+        return;
+    }
+
+    while (count > 0)
+    {
+        int index = -1;
+        {
+            QMutexLocker locker (&m_mutex);
+            if (m_free.isEmpty ())
+            {
+                //  Der Encoder ist um alle Puffer im Rückstand.
+                ++m_stats.stalls;
+                while (m_free.isEmpty ())
+                {
+                    m_freeCond.wait (&m_mutex);
+                }
+            }
+            index = m_free.takeLast ();
+        }
+
+        std::vector<float> &buffer = m_buffers[size_t (index)];
+        const qint64 n = qMin<qint64> (count, qint64 (buffer.capacity ()));
+        buffer.resize (size_t (n));
+        std::memcpy (buffer.data (), samples, size_t (n) * sizeof (float));
+        samples += n;
+        count -= n;
+
+        QMutexLocker locker (&m_mutex);
+        m_filled.append (index);
+        m_filledCond.wakeOne ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool FlacFileWriter::close ()
+{
+    if (!m_thread)
+    {
+        return true;
+    }
+
+    //  Der Encoder-Thread kodiert alle ausstehenden Puffer, schließt die Datei und endet.
+    {
+        QMutexLocker locker (&m_mutex);
+        m_stop = true;
+        m_filledCond.wakeAll ();
+    }
+    m_thread->wait ();
+    delete m_thread;
+    m_thread = nullptr;
+
+    QMutexLocker locker (&m_mutex);
+    return !m_error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+FlacFileWriter::Statistics FlacFileWriter::statistics () const
+{
+    QMutexLocker locker (&m_mutex);
+    return m_stats;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void FlacFileWriter::encodeLoop ()
+{
+    QElapsedTimer timer;
+    for (;;)
+    {
+        int index = -1;
+        {
+            QMutexLocker locker (&m_mutex);
+            while (m_filled.isEmpty () && !m_stop)
+            {
+                m_filledCond.wait (&m_mutex);
+            }
+            if (m_filled.isEmpty ())
+            {
+                break;
+            }
+            index = m_filled.takeFirst ();
+        }
+
+        const std::vector<float> &buffer = m_buffers[size_t (index)];
+        const qint64 frames = qint64 (buffer.size ()) / m_channels;
+        timer.start ();
+        const bool ok = m_encoder.encode (buffer.data (), frames);
+        const double seconds = timer.nsecsElapsed () / 1e9;
+
+        QMutexLocker locker (&m_mutex);
+        m_error = m_error || !ok;
+        m_stats.audioSeconds += double (frames) / m_sampleRate;
+        m_stats.encodeSeconds += seconds;
+        m_stats.inputBytes += qint64 (buffer.size () * sizeof (float));
+        m_stats.outputBytes = m_encoder.bytesWritten ();
+        m_free.append (index);
+        m_freeCond.wakeOne ();
+    }
+
+    //  Letzter, unvollständiger Block und endgültiger STREAMINFO-Block.
+    timer.start ();
+    const bool ok = m_encoder.finish ();
+    const double seconds = timer.nsecsElapsed () / 1e9;
+    if (!ok)
+    {
+        qWarning () << "FlacFileWriter: Datei konnte nicht vollständig geschrieben werden:" << m_path;
+    }
+
+    QMutexLocker locker (&m_mutex);
+    m_error = m_error || !ok;
+    m_stats.encodeSeconds += seconds;
+    m_stats.outputBytes = m_encoder.bytesWritten ();
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,120 @@
+/**
+ * @file flacfilewriter.h
+ * @brief Enthält die Deklaration des FlacFileWriter zum FLAC-Kodieren in einem eigenen Thread.
+ * @author Mike Wild
+ */
+#ifndef FLACFILEWRITER_H
+#define FLACFILEWRITER_H
+
+#include "flacencoder.h"
+
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <vector>
+
+class QThread;
+
+/**
+ * @brief Kodiert einen fortlaufenden Strom von float-Samples im Hintergrund zu FLAC.
+ *
+ * Der Aufrufer (der WavWriterThread) kopiert seine Samples mit append() in einen von
+ * mehreren vorab angelegten Puffern; ein eigener Encoder-Thread kodiert die Puffer der
+ * Reihe nach mit einem FlacEncoder. Der Aufrufer wartet nur, wenn alle Puffer belegt
+ * sind, der Encoder also mehrere Sekunden im Rückstand ist; solche Wartezeiten werden
+ * als "stalls" gezählt.
+ *
+ * @note append() und close() dürfen nur aus einem Thread aufgerufen werden.
+ */
+class FlacFileWriter
+{
+public:
+    /**
+     * @brief Kennzahlen einer Datei seit dem letzten open().
+     */
+    struct Statistics
+    {
+        double audioSeconds = 0.0;  ///< Kodierte Audiodauer in Sekunden.
+        double encodeSeconds = 0.0; ///< Rechenzeit des Encoder-Threads in Sekunden.
+        qint64 inputBytes = 0;      ///< Größe der Eingangsdaten als 32-bit float.
+        qint64 outputBytes = 0;     ///< Größe der FLAC-Datei.
+        int stalls = 0;             ///< Wie oft der Aufrufer auf einen freien Puffer warten musste.
+
+        /** @brief Rechenzeit in Millisekunden je Sekunde Audio. */
+        double msPerAudioSecond () const { return audioSeconds > 0.0 ? 1000.0 * encodeSeconds / audioSeconds : 0.0; }
+
+        /** @brief Größe der FLAC-Datei relativ zur unkomprimierten float-Datei. */
+        double ratio () const { return inputBytes > 0 ? double (outputBytes) / double (inputBytes) : 0.0; }
+    };
+
+    /**
+     * @brief Standard-Konstruktor.
+     */
+    FlacFileWriter () = default;
+
+    /**
+     * @brief Destruktor. Schließt eine noch offene Datei (inkl. aller ausstehenden Daten).
+     */
+    ~FlacFileWriter ();
+
+    FlacFileWriter (const FlacFileWriter &) = delete;
+    FlacFileWriter &operator= (const FlacFileWriter &) = delete;
+
+    /**
+     * @brief Legt die Datei an und startet den Encoder-Thread.
+     * @param path Pfad der FLAC-Datei (wird überschrieben).
+     * @param sampleRate Abtastrate in Hz.
+     * @param channels Anzahl der Kanäle.
+     * @param level Kompressionsstufe von 0 (schnell) bis 8 (klein).
+     * @param bufferSamples Größe eines Puffers in float-Werten.
+     * @return true, wenn die Datei geöffnet werden konnte.
+     */
+    bool open (const QString &path, int sampleRate, int channels, int level, qint64 bufferSamples);
+
+    /**
+     * @brief Übergibt interleavte Samples an den Encoder-Thread.
+     * @param samples Zeiger auf die Samples.
+     * @param count Anzahl der float-Werte (Vielfaches der Kanalanzahl).
+     */
+    void append (const float *samples, qint64 count);
+
+    /**
+     * @brief Kodiert alle ausstehenden Samples, beendet den Encoder-Thread und schließt die Datei.
+     * @return true, wenn die Datei vollständig geschrieben wurde.
+     */
+    bool close ();
+
+    /** @brief Gibt an, ob gerade eine Datei geöffnet ist. */
+    bool isOpen () const { return m_thread != nullptr; }
+
+    /** @brief Gibt den Pfad der (zuletzt) geöffneten Datei zurück. */
+    QString fileName () const { return m_path; }
+
+    /** @brief Gibt die Kennzahlen seit dem letzten open() zurück (threadsicher). */
+    Statistics statistics () const;
+
+private:
+    /** @brief Die Schleife des Encoder-Threads. */
+    void encodeLoop ();
+
+    static constexpr int BufferCount = 16; ///< Anzahl der Puffer (bei ~1 s je Flush gut 15 s Vorlauf).
+
+    FlacEncoder m_encoder;       ///< Der eigentliche Encoder (nur im Encoder-Thread benutzt).
+    QThread *m_thread = nullptr; ///< Der Encoder-Thread.
+    QString m_path;              ///< Pfad der Datei.
+    int m_sampleRate = 0;        ///< Abtastrate in Hz.
+    int m_channels = 0;          ///< Anzahl der Kanäle.
+    std::vector<std::vector<float>> m_buffers; ///< Die vorab angelegten Puffer.
+
+    // Gemeinsamer Zustand (geschützt durch m_mutex)
+    mutable QMutex m_mutex;
+    QWaitCondition m_filledCond; ///< Weckt den Encoder-Thread bei neuen Daten.
+    QWaitCondition m_freeCond;   ///< Weckt den Aufrufer, wenn ein Puffer frei wird.
+    QList<int> m_free;           ///< Indizes der freien Puffer.
+    QList<int> m_filled;         ///< Indizes der gefüllten Puffer in Reihenfolge.
+    bool m_stop = false;         ///< Der Encoder-Thread soll sich nach der Warteschlange beenden.
+    bool m_error = false;        ///< Beim Kodieren ist ein Fehler aufgetreten.
+    Statistics m_stats;          ///< Laufende Kennzahlen.
+};
+
+#endif // FLACFILEWRITER_H
@@ -0,0 +1,115 @@
+#include "jobqueuedialog.h"
+#include "jobscheduler.h"
+
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace
+{
+//  Formatiert eine Dauer in Sekunden als "h:mm:ss".
+QString formatSeconds (
+    double seconds)
+{
+    const qint64 s = qint64 (seconds);
+    return QString ("%1:%2:%3")
+        .arg (s / 3600)
+        .arg ((s % 3600) / 60, 2, 10, QLatin1Char ('0'))
+        .arg (s % 60, 2, 10, QLatin1Char ('0'));
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+JobQueueDialog::JobQueueDialog (
+    JobScheduler *scheduler, QWidget *parent)
+    : QDialog (parent)
+    , m_scheduler (scheduler)
+    , m_table (new QTableWidget (this))
+    , m_timer (new QTimer (this))
+{
+    setWindowTitle (tr ("Auftragswarteschlange"));
+    resize (800, 400);
+
+    m_table->setColumnCount (6);
+    m_table->setHorizontalHeaderLabels (
+        {tr ("Auftrag"), tr ("Priorität"), tr ("Zustand"), tr ("Datei"), tr ("Wartezeit"), tr ("Laufzeit")});
+    m_table->horizontalHeader ()->setSectionResizeMode (3, QHeaderView::Stretch);
+    m_table->setEditTriggers (QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior (QAbstractItemView::SelectRows);
+    m_table->verticalHeader ()->setVisible (false);
+
+    QPushButton *clearButton = new QPushButton (tr ("Abgeschlossene entfernen"), this);
+    QPushButton *closeButton = new QPushButton (tr ("Schließen"), this);
+    QHBoxLayout *buttonLayout = new QHBoxLayout ();
+    buttonLayout->addWidget (clearButton);
+    buttonLayout->addStretch ();
+    buttonLayout->addWidget (closeButton);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout (this);
+    mainLayout->addWidget (m_table);
+    mainLayout->addLayout (buttonLayout);
+
+    m_timer->setInterval (1000);
+    connect (m_timer, &QTimer::timeout, this, &JobQueueDialog::refresh);
+    connect (m_scheduler,
+             &JobScheduler::jobChanged,
+             this,
+             [this] ()
+             {
+                 if (isVisible ())
+                 {
+                     refresh ();
+                 }
+             });
+    connect (clearButton, &QPushButton::clicked, m_scheduler, &JobScheduler::clearFinished);
+    connect (closeButton, &QPushButton::clicked, this, &QDialog::close);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobQueueDialog::showEvent (
+    QShowEvent *event)
+{
+    refresh ();
+    m_timer->start ();
+    QDialog::showEvent (event);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobQueueDialog::hideEvent (
+    QHideEvent *event)
+{
+    m_timer->stop ();
+    QDialog::hideEvent (event);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobQueueDialog::refresh ()
+{
+    static const QStringList priorities = {tr ("Live"), tr ("Normal"), tr ("Nachtrag")};
+
+    const QList<SchedulerJob> jobs = m_scheduler->jobs ();
+    m_table->setRowCount (jobs.size ());
+    for (int row = 0; row < jobs.size (); ++row)
+    {
+        const SchedulerJob &job = jobs[row];
+        QTableWidgetItem *fileItem = new QTableWidgetItem (QFileInfo (job.input).fileName ());
+        fileItem->setToolTip (job.input);
+        m_table->setItem (row, 0, new QTableWidgetItem (job.kindText ()));
+        m_table->setItem (row, 1, new QTableWidgetItem (priorities.value (int (job.priority))));
+        m_table->setItem (row, 2, new QTableWidgetItem (job.stateText ()));
+        m_table->setItem (row, 3, fileItem);
+        m_table->setItem (row, 4, new QTableWidgetItem (formatSeconds (job.waitSeconds ())));
+        m_table->setItem (row, 5, new QTableWidgetItem (formatSeconds (job.runSeconds ())));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
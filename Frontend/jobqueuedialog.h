@@ -0,0 +1,46 @@
+/**
+ * @file jobqueuedialog.h
+ * @brief Enthält die Deklaration des JobQueueDialog zur Anzeige der Auftragswarteschlange.
+ * @author Mike Wild
+ */
+#ifndef JOBQUEUEDIALOG_H
+#define JOBQUEUEDIALOG_H
+
+#include <QDialog>
+
+class JobScheduler;
+class QTableWidget;
+class QTimer;
+
+/**
+ * @brief Zeigt alle Aufträge des JobScheduler mit Zustand, Wartezeit und Laufzeit an.
+ *
+ * Der Dialog ist nicht modal; er aktualisiert sich bei jeder Änderung eines Auftrags
+ * und, solange er sichtbar ist, jede Sekunde für die laufenden Zeiten.
+ */
+class JobQueueDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor.
+     * @param scheduler Der anzuzeigende Scheduler.
+     * @param parent Übergeordnetes Widget, optional.
+     */
+    explicit JobQueueDialog (JobScheduler *scheduler, QWidget *parent = nullptr);
+
+protected:
+    void showEvent (QShowEvent *event) override;
+
+    void hideEvent (QHideEvent *event) override;
+
+private:
+    /** @brief Füllt die Tabelle neu. */
+    void refresh ();
+
+    JobScheduler *m_scheduler; ///< Der angezeigte Scheduler.
+    QTableWidget *m_table;     ///< Tabelle mit einer Zeile je Auftrag.
+    QTimer *m_timer;           ///< Aktualisiert die laufenden Zeiten.
+};
+
+#endif // JOBQUEUEDIALOG_H
@@ -0,0 +1,504 @@
+#include "jobscheduler.h"
+#include "asrprocessmanager.h"
+#include "taggeneratormanager.h"
+#include "transcription.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSettings>
+#include <QTimer>
+#include <QUuid>
+
+namespace
+{
+const char *const KindNames[] = {"transcribe", "retranscribe", "tag"};
+const char *const StateNames[] = {"queued", "running", "finished", "failed"};
+
+//  Liest ein gespeichertes Transkript; false, wenn die Datei fehlt oder ungültig ist.
+bool readTranscript (
+    const QString &path, Transcription *script)
+{
+    QFile file (path);
+    if (!file.open (QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    return script->fromJson (file.readAll ());
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+double SchedulerJob::waitSeconds () const
+{
+    const QDateTime end = startedAt.isValid () ? startedAt : QDateTime::currentDateTime ();
+    return queuedAt.isValid () ? queuedAt.msecsTo (end) / 1000.0 : 0.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double SchedulerJob::runSeconds () const
+{
+    if (!startedAt.isValid ())
+    {
+        return 0.0;
+    }
+    const QDateTime end = finishedAt.isValid () ? finishedAt : QDateTime::currentDateTime ();
+    return startedAt.msecsTo (end) / 1000.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString SchedulerJob::kindText () const
+{
+    switch (kind)
+    {
+    case Kind::Transcribe:
+        return QObject::tr ("Transkription");
+    case Kind::Retranscribe:
+        return QObject::tr ("Neu-Transkription");
+    case Kind::Tag:
+        return QObject::tr ("Tags");
+    }
+    return QString ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString SchedulerJob::stateText () const
+{
+    switch (state)
+    {
+    case State::Queued:
+        return QObject::tr ("wartet");
+    case State::Running:
+        return QObject::tr ("läuft");
+    case State::Finished:
+        return QObject::tr ("fertig");
+    case State::Failed:
+        return QObject::tr ("fehlgeschlagen: %1").arg (error);
+    }
+    return QString ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QJsonObject SchedulerJob::toJson () const
+{
+    QJsonObject object;
+    object["id"] = id;
+    object["kind"] = KindNames[int (kind)];
+    object["priority"] = int (priority);
+    object["state"] = StateNames[int (state)];
+    object["input"] = input;
+    object["output"] = output;
+    object["sequence"] = sequence;
+    object["queued_at"] = queuedAt.toString (Qt::ISODateWithMs);
+    object["started_at"] = startedAt.toString (Qt::ISODateWithMs);
+    object["finished_at"] = finishedAt.toString (Qt::ISODateWithMs);
+    object["error"] = error;
+    return object;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+SchedulerJob SchedulerJob::fromJson (
+    const QJsonObject &object)
+{
+    SchedulerJob job;
+    job.id = object.value ("id").toString ();
+    const QString kind = object.value ("kind").toString ();
+    for (int i = 0; i < 3; ++i)
+    {
+        if (kind == KindNames[i])
+        {
+            job.kind = Kind (i);
+        }
+    }
+    job.priority = Priority (qBound (0, object.value ("priority").toInt (1), 2));
+    const QString state = object.value ("state").toString ();
+    for (int i = 0; i < 4; ++i)
+    {
+        if (state == StateNames[i])
+        {
+            job.state = State (i);
+        }
+    }
+    job.input = object.value ("input").toString ();
+    job.output = object.value ("output").toString ();
+    job.sequence = object.value ("sequence").toInteger ();
+    job.queuedAt = QDateTime::fromString (object.value ("queued_at").toString (), Qt::ISODateWithMs);
+    job.startedAt = QDateTime::fromString (object.value ("started_at").toString (), Qt::ISODateWithMs);
+    job.finishedAt = QDateTime::fromString (object.value ("finished_at").toString (), Qt::ISODateWithMs);
+    job.error = object.value ("error").toString ();
+    return job;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+JobScheduler::JobScheduler (
+    const QString &queueFile, QObject *parent)
+    : QObject (parent)
+    , m_queueFile (queueFile)
+{
+    load ();
+
+    //  Wartende Aufträge vom letzten Programmlauf werden erst gestartet, wenn die
+    //  Anwendung vollständig aufgebaut ist (und ggf. schon Plätze reserviert hat).
+    QTimer::singleShot (0, this, &JobScheduler::schedule);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+JobScheduler::~JobScheduler ()
+{
+    //  Beim Beenden der Prozesse sollen keine Ergebnisse mehr verarbeitet werden.
+    for (const Running &running : std::as_const (m_running))
+    {
+        if (running.asr)
+        {
+            running.asr->disconnect (this);
+            running.asr->disconnect (running.script);
+        }
+        if (running.tagger)
+        {
+            running.tagger->disconnect (this);
+        }
+    }
+    save ();
+    qDeleteAll (m_idleAsr);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString JobScheduler::submit (
+    SchedulerJob::Kind kind,
+    const QString &input,
+    const QString &output,
+    SchedulerJob::Priority priority)
+{
+    SchedulerJob job;
+    job.id = QUuid::createUuid ().toString (QUuid::WithoutBraces);
+    job.kind = kind;
+    job.priority = priority;
+    job.input = input;
+    job.output = output.isEmpty () ? input : output;
+    job.sequence = m_nextSequence++;
+    job.queuedAt = QDateTime::currentDateTime ();
+    m_jobs.append (job);
+
+    save ();
+    emit jobChanged (job.id);
+    schedule ();
+    return job.id;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int JobScheduler::pendingCount () const
+{
+    int count = 0;
+    for (const SchedulerJob &job : m_jobs)
+    {
+        if (job.state == SchedulerJob::State::Queued || job.state == SchedulerJob::State::Running)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobScheduler::clearFinished ()
+{
+    m_jobs.removeIf (
+        [] (const SchedulerJob &job)
+        { return job.state == SchedulerJob::State::Finished || job.state == SchedulerJob::State::Failed; });
+    save ();
+    emit jobChanged (QString ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobScheduler::setReservedSlots (
+    int count)
+{
+    const bool released = count < m_reservedSlots;
+    m_reservedSlots = qMax (0, count);
+    if (released)
+    {
+        schedule ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobScheduler::schedule ()
+{
+    const int capacity = maxParallel ();
+    for (;;)
+    {
+        //  Der wartende Auftrag mit der höchsten Priorität, bei Gleichstand der älteste.
+        int best = -1;
+        for (int i = 0; i < m_jobs.size (); ++i)
+        {
+            const SchedulerJob &job = m_jobs[i];
+            if (job.state != SchedulerJob::State::Queued)
+            {
+                continue;
+            }
+            if (best < 0 || job.priority < m_jobs[best].priority
+                || (job.priority == m_jobs[best].priority && job.sequence < m_jobs[best].sequence))
+            {
+                best = i;
+            }
+        }
+        if (best < 0)
+        {
+            return;
+        }
+
+        //  Nur Live-Aufträge dürfen die von laufenden Aufnahmen reservierten Plätze nutzen.
+        const int busy = m_running.size ()
+                         + (m_jobs[best].priority == SchedulerJob::Priority::Live ? 0 : m_reservedSlots);
+        if (busy >= capacity)
+        {
+            return;
+        }
+        start (best);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobScheduler::start (
+    int index)
+{
+    SchedulerJob &job = m_jobs[index];
+    job.state = SchedulerJob::State::Running;
+    job.startedAt = QDateTime::currentDateTime ();
+    job.finishedAt = QDateTime ();
+    job.error.clear ();
+    const QString id = job.id;
+
+    Running running;
+    running.script = new Transcription (this);
+    Transcription *script = running.script;
+
+    if (job.kind == SchedulerJob::Kind::Tag)
+    {
+        if (!readTranscript (job.input, script) || script->text ().isEmpty ())
+        {
+            m_running.insert (id, running);
+            QTimer::singleShot (0,
+                                this,
+                                [this, id] ()
+                                { finish (id, false, tr ("Transkript fehlt oder ist leer")); });
+            return;
+        }
+
+        running.tagger = new TagGeneratorManager (this);
+        connect (running.tagger,
+                 &TagGeneratorManager::tagsReady,
+                 this,
+                 [this, id, script] (const QStringList &tags, bool success, const QString &errorMsg)
+                 {
+                     if (success)
+                     {
+                         script->setTags (tags);
+                     }
+                     finish (id, success, errorMsg);
+                 });
+        m_running.insert (id, running);
+        save ();
+        emit jobChanged (id);
+        running.tagger->generateTagsFor (script);
+        return;
+    }
+
+    //  Eine Neu-Transkription übernimmt Name und Datum des vorhandenen Transkripts,
+    //  eine erste Transkription benennt das Ergebnis nach der Aufnahme.
+    const QFileInfo info (job.input);
+    QString name = info.completeBaseName ();
+    QDateTime dateTime = info.lastModified ();
+    if (job.kind == SchedulerJob::Kind::Retranscribe && readTranscript (job.output, script))
+    {
+        name = script->name ();
+        dateTime = script->dateTime ();
+    }
+    script->clear ();
+    script->setName (name);
+    script->setDateTime (dateTime);
+
+    //  Ein untätiger Manager behält seine Worker samt geladener Modelle.
+    running.asr = m_idleAsr.isEmpty () ? new AsrProcessManager (this) : m_idleAsr.takeLast ();
+    AsrProcessManager *asr = running.asr;
+
+    //  Die Verbindungen hängen am Transkript und enden mit ihm; der Manager wird weiterverwendet.
+    connect (asr, &AsrProcessManager::segmentReady, script, &Transcription::add);
+    connect (asr,
+             &AsrProcessManager::segmentSpeakerChanged,
+             script,
+             &Transcription::changeSpeakerForSegment);
+    connect (asr,
+             &AsrProcessManager::finished,
+             script,
+             [this, id] (bool success, const QString &errorMsg) { finish (id, success, errorMsg); });
+
+    m_running.insert (id, running);
+    save ();
+    emit jobChanged (id);
+
+    qDebug () << "JobScheduler: Starte" << job.kindText () << job.input;
+    asr->startTranscription (job.input);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobScheduler::finish (
+    const QString &id, bool success, const QString &errorMsg)
+{
+    const int index = indexOf (id);
+    if (index < 0 || !m_running.contains (id))
+    {
+        return;
+    }
+    const Running running = m_running.take (id);
+    SchedulerJob &job = m_jobs[index];
+
+    //  Das Ergebnis wird atomar geschrieben, damit ein Abbruch kein halbes Transkript hinterlässt.
+    QString error = errorMsg;
+    if (success)
+    {
+        QSaveFile file (job.output);
+        if (!file.open (QIODevice::WriteOnly)
+            || file.write (running.script->toJson ().toJson (QJsonDocument::Indented)) < 0
+            || !file.commit ())
+        {
+            success = false;
+            error = tr ("Ergebnis kann nicht gespeichert werden: %1").arg (file.errorString ());
+        }
+    }
+
+    job.state = success ? SchedulerJob::State::Finished : SchedulerJob::State::Failed;
+    job.finishedAt = QDateTime::currentDateTime ();
+    job.error = success ? QString () : error;
+    qDebug () << "JobScheduler:" << job.kindText () << job.input << job.stateText () << "nach"
+              << job.waitSeconds () << "s Wartezeit und" << job.runSeconds () << "s Laufzeit";
+
+    //  Der ASR-Manager wird für den nächsten Auftrag aufbewahrt; alles andere wird freigegeben.
+    if (running.asr)
+    {
+        if (m_idleAsr.size () < maxParallel ())
+        {
+            m_idleAsr.append (running.asr);
+        }
+        else
+        {
+            running.asr->deleteLater ();
+        }
+    }
+    if (running.tagger)
+    {
+        running.tagger->deleteLater ();
+    }
+    running.script->deleteLater ();
+
+    const SchedulerJob finished = job;
+    if (success && finished.kind != SchedulerJob::Kind::Tag
+        && QSettings ("SS2025FP_T2", "AudioTranskriptor").value ("jobs/autoTag", false).toBool ())
+    {
+        submit (SchedulerJob::Kind::Tag, finished.output, finished.output, finished.priority);
+    }
+
+    save ();
+    emit jobChanged (id);
+    emit jobFinished (finished);
+    schedule ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int JobScheduler::indexOf (
+    const QString &id) const
+{
+    for (int i = 0; i < m_jobs.size (); ++i)
+    {
+        if (m_jobs[i].id == id)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int JobScheduler::maxParallel () const
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    return qMax (1, settings.value ("jobs/maxParallel", 1).toInt ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobScheduler::load ()
+{
+    QFile file (m_queueFile);
+    if (!file.open (QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson (file.readAll ()).object ();
+    m_nextSequence = root.value ("next_sequence").toInteger ();
+    const QJsonArray jobs = root.value ("jobs").toArray ();
+    for (const QJsonValue &value : jobs)
+    {
+        SchedulerJob job = SchedulerJob::fromJson (value.toObject ());
+        if (job.id.isEmpty ())
+        {
+            continue;
+        }
+
+        //  Beim Beenden laufende Aufträge werden vollständig wiederholt.
+        if (job.state == SchedulerJob::State::Running)
+        {
+            job.state = SchedulerJob::State::Queued;
+            job.startedAt = QDateTime ();
+        }
+        m_nextSequence = qMax (m_nextSequence, job.sequence + 1);
+        m_jobs.append (job);
+    }
+    qDebug () << "JobScheduler:" << pendingCount () << "offene Aufträge geladen aus" << m_queueFile;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JobScheduler::save () const
+{
+    QJsonArray jobs;
+    for (const SchedulerJob &job : m_jobs)
+    {
+        jobs.append (job.toJson ());
+    }
+    QJsonObject root;
+    root["next_sequence"] = m_nextSequence;
+    root["jobs"] = jobs;
+
+    QSaveFile file (m_queueFile);
+    if (!file.open (QIODevice::WriteOnly) || file.write (QJsonDocument (root).toJson ()) < 0
+        || !file.commit ())
+    {
+        qWarning () << "JobScheduler: Warteschlange kann nicht gespeichert werden:" << m_queueFile
+                    << file.errorString ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,187 @@
+/**
+ * @file jobscheduler.h
+ * @brief Enthält die Deklaration des JobScheduler für ASR- und Tag-Aufträge im Hintergrund.
+ * @author Mike Wild
+ */
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class AsrProcessManager;
+class TagGeneratorManager;
+class Transcription;
+
+/**
+ * @brief Ein Auftrag in der Warteschlange des JobScheduler.
+ */
+struct SchedulerJob
+{
+    /** @brief Art des Auftrags. */
+    enum class Kind
+    {
+        Transcribe,   ///< Eine Aufnahme transkribieren; das Ergebnis ersetzt die Ausgabedatei.
+        Retranscribe, ///< Eine Aufnahme erneut transkribieren; Name und Datum bleiben erhalten.
+        Tag           ///< Tags für ein gespeichertes Transkript erzeugen.
+    };
+
+    /** @brief Priorität; kleinere Werte werden zuerst gestartet. */
+    enum class Priority
+    {
+        Live = 0,     ///< Aufnahmen der laufenden Programmsitzung; belegt auch reservierte Plätze.
+        Normal = 1,   ///< Vom Benutzer angestoßene Einzelaufträge.
+        Backfill = 2  ///< Nachträgliche Verarbeitung älterer Aufnahmen.
+    };
+
+    /** @brief Bearbeitungszustand. */
+    enum class State
+    {
+        Queued,   ///< Wartet auf einen freien Platz.
+        Running,  ///< Wird gerade bearbeitet.
+        Finished, ///< Erfolgreich abgeschlossen.
+        Failed    ///< Mit Fehler abgebrochen.
+    };
+
+    QString id;                           ///< Eindeutige Kennung.
+    Kind kind = Kind::Transcribe;         ///< Art des Auftrags.
+    Priority priority = Priority::Normal; ///< Priorität.
+    State state = State::Queued;          ///< Bearbeitungszustand.
+    QString input;                        ///< ASR-WAV-Datei bzw. (bei Tags) Transkript-JSON.
+    QString output;                       ///< Transkript-JSON, in das das Ergebnis geschrieben wird.
+    qint64 sequence = 0;                  ///< Reihenfolge innerhalb derselben Priorität.
+    QDateTime queuedAt;                   ///< Zeitpunkt des Einreihens.
+    QDateTime startedAt;                  ///< Start der (letzten) Bearbeitung.
+    QDateTime finishedAt;                 ///< Ende der Bearbeitung.
+    QString error;                        ///< Fehlermeldung bei State::Failed.
+
+    /** @brief Wartezeit in der Warteschlange in Sekunden (bis jetzt, falls noch wartend). */
+    double waitSeconds () const;
+
+    /** @brief Bearbeitungszeit in Sekunden (bis jetzt, falls noch laufend). */
+    double runSeconds () const;
+
+    /** @brief Beschreibt die Art des Auftrags für die Anzeige. */
+    QString kindText () const;
+
+    /** @brief Beschreibt den Zustand für die Anzeige. */
+    QString stateText () const;
+
+    /** @brief Serialisiert den Auftrag für die Warteschlangen-Datei. */
+    QJsonObject toJson () const;
+
+    /** @brief Liest einen Auftrag aus der Warteschlangen-Datei. */
+    static SchedulerJob fromJson (const QJsonObject &object);
+};
+
+/**
+ * @brief Arbeitet Transkriptions- und Tag-Aufträge in einer persistenten Warteschlange ab.
+ *
+ * Anders als ein einzelner AsrProcessManager, der immer nur einen Job gleichzeitig
+ * annimmt, nimmt der Scheduler beliebig viele Aufträge entgegen und führt sie nach
+ * Priorität (bei gleicher Priorität in Eingangsreihenfolge) auf höchstens
+ * "jobs/maxParallel" gleichzeitigen Plätzen aus. Jeder Platz hat einen eigenen
+ * AsrProcessManager; untätige Manager werden samt geladener Worker weiterverwendet.
+ *
+ * Laufende Aufnahmen belegen ihre Plätze über setReservedSlots(); Aufträge mit
+ * Priority::Live dürfen diese Reserve nutzen, Nachträge warten, bis die Aufnahmen
+ * fertig transkribiert sind. Die Warteschlange wird bei jeder Änderung als JSON
+ * gespeichert und beim Start wieder geladen; beim Beenden laufende Aufträge werden
+ * dabei neu eingereiht. Mit "jobs/autoTag" folgt auf jede Transkription ein Tag-Auftrag
+ * mit derselben Priorität.
+ */
+class JobScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Konstruktor. Lädt eine vorhandene Warteschlange und startet wartende Aufträge.
+     * @param queueFile Pfad der JSON-Datei, in der die Warteschlange gespeichert wird.
+     * @param parent Das QObject-Elternteil für die Speicherverwaltung.
+     */
+    explicit JobScheduler (const QString &queueFile, QObject *parent = nullptr);
+
+    /**
+     * @brief Destruktor. Speichert die Warteschlange; laufende Aufträge werden beim
+     * nächsten Start wiederholt.
+     */
+    ~JobScheduler ();
+
+    /**
+     * @brief Reiht einen neuen Auftrag ein.
+     * @param kind Art des Auftrags.
+     * @param input ASR-WAV-Datei bzw. (bei Tags) Transkript-JSON.
+     * @param output Transkript-JSON für das Ergebnis (bei Tags leer = @p input).
+     * @param priority Priorität des Auftrags.
+     * @return Die Kennung des Auftrags.
+     */
+    QString submit (SchedulerJob::Kind kind,
+                    const QString &input,
+                    const QString &output,
+                    SchedulerJob::Priority priority = SchedulerJob::Priority::Normal);
+
+    /** @brief Gibt alle Aufträge in Eingangsreihenfolge zurück. */
+    QList<SchedulerJob> jobs () const { return m_jobs; }
+
+    /** @brief Gibt die Anzahl der wartenden bzw. laufenden Aufträge zurück. */
+    int pendingCount () const;
+
+    /** @brief Entfernt alle abgeschlossenen und fehlgeschlagenen Aufträge. */
+    void clearFinished ();
+
+    /**
+     * @brief Legt fest, wie viele Plätze gerade von laufenden Aufnahmen belegt werden.
+     * @param count Anzahl der Aufnahmen, deren ASR noch läuft.
+     */
+    void setReservedSlots (int count);
+
+signals:
+    /** @brief Ein Auftrag wurde eingereiht, gestartet oder beendet. */
+    void jobChanged (const QString &id);
+
+    /** @brief Ein Auftrag ist abgeschlossen (erfolgreich oder nicht). */
+    void jobFinished (const SchedulerJob &job);
+
+private:
+    /** @brief Die Hilfsobjekte eines laufenden Auftrags. */
+    struct Running
+    {
+        AsrProcessManager *asr = nullptr;      ///< ASR-Manager (nur bei Transkriptionen).
+        TagGeneratorManager *tagger = nullptr; ///< Tag-Generator (nur bei Tags).
+        Transcription *script = nullptr;       ///< Das entstehende bzw. zu taggende Transkript.
+    };
+
+    /** @brief Startet wartende Aufträge, solange Plätze frei sind. */
+    void schedule ();
+
+    /** @brief Startet den Auftrag an Index @p index. */
+    void start (int index);
+
+    /** @brief Schließt einen laufenden Auftrag ab, speichert das Ergebnis und gibt den Platz frei. */
+    void finish (const QString &id, bool success, const QString &errorMsg);
+
+    /** @brief Gibt den Index des Auftrags mit der Kennung zurück (-1, wenn unbekannt). */
+    int indexOf (const QString &id) const;
+
+    /** @brief Liest "jobs/maxParallel" (mindestens 1). */
+    int maxParallel () const;
+
+    /** @brief Lädt die Warteschlange aus m_queueFile. */
+    void load ();
+
+    /** @brief Speichert die Warteschlange in m_queueFile. */
+    void save () const;
+
+    QString m_queueFile;                   ///< Pfad der Warteschlangen-Datei.
+    QList<SchedulerJob> m_jobs;            ///< Alle Aufträge in Eingangsreihenfolge.
+    QHash<QString, Running> m_running;     ///< Laufende Aufträge nach Kennung.
+    QList<AsrProcessManager *> m_idleAsr;  ///< Untätige ASR-Manager zur Weiterverwendung.
+    qint64 m_nextSequence = 0;             ///< Nächste Eingangsnummer.
+    int m_reservedSlots = 0;               ///< Von laufenden Aufnahmen belegte Plätze.
+};
+
+#endif // JOBSCHEDULER_H
@@ -0,0 +1,436 @@
+#include "keywordextractor.h"
+#include "transcription.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr int MinWordLength = 3;     //  Kürzere Wörter sind nur als Abkürzung Schlagwörter.
+constexpr int MinPhraseCount = 2;    //  Phrasen müssen sich mindestens so oft wiederholen.
+constexpr double PhraseWeight = 1.5; //  Vorrang einer Phrase vor ihren einzelnen Wörtern.
+
+//  Deutsche Stoppwörter, Füllwörter gesprochener Sprache und Allerweltsbegriffe aus Meetings
+//  (kleingeschrieben).
+const QSet<QString> &stopWords ()
+{
+    static const QSet<QString> words{
+        "aber", "alle", "allem", "allen", "aller", "alles", "als", "also", "am", "an", "ander",
+        "andere", "anderen", "anderer", "anderes", "anders", "auch", "auf", "aus", "bei", "beim",
+        "bin", "bis", "bist", "bitte", "da", "dabei", "dadurch", "dafür", "dagegen", "daher",
+        "damit", "danach", "dann", "daran", "darauf", "daraus", "darf", "darüber", "darum", "das",
+        "dass", "davon", "dazu", "dein", "deine", "dem", "den", "denen", "denn", "dennoch", "der",
+        "deren", "des", "deshalb", "dessen", "dich", "die", "dies", "diese", "diesem", "diesen",
+        "dieser", "dieses", "dir", "doch", "dort", "du", "durch", "eben", "eigentlich", "ein",
+        "eine", "einem", "einen", "einer", "eines", "einfach", "einige", "einmal", "er", "es",
+        "etwa", "etwas", "euch", "euer", "eure", "für", "ganz", "gar", "gegen", "gehabt", "geht",
+        "gemacht", "genau", "gerade", "gewesen", "gibt", "gleich", "gut", "habe", "haben", "hat",
+        "hatte", "hatten", "hier", "hin", "hinter", "ich", "ihm", "ihn", "ihnen", "ihr", "ihre",
+        "ihrem", "ihren", "ihrer", "im", "immer", "in", "ins", "irgendwie", "ist", "ja", "jede",
+        "jedem", "jeden", "jeder", "jedes", "jetzt", "kann", "kannst", "kein", "keine", "keinem",
+        "keinen", "keiner", "können", "könnte", "machen", "macht", "mal", "man", "manche", "mehr",
+        "mein", "meine", "meinem", "meinen", "meiner", "mich", "mir", "mit", "muss", "müssen",
+        "nach", "nicht", "nichts", "noch", "nun", "nur", "ob", "obwohl", "oder", "ohne", "okay",
+        "quasi", "schon", "sehr", "sein", "seine", "seinem", "seinen", "seiner", "seit", "sich",
+        "sie", "sind", "so", "sogar", "solche", "soll", "sollen", "sollte", "sondern", "sozusagen",
+        "über", "um", "und", "uns", "unser", "unsere", "unter", "viel", "viele", "vom", "von",
+        "vor", "wann", "war", "waren", "warum", "was", "weil", "weiter", "welche", "welchem",
+        "welchen", "welcher", "wenn", "wer", "werde", "werden", "wie", "wieder", "will", "wir",
+        "wird", "wirklich", "wo", "wohl", "wollen", "würde", "würden", "zu", "zum", "zur", "zwar",
+        "zwischen", "äh", "ähm", "hm", "hmm", "naja", "ne", "nee", "ok", "tja", "gesagt", "sagen",
+        "sagt", "heißt", "halt", "eher", "danke", "hallo", "leute", "ding", "dinge", "sache",
+        "sachen", "frage", "teil", "punkt", "prozent", "jahr", "jahre", "woche", "tag",
+        "tage", "zeit", "minuten", "stunde", "stunden", "herr", "frau",
+    };
+    return words;
+}
+
+//  Gibt die häufigste Schreibweise zurück; bei Gleichstand die großgeschriebene.
+QString mostFrequentForm (
+    const QHash<QString, int> &forms)
+{
+    QString best;
+    int bestCount = 0;
+    for (auto it = forms.cbegin (); it != forms.cend (); ++it)
+    {
+        const bool better = it.value () > bestCount
+                            || (it.value () == bestCount && it.key () < best);
+        if (better)
+        {
+            best = it.key ();
+            bestCount = it.value ();
+        }
+    }
+    return best;
+}
+
+//  Häufigkeit und Schreibweisen eines Begriffs (Stamm oder Phrase) im Text.
+struct Candidate
+{
+    int count = 0;              //  Vorkommen im Text.
+    int upper = 0;              //  Großgeschrieben innerhalb eines Satzes.
+    int lower = 0;              //  Kleingeschrieben innerhalb eines Satzes.
+    QHash<QString, int> forms;  //  Schreibweisen und ihre Häufigkeit.
+    QStringList stems;          //  Die Stämme (eine Phrase hat zwei).
+
+    //  Ein Substantiv wird innerhalb eines Satzes überwiegend großgeschrieben.
+    bool isNoun () const { return upper > lower; }
+};
+
+using Ranked = QPair<double, const Candidate *>; //  Bewertung und Begriff.
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+KeywordExtractor &KeywordExtractor::shared ()
+{
+    static KeywordExtractor instance;
+    return instance;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void KeywordExtractor::addDocument (
+    const QString &key, const QString &text)
+{
+    //  Die Analyse läuft ohne Sperre; nur das Eintragen ist geschützt.
+    QSet<QString> terms;
+    for (const Token &token : analyze (text))
+    {
+        if (!token.stem.isEmpty ())
+        {
+            terms.insert (token.stem);
+        }
+    }
+
+    QMutexLocker locker (&m_mutex);
+    removeDocumentLocked (key);
+    for (const QString &term : std::as_const (terms))
+    {
+        ++m_documentFrequency[term];
+    }
+    m_documentTerms.insert (key, terms);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void KeywordExtractor::addTranscription (
+    const Transcription *script)
+{
+    if (script && !script->name ().isEmpty ())
+    {
+        addDocument (script->name (), script->text ());
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void KeywordExtractor::removeDocument (
+    const QString &key)
+{
+    QMutexLocker locker (&m_mutex);
+    removeDocumentLocked (key);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int KeywordExtractor::documentCount () const
+{
+    QMutexLocker locker (&m_mutex);
+    return int (m_documentTerms.size ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QStringList KeywordExtractor::suggest (
+    const QString &text, int count) const
+{
+    if (count <= 0)
+    {
+        return {};
+    }
+
+    //  1. Häufigkeit und Schreibweise jedes Stamms und jeder Zwei-Wort-Phrase zählen.
+    const QList<Token> tokens = analyze (text);
+    QHash<QString, Candidate> terms;
+    QHash<QString, Candidate> phrases;
+    bool caseInfo = false;
+    for (int i = 0; i < tokens.size (); ++i)
+    {
+        const Token &token = tokens[i];
+        if (token.stem.isEmpty ())
+        {
+            continue;
+        }
+
+        Candidate &term = terms[token.stem];
+        if (term.count == 0)
+        {
+            term.stems = {token.stem};
+        }
+        ++term.count;
+        ++term.forms[token.text];
+        if (!token.sentenceStart)
+        {
+            ++(token.capitalized ? term.upper : term.lower);
+        }
+        caseInfo = caseInfo || token.capitalized;
+
+        //  Eine Phrase besteht aus zwei direkt aufeinanderfolgenden Nicht-Stoppwörtern;
+        //  das zweite (der Kopf, meist ein Substantiv) entscheidet über die Wortart.
+        if (i > 0 && token.joined && !tokens[i - 1].stem.isEmpty ())
+        {
+            const Token &previous = tokens[i - 1];
+            Candidate &phrase = phrases[previous.stem + ' ' + token.stem];
+            if (phrase.count == 0)
+            {
+                phrase.stems = {previous.stem, token.stem};
+            }
+            ++phrase.count;
+            ++phrase.forms[previous.text + ' ' + token.text];
+            if (!token.sentenceStart)
+            {
+                ++(token.capitalized ? phrase.upper : phrase.lower);
+            }
+        }
+    }
+
+    //  2. Bewertung: logarithmische Häufigkeit im Text mal Seltenheit im Korpus.
+    QList<Ranked> ranked;
+    {
+        QMutexLocker locker (&m_mutex);
+        for (auto it = terms.cbegin (); it != terms.cend (); ++it)
+        {
+            if (caseInfo && !it->isNoun ())
+            {
+                continue;
+            }
+            const double score = (1.0 + std::log (double (it->count))) * idf (it.key ());
+            ranked.append ({score, &it.value ()});
+        }
+        for (auto it = phrases.cbegin (); it != phrases.cend (); ++it)
+        {
+            if (it->count < MinPhraseCount || (caseInfo && !it->isNoun ()))
+            {
+                continue;
+            }
+            const double weight = (idf (it->stems[0]) + idf (it->stems[1])) / 2.0;
+            const double score = (1.0 + std::log (double (it->count))) * weight * PhraseWeight;
+            ranked.append ({score, &it.value ()});
+        }
+    }
+
+    std::sort (ranked.begin (),
+               ranked.end (),
+               [] (const Ranked &a, const Ranked &b)
+               {
+                   if (a.first != b.first)
+                   {
+                       return a.first > b.first;
+                   }
+                   return a.second->stems < b.second->stems;
+               });
+
+    //  3. Die besten Begriffe übernehmen; Wörter einer bereits gewählten Phrase entfallen.
+    QStringList result;
+    QSet<QString> covered;
+    for (const auto &entry : std::as_const (ranked))
+    {
+        if (result.size () >= count)
+        {
+            break;
+        }
+
+        const Candidate &candidate = *entry.second;
+        if (candidate.stems.size () == 1 && covered.contains (candidate.stems[0]))
+        {
+            continue;
+        }
+
+        const QString display = mostFrequentForm (candidate.forms);
+        if (!result.contains (display, Qt::CaseInsensitive))
+        {
+            result.append (display);
+            for (const QString &stem : candidate.stems)
+            {
+                covered.insert (stem);
+            }
+        }
+    }
+
+    result.sort ();
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QStringList KeywordExtractor::suggestForSegment (
+    const MetaText &segment, int count) const
+{
+    return suggest (segment.Text, count);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QStringList KeywordExtractor::suggestForTranscription (
+    const Transcription *script, int count) const
+{
+    return script ? suggest (script->text (), count) : QStringList ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString KeywordExtractor::stem (
+    const QString &word)
+{
+    //  CISTEM ohne Beachtung der Großschreibung, damit "Projekt" und "projekt" denselben
+    //  Stamm erhalten. Mehrbuchstabige Laute und Doppelbuchstaben werden vorübergehend durch
+    //  Platzhalter ersetzt, damit das Abschneiden der Endungen sie nicht zerreißt.
+    QString w = word.toLower ();
+    w.replace (QChar (0x00FC), QChar ('u'));  //  ü
+    w.replace (QChar (0x00F6), QChar ('o'));  //  ö
+    w.replace (QChar (0x00E4), QChar ('a'));  //  ä
+    w.replace (QChar (0x00DF), QStringLiteral ("ss"));
+    w.replace (QStringLiteral ("sch"), QStringLiteral ("$"));
+    w.replace (QStringLiteral ("ei"), QStringLiteral ("%"));
+    w.replace (QStringLiteral ("ie"), QStringLiteral ("&"));
+    for (int i = 1; i < w.size (); ++i)
+    {
+        if (w[i] == w[i - 1])
+        {
+            w[i] = QChar ('*');
+        }
+    }
+
+    while (w.size () > 3)
+    {
+        if (w.size () > 5 && (w.endsWith ("em") || w.endsWith ("er") || w.endsWith ("nd")))
+        {
+            w.chop (2);
+            continue;
+        }
+        if (w.endsWith ('t') || w.endsWith ('e') || w.endsWith ('s') || w.endsWith ('n'))
+        {
+            w.chop (1);
+            continue;
+        }
+        break;
+    }
+
+    for (int i = 1; i < w.size (); ++i)
+    {
+        if (w[i] == QChar ('*'))
+        {
+            w[i] = w[i - 1];
+        }
+    }
+    w.replace (QStringLiteral ("&"), QStringLiteral ("ie"));
+    w.replace (QStringLiteral ("%"), QStringLiteral ("ei"));
+    w.replace (QStringLiteral ("$"), QStringLiteral ("sch"));
+    return w;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool KeywordExtractor::isStopWord (
+    const QString &lowerWord)
+{
+    return stopWords ().contains (lowerWord);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QList<KeywordExtractor::Token> KeywordExtractor::analyze (
+    const QString &text)
+{
+    QList<Token> tokens;
+    bool sentenceStart = true;
+    bool joined = false;
+
+    const int n = int (text.size ());
+    int i = 0;
+    while (i < n)
+    {
+        const QChar c = text[i];
+        if (!c.isLetter ())
+        {
+            //  Satzende beginnt einen neuen Satz, jedes andere Zeichen außer Leerraum
+            //  (Komma, Ziffern, Klammern) trennt zumindest eine Phrase.
+            if (c == '.' || c == '!' || c == '?' || c == ':')
+            {
+                sentenceStart = true;
+                joined = false;
+            }
+            else if (!c.isSpace ())
+            {
+                joined = false;
+            }
+            ++i;
+            continue;
+        }
+
+        //  Ein Wort besteht aus Buchstaben und Bindestrichen zwischen Buchstaben ("E-Mail").
+        const int start = i;
+        while (i < n
+               && (text[i].isLetter () || (text[i] == '-' && i + 1 < n && text[i + 1].isLetter ())))
+        {
+            ++i;
+        }
+
+        Token token;
+        token.text = text.mid (start, i - start);
+        token.sentenceStart = sentenceStart;
+        token.capitalized = !sentenceStart && token.text[0].isUpper ();
+        token.joined = joined;
+
+        //  Kurze Wörter sind nur als Abkürzung ("EU", "KI") interessant.
+        const bool acronym = token.text.size () == 2 && token.text == token.text.toUpper ();
+        if ((token.text.size () >= MinWordLength || acronym) && !isStopWord (token.text.toLower ()))
+        {
+            token.stem = acronym ? token.text.toLower () : stem (token.text);
+        }
+        tokens.append (token);
+
+        //  Ein Stoppwort (leerer Stamm) unterbricht eine Phrase.
+        sentenceStart = false;
+        joined = !token.stem.isEmpty ();
+    }
+    return tokens;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double KeywordExtractor::idf (
+    const QString &stem) const
+{
+    //  Geglättete inverse Dokumenthäufigkeit; ohne Korpus ist das Gewicht für alle Stämme 1.
+    const double documents = double (m_documentTerms.size ());
+    const double frequency = double (m_documentFrequency.value (stem));
+    return std::log ((1.0 + documents) / (1.0 + frequency)) + 1.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void KeywordExtractor::removeDocumentLocked (
+    const QString &key)
+{
+    const auto it = m_documentTerms.constFind (key);
+    if (it == m_documentTerms.cend ())
+    {
+        return;
+    }
+
+    for (const QString &term : *it)
+    {
+        if (--m_documentFrequency[term] <= 0)
+        {
+            m_documentFrequency.remove (term);
+        }
+    }
+    m_documentTerms.erase (it);
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
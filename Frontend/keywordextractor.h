@@ -0,0 +1,113 @@
+/**
+ * @file keywordextractor.h
+ * @brief Enthält die Deklaration des KeywordExtractor für Tag-Vorschläge ohne Python.
+ * @author Mike Wild
+ */
+#ifndef KEYWORDEXTRACTOR_H
+#define KEYWORDEXTRACTOR_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+struct MetaText;
+class Transcription;
+
+/**
+ * @brief Schlägt Tags für deutsche Texte per TF-IDF vor, direkt im Prozess und in Millisekunden.
+ *
+ * Die schnelle Alternative zu spaCy (tag_worker.py): Der Text wird in Wörter zerlegt,
+ * Stoppwörter (inkl. typischer Füllwörter gesprochener Sprache) werden verworfen und die
+ * übrigen Wörter mit einem leichten Stemmer (CISTEM) auf einen Stamm zurückgeführt. Jeder Stamm
+ * wird nach seiner Häufigkeit im Text und seiner Seltenheit im Korpus bewertet; angezeigt wird
+ * die häufigste Schreibweise. Wie bei spaCy kommen nur Substantive in Frage, erkannt an der
+ * Großschreibung innerhalb eines Satzes (ist der Text durchgehend kleingeschrieben, entfällt
+ * dieser Filter). Zusätzlich werden wiederkehrende Zwei-Wort-Phrasen ("künstliche Intelligenz")
+ * vorgeschlagen.
+ *
+ * Der Korpus besteht aus allen Meetings, die der DatabaseManager geladen oder gespeichert
+ * hat, und wächst mit jedem neuen Meeting (addDocument()). Ohne Korpus zählt nur die
+ * Häufigkeit im Text. Die gemeinsame Instanz shared() ist threadsicher.
+ */
+class KeywordExtractor
+{
+public:
+    static constexpr int MeetingTags = 10; ///< Vorschläge für ein ganzes Transkript.
+    static constexpr int SegmentTags = 3;  ///< Vorschläge für ein einzelnes Segment.
+
+    KeywordExtractor () = default;
+
+    /** @brief Gibt den anwendungsweiten Korpus zurück. */
+    static KeywordExtractor &shared ();
+
+    /**
+     * @brief Nimmt ein Dokument in den Korpus auf bzw. ersetzt es.
+     * @param key Eindeutiger Schlüssel, z.B. der Titel des Meetings.
+     * @param text Der Text des Dokuments.
+     */
+    void addDocument (const QString &key, const QString &text);
+
+    /** @brief Nimmt ein Transkript unter seinem Namen in den Korpus auf bzw. ersetzt es. */
+    void addTranscription (const Transcription *script);
+
+    /** @brief Entfernt ein Dokument aus dem Korpus. */
+    void removeDocument (const QString &key);
+
+    /** @brief Gibt die Anzahl der Dokumente im Korpus zurück. */
+    int documentCount () const;
+
+    /**
+     * @brief Schlägt die wichtigsten Begriffe eines Textes vor.
+     * @param text Der Text.
+     * @param count Höchstzahl der Vorschläge.
+     * @return Die Vorschläge, alphabetisch sortiert.
+     */
+    QStringList suggest (const QString &text, int count) const;
+
+    /** @brief Schlägt Tags für ein einzelnes Segment vor. */
+    QStringList suggestForSegment (const MetaText &segment, int count = SegmentTags) const;
+
+    /** @brief Schlägt Tags für ein ganzes Transkript vor. */
+    QStringList suggestForTranscription (const Transcription *script,
+                                         int count = MeetingTags) const;
+
+    /**
+     * @brief Führt ein deutsches Wort auf seinen Stamm zurück (CISTEM, Weißgerber & Weiss 2017).
+     *
+     * Die Großschreibung wird nicht beachtet. Der Stamm ist nur ein Schlüssel zum Zusammenfassen
+     * von Wortformen ("Projekte", "Projekten" → "projek") und nicht zur Anzeige gedacht.
+     */
+    static QString stem (const QString &word);
+
+    /** @brief Gibt an, ob ein (kleingeschriebenes) Wort ein Stoppwort ist. */
+    static bool isStopWord (const QString &lowerWord);
+
+private:
+    /** @brief Ein Wort des analysierten Textes. */
+    struct Token
+    {
+        QString text;               ///< Das Wort in Originalschreibweise.
+        QString stem;               ///< Der Stamm (leer bei Stoppwörtern).
+        bool capitalized = false;   ///< Großgeschrieben, ohne am Satzanfang zu stehen.
+        bool sentenceStart = false; ///< Steht am Satzanfang.
+        bool joined = false;        ///< Folgt direkt auf ein Nicht-Stoppwort (ohne Satzzeichen).
+    };
+
+    /** @brief Zerlegt einen Text in Wörter und bestimmt ihre Stämme. */
+    static QList<Token> analyze (const QString &text);
+
+    /** @brief Gewicht eines Stamms nach seiner Seltenheit im Korpus (Sperre muss gehalten werden). */
+    double idf (const QString &stem) const;
+
+    /** @brief Entfernt ein Dokument aus dem Korpus (Sperre muss gehalten werden). */
+    void removeDocumentLocked (const QString &key);
+
+    mutable QMutex m_mutex;                        ///< Schützt den Korpus.
+    QHash<QString, int> m_documentFrequency;       ///< Anzahl der Dokumente je Stamm.
+    QHash<QString, QSet<QString>> m_documentTerms; ///< Stämme je Dokument (für das Ersetzen).
+};
+
+#endif // KEYWORDEXTRACTOR_H
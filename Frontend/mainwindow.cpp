@@ -8,6 +8,7 @@
 #include <QDir>
 #include <QFile>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QInputDialog>
 #include <QLabel>
 #include <QLineEdit>
@@ -16,6 +17,7 @@
 #include <QPalette>
 #include <QProcess>
 #include <QPushButton>
+#include <QSettings>
 #include <QSplitter>
 #include <QSqlError>
 #include <QSqlQuery>
@@ -27,6 +29,8 @@
 #include "audiofactory.h"
 #include "capturethread.h"
 #include "databasemanager.h"
+#include "jobqueuedialog.h"
+#include "jobscheduler.h"
 #include "multisearchdialog.h"
 #include "pythonenvironmentmanager.h"
 #include "searchdialog.h"
@@ -45,6 +49,7 @@ MainWindow::MainWindow (QWidget *parent)
     , leftPanel (new QWidget (this))
     , searchBox (new QLineEdit (this))
     , meetingList (new QListWidget (this))
+    , sessionList (new QListWidget (this))
     , rightPanel (new QWidget (this))
     , mainLayout (new QVBoxLayout)
     , buttonLayout (new QHBoxLayout)
@@ -59,7 +64,6 @@ MainWindow::MainWindow (QWidget *parent)
     , toggleButton (new QPushButton (tr ("Transkript umschalten"), this))
     , multiSearchButton (new QPushButton (tr ("Suche in allen Transkripten"), this))
     , transcriptView (new QTextEdit (this))
-    , pollTimer (new QTimer (this))
     , statusTimer (new QTimer (this))
     , pluginProcess (new QProcess (this))
     , timeUpdateTimer (new QTimer (this))
@@ -68,12 +72,15 @@ MainWindow::MainWindow (QWidget *parent)
     , m_captureThread (AudioFactory::createThread (this))
     , m_wavWriter (new WavWriterThread (this))
     , m_fileManager (new FileManager (this))
-    , m_asrManager (new AsrProcessManager (this))
     , m_tagGenerator (new TagGeneratorManager (this))
     , m_textEditorDialog (nullptr)
     , m_databaseManager (new DatabaseManager (this))
+    , m_jobScheduler (new JobScheduler (m_fileManager->jobQueuePath (), this))
     , m_searchDialog (new SearchDialog (this))
     , m_multiSearchDialog (new MultiSearchDialog (this))
+    , m_jobQueueDialog (nullptr)
+    , m_recordingSession (nullptr)
+    , m_shownSession (nullptr)
 {
     //  Konfiguriert den Timer, der Statusnachrichten nach 3 Sekunden automatisch ausblendet.
     statusTimer->setSingleShot (true);
@@ -82,6 +89,12 @@ MainWindow::MainWindow (QWidget *parent)
     //  Initialisiert die Benutzeroberfläche und lädt gespeicherte Meetings.
     setupUI ();
 
+    // Hinweise des DatabaseManagers anzeigen (er selbst kennt keine Oberfläche)
+    connect (m_databaseManager,
+             &DatabaseManager::notice,
+             this,
+             [this] (const QString &message) { QMessageBox::warning (this, "Hinweis", message); });
+
     // Datenbank-Verbindung versuchen
     if (!m_databaseManager->connectToSupabase ())
     {
@@ -116,6 +129,9 @@ MainWindow::MainWindow (QWidget *parent)
     assignNamesButton->setEnabled (false);
     editTextButton->setEnabled (false);
 
+    //  Gains und DSP-Kette werden vor dem Start aus den Einstellungen übernommen.
+    applyAudioSettings ();
+
     //  Die Hintergrund-Threads für die Aufnahme werden direkt gestartet.
     //  Sie gehen sofort in einen Wartezustand, bis startCapture() bzw. startWriting() aufgerufen wird.
     m_captureThread->start ();
@@ -214,6 +230,8 @@ void MainWindow::setupUI ()
     searchBox->setPlaceholderText (tr ("Suchen..."));
     leftLayout->addWidget (searchBox);
     leftLayout->addWidget (meetingList);
+    leftLayout->addWidget (new QLabel (tr ("Aufnahmen dieser Sitzung:"), this));
+    leftLayout->addWidget (sessionList);
     leftPanel->setLayout (leftLayout);
 
     //  Rechtes Panel: Steuerelemente und Transkript-Anzeige
@@ -286,6 +304,10 @@ void MainWindow::setupUI ()
     m_actionClose = new QAction (tr ("Beenden"), this);
     m_actionSetMeetingName = new QAction (tr ("Meetingname setzen..."), this);
     m_reinstallPythonAction = new QAction (tr ("Python neu-installieren"), this);
+    m_backfillAction = new QAction (tr ("Aufnahmen nachträglich transkribieren..."), this);
+    m_backfillTagsAction = new QAction (tr ("Tags für Transkripte erzeugen..."), this);
+    m_retranscribeAction = new QAction (tr ("Aufnahme neu transkribieren"), this);
+    m_jobQueueAction = new QAction (tr ("Auftragswarteschlange..."), this);
 
     //  Standard-Tastenkürzel für die Aktionen festlegen
     m_actionOpen->setShortcut (QKeySequence::Open);
@@ -322,6 +344,11 @@ void MainWindow::setupUI ()
     menuExtras->addAction (m_actionSetMeetingName);
     menuExtras->addAction (m_settingsAction);
     menuExtras->addAction (m_reinstallPythonAction);
+    menuExtras->addSeparator ();
+    menuExtras->addAction (m_retranscribeAction);
+    menuExtras->addAction (m_backfillAction);
+    menuExtras->addAction (m_backfillTagsAction);
+    menuExtras->addAction (m_jobQueueAction);
 
     //  Die Aktionen der Menüeinträge mit den entsprechenden Slots verbinden.
     //  Diese Verbindungen werden in der doConnects()-Methode gebündelt.
@@ -344,6 +371,7 @@ void MainWindow::doConnects ()
     connect (editTextButton, &QPushButton::clicked, this, &MainWindow::onEditTranscript);
     connect (generateTagsButton, &QPushButton::clicked, this, &MainWindow::onGenerateTags);
     connect (meetingList, &QListWidget::itemDoubleClicked, this, &MainWindow::onMeetingSelected);
+    connect (sessionList, &QListWidget::itemDoubleClicked, this, &MainWindow::onSessionSelected);
     connect (searchBox, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
     connect (searchButton, &QPushButton::clicked, this, &MainWindow::onSearchButtonClicked);
     connect (multiSearchButton, &QPushButton::clicked, this, &MainWindow::openMultiSearchDialog);
@@ -368,17 +396,18 @@ void MainWindow::doConnects ()
     connect (m_actionSetMeetingName, &QAction::triggered, this, &MainWindow::onSetMeetingName);
     connect (m_settingsAction, &QAction::triggered, this, &MainWindow::openSettingsWizard);
     connect (m_reinstallPythonAction, &QAction::triggered, this, &MainWindow::onReinstallPython);
+    connect (m_retranscribeAction, &QAction::triggered, this, &MainWindow::onRetranscribe);
+    connect (m_backfillAction, &QAction::triggered, this, &MainWindow::onBackfillTranscription);
+    connect (m_backfillTagsAction, &QAction::triggered, this, &MainWindow::onBackfillTags);
+    connect (m_jobQueueAction, &QAction::triggered, this, &MainWindow::openJobQueue);
 
     //  --- 2. Asynchrone Logik-Ketten (State Machine via Signals & Slots) ---
 
     //  A. Audio-Daten-Pipeline: CaptureThread -> WavWriterThread
-    //  Der CaptureThread sendet Daten, der Writer-Thread empfängt und schreibt sie.
-    //  Qt::QueuedConnection ist wichtig für die Thread-sichere Kommunikation.
-    connect (m_captureThread,
-             &CaptureThread::pcmChunkReady,
-             m_wavWriter,
-             &WavWriterThread::writeChunk,
-             Qt::QueuedConnection);
+    //  Der CaptureThread veröffentlicht Blöcke auf seinem AudioBus, der Writer-Thread
+    //  liest sie lock-frei als eigener Consumer. Es werden keine Audiodaten mehr über
+    //  die Event-Loop kopiert.
+    m_wavWriter->setAudioSource (m_captureThread->audioBus ());
 
     //  B. Aufnahme-Start-Logik: UI-Reaktion auf den Start des CaptureThreads.
     connect (m_captureThread,
@@ -399,16 +428,52 @@ void MainWindow::doConnects ()
              [this] ()
              {
                  m_wavWriter->stopWriting ();
+
+                 //  Die Aufnahme kann sich auch selbst beenden (z.B. am Dateiende des
+                 //  Replay-Backends), daher wird die UI auch hier zurückgesetzt. Eine neue
+                 //  Aufnahme ist erst möglich, wenn der WavWriter die Dateien geschlossen hat.
+                 timeUpdateTimer->stop ();
+                 stopButton->setEnabled (false);
                  setStatus ("Aufnahme beendet, speichere und verarbeite...", true);
              });
 
     //  D. Verarbeitungs-Logik (Kette 2): WavWriterThread -> ASR-Prozess
-    //  Wenn der WavWriter fertig ist, wird der ASR-Prozess angestoßen.
+    //  Wenn der WavWriter fertig ist, wird der ASR-Prozess der Sitzung angestoßen; ab
+    //  dann kann bereits die nächste Aufnahme beginnen.
     connect (m_wavWriter, &WavWriterThread::finishedWriting, this, &MainWindow::processAudio);
     connect (m_wavWriter,
              &WavWriterThread::finishedWriting,
              this,
-             [=] () { saveAudioButton->setEnabled (true); });
+             [=] ()
+             {
+                 saveAudioButton->setEnabled (true);
+                 startButton->setEnabled (true);
+             });
+
+    //  E. Live-Transkription: WavWriterThread -> ASR-Worker der aufnehmenden Sitzung
+    //  Während der Aufnahme gehen die ASR-Samples direkt an den laufenden Stream.
+    connect (m_wavWriter,
+             &WavWriterThread::asrAudioReady,
+             this,
+             [this] (const QByteArray &pcm16)
+             {
+                 if (m_recordingSession)
+                 {
+                     m_recordingSession->asr ()->appendStreamAudio (pcm16);
+                 }
+             });
+
+    //  Im segmentierten Modus werden abgeschlossene Teildateien sofort transkribiert.
+    connect (m_wavWriter,
+             &WavWriterThread::segmentCompleted,
+             this,
+             [this] (const QString &path, double offsetSeconds)
+             {
+                 if (m_recordingSession)
+                 {
+                     m_recordingSession->asr ()->addSegment (path, offsetSeconds);
+                 }
+             });
 
     //  --- 3. Timer und Datenmodell-Synchronisation ---
 
@@ -441,26 +506,10 @@ void MainWindow::doConnects ()
 
     //  --- 4. Manager-Verbindungen ---
 
-    //  H. ASR-Manager: Verarbeitet die Ergebnisse des ASR-Prozesses.
-    connect (m_asrManager, &AsrProcessManager::segmentReady, m_script, &Transcription::add);
-    connect (m_asrManager,
-             &AsrProcessManager::finished,
-             this,
-             [this] (bool success, const QString &errorMsg)
-             {
-                 if (success)
-                 {
-                     setStatus ("Verarbeitung beendet");
-                     updateUiForCurrentMeeting ();
-                 }
-                 else
-                 {
-                     setStatus ("Verarbeitung fehlgeschlagen");
-                     QMessageBox::warning (this, tr ("ASR-Fehler"), errorMsg);
-                 }
-             });
+    //  H. ASR-Manager: Die Ergebnisse jeder Aufnahme verarbeitet deren RecordingSession;
+    //  die Verbindungen zur UI entstehen in createSession().
 
-    //  I. Tag-Generator: Verarbeitet die Ergebnisse der Tag-Analyse.
+    //  I. Tag-Generator: Verarbeitet die Ergebnisse der Tag-Analyse geladener Meetings.
     connect (m_tagGenerator,
              &TagGeneratorManager::tagsReady,
              this,
@@ -480,6 +529,38 @@ void MainWindow::doConnects ()
                  }
                  generateTagsButton->setEnabled (true);
              });
+
+    //  J. Auftragswarteschlange: Neu-Transkriptionen gehen an ihre Sitzung zurück, alle
+    //  anderen Ergebnisse liegen als JSON neben der Aufnahme.
+    connect (m_jobScheduler,
+             &JobScheduler::jobFinished,
+             this,
+             [this] (const SchedulerJob &job)
+             {
+                 RecordingSession *session = m_sessionJobs.take (job.id);
+                 if (session && m_sessions.contains (session))
+                 {
+                     if (job.state == SchedulerJob::State::Finished)
+                     {
+                         QFile file (job.output);
+                         if (file.open (QIODevice::ReadOnly))
+                         {
+                             session->script ()->fromJson (file.readAll ());
+                         }
+                     }
+                     session->setState (job.state == SchedulerJob::State::Finished
+                                            ? RecordingSession::State::Finished
+                                            : RecordingSession::State::Failed);
+                     if (session == m_shownSession)
+                     {
+                         updateUiForCurrentMeeting ();
+                     }
+                 }
+                 setStatus (QString ("%1 %2: %3")
+                                .arg (job.kindText (),
+                                      QFileInfo (job.input).fileName (),
+                                      job.stateText ()));
+             });
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -515,10 +596,10 @@ void MainWindow::updateUiForCurrentMeeting ()
     editTextButton->setEnabled (meetingLoaded);
     generateTagsButton->setEnabled (meetingLoaded);
 
-    //  Der Button zum Speichern der .wav-Datei wird hier pauschal deaktiviert,
-    //  da für ein aus einer Datei geladenes Meeting die temporäre .wav-Datei nicht mehr existiert.
-    //  Er wird nur nach einer Neuaufnahme explizit aktiviert.
-    saveAudioButton->setEnabled (false);
+    //  Der Button zum Speichern der Aufnahme ist nur für eine angezeigte Sitzung mit
+    //  abgeschlossener Aufnahme aktiv; für ein geladenes Meeting existiert keine Aufnahme.
+    saveAudioButton->setEnabled (m_shownSession && m_shownSession != m_recordingSession
+                                 && QFile::exists (m_shownSession->hqPath ()));
 
     if (meetingLoaded)
     {
@@ -589,19 +670,62 @@ void MainWindow::onSearchButtonClicked ()
 
 void MainWindow::processAudio ()
 {
+    //  Die Aufnahme der Sitzung ist vollständig geschrieben; ab hier läuft ihre Verarbeitung
+    //  im Hintergrund weiter, auch wenn inzwischen eine neue Aufnahme beginnt.
+    RecordingSession *session = m_recordingSession;
+    m_recordingSession = nullptr;
+    if (!session)
+    {
+        return;
+    }
+    session->setHqPath (m_wavWriter->hqFilePath ());
+    session->setState (RecordingSession::State::Transcribing);
+    AsrProcessManager *asr = session->asr ();
+
+    //  Bei der Live-Transkription liegt der Großteil des Texts bereits vor; es fehlen nur
+    //  das letzte Fenster und die Sprecherzuordnung.
+    if (asr->isStreaming ())
+    {
+        setStatus ("Live-Transkription wird abgeschlossen … - bitte warten", true);
+        asr->endStream (session->asrPath ());
+        return;
+    }
+
+    //  Bei Teildateien wurde bereits während der Aufnahme transkribiert; es fehlen die
+    //  letzte Teildatei und die Sprecherzuordnung.
+    if (asr->isSegmenting ())
+    {
+        setStatus ("Teildateien werden abgeschlossen … - bitte warten", true);
+        asr->endSegments (session->asrPath ());
+        return;
+    }
+
     setStatus ("wird verarbeitet … - bitte warten", true);
 
     //  Bewahrt die Metadaten der aktuellen Aufnahme (Name, Datum), bevor das
     //  Transkript-Objekt für die neuen ASR-Ergebnisse geleert wird.
-    auto nam = m_script->name ();
-    auto dat = m_script->dateTime ();
-    m_script->clear ();
-    m_script->setName (nam);
-    m_script->setDateTime (dat);
+    Transcription *script = session->script ();
+    auto nam = script->name ();
+    auto dat = script->dateTime ();
+    script->clear ();
+    script->setName (nam);
+    script->setDateTime (dat);
+
+    //  Gibt den Startschuss an den ASR-Manager, die Verarbeitung zu beginnen. Hat der
+    //  WavWriter eine auf die Sprachbereiche verkürzte Datei erstellt, wird nur diese
+    //  transkribiert; die Zeitstempel werden über die Timeline zurückgerechnet.
+    const QString speechWavPath = m_wavWriter->speechWavPath ();
+    if (!speechWavPath.isEmpty ())
+    {
+        const SpeechTimeline timeline = m_wavWriter->speechTimeline ();
+        setStatus (QString ("wird verarbeitet (Sprachanteil %1 %) … - bitte warten")
+                       .arg (qRound (timeline.speechRatio () * 100.0)),
+                   true);
+        asr->startTranscription (speechWavPath, timeline);
+        return;
+    }
 
-    //  Gibt den Startschuss an den ASR-Manager, die Verarbeitung zu beginnen.
-    QString asrWavPath = m_fileManager->getTempWavPath (true);
-    m_asrManager->startTranscription (asrWavPath);
+    asr->startTranscription (session->asrPath ());
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -612,6 +736,23 @@ void MainWindow::openSettingsWizard ()
     //  dlg.exec() öffnet den Dialog modal, d.h. der Code pausiert hier,
     //  bis der Benutzer den Dialog schließt.
     dlg.exec ();
+
+    //  Geänderte Gains bzw. DSP-Einstellungen wirken sofort, auch während einer Aufnahme.
+    applyAudioSettings ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::applyAudioSettings ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    m_captureThread->setGains (settings.value ("sysGain", 0.5f).toFloat (),
+                               settings.value ("micGain", 6.0f).toFloat ());
+
+    const float highPassHz = settings.value ("audio/highPassHz", 0).toFloat ();
+    m_captureThread->setHighPass (highPassHz > 0.0f, highPassHz);
+    m_captureThread->setLimiter (settings.value ("audio/limiter", false).toBool (),
+                                 settings.value ("audio/limiterThreshold", 0.9f).toFloat ());
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -766,6 +907,7 @@ void MainWindow::loadTranscriptionFromJson ()
         return;
     }
 
+    detachShownSession ();
     if (m_script->fromJson (doc.toJson ()))
     {
         //  Versucht, Name und Datum aus dem Dateinamen zu extrahieren,
@@ -833,6 +975,9 @@ void MainWindow::restoreOriginalTranscription ()
 
 void MainWindow::loadMeetingTranscription(const QString &meetingTitle, const QString &textColumn)
 {
+    //  Eine angezeigte Aufnahme behält ihr Transkript in ihrer Sitzung.
+    detachShownSession ();
+
     // Transkript aus der Datenbank laden
     m_databaseManager->loadMeetingTranscriptions(meetingTitle, textColumn, m_script);
     // UI aktualisieren
@@ -1083,15 +1228,38 @@ void MainWindow::onStartClicked ()
     editTextButton->setEnabled (false);
     generateTagsButton->setEnabled (false);
 
-    //  2. Eventuell laufende Hintergrundprozesse der vorherigen Aufnahme beenden.
-    m_asrManager->stop ();
+    //  2. Neue Sitzung mit eigenem Verzeichnis anlegen. Die vorherige Aufnahme wird dabei
+    //  nicht abgebrochen: Ihre Transkription läuft in ihrer Sitzung im Hintergrund weiter.
+    RecordingSession *session = createSession ();
+    if (!session)
+    {
+        startButton->setEnabled (true);
+        stopButton->setEnabled (false);
+        setStatus ("Aufnahmeverzeichnis konnte nicht angelegt werden");
+        return;
+    }
+    m_recordingSession = session;
 
-    //  3. Datenmodell für die neue Aufnahme zurücksetzen.
+    //  3. Datenmodell für die neue Aufnahme zurücksetzen; das bisher angezeigte Transkript
+    //  geht vorher an seine Sitzung zurück.
+    detachShownSession ();
     m_script->clear ();
+    session->attach (m_script);
+    m_shownSession = session;
 
     //  4. Threads für das Schreiben der .wav-Dateien und die Audio-Aufnahme starten.
-    m_wavWriter->startWriting (m_fileManager->getTempWavPath (false),
-                               m_fileManager->getTempWavPath (true));
+    //  Läuft der ASR-Worker, wird schon während der Aufnahme transkribiert: live oder,
+    //  wenn "audio/segmentMinutes" gesetzt ist, in abgeschlossenen Teildateien.
+    AsrProcessManager *asr = session->asr ();
+    const bool streaming = asr->beginStream ();
+    const int segmentMinutes = QSettings ("SS2025FP_T2", "AudioTranskriptor")
+                                   .value ("audio/segmentMinutes", 0)
+                                   .toInt ();
+    const bool segmented = !streaming && segmentMinutes > 0 && asr->beginSegments ();
+    m_wavWriter->startWriting (session->hqPath (),
+                               session->asrPath (),
+                               streaming,
+                               segmented ? segmentMinutes : 0);
     m_captureThread->startCapture ();
 
     //  5. Metadaten für das neue Meeting setzen.
@@ -1104,10 +1272,6 @@ void MainWindow::onStartClicked ()
     m_script->setName (m_currentMeetingName);
     m_script->setDateTime (dt);
     nameLabel->setText (currentName ());
-
-    //  Poll-Timer starten, damit onPollTranscripts() regelmäßig aufgerufen wird
-    //  Das ist nur zu Demonstrationszwecken bis die Echtzeit-Transkribierung erfolgt
-    pollTimer->start (500);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1115,50 +1279,47 @@ void MainWindow::onStartClicked ()
 void MainWindow::onStopClicked ()
 {
     //  Beendet alle Prozesse, die mit der aktiven Aufnahme zusammenhängen.
-    pollTimer->stop ();
     m_captureThread->stopCapture ();
     timeUpdateTimer->stop ();
 
-    //  Setzt die UI in den "gestoppt"-Zustand.
+    //  Setzt die UI in den "gestoppt"-Zustand. Der Start-Button wird wieder aktiv,
+    //  sobald der WavWriter die Dateien geschlossen hat (finishedWriting).
     stopButton->setEnabled (false);
-    startButton->setEnabled (true);
-}
-
-//--------------------------------------------------------------------------------------------------
-
-void MainWindow::onPollTranscripts ()
-{
-    static int count;
-    QList<MetaText> bsp = {{timeLabel->text (), " ", "Sprecher 1", "Beispieltext"},
-                           {timeLabel->text (), " ", "Sprecher 2", "Weiterer Text"},
-                           {timeLabel->text (), " ", "Sprecher 3", "Bla bla bla."}};
-    count = ((count + 1) % bsp.length ());
-
-    m_script->add (bsp[count]);
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void MainWindow::onSaveAudio ()
 {
+    //  Die Aufnahme liegt je nach Einstellung als WAV oder FLAC vor. Gespeichert werden
+    //  kann in beiden Formaten, vorgeschlagen wird das der Aufnahme.
+    QString source = m_shownSession ? m_shownSession->hqPath () : m_wavWriter->hqFilePath ();
+    if (source.isEmpty ())
+    {
+        source = m_fileManager->getTempWavPath ();
+    }
+    const QString wavFilter = tr ("WAV-Datei (*.wav)");
+    const QString flacFilter = tr ("FLAC-Datei (*.flac)");
+    QString selectedFilter = source.endsWith (".flac", Qt::CaseInsensitive) ? flacFilter : wavFilter;
+
     QString path = QFileDialog::getSaveFileName (this,
                                                  tr ("Audio speichern"),
                                                  QString (),
-                                                 tr ("WAV-Datei (*.wav)"));
+                                                 wavFilter + ";;" + flacFilter,
+                                                 &selectedFilter);
     if (path.isEmpty ())
     {
         return;
     }
+    if (!path.endsWith (".wav", Qt::CaseInsensitive) && !path.endsWith (".flac", Qt::CaseInsensitive))
+    {
+        path += selectedFilter == flacFilter ? ".flac" : ".wav";
+    }
     m_currentAudioPath = path;
 
-    //  Das Kopieren der potenziell großen WAV-Datei wird in einen separaten Thread ausgelagert,
-    //  um ein Einfrieren der Benutzeroberfläche zu verhindern.
-    auto future = QtConcurrent::run (
-        [=] ()
-        {
-            QFile::remove (path);
-            return QFile::copy (m_fileManager->getTempWavPath (), path);
-        });
+    //  Das Kopieren bzw. Umwandeln der potenziell großen Datei wird in einen separaten
+    //  Thread ausgelagert, um ein Einfrieren der Benutzeroberfläche zu verhindern.
+    auto future = QtConcurrent::run ([=] () { return m_fileManager->exportAudio (source, path); });
 
     //  Ein QFutureWatcher wird verwendet, um auf das Ergebnis der asynchronen Operation zu reagieren.
     QFutureWatcher<bool> *watcher = new QFutureWatcher<bool> (this);
@@ -1313,12 +1474,371 @@ void MainWindow::onGenerateTags ()
         return;
     }
 
+    //  Eine eigene Aufnahme erzeugt ihre Tags in ihrer Sitzung, damit das Ergebnis auch
+    //  dann beim richtigen Transkript ankommt, wenn inzwischen ein anderes angezeigt wird.
+    if (m_shownSession)
+    {
+        if (!m_shownSession->generateTags ())
+        {
+            setStatus ("Die Aufnahme wird noch verarbeitet");
+            return;
+        }
+        generateTagsButton->setEnabled (false);
+        setStatus ("Generiere Tags, bitte warten...", true);
+        return;
+    }
+
     // Deaktiviere den Button, während die Analyse läuft
     generateTagsButton->setEnabled (false);
     setStatus ("Generiere Tags, bitte warten...", true);
 
     // Starte die Analyse
-    m_tagGenerator->generateTagsFor (m_script->text ());
+    m_tagGenerator->generateTagsFor (m_script);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::onSessionSelected (
+    QListWidgetItem *item)
+{
+    if (!item)
+    {
+        return;
+    }
+
+    const QString id = item->data (Qt::UserRole).toString ();
+    for (RecordingSession *session : std::as_const (m_sessions))
+    {
+        if (session->id () == id)
+        {
+            showSession (session);
+            return;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+RecordingSession *MainWindow::createSession ()
+{
+    //  Millisekunden und notfalls ein Zähler machen die Kennung eindeutig, auch wenn zwei
+    //  Aufnahmen in derselben Sekunde beginnen.
+    const QString stamp = QDateTime::currentDateTime ().toString ("yyyy-MM-dd_HH-mm-ss-zzz");
+    const QDir root (m_fileManager->sessionsDirectory ());
+    QString id = stamp;
+    for (int n = 2; root.exists (id); ++n)
+    {
+        id = QString ("%1_%2").arg (stamp).arg (n);
+    }
+    const QString directory = m_fileManager->createSessionDirectory (id);
+    if (directory.isEmpty ())
+    {
+        return nullptr;
+    }
+
+    //  Die Worker einer abgeschlossenen Sitzung werden samt geladener Modelle übernommen.
+    AsrProcessManager *asr = nullptr;
+    for (int i = m_sessions.size () - 1; i >= 0 && !asr; --i)
+    {
+        asr = m_sessions[i]->releaseAsr ();
+    }
+
+    RecordingSession *session = new RecordingSession (id,
+                                                      directory,
+                                                      m_fileManager->sessionWavPath (directory, false),
+                                                      m_fileManager->sessionWavPath (directory, true),
+                                                      asr,
+                                                      this);
+    m_sessions.append (session);
+
+    QListWidgetItem *item = new QListWidgetItem (sessionList);
+    item->setData (Qt::UserRole, id);
+    updateSessionItem (session);
+
+    connect (session,
+             &RecordingSession::stateChanged,
+             this,
+             [this, session] ()
+             {
+                 updateSessionItem (session);
+                 updateReservedSlots ();
+             });
+    connect (session,
+             &RecordingSession::streamInterrupted,
+             this,
+             [this] (const QString &errorMsg)
+             {
+                 //  Die Aufnahme läuft weiter und wird danach vollständig transkribiert.
+                 qWarning () << "MainWindow: Live-Transkription abgebrochen:" << errorMsg;
+                 setStatus ("Live-Transkription unterbrochen - Transkription folgt nach der Aufnahme",
+                            true);
+             });
+    connect (session,
+             &RecordingSession::transcriptionFinished,
+             this,
+             [this, session] (bool success, const QString &errorMsg)
+             {
+                 if (success)
+                 {
+                     setStatus (QString ("Verarbeitung von %1 beendet").arg (session->id ()));
+                     if (session == m_shownSession)
+                     {
+                         updateUiForCurrentMeeting ();
+                     }
+                 }
+                 else
+                 {
+                     setStatus (QString ("Verarbeitung von %1 fehlgeschlagen").arg (session->id ()));
+                     QMessageBox::warning (this, tr ("ASR-Fehler"), errorMsg);
+                 }
+                 cleanupSessions ();
+             });
+    connect (session,
+             &RecordingSession::tagsReady,
+             this,
+             [this, session] (const QStringList &tags, bool success, const QString &errorMsg)
+             {
+                 if (session != m_shownSession)
+                 {
+                     setStatus (success ? QString ("Tags für %1 erzeugt").arg (session->id ())
+                                        : QString ("Tags für %1 fehlgeschlagen").arg (session->id ()));
+                     return;
+                 }
+                 if (success)
+                 {
+                     QMessageBox::information (this,
+                                               "Generierte Tags",
+                                               "Folgende Tags wurden gefunden:\n\n"
+                                                   + tags.join ("\n"));
+                 }
+                 else
+                 {
+                     QMessageBox::warning (this, "Fehler bei der Tag-Erstellung", errorMsg);
+                 }
+                 generateTagsButton->setEnabled (true);
+             });
+
+    cleanupSessions ();
+    return session;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::showSession (
+    RecordingSession *session)
+{
+    if (session == m_shownSession)
+    {
+        return;
+    }
+
+    //  Der Stand der Sitzung wird übernommen; weitere Ergebnisse landen direkt in der Anzeige.
+    detachShownSession ();
+    m_script->fromJson (session->script ()->toJson ().toJson ());
+    session->attach (m_script);
+    m_shownSession = session;
+    m_currentMeetingName = m_script->name ();
+    m_currentMeetingDateTime = m_script->dateTime ().toString ("yyyy-MM-dd_HH-mm");
+    updateUiForCurrentMeeting ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::detachShownSession ()
+{
+    if (m_shownSession)
+    {
+        m_shownSession->detach ();
+        m_shownSession = nullptr;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::updateSessionItem (
+    RecordingSession *session)
+{
+    for (int i = 0; i < sessionList->count (); ++i)
+    {
+        QListWidgetItem *item = sessionList->item (i);
+        if (item->data (Qt::UserRole).toString () == session->id ())
+        {
+            item->setText (QString ("%1 - %2").arg (session->id (), session->stateText ()));
+            return;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::cleanupSessions ()
+{
+    //  Verzeichnisse laufender oder angezeigter Sitzungen bleiben in jedem Fall erhalten,
+    //  ebenso Sitzungen, deren Transkript noch nicht in der Datenbank gespeichert ist.
+    QStringList protectedDirectories;
+    for (RecordingSession *session : std::as_const (m_sessions))
+    {
+        if (session->isBusy () || session == m_shownSession || hasUnsavedTranscript (session))
+        {
+            protectedDirectories.append (session->directory ());
+        }
+    }
+
+    //  Aufträge der Warteschlange (auch aus einem früheren Programmlauf, ohne Sitzung)
+    //  brauchen ihre Ein- und Ausgabedateien noch.
+    const QList<SchedulerJob> jobs = m_jobScheduler->jobs ();
+    for (const SchedulerJob &job : jobs)
+    {
+        if (job.state == SchedulerJob::State::Queued || job.state == SchedulerJob::State::Running)
+        {
+            protectedDirectories << job.input << job.output;
+        }
+    }
+
+    const int keep = QSettings ("SS2025FP_T2", "AudioTranskriptor")
+                         .value ("audio/keepSessions", 5)
+                         .toInt ();
+    const QStringList removed = m_fileManager->cleanupSessions (keep, protectedDirectories);
+
+    //  Sitzungen, deren Verzeichnis gelöscht wurde, verschwinden auch aus der Liste.
+    for (int i = m_sessions.size () - 1; i >= 0; --i)
+    {
+        RecordingSession *session = m_sessions[i];
+        if (!removed.contains (session->directory ()))
+        {
+            continue;
+        }
+        for (int row = 0; row < sessionList->count (); ++row)
+        {
+            if (sessionList->item (row)->data (Qt::UserRole).toString () == session->id ())
+            {
+                delete sessionList->takeItem (row);
+                break;
+            }
+        }
+        m_sessions.removeAt (i);
+        session->deleteLater ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool MainWindow::hasUnsavedTranscript (
+    RecordingSession *session) const
+{
+    const Transcription *script = session->script ();
+    if (!script || script->getMetaTexts ().isEmpty ())
+    {
+        return false;
+    }
+
+    //  Gespeicherte Transkripte stehen unter ihrem Titel in m_transcriptions.
+    const Transcription *saved = m_transcriptions.value (script->name (), nullptr);
+    return !saved || !script->isContentEqual (saved);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::updateReservedSlots ()
+{
+    //  Aufnahmen, deren eigene ASR noch läuft, haben Vorrang vor Nachträgen in der Warteschlange.
+    int reserved = 0;
+    for (RecordingSession *session : std::as_const (m_sessions))
+    {
+        const bool asrBusy = session->state () == RecordingSession::State::Recording
+                             || session->state () == RecordingSession::State::Transcribing;
+        if (asrBusy && !m_sessionJobs.values ().contains (session))
+        {
+            ++reserved;
+        }
+    }
+    m_jobScheduler->setReservedSlots (reserved);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::onRetranscribe ()
+{
+    RecordingSession *session = m_shownSession;
+    if (!session || session->isBusy () || !QFile::exists (session->asrPath ()))
+    {
+        QMessageBox::information (this,
+                                  tr ("Neu transkribieren"),
+                                  tr ("Bitte zuerst eine abgeschlossene Aufnahme dieser Sitzung "
+                                      "anzeigen (Doppelklick in der Liste der Aufnahmen)."));
+        return;
+    }
+
+    //  Das aktuelle Transkript wird gesichert, damit der Auftrag Name und Datum übernimmt
+    //  und nach einem Neustart der Anwendung fortgesetzt werden kann.
+    const QString transcriptPath = QDir (session->directory ()).filePath ("transcript.json");
+    m_fileManager->saveJson (transcriptPath, session->script ()->toJson ());
+
+    const QString id = m_jobScheduler->submit (SchedulerJob::Kind::Retranscribe,
+                                               session->asrPath (),
+                                               transcriptPath,
+                                               SchedulerJob::Priority::Live);
+    m_sessionJobs.insert (id, session);
+    session->setState (RecordingSession::State::Transcribing);
+    setStatus ("Neu-Transkription eingereiht");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::onBackfillTranscription ()
+{
+    const QStringList files
+        = QFileDialog::getOpenFileNames (this,
+                                         tr ("Aufnahmen nachträglich transkribieren"),
+                                         m_fileManager->sessionsDirectory (),
+                                         tr ("ASR-WAV-Dateien (16 kHz, mono) (*.wav)"));
+    for (const QString &file : files)
+    {
+        //  Das Transkript wird als JSON neben der Aufnahme abgelegt.
+        const QFileInfo info (file);
+        m_jobScheduler->submit (SchedulerJob::Kind::Transcribe,
+                                file,
+                                info.dir ().filePath (info.completeBaseName () + ".json"),
+                                SchedulerJob::Priority::Backfill);
+    }
+    if (!files.isEmpty ())
+    {
+        setStatus (QString ("%1 Aufträge eingereiht").arg (files.size ()));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::onBackfillTags ()
+{
+    const QStringList files = QFileDialog::getOpenFileNames (this,
+                                                             tr ("Tags für Transkripte erzeugen"),
+                                                             m_fileManager->sessionsDirectory (),
+                                                             "*.json");
+    for (const QString &file : files)
+    {
+        m_jobScheduler->submit (SchedulerJob::Kind::Tag,
+                                file,
+                                file,
+                                SchedulerJob::Priority::Backfill);
+    }
+    if (!files.isEmpty ())
+    {
+        setStatus (QString ("%1 Aufträge eingereiht").arg (files.size ()));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MainWindow::openJobQueue ()
+{
+    if (!m_jobQueueDialog)
+    {
+        m_jobQueueDialog = new JobQueueDialog (m_jobScheduler, this);
+    }
+    m_jobQueueDialog->show ();
+    m_jobQueueDialog->raise ();
+    m_jobQueueDialog->activateWindow ();
 }
 
 //--------------------------------------------------------------------------------------------------
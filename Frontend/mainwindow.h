@@ -7,6 +7,7 @@
 #define MAINWINDOW_H
 
 #include <QElapsedTimer>
+#include <QHash>
 #include <QJsonDocument>
 #include <QListWidget>
 #include <QMainWindow>
@@ -14,12 +15,14 @@
 #include <QStack>
 
 // Eigene Klassen
-#include "asrprocessmanager.h"
 #include "filemanager.h"
+#include "recordingsession.h"
 #include "transcription.h"
 
 // Forward-Deklarationen
 class TagGeneratorManager;
+class JobScheduler;
+class JobQueueDialog;
 class SpeakerEditorDialog;
 class TextEditorDialog;
 class WavWriterThread;
@@ -72,13 +75,6 @@ private slots:
     /** @brief Beendet die laufende Audio-Aufnahmesession. */
     void onStopClicked ();
 
-    /**
-     * @brief Temporärer Platzhalter zur Simulation von Echtzeit-Transkripten.
-     * @todo Diese Methode ist nur für Demonstrationszwecke und wird entfernt,
-     * sobald die Echtzeit-Verarbeitung via ASR-Manager implementiert ist.
-     */
-    void onPollTranscripts ();
-
     /** @brief Öffnet einen Dialog zum Speichern der hochqualitativen WAV-Audiodatei. */
     void onSaveAudio ();
 
@@ -98,6 +94,8 @@ private slots:
      */
     void onMeetingSelected (QListWidgetItem *item);
 
+    void onSessionSelected (QListWidgetItem *item);
+
     /** @brief Filtert die Meeting-Liste basierend auf der Eingabe im Suchfeld. */
     void onSearchTextChanged (const QString &text);
 
@@ -194,6 +192,14 @@ private slots:
      * @brief Öffnet einen Dialog zur gezielten Suche nach Inhalten oder Diskussionen in allen Transkripten. */
     void openMultiSearchDialog ();
 
+    void onBackfillTranscription ();
+
+    void onBackfillTags ();
+
+    void onRetranscribe ();
+
+    void openJobQueue ();
+
     /**
      * @author Yolanda Fiska 
      * @brief Aktualisiert die Statusanzeige für den aktuell dargestellten Transkriptmodus. */
@@ -216,6 +222,9 @@ private:
     /** @brief Bündelt alle Signal-Slot-Verbindungen. */
     void doConnects ();
 
+    /** @brief Überträgt Gains, Hochpass und Limiter aus den Einstellungen auf den Capture-Thread. */
+    void applyAudioSettings ();
+
     /**
      * @brief Lädt die Liste der verfügbaren Meetings in die Seitenleiste.
      */
@@ -230,6 +239,30 @@ private:
     /** @brief Konstruiert den Anzeige-Namen für das aktuelle Meeting aus Name und Datum. */
     QString currentName () const;
 
+    /**
+     * @brief Legt eine neue Aufnahme-Sitzung mit eigenem Verzeichnis an.
+     * @return Die Sitzung oder nullptr, wenn das Verzeichnis nicht angelegt werden konnte.
+     */
+    RecordingSession *createSession ();
+
+    /** @brief Zeigt das Transkript einer Sitzung an und leitet deren weitere Ergebnisse dorthin. */
+    void showSession (RecordingSession *session);
+
+    /** @brief Löst die angezeigte Sitzung vom Hauptfenster, bevor etwas anderes geladen wird. */
+    void detachShownSession ();
+
+    /** @brief Aktualisiert den Eintrag einer Sitzung in der Sitzungsliste. */
+    void updateSessionItem (RecordingSession *session);
+
+    /** @brief Löscht alte, untätige Sitzungen gemäß "audio/keepSessions". */
+    void cleanupSessions ();
+
+    /** @brief Gibt an, ob die Sitzung ein Transkript hat, das nicht in der Datenbank gespeichert ist. */
+    bool hasUnsavedTranscript (RecordingSession *session) const;
+
+    /** @brief Meldet dem JobScheduler, wie viele Aufnahmen gerade ihre ASR belegen. */
+    void updateReservedSlots ();
+
     // Undo/Redo-Logik
     QStack<QJsonDocument> m_undoStack; ///< Stapel für die Undo-Zustände.
     QStack<QJsonDocument> m_redoStack; ///< Stapel für die Redo-Zustände.
@@ -246,21 +279,26 @@ private:
     QAction *m_actionSetMeetingName;
     QAction *m_settingsAction;
     QAction *m_reinstallPythonAction;
+    QAction *m_backfillAction;
+    QAction *m_backfillTagsAction;
+    QAction *m_retranscribeAction;
+    QAction *m_jobQueueAction;
 
     // Threads und Manager
     CaptureThread *m_captureThread;      ///< Thread für die plattformspezifische Audio-Aufnahme.
     WavWriterThread *m_wavWriter;        ///< Thread zum Schreiben der WAV-Dateien.
     Transcription *m_script;             ///< Das zentrale Datenmodell für das Transkript.
     FileManager *m_fileManager;          ///< Manager für alle Dateizugriffe.
-    AsrProcessManager *m_asrManager;     ///< Manager für den ASR-Python-Prozess.
     TagGeneratorManager *m_tagGenerator; ///< Manager für den Tag-Generator-Python-Prozess.
     DatabaseManager *m_databaseManager;  ///< Manager für den Datenbank
+    JobScheduler *m_jobScheduler;        ///< Warteschlange für Transkriptions- und Tag-Aufträge.
 
     // UI-Widgets
     QSplitter *splitter;
     QWidget *leftPanel;
     QLineEdit *searchBox;
     QListWidget *meetingList;
+    QListWidget *sessionList;
     QWidget *rightPanel;
     QVBoxLayout *mainLayout;
     QHBoxLayout *buttonLayout;
@@ -279,7 +317,6 @@ private:
     QLabel *statusLabel;
     QLabel *transkriptStatusLabel;
     QTextEdit *transcriptView;
-    QTimer *pollTimer;
     QTimer *timeUpdateTimer;
     QTimer *statusTimer;
     QElapsedTimer elapsedTime;
@@ -287,6 +324,7 @@ private:
     TextEditorDialog *m_textEditorDialog;
     SearchDialog *m_searchDialog;
     MultiSearchDialog *m_multiSearchDialog;
+    JobQueueDialog *m_jobQueueDialog;
 
     // Zustandsvariablen
     QString m_currentAudioPath;   ///< Pfad zur zuletzt gespeicherten Audiodatei.
@@ -295,6 +333,12 @@ private:
     QMap<QString, Transcription *>
         m_transcriptions; ///< Sammlung aller verfügbaren Transkriptionen, indexiert nach Besprechungstitel.
     QProcess *pluginProcess; ///< Platzhalter für einen möglichen IPC-Prozess.
+
+    // Aufnahme-Sitzungen
+    QList<RecordingSession *> m_sessions;   ///< Alle Sitzungen dieser Programmausführung, älteste zuerst.
+    RecordingSession *m_recordingSession;   ///< Sitzung, deren Aufnahme gerade geschrieben wird.
+    RecordingSession *m_shownSession;       ///< Angezeigte Sitzung (nullptr bei geladenen Meetings).
+    QHash<QString, RecordingSession *> m_sessionJobs; ///< Neu-Transkriptionen von Sitzungen nach Auftrags-ID.
 };
 
 #endif // MAINWINDOW_H
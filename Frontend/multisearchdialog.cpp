@@ -113,15 +113,6 @@ void MultiSearchDialog::loadSpeakerAndTagOptionsFromTranscriptions(const QMap<QS
 }
 //--------------------------------------------------------------------------------------------------
 
-QTime MultiSearchDialog::parseTimeFromSeconds(const QString &timestamp) const
-{
-    QDateTime dt = QDateTime::fromString(timestamp, Qt::ISODate);
-    if (!dt.isValid())
-        return QTime(); // Rückfall bei ungültigem Datum
-
-    return dt.time();
-}
-//--------------------------------------------------------------------------------------------------
 
 void MultiSearchDialog::onSearchClicked()
 {
@@ -165,19 +156,19 @@ void MultiSearchDialog::performSearch()
         Transcription *t = it.value();
         if (!t) continue;
 
-        const QList<MetaText> &segments = t->getMetaTexts();
-
-        for (const MetaText &segment : segments) {
+        // Datumfilter
+        QDate meetingDate = t->dateTime().date(); // Using your Transcription API
+        if (meetingDate < dateFrom || meetingDate > dateTo)
+            continue;
 
-            // Datumfilter
-            QDate meetingDate = t->dateTime().date(); // Using your Transcription API
-            if (meetingDate < dateFrom || meetingDate > dateTo)
-                continue;
+        // Zeitfilter über den Zeitindex: nur Segmente, die in [startTime, endTime] hineinreichen
+        const QList<MetaText> &segments = t->getMetaTexts();
+        const QList<int> inRange = t->segmentsInRange(startTime.msecsSinceStartOfDay(),
+                                                      endTime.msecsSinceStartOfDay() + 1000);
 
-            // Zeitfilter
-            QTime segmentTime = parseTimeFromSeconds(segment.Start);
-            if (segmentTime.isValid() && (segmentTime < startTime || segmentTime > endTime))
-                continue;
+        for (int index : inRange) {
+            const MetaText &segment = segments.at(index);
+            QTime segmentTime = QTime::fromMSecsSinceStartOfDay(int(segment.StartMs % 86400000));
 
             // Sprecherfilter
             if (selectedSpeaker != "Alle Sprecher" && segment.Speaker != selectedSpeaker)
@@ -191,7 +182,7 @@ void MultiSearchDialog::performSearch()
             if (!searchTerm.isEmpty() && !segment.Text.contains(searchTerm, Qt::CaseInsensitive))
                 continue;
 
-            QString timeStr = segmentTime.isValid() ? segmentTime.toString("HH:mm:ss") : "Unbekannt";
+            QString timeStr = segmentTime.toString("HH:mm:ss");
 
             QString displayText = QString("Besprechung: %1\nDatum:        %2\nZeit:        %3\nSprecher:    %4\nTranskript:  %5")
                                       .arg(meetingName)
@@ -69,13 +69,6 @@ private:
      */
     void loadSpeakerAndTagOptionsFromTranscriptions(const QMap<QString, Transcription*> &transcriptions);
 
-    /**
-     * @brief Wandelt Sekunden (als String) in QTime um.
-     * @param seconds Zeitwert in Sekunden als String.
-     * @return Entsprechendes QTime-Objekt.
-     */
-    QTime parseTimeFromSeconds(const QString &seconds) const;
-
     // UI-Elemente
     QLineEdit *keywordInput;      // Eingabefeld für das Suchwort
     QComboBox *speakerFilter;     // Auswahlfeld für Sprecher
@@ -0,0 +1,319 @@
+#include "polyphaseresampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define POLYPHASE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+//  GCC und Clang erzeugen AVX2-Code nur in Funktionen, die explizit dafür markiert sind.
+#if defined(POLYPHASE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define POLYPHASE_TARGET_AVX2 __attribute__ ((target ("avx2,fma")))
+#else
+#define POLYPHASE_TARGET_AVX2
+#endif
+
+namespace
+{
+constexpr double Pi = 3.14159265358979323846;
+constexpr double KaiserBeta = 8.0;       //  Ergibt ca. 80 dB Sperrdämpfung.
+constexpr double StopbandDb = 80.0;      //  Zur Abschätzung der Übergangsbreite.
+constexpr int TapAlignment = 8;          //  Koeffizienten pro Phase sind ein Vielfaches davon.
+
+//  Modifizierte Bessel-Funktion 1. Art, Ordnung 0 (Potenzreihe), für das Kaiser-Fenster.
+double besselI0 (
+    double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfX = 0.5 * x;
+    for (int k = 1; k < 50; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-12)
+        {
+            break;
+        }
+    }
+    return sum;
+}
+
+//  --- Skalarprodukt-Kernel; n ist immer ein Vielfaches von TapAlignment ---
+
+float dotScalar (
+    const float *a, const float *b, int n)
+{
+    //  Vier unabhängige Summen erlauben dem Compiler, die Additionen zu überlappen.
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (int i = 0; i < n; i += 4)
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+#if defined(POLYPHASE_X86)
+float dotSse2 (
+    const float *a, const float *b, int n)
+{
+    __m128 acc0 = _mm_setzero_ps ();
+    __m128 acc1 = _mm_setzero_ps ();
+    for (int i = 0; i < n; i += 8)
+    {
+        acc0 = _mm_add_ps (acc0, _mm_mul_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i)));
+        acc1 = _mm_add_ps (acc1, _mm_mul_ps (_mm_loadu_ps (a + i + 4), _mm_loadu_ps (b + i + 4)));
+    }
+    const __m128 acc = _mm_add_ps (acc0, acc1);
+    float lanes[4];
+    _mm_storeu_ps (lanes, acc);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+POLYPHASE_TARGET_AVX2 float dotAvx2 (
+    const float *a, const float *b, int n)
+{
+    __m256 acc = _mm256_setzero_ps ();
+    for (int i = 0; i < n; i += 8)
+    {
+        acc = _mm256_fmadd_ps (_mm256_loadu_ps (a + i), _mm256_loadu_ps (b + i), acc);
+    }
+    const __m128 sum4 = _mm_add_ps (_mm256_castps256_ps128 (acc), _mm256_extractf128_ps (acc, 1));
+    float lanes[4];
+    _mm_storeu_ps (lanes, sum4);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+//  Prüft zur Laufzeit, ob CPU und Betriebssystem AVX2 und FMA unterstützen.
+bool cpuHasAvx2Fma ()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid (info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid (info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!fma || !osxsave || !avx || (_xgetbv (0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex (info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+#endif
+}
+#endif
+
+//  Die zur Laufzeit gewählte Kernel-Variante.
+struct Kernel
+{
+    float (*dot) (const float *, const float *, int);
+    const char *name;
+};
+
+const Kernel &kernel ()
+{
+    //  Die Auswahl erfolgt einmalig beim ersten Aufruf (thread-sicher seit C++11).
+    static const Kernel selected = [] () -> Kernel
+    {
+#if defined(POLYPHASE_X86)
+        if (cpuHasAvx2Fma ())
+        {
+            return {dotAvx2, "AVX2"};
+        }
+        return {dotSse2, "SSE2"};
+#else
+        return {dotScalar, "Skalar"};
+#endif
+    }();
+    return selected;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+PolyphaseResampler::PolyphaseResampler (
+    int inputRate, int outputRate, int channels, int zeroCrossings)
+    : m_inputRate (inputRate)
+    , m_outputRate (outputRate)
+    , m_channels (std::max (1, channels))
+    , m_up (1)
+    , m_down (1)
+    , m_taps (TapAlignment)
+    , m_filled (0)
+    , m_position (0)
+    , m_phase (0)
+{
+    if (inputRate > 0 && outputRate > 0)
+    {
+        const int divisor = std::gcd (inputRate, outputRate);
+        m_up = outputRate / divisor;
+        m_down = inputRate / divisor;
+    }
+
+    designFilter (std::max (1, zeroCrossings));
+    m_history.resize (size_t (m_channels));
+    reset ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PolyphaseResampler::reset ()
+{
+    //  Die Historie wird mit einer halben Filterlänge Stille vorbelegt. Dadurch liegt die
+    //  Mitte des Filters beim ersten Ausgabe-Sample auf dem ersten Eingabe-Sample, und
+    //  die Ausgabe ist gegenüber der Eingabe nicht verzögert.
+    m_filled = m_taps / 2;
+    m_position = 0;
+    m_phase = 0;
+    for (std::vector<float> &channel : m_history)
+    {
+        channel.assign (size_t (m_taps) * 4, 0.0f);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int PolyphaseResampler::maxOutputFrames (
+    int inFrames) const
+{
+    return int ((long long) (std::max (0, inFrames)) * m_up / m_down) + 2;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int PolyphaseResampler::process (
+    const float *in, int inFrames, float *out)
+{
+    if (inFrames < 0)
+    {
+        return 0;
+    }
+
+    //  --- 1. Eingabe planar an die Historie anhängen ---
+    const size_t needed = size_t (m_filled) + size_t (inFrames);
+    for (int ch = 0; ch < m_channels; ++ch)
+    {
+        std::vector<float> &history = m_history[size_t (ch)];
+        if (history.size () < needed)
+        {
+            history.resize (needed); //  Nur, wenn das Stück größer ist als alle bisherigen.
+        }
+        float *dst = history.data () + m_filled;
+        for (int i = 0; i < inFrames; ++i)
+        {
+            dst[i] = in[size_t (i) * m_channels + ch];
+        }
+    }
+    m_filled += inFrames;
+
+    //  --- 2. Ausgabe-Samples berechnen, solange das Filterfenster vollständig gefüllt ist ---
+    const Kernel &k = kernel ();
+    int produced = 0;
+    while (m_position + m_taps <= m_filled)
+    {
+        const float *coeffs = m_coeffs.data () + size_t (m_phase) * m_taps;
+        float *frame = out + size_t (produced) * m_channels;
+        for (int ch = 0; ch < m_channels; ++ch)
+        {
+            frame[ch] = k.dot (coeffs, m_history[size_t (ch)].data () + m_position, m_taps);
+        }
+        ++produced;
+
+        //  Nächste Ausgabeposition im hochgetakteten Raster: Phase um M weiterschieben,
+        //  ganze Vielfache von L rücken die Eingabeposition vor.
+        m_phase += m_down;
+        m_position += m_phase / m_up;
+        m_phase %= m_up;
+    }
+
+    //  --- 3. Verbrauchte Eingabe verwerfen; nur die für das Filter nötige Historie bleibt ---
+    const int consumed = std::min (m_position, m_filled);
+    if (consumed > 0)
+    {
+        const size_t remaining = size_t (m_filled - consumed);
+        for (std::vector<float> &history : m_history)
+        {
+            std::memmove (history.data (), history.data () + consumed, remaining * sizeof (float));
+        }
+        m_filled -= consumed;
+        m_position -= consumed;
+    }
+
+    return produced;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const char *PolyphaseResampler::kernelName ()
+{
+    return kernel ().name;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PolyphaseResampler::designFilter (
+    int zeroCrossings)
+{
+    //  Die Filterlänge richtet sich nach der kleineren Rate: Beim Heruntertakten um den
+    //  Faktor M/L wird das Filter bezogen auf die Eingabe entsprechend länger.
+    const int rateFactor = std::max (m_up, m_down);
+    const int rawTaps = (2 * zeroCrossings * rateFactor + m_up - 1) / m_up;
+    m_taps = ((rawTaps + TapAlignment - 1) / TapAlignment) * TapAlignment;
+
+    //  Übergangsbreite des Kaiser-Fensters (relativ zur kleineren Nyquist-Frequenz). Die
+    //  Grenzfrequenz wird so gelegt, dass der Sperrbereich genau bei Nyquist beginnt.
+    const double transition = (StopbandDb - 7.95) / (14.36 * 2.0 * zeroCrossings);
+    const double rolloff = std::max (0.5, 1.0 - transition);
+    const double cutoff = rolloff * 0.5 / rateFactor; //  In Zyklen pro hochgetaktetem Sample.
+
+    const int length = m_up * m_taps;
+    const double center = 0.5 * (length - 1);
+    const double norm = besselI0 (KaiserBeta);
+
+    //  Prototyp-Tiefpass im hochgetakteten Raster. Der Faktor L gleicht die beim
+    //  Hochtakten eingefügten Nullen aus, sodass die Verstärkung im Durchlassbereich 1 ist.
+    std::vector<double> prototype (size_t (length), 0.0);
+    for (int n = 0; n < length; ++n)
+    {
+        const double t = n - center;
+        const double x = 2.0 * cutoff * t;
+        const double sinc = std::fabs (x) < 1e-12 ? 1.0 : std::sin (Pi * x) / (Pi * x);
+        const double r = t / (0.5 * length);
+        const double window = std::fabs (r) <= 1.0
+                                  ? besselI0 (KaiserBeta * std::sqrt (1.0 - r * r)) / norm
+                                  : 0.0;
+        prototype[size_t (n)] = m_up * 2.0 * cutoff * sinc * window;
+    }
+
+    //  Zerlegung in L Phasen. Die Koeffizienten jeder Phase werden umgekehrt abgelegt,
+    //  damit das Skalarprodukt über aufsteigende Eingabe-Indizes läuft.
+    m_coeffs.assign (size_t (length), 0.0f);
+    for (int phase = 0; phase < m_up; ++phase)
+    {
+        float *dst = m_coeffs.data () + size_t (phase) * m_taps;
+        for (int j = 0; j < m_taps; ++j)
+        {
+            dst[j] = float (prototype[size_t (phase + (m_taps - 1 - j) * m_up)]);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
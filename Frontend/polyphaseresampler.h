@@ -0,0 +1,93 @@
+/**
+ * @file polyphaseresampler.h
+ * @brief Enthält die Deklaration des PolyphaseResampler für rationale Abtastratenwandlung.
+ * @author Mike Wild
+ */
+#ifndef POLYPHASERESAMPLER_H
+#define POLYPHASERESAMPLER_H
+
+#include <vector>
+
+/**
+ * @brief Ein Polyphasen-FIR-Resampler für beliebige rationale Verhältnisse.
+ *
+ * Das Verhältnis Ausgaberate/Eingaberate wird auf L/M gekürzt. Das Tiefpassfilter
+ * (gefensterter Sinc mit Kaiser-Fenster) liegt bei der kleineren der beiden
+ * Nyquist-Frequenzen und verhindert so Aliasing beim Heruntertakten und Spiegelungen
+ * beim Hochtakten. Für jede der L Phasen wird ein eigener Koeffizientensatz
+ * abgelegt, sodass jedes Ausgabe-Sample genau ein Skalarprodukt über
+ * zusammenhängende Eingabe-Samples ist. Dieses Skalarprodukt liegt als SSE2-,
+ * AVX2- und skalare Variante vor (Auswahl einmalig zur Laufzeit).
+ *
+ * Der Zustand (Filter-Historie und Phase) bleibt zwischen den Aufrufen von process()
+ * erhalten; ein Datenstrom kann also in beliebig großen Stücken verarbeitet werden,
+ * ohne dass an den Stückgrenzen Artefakte entstehen. Die Klasse hat keine
+ * Abhängigkeit zu Qt und alloziert nur, wenn ein Stück größer ist als alle vorherigen.
+ */
+class PolyphaseResampler
+{
+public:
+    /**
+     * @brief Erstellt einen Resampler.
+     * @param inputRate Die Abtastrate der Eingabe in Hz.
+     * @param outputRate Die Abtastrate der Ausgabe in Hz.
+     * @param channels Anzahl der interleavten Kanäle (Ein- und Ausgabe).
+     * @param zeroCrossings Halbe Filterlänge in Nulldurchgängen des Sinc bei der
+     *        kleineren Rate; höhere Werte ergeben steilere Flanken bei mehr Rechenaufwand.
+     */
+    PolyphaseResampler (int inputRate, int outputRate, int channels, int zeroCrossings = 16);
+
+    /**
+     * @brief Setzt Filter-Historie und Phase zurück (z.B. zu Beginn einer Aufnahme).
+     */
+    void reset ();
+
+    /**
+     * @brief Wandelt ein Stück des Datenstroms.
+     * @param in Interleavte Eingabe-Samples.
+     * @param inFrames Anzahl der Eingabe-Frames.
+     * @param out Zielpuffer für interleavte Ausgabe-Samples; muss mindestens
+     *        maxOutputFrames(inFrames) Frames fassen.
+     * @return Die Anzahl der geschriebenen Ausgabe-Frames.
+     */
+    int process (const float *in, int inFrames, float *out);
+
+    /**
+     * @brief Gibt die maximale Anzahl an Ausgabe-Frames für @p inFrames Eingabe-Frames zurück.
+     */
+    int maxOutputFrames (int inFrames) const;
+
+    /** @brief Gibt die Eingaberate in Hz zurück. */
+    int inputRate () const { return m_inputRate; }
+
+    /** @brief Gibt die Ausgaberate in Hz zurück. */
+    int outputRate () const { return m_outputRate; }
+
+    /** @brief Gibt die Anzahl der Kanäle zurück. */
+    int channels () const { return m_channels; }
+
+    /** @brief Gibt die Anzahl der Filterkoeffizienten pro Phase zurück. */
+    int tapsPerPhase () const { return m_taps; }
+
+    /** @brief Gibt den Namen der zur Laufzeit gewählten Kernel-Variante zurück. */
+    static const char *kernelName ();
+
+private:
+    /** @brief Berechnet die Koeffizienten aller Phasen. */
+    void designFilter (int zeroCrossings);
+
+    int m_inputRate;  ///< Eingaberate in Hz.
+    int m_outputRate; ///< Ausgaberate in Hz.
+    int m_channels;   ///< Kanäle pro Frame.
+    int m_up;         ///< Interpolationsfaktor L (gekürzt).
+    int m_down;       ///< Dezimationsfaktor M (gekürzt).
+    int m_taps;       ///< Koeffizienten pro Phase (Vielfaches von 8).
+
+    std::vector<float> m_coeffs;               ///< L Phasen mit je m_taps Koeffizienten (umgekehrte Reihenfolge).
+    std::vector<std::vector<float>> m_history; ///< Eingabe je Kanal (planar) inkl. Filter-Historie.
+    int m_filled;                              ///< Anzahl gültiger Samples in m_history je Kanal.
+    int m_position;                            ///< Startindex des Fensters für das nächste Ausgabe-Sample.
+    int m_phase;                               ///< Phase (0..L-1) des nächsten Ausgabe-Samples.
+};
+
+#endif // POLYPHASERESAMPLER_H
@@ -0,0 +1,470 @@
+#include "processgovernor.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QSettings>
+#include <QThread>
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <QDBusConnection>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <sys/syscall.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace
+{
+constexpr int HighPriorityNice = -11;      //  Ersatz, wenn keine Echtzeit-Priorität erlaubt ist.
+constexpr qint64 RtTimeLimitUs = 200000;   //  CPU-Zeit ohne Blockieren, die RealtimeKit verlangt.
+constexpr const char *CgroupName = "audiotranskriptor-python";
+
+std::atomic<int> s_running{0}; //  Laufende Prozesse, auf die apply() angewendet wurde.
+
+/**
+ * @brief Zerlegt eine CPU-Liste wie "0-3,6" in einzelne CPU-Nummern unter @p cores.
+ */
+QList<int> parseCpuList (
+    const QString &text, int cores)
+{
+    QList<int> cpus;
+    for (const QString &part : text.split (',', Qt::SkipEmptyParts))
+    {
+        const QStringList range = part.trimmed ().split ('-');
+        bool okFirst = false;
+        bool okLast = true;
+        const int first = range.value (0).toInt (&okFirst);
+        const int last = range.size () > 1 ? range.value (1).toInt (&okLast) : first;
+        if (!okFirst || !okLast)
+        {
+            qWarning () << "ProcessGovernor: Ungültige CPU-Liste:" << text;
+            return {};
+        }
+        for (int cpu = qMax (0, first); cpu <= qMin (last, cores - 1); ++cpu)
+        {
+            if (!cpus.contains (cpu))
+            {
+                cpus.append (cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+#ifdef Q_OS_LINUX
+/**
+ * @brief Schreibt eine Steuerdatei der cgroup; Fehler werden gemeldet.
+ */
+bool writeCgroupFile (
+    const QString &path, const QByteArray &value)
+{
+    //  Ungepuffert, damit ein vom Kernel abgelehnter Wert schon beim Schreiben auffällt.
+    QFile file (path);
+    if (!file.open (QIODevice::WriteOnly | QIODevice::Unbuffered) || file.write (value) != value.size ())
+    {
+        qWarning () << "ProcessGovernor: cgroup-Datei nicht beschreibbar:" << path << file.errorString ();
+        return false;
+    }
+    return true;
+}
+#endif
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+ProcessGovernor::ProcessGovernor ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const int cores = qMax (1, QThread::idealThreadCount ());
+
+    m_enabled = settings.value ("governor/enabled", true).toBool ();
+    m_nice = qBound (0, settings.value ("governor/nice", 10).toInt (), 19);
+    m_ioniceClass = settings.value ("governor/ioniceClass", 2).toInt ();
+    if (m_ioniceClass != 2 && m_ioniceClass != 3)
+    {
+        m_ioniceClass = 0;
+    }
+    m_ioniceLevel = qBound (0, settings.value ("governor/ioniceLevel", 7).toInt (), 7);
+    m_cpus = parseCpuList (settings.value ("governor/affinity").toString (), cores);
+    m_cgroupPath = settings.value ("governor/cgroupPath").toString ();
+    m_cgroupCpuPercent = qBound (0, settings.value ("governor/cgroupCpuPercent", 0).toInt (), 100);
+    m_cgroupMemoryMB = qMax (0, settings.value ("governor/cgroupMemoryMB", 0).toInt ());
+
+    //  Standard: Ein Kern bleibt für Aufnahme, Oberfläche und Schreib-Threads frei. Mehr
+    //  Threads als erlaubte CPUs würden sich nur gegenseitig verdrängen.
+    const int threads = settings.value ("governor/threads", 0).toInt ();
+    m_threads = threads > 0 ? qMin (threads, cores) : qMax (1, cores - 1);
+    if (!m_cpus.isEmpty ())
+    {
+        m_threads = qMin (m_threads, int (m_cpus.size ()));
+    }
+    if (!m_enabled)
+    {
+        m_threads = cores;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ProcessGovernor::apply (
+    QProcess *process, int threads) const
+{
+    if (!process)
+    {
+        return;
+    }
+
+    //  Gezählt wird auch ohne Governor, damit die Xrun-Statistik Aufnahmen unter Last erkennt.
+    if (!process->property ("governed").toBool ())
+    {
+        process->setProperty ("governed", true);
+        QObject::connect (process, &QProcess::started, process, [] () { ++s_running; });
+        QObject::connect (process,
+                          &QProcess::finished,
+                          process,
+                          [] (int, QProcess::ExitStatus) { --s_running; });
+    }
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment ();
+    if (!m_enabled)
+    {
+        process->setProcessEnvironment (env);
+#ifdef Q_OS_UNIX
+        process->setChildProcessModifier ({});
+#elif defined(Q_OS_WIN)
+        process->setCreateProcessArgumentsModifier ({});
+#endif
+        return;
+    }
+
+    //  Torch, OpenMP und die BLAS-Bibliotheken lesen die Grenze beim Laden; der Worker setzt
+    //  je Anfrage zusätzlich torch.set_num_threads().
+    const QString budget = QString::number (threads > 0 ? qMin (threads, m_threads) : m_threads);
+    env.insert ("OMP_NUM_THREADS", budget);
+    env.insert ("MKL_NUM_THREADS", budget);
+    env.insert ("OPENBLAS_NUM_THREADS", budget);
+    process->setProcessEnvironment (env);
+
+#ifdef Q_OS_UNIX
+    const int nice = m_nice;
+#ifdef Q_OS_LINUX
+    //  ioprio: Klasse in den oberen Bits, Stufe in den unteren (wie ionice).
+    const int ioprio = m_ioniceClass > 0 ? (m_ioniceClass << 13) | m_ioniceLevel : 0;
+    cpu_set_t mask;
+    CPU_ZERO (&mask);
+    for (int cpu : m_cpus)
+    {
+        CPU_SET (cpu, &mask);
+    }
+    const bool hasMask = !m_cpus.isEmpty ();
+    const QByteArray procs = prepareCgroup ();
+#endif
+
+    //  Läuft im Kindprozess zwischen fork() und exec(): Nur async-signal-sichere Aufrufe,
+    //  keine Allokationen und kein Logging. Fehler lassen den Prozess ungebremst laufen.
+    process->setChildProcessModifier (
+        [=] ()
+        {
+            if (nice > 0)
+            {
+                ::setpriority (PRIO_PROCESS, 0, nice);
+            }
+#ifdef Q_OS_LINUX
+            if (ioprio > 0)
+            {
+                ::syscall (SYS_ioprio_set, 1 /* IOPRIO_WHO_PROCESS */, 0, ioprio);
+            }
+            if (hasMask)
+            {
+                ::sched_setaffinity (0, sizeof (mask), &mask);
+            }
+            if (!procs.isEmpty ())
+            {
+                const int fd = ::open (procs.constData (), O_WRONLY | O_CLOEXEC);
+                if (fd >= 0)
+                {
+                    ssize_t written = ::write (fd, "0", 1);
+                    Q_UNUSED (written);
+                    ::close (fd);
+                }
+            }
+#endif
+        });
+#elif defined(Q_OS_WIN)
+    const DWORD priorityClass = m_nice >= 15  ? IDLE_PRIORITY_CLASS
+                                : m_nice > 0 ? BELOW_NORMAL_PRIORITY_CLASS
+                                             : 0;
+    process->setCreateProcessArgumentsModifier (
+        [priorityClass] (QProcess::CreateProcessArguments *args) { args->flags |= priorityClass; });
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int ProcessGovernor::runningProcesses ()
+{
+    return s_running.load ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QByteArray ProcessGovernor::prepareCgroup () const
+{
+#ifdef Q_OS_LINUX
+    if (m_cgroupPath.isEmpty () || (m_cgroupCpuPercent == 0 && m_cgroupMemoryMB == 0))
+    {
+        return QByteArray ();
+    }
+
+    const QDir base (m_cgroupPath);
+    if (!base.exists ("cgroup.procs"))
+    {
+        qWarning () << "ProcessGovernor: Kein cgroup-v2-Verzeichnis:" << m_cgroupPath;
+        return QByteArray ();
+    }
+
+    //  Die Controller müssen in der Elterngruppe freigegeben sein. Es werden nur die fehlenden
+    //  eingetragen: Enthält die Elterngruppe selbst Prozesse (bei einem delegierten
+    //  User-Scope der Normalfall), lehnt cgroup v2 das Freigeben mit EBUSY ab.
+    QFile subtreeFile (base.filePath ("cgroup.subtree_control"));
+    QList<QByteArray> enabled;
+    if (subtreeFile.open (QIODevice::ReadOnly))
+    {
+        enabled = subtreeFile.readAll ().simplified ().split (' ');
+        subtreeFile.close ();
+    }
+    QByteArray missing;
+    for (const QByteArray &controller : {QByteArray ("cpu"), QByteArray ("memory")})
+    {
+        if (!enabled.contains (controller))
+        {
+            missing += (missing.isEmpty () ? "+" : " +") + controller;
+        }
+    }
+    if (!missing.isEmpty () && !writeCgroupFile (subtreeFile.fileName (), missing))
+    {
+        qWarning () << "ProcessGovernor: Controller" << missing << "in" << m_cgroupPath
+                    << "nicht freigebbar (bei EBUSY enthält die Gruppe enthält selbst Prozesse)."
+                    << "CPU- und Speicherlimit bleiben wirkungslos.";
+        return QByteArray ();
+    }
+
+    const QString group = base.filePath (CgroupName);
+    if (!QDir ().mkpath (group))
+    {
+        qWarning () << "ProcessGovernor: cgroup nicht anlegbar:" << group;
+        return QByteArray ();
+    }
+
+    //  cpu.max: Kontingent je Periode (100 ms) über alle Kerne.
+    const qint64 period = 100000;
+    const QByteArray cpuMax
+        = m_cgroupCpuPercent > 0
+              ? QByteArray::number (period * m_cgroupCpuPercent * qMax (1, QThread::idealThreadCount ()) / 100)
+                    + ' ' + QByteArray::number (period)
+              : QByteArray ("max ") + QByteArray::number (period);
+    const QByteArray memoryMax = m_cgroupMemoryMB > 0
+                                     ? QByteArray::number (qint64 (m_cgroupMemoryMB) * 1024 * 1024)
+                                     : QByteArray ("max");
+    if (!writeCgroupFile (group + "/cpu.max", cpuMax) || !writeCgroupFile (group + "/memory.max", memoryMax))
+    {
+        return QByteArray ();
+    }
+    return QFile::encodeName (group + "/cgroup.procs");
+#else
+    return QByteArray ();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ProcessGovernor::elevateCurrentThread (
+    int priority)
+{
+#ifdef Q_OS_LINUX
+    sched_param param{};
+    param.sched_priority = qBound (1, priority, 99);
+
+    //  Direkt, wenn RLIMIT_RTPRIO es erlaubt. Kindprozesse erben die Priorität nicht.
+    if (::sched_setscheduler (0, SCHED_FIFO | SCHED_RESET_ON_FORK, &param) == 0)
+    {
+        qDebug () << "ProcessGovernor: SCHED_FIFO" << param.sched_priority << "für Thread" << ::syscall (SYS_gettid);
+        return true;
+    }
+
+    //  Sonst über RealtimeKit, das Desktop-Systeme für Audio-Anwendungen bereitstellen. Es
+    //  verlangt ein RLIMIT_RTTIME, damit ein hängender Thread das System nicht blockiert.
+    const quint64 tid = quint64 (::syscall (SYS_gettid));
+    QDBusInterface rtkit ("org.freedesktop.RealtimeKit1",
+                          "/org/freedesktop/RealtimeKit1",
+                          "org.freedesktop.RealtimeKit1",
+                          QDBusConnection::systemBus ());
+    if (rtkit.isValid ())
+    {
+        const int maxPriority = rtkit.property ("MaxRealtimePriority").toInt ();
+        const qint64 maxRtTime = rtkit.property ("RTTimeUSecMax").toLongLong ();
+        const rlim_t rtTime = rlim_t (maxRtTime > 0 ? qMin (maxRtTime, RtTimeLimitUs) : RtTimeLimitUs);
+        const rlimit limit{rtTime, rtTime};
+        ::setrlimit (RLIMIT_RTTIME, &limit);
+
+        const quint32 rtPriority = quint32 (maxPriority > 0 ? qMin (param.sched_priority, maxPriority)
+                                                            : param.sched_priority);
+        const QDBusReply<void> reply = rtkit.call ("MakeThreadRealtime", tid, rtPriority);
+        if (reply.isValid ())
+        {
+            qDebug () << "ProcessGovernor: RealtimeKit-Priorität" << rtPriority << "für Thread" << tid;
+            return true;
+        }
+        const QDBusReply<void> nice = rtkit.call ("MakeThreadHighPriority", tid, qint32 (HighPriorityNice));
+        if (nice.isValid ())
+        {
+            qDebug () << "ProcessGovernor: RealtimeKit-nice" << HighPriorityNice << "für Thread" << tid;
+            return true;
+        }
+        qWarning () << "ProcessGovernor: RealtimeKit lehnt ab:" << reply.error ().message ();
+    }
+
+    //  Unter Linux gilt nice je Thread.
+    return ::setpriority (PRIO_PROCESS, id_t (tid), HighPriorityNice) == 0;
+#elif defined(Q_OS_UNIX)
+    sched_param param{};
+    param.sched_priority = qBound (1, priority, 99);
+    return ::pthread_setschedparam (::pthread_self (), SCHED_FIFO, &param) == 0;
+#elif defined(Q_OS_WIN)
+    const int level = priority >= 50 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST;
+    return ::SetThreadPriority (::GetCurrentThread (), level) != 0;
+#else
+    Q_UNUSED (priority);
+    return false;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ProcessGovernor::resetCurrentThread ()
+{
+#ifdef Q_OS_UNIX
+    sched_param param{};
+    param.sched_priority = 0;
+#ifdef Q_OS_LINUX
+    ::sched_setscheduler (0, SCHED_OTHER, &param);
+    ::setpriority (PRIO_PROCESS, id_t (::syscall (SYS_gettid)), 0);
+#else
+    ::pthread_setschedparam (::pthread_self (), SCHED_OTHER, &param);
+#endif
+#elif defined(Q_OS_WIN)
+    ::SetThreadPriority (::GetCurrentThread (), THREAD_PRIORITY_NORMAL);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ProcessGovernor::lockMemory (
+    const void *data, size_t bytes)
+{
+    if (!data || bytes == 0)
+    {
+        return false;
+    }
+#ifdef Q_OS_UNIX
+    if (::mlock (data, bytes) != 0)
+    {
+        qWarning () << "ProcessGovernor: mlock von" << bytes << "Bytes fehlgeschlagen:" << std::strerror (errno);
+        return false;
+    }
+    return true;
+#elif defined(Q_OS_WIN)
+    return ::VirtualLock (const_cast<void *> (data), bytes) != 0;
+#else
+    return false;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ProcessGovernor::unlockMemory (
+    const void *data, size_t bytes)
+{
+    if (!data || bytes == 0)
+    {
+        return;
+    }
+#ifdef Q_OS_UNIX
+    ::munlock (data, bytes);
+#elif defined(Q_OS_WIN)
+    ::VirtualUnlock (const_cast<void *> (data), bytes);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ProcessGovernor::recordSession (
+    double seconds, quint64 xruns, bool underLoad, bool governed)
+{
+    //  Ohne laufende Python-Prozesse sagt eine Aufnahme nichts über den Governor aus.
+    if (!underLoad || seconds <= 0.0)
+    {
+        return;
+    }
+
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const QString group = governed ? "governor/xrunStats/on/" : "governor/xrunStats/off/";
+    settings.setValue (group + "sessions", settings.value (group + "sessions", 0).toLongLong () + 1);
+    settings.setValue (group + "seconds", settings.value (group + "seconds", 0.0).toDouble () + seconds);
+    settings.setValue (group + "xruns", settings.value (group + "xruns", 0).toLongLong () + qint64 (xruns));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString ProcessGovernor::xrunSummary ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    QStringList parts;
+    for (const bool governed : {true, false})
+    {
+        const QString group = governed ? "governor/xrunStats/on/" : "governor/xrunStats/off/";
+        const QString label = governed ? QObject::tr ("mit Governor") : QObject::tr ("ohne Governor");
+        const double seconds = settings.value (group + "seconds", 0.0).toDouble ();
+        if (seconds <= 0.0)
+        {
+            parts.append (QObject::tr ("%1: keine Aufnahmen unter Last").arg (label));
+            continue;
+        }
+        const qint64 xruns = settings.value (group + "xruns", 0).toLongLong ();
+        parts.append (QObject::tr ("%1: %2 Xruns/h (%3 in %4 Aufnahmen, %5 min)")
+                          .arg (label)
+                          .arg (3600.0 * xruns / seconds, 0, 'f', 1)
+                          .arg (xruns)
+                          .arg (settings.value (group + "sessions", 0).toLongLong ())
+                          .arg (seconds / 60.0, 0, 'f', 1));
+    }
+    return parts.join ('\n');
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ProcessGovernor::resetXrunStats ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    settings.remove ("governor/xrunStats");
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,136 @@
+/**
+ * @file processgovernor.h
+ * @brief Enthält die Deklaration des ProcessGovernor für Python-Prozesse und Echtzeit-Threads.
+ * @author Mike Wild
+ */
+#ifndef PROCESSGOVERNOR_H
+#define PROCESSGOVERNOR_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include <cstddef>
+
+class QProcess;
+
+/**
+ * @brief Begrenzt die Ressourcen der Python-Prozesse, damit die Aufnahme nie stockt.
+ *
+ * Whisper belegt ohne Begrenzung alle Kerne; läuft gleichzeitig eine Aufnahme, kommen
+ * CaptureThread und WavWriterThread nicht mehr rechtzeitig zum Zug. Der Governor wird
+ * vor jedem Start eines QProcess (ASR-Skript, ASR-Worker, Tag-Generator) mit apply()
+ * angewendet und setzt:
+ *
+ * - ein Thread-Budget ("governor/threads", 0 = alle Kerne bis auf einen) über
+ *   OMP_NUM_THREADS, MKL_NUM_THREADS und OPENBLAS_NUM_THREADS; Torch übernimmt es beim Import,
+ * - eine niedrigere CPU-Priorität ("governor/nice", Standard 10),
+ * - unter Linux die I/O-Priorität ("governor/ioniceClass": 0 = unverändert, 2 = best-effort,
+ *   3 = idle; "governor/ioniceLevel" 0..7),
+ * - unter Linux eine CPU-Maske ("governor/affinity", z.B. "2-7" oder "1,3,5"; leer = alle),
+ * - unter Linux optional cgroup-v2-Grenzen: "governor/cgroupPath" nennt ein an den Benutzer
+ *   delegiertes cgroup-Verzeichnis; darin wird eine Untergruppe angelegt, deren cpu.max
+ *   ("governor/cgroupCpuPercent" der gesamten Maschine) und memory.max
+ *   ("governor/cgroupMemoryMB") gesetzt werden.
+ *
+ * Unter Windows werden nur das Thread-Budget und eine niedrigere Prioritätsklasse gesetzt.
+ * Mit "governor/enabled" = false bleibt alles wie bisher (für den Vergleich der Xruns).
+ *
+ * Die statischen Methoden erhöhen die Priorität des aufrufenden Threads (SCHED_FIFO bzw.
+ * RealtimeKit) und sperren Puffer im RAM; sie werden von den Audio-Threads verwendet.
+ * Außerdem werden die Xruns je Aufnahme mit und ohne Governor gezählt (xrunSummary()).
+ */
+class ProcessGovernor
+{
+public:
+    /** @brief Liest die aktuellen Einstellungen. */
+    ProcessGovernor ();
+
+    /** @brief Gibt an, ob der Governor eingeschaltet ist ("governor/enabled"). */
+    bool isEnabled () const { return m_enabled; }
+
+    /**
+     * @brief Gibt die Anzahl der Threads zurück, die alle Python-Prozesse zusammen nutzen dürfen.
+     * @note Ohne Governor sind das alle Kerne (wie bisher).
+     */
+    int threadBudget () const { return m_threads; }
+
+    /**
+     * @brief Wendet die Begrenzungen auf einen noch nicht gestarteten Prozess an.
+     *
+     * Darf vor jedem start() erneut aufgerufen werden; die Einstellungen gelten dann für
+     * den nächsten Start.
+     * @param process Der Prozess.
+     * @param threads Threads dieses Prozesses (0 = das ganze Budget).
+     */
+    void apply (QProcess *process, int threads = 0) const;
+
+    /** @brief Anzahl der gerade laufenden Prozesse, auf die apply() angewendet wurde. */
+    static int runningProcesses ();
+
+    /**
+     * @brief Versucht, den aufrufenden Thread mit Echtzeit-Priorität laufen zu lassen.
+     *
+     * Unter Linux zuerst direkt über SCHED_FIFO (erfordert RLIMIT_RTPRIO, z.B. über die
+     * Gruppe "audio"), sonst über RealtimeKit auf dem System-D-Bus; zuletzt wird
+     * wenigstens eine höhere nice-Stufe angefordert. Unter Windows wird die Thread-Priorität
+     * erhöht.
+     * @param priority Echtzeit-Priorität 1..99 (RealtimeKit begrenzt sie ggf. weiter).
+     * @return true, wenn eine Echtzeit- oder höhere Priorität gesetzt wurde.
+     */
+    static bool elevateCurrentThread (int priority);
+
+    /**
+     * @brief Setzt den aufrufenden Thread auf die normale Priorität zurück.
+     *
+     * Vor längeren Arbeiten ohne blockierende Aufrufe (z.B. dem Abschluss einer Datei)
+     * nötig, da RealtimeKit den Thread sonst nach RLIMIT_RTTIME beendet.
+     */
+    static void resetCurrentThread ();
+
+    /**
+     * @brief Sperrt einen Speicherbereich im RAM, damit er nie ausgelagert wird.
+     * @return false, wenn das System es nicht erlaubt (z.B. RLIMIT_MEMLOCK zu klein).
+     */
+    static bool lockMemory (const void *data, size_t bytes);
+
+    /** @brief Hebt lockMemory() wieder auf. */
+    static void unlockMemory (const void *data, size_t bytes);
+
+    /**
+     * @brief Verbucht eine beendete Aufnahme für den Vergleich mit und ohne Governor.
+     *
+     * Gezählt werden nur Aufnahmen, während derer Python-Prozesse liefen; die Summen liegen
+     * in "governor/xrunStats/on" bzw. ".../off".
+     * @param seconds Dauer der Aufnahme.
+     * @param xruns Verworfene oder fehlende Blöcke während der Aufnahme.
+     * @param underLoad true, wenn währenddessen ein Python-Prozess lief.
+     * @param governed true, wenn der Governor zu Beginn der Aufnahme eingeschaltet war.
+     */
+    static void recordSession (double seconds, quint64 xruns, bool underLoad, bool governed);
+
+    /** @brief Beschreibt die gezählten Xruns pro Stunde mit und ohne Governor. */
+    static QString xrunSummary ();
+
+    /** @brief Setzt die Xrun-Statistik zurück. */
+    static void resetXrunStats ();
+
+private:
+    /**
+     * @brief Legt die cgroup-Untergruppe an und setzt ihre Grenzen.
+     * @return Pfad der Datei cgroup.procs oder leer, wenn cgroups nicht genutzt werden.
+     */
+    QByteArray prepareCgroup () const;
+
+    bool m_enabled;          ///< Governor eingeschaltet.
+    int m_threads;           ///< Thread-Budget aller Python-Prozesse.
+    int m_nice;              ///< nice-Stufe der Prozesse (0 = unverändert).
+    int m_ioniceClass;       ///< I/O-Klasse (0 = unverändert, 2 = best-effort, 3 = idle).
+    int m_ioniceLevel;       ///< I/O-Stufe innerhalb der Klasse (0..7).
+    QList<int> m_cpus;       ///< Erlaubte CPUs (leer = alle).
+    QString m_cgroupPath;    ///< Delegiertes cgroup-v2-Verzeichnis (leer = keine cgroups).
+    int m_cgroupCpuPercent;  ///< CPU-Grenze der Untergruppe in % der Maschine (0 = keine).
+    int m_cgroupMemoryMB;    ///< Speichergrenze der Untergruppe in MB (0 = keine).
+};
+
+#endif // PROCESSGOVERNOR_H
@@ -0,0 +1,611 @@
+#include "pulseasynccapturethread.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <pulse/error.h>
+#include <pulse/pulseaudio.h>
+
+namespace
+{
+constexpr int SampleRate = 48000;      //  Abtastrate beider Streams.
+constexpr int FragmentMs = 10;         //  Gewünschte Callback-Granularität des Servers.
+constexpr int LoopbackLatencyMs = 20;  //  Latenz des module-loopback für das Mikrofon.
+constexpr int StallFrames = 9600;      //  Ab 200 ms Vorsprung gilt der andere Stream als stockend.
+constexpr int MaxDrainFrames = 96000;  //  Obergrenze für das Nachlesen beim Stoppen (2 s).
+
+//  Wartet (bei gesperrtem Mainloop), bis eine asynchrone Operation abgeschlossen ist.
+bool waitForOperation (
+    pa_threaded_mainloop *mainloop, pa_operation *op)
+{
+    if (!op)
+    {
+        return false;
+    }
+    while (pa_operation_get_state (op) == PA_OPERATION_RUNNING)
+    {
+        pa_threaded_mainloop_wait (mainloop);
+    }
+    const bool done = pa_operation_get_state (op) == PA_OPERATION_DONE;
+    pa_operation_unref (op);
+    return done;
+}
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+PulseAsyncCaptureThread::PulseAsyncCaptureThread (
+    QObject *parent)
+    : CaptureThread (parent)
+    , m_mainloop (nullptr)
+    , m_context (nullptr)
+    , m_modNull (-1)
+    , m_modLoop (-1)
+    , m_aligned (false)
+    , m_lastIndex (PA_INVALID_INDEX)
+{
+    m_sys.owner = this;
+    m_mic.owner = this;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::stopCapture ()
+{
+    CaptureThread::stopCapture ();
+
+    //  Die Aufnahmeschleife schläft in pa_threaded_mainloop_wait(); sie wird hier geweckt,
+    //  damit das Stoppen nicht auf den nächsten Callback des Servers warten muss.
+    QMutexLocker locker (&m_mainloopGuard);
+    if (m_mainloop)
+    {
+        pa_threaded_mainloop_lock (m_mainloop);
+        pa_threaded_mainloop_signal (m_mainloop, 0);
+        pa_threaded_mainloop_unlock (m_mainloop);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool PulseAsyncCaptureThread::initializeCapture ()
+{
+    //  ---- 1. Puffer vorbereiten ----
+    //  Die Ringpuffer fassen 2 Sekunden, der Rest wird vorab auf Blockgröße alloziert.
+    m_sys.fifo.resize (size_t (SampleRate) * 2 * BlockChannels);
+    m_mic.fifo.resize (size_t (SampleRate) * 2 * BlockChannels);
+    bufSys.resize (BlockFrames * BlockChannels);
+    bufMic.resize (BlockFrames * BlockChannels);
+    bufMix.resize (BlockFrames * BlockChannels);
+    m_aligned = false;
+
+    //  ---- 2. Mainloop und Kontext erstellen ----
+    pa_threaded_mainloop *mainloop = pa_threaded_mainloop_new ();
+    if (!mainloop)
+    {
+        qWarning () << "PulseAsyncCapture: pa_threaded_mainloop_new failed";
+        return false;
+    }
+    {
+        QMutexLocker locker (&m_mainloopGuard);
+        m_mainloop = mainloop;
+    }
+
+    m_context = pa_context_new (pa_threaded_mainloop_get_api (m_mainloop), "AudioTranskriptor");
+    pa_context_set_state_callback (m_context, &PulseAsyncCaptureThread::contextStateCallback, this);
+
+    if (pa_context_connect (m_context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0
+        || pa_threaded_mainloop_start (m_mainloop) < 0)
+    {
+        qWarning () << "PulseAsyncCapture: Verbindung zum Server fehlgeschlagen:"
+                    << pa_strerror (pa_context_errno (m_context));
+        cleanupCapture ();
+        return false;
+    }
+
+    pa_threaded_mainloop_lock (m_mainloop);
+
+    //  Wartet, bis der Kontext bereit ist (oder endgültig fehlgeschlagen ist).
+    for (;;)
+    {
+        const pa_context_state_t state = pa_context_get_state (m_context);
+        if (state == PA_CONTEXT_READY)
+        {
+            break;
+        }
+        if (!PA_CONTEXT_IS_GOOD (state))
+        {
+            qWarning () << "PulseAsyncCapture: Kontext fehlgeschlagen:"
+                        << pa_strerror (pa_context_errno (m_context));
+            pa_threaded_mainloop_unlock (m_mainloop);
+            cleanupCapture ();
+            return false;
+        }
+        pa_threaded_mainloop_wait (m_mainloop);
+    }
+
+    //  ---- 3. Default-Sink & -Source direkt vom Server abfragen ----
+    m_defaultSink.clear ();
+    m_defaultSource.clear ();
+    waitForOperation (m_mainloop,
+                      pa_context_get_server_info (m_context,
+                                                  &PulseAsyncCaptureThread::serverInfoCallback,
+                                                  this));
+    if (m_defaultSink.isEmpty () || m_defaultSource.isEmpty ())
+    {
+        qWarning () << "PulseAsyncCapture: Default-Sink/-Source nicht gefunden";
+        pa_threaded_mainloop_unlock (m_mainloop);
+        cleanupCapture ();
+        return false;
+    }
+
+    //  ---- 4. Null-Sink + Loopback für's Mikrofon erstellen ----
+    //  Der Loopback bekommt eine kurze, feste Latenz, die später bei der Ausrichtung
+    //  der beiden Streams berücksichtigt wird.
+    m_modNull = loadModule ("module-null-sink",
+                            "sink_name=mic_sink sink_properties=device.description=MicSink");
+    m_modLoop = loadModule ("module-loopback",
+                            QString ("source=%1 sink=mic_sink latency_msec=%2")
+                                .arg (m_defaultSource)
+                                .arg (LoopbackLatencyMs));
+
+    if (m_modNull < 0 || m_modLoop < 0)
+    {
+        qWarning () << "PulseAsyncCapture: Erstellen der PulseAudio-Module fehlgeschlagen.";
+        pa_threaded_mainloop_unlock (m_mainloop);
+        cleanupCapture ();
+        return false;
+    }
+
+    //  ---- 5. Aufnahme-Streams öffnen ----
+    if (!openStream (m_sys, "syscap", m_defaultSink + ".monitor")
+        || !openStream (m_mic, "miccap", "mic_sink.monitor"))
+    {
+        pa_threaded_mainloop_unlock (m_mainloop);
+        cleanupCapture ();
+        return false;
+    }
+
+    pa_threaded_mainloop_unlock (m_mainloop);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::captureLoopIteration ()
+{
+    const size_t blockSamples = size_t (BlockFrames) * BlockChannels;
+    const size_t stallSamples = size_t (StallFrames) * BlockChannels;
+
+    pa_threaded_mainloop_lock (m_mainloop);
+    while (m_active.load ())
+    {
+        if (!PA_STREAM_IS_GOOD (pa_stream_get_state (m_sys.stream))
+            || !PA_STREAM_IS_GOOD (pa_stream_get_state (m_mic.stream)))
+        {
+            //  Bei einem kritischen Stream-Fehler wird die aktuelle Aufnahme-Session beendet.
+            qWarning () << "PulseAsyncCapture: Stream fehlgeschlagen:"
+                        << pa_strerror (pa_context_errno (m_context));
+            pa_threaded_mainloop_unlock (m_mainloop);
+            stopCapture ();
+            return;
+        }
+
+        if (!m_aligned && !alignStreams ())
+        {
+            pa_threaded_mainloop_wait (m_mainloop);
+            continue;
+        }
+
+        const size_t sysAvail = m_sys.fifo.size ();
+        const size_t micAvail = m_mic.fifo.size ();
+
+        //  Ein Block wird gemischt, sobald beide Streams genug Daten haben. Liegt ein Stream
+        //  weit voraus, gilt der andere als stockend und wird mit Stille aufgefüllt.
+        if ((sysAvail >= blockSamples && micAvail >= blockSamples)
+            || sysAvail >= blockSamples + stallSamples || micAvail >= blockSamples + stallSamples)
+        {
+            takeBlock ();
+            pa_threaded_mainloop_unlock (m_mainloop);
+            mixAndPublish ();
+            return;
+        }
+
+        //  Schläft, bis ein Read-Callback neue Daten meldet oder stopCapture() weckt.
+        pa_threaded_mainloop_wait (m_mainloop);
+    }
+    pa_threaded_mainloop_unlock (m_mainloop);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::cleanupCapture ()
+{
+    if (!m_mainloop)
+    {
+        return;
+    }
+
+    pa_threaded_mainloop_lock (m_mainloop);
+
+    //  --- Draining des PulseAudio-Puffers ---
+    //  Es wird genau so viel nachgelesen, wie laut Server-Latenz zum Zeitpunkt des
+    //  Stopp-Befehls noch unterwegs war (statt pauschal 2 Sekunden).
+    if (m_sys.stream && m_mic.stream
+        && pa_stream_get_state (m_sys.stream) == PA_STREAM_READY
+        && pa_stream_get_state (m_mic.stream) == PA_STREAM_READY)
+    {
+        const qint64 latSys = streamLatencyFrames (m_sys);
+        const qint64 latMic = streamLatencyFrames (m_mic);
+        qint64 drainFrames = SampleRate / 10; //  Latenz unbekannt: 100 ms als Schätzung.
+        if (latSys >= 0 && latMic >= 0)
+        {
+            drainFrames = std::max (latSys, latMic + LoopbackLatencyMs * SampleRate / 1000);
+        }
+        drainFrames = std::min<qint64> (drainFrames + BlockFrames, MaxDrainFrames);
+
+        //  Falls der Server weniger liefert als erwartet, wird nach der doppelten
+        //  Latenz (plus Reserve) abgebrochen.
+        const qint64 deadlineMs = 2 * drainFrames * 1000 / SampleRate + 100;
+        const size_t blockSamples = size_t (BlockFrames) * BlockChannels;
+        QElapsedTimer timer;
+        timer.start ();
+
+        qint64 drained = 0;
+        while (drained < drainFrames && timer.elapsed () < deadlineMs)
+        {
+            if (m_sys.fifo.size () >= blockSamples && m_mic.fifo.size () >= blockSamples)
+            {
+                takeBlock ();
+                pa_threaded_mainloop_unlock (m_mainloop);
+                mixAndPublish ();
+                pa_threaded_mainloop_lock (m_mainloop);
+                drained += BlockFrames;
+                continue;
+            }
+            pa_threaded_mainloop_wait (m_mainloop);
+        }
+        qDebug () << "PulseAsyncCapture: Drain" << drained << "von" << drainFrames << "Frames in"
+                  << timer.elapsed () << "ms";
+    }
+
+    closeStream (m_sys);
+    closeStream (m_mic);
+
+    //  Entlade die PulseAudio-Module, die wir in initializeCapture() erstellt haben,
+    //  um das System in den Ausgangszustand zurückzuversetzen.
+    if (m_context && pa_context_get_state (m_context) == PA_CONTEXT_READY)
+    {
+        if (m_modLoop >= 0)
+        {
+            unloadModule (m_modLoop);
+        }
+        if (m_modNull >= 0)
+        {
+            unloadModule (m_modNull);
+        }
+    }
+    m_modLoop = -1;
+    m_modNull = -1;
+
+    if (m_context)
+    {
+        pa_context_set_state_callback (m_context, nullptr, nullptr);
+        pa_context_disconnect (m_context);
+        pa_context_unref (m_context);
+        m_context = nullptr;
+    }
+
+    pa_threaded_mainloop_unlock (m_mainloop);
+
+    //  Der Zeiger wird vor dem Freigeben entfernt, damit stopCapture() ihn nicht mehr benutzt.
+    pa_threaded_mainloop *mainloop = nullptr;
+    {
+        QMutexLocker locker (&m_mainloopGuard);
+        mainloop = m_mainloop;
+        m_mainloop = nullptr;
+    }
+    pa_threaded_mainloop_stop (mainloop);
+    pa_threaded_mainloop_free (mainloop);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int PulseAsyncCaptureThread::loadModule (
+    const char *name, const QString &arguments)
+{
+    m_lastIndex = PA_INVALID_INDEX;
+    const QByteArray args = arguments.toUtf8 ();
+    waitForOperation (m_mainloop,
+                      pa_context_load_module (m_context,
+                                              name,
+                                              args.constData (),
+                                              &PulseAsyncCaptureThread::moduleIndexCallback,
+                                              this));
+    if (m_lastIndex == PA_INVALID_INDEX)
+    {
+        qWarning () << "load-module failed:" << name << arguments
+                    << pa_strerror (pa_context_errno (m_context));
+        return -1;
+    }
+    return int (m_lastIndex);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::unloadModule (
+    int index)
+{
+    waitForOperation (m_mainloop,
+                      pa_context_unload_module (m_context,
+                                                uint32_t (index),
+                                                &PulseAsyncCaptureThread::successCallback,
+                                                this));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool PulseAsyncCaptureThread::openStream (
+    StreamState &state, const char *name, const QString &device)
+{
+    //  Audio-Spezifikation: 32-bit Float, Little Endian, 48000 Hz, 2 Kanäle (Stereo).
+    pa_sample_spec ss{PA_SAMPLE_FLOAT32LE, uint32_t (SampleRate), uint8_t (BlockChannels)};
+
+    state.fifo.clear ();
+    state.framesReceived = 0;
+    state.stream = pa_stream_new (m_context, name, &ss, nullptr);
+    if (!state.stream)
+    {
+        qWarning () << "pa_stream_new failed:" << name << pa_strerror (pa_context_errno (m_context));
+        return false;
+    }
+
+    pa_stream_set_state_callback (state.stream, &PulseAsyncCaptureThread::streamStateCallback, this);
+    pa_stream_set_read_callback (state.stream, &PulseAsyncCaptureThread::streamReadCallback, &state);
+    pa_stream_set_overflow_callback (state.stream, &PulseAsyncCaptureThread::streamOverflowCallback, &state);
+
+    //  Kleine Fragmente sorgen dafür, dass die Callbacks regelmäßig (ca. alle 10 ms) kommen.
+    pa_buffer_attr attr;
+    attr.maxlength = uint32_t (-1);
+    attr.tlength = uint32_t (-1);
+    attr.prebuf = uint32_t (-1);
+    attr.minreq = uint32_t (-1);
+    attr.fragsize = uint32_t (pa_usec_to_bytes (pa_usec_t (FragmentMs) * 1000, &ss));
+
+    const pa_stream_flags_t flags = pa_stream_flags_t (
+        PA_STREAM_ADJUST_LATENCY | PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE);
+
+    const QByteArray dev = device.toUtf8 ();
+    if (pa_stream_connect_record (state.stream, dev.constData (), &attr, flags) < 0)
+    {
+        qWarning () << "pa_stream_connect_record failed:" << device
+                    << pa_strerror (pa_context_errno (m_context));
+        return false;
+    }
+
+    for (;;)
+    {
+        const pa_stream_state_t st = pa_stream_get_state (state.stream);
+        if (st == PA_STREAM_READY)
+        {
+            return true;
+        }
+        if (!PA_STREAM_IS_GOOD (st))
+        {
+            qWarning () << "PulseAsyncCapture: Stream konnte nicht geöffnet werden:" << device
+                        << pa_strerror (pa_context_errno (m_context));
+            return false;
+        }
+        pa_threaded_mainloop_wait (m_mainloop);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::closeStream (
+    StreamState &state)
+{
+    if (!state.stream)
+    {
+        return;
+    }
+
+    pa_stream_set_read_callback (state.stream, nullptr, nullptr);
+    pa_stream_set_overflow_callback (state.stream, nullptr, nullptr);
+    pa_stream_set_state_callback (state.stream, nullptr, nullptr);
+    pa_stream_disconnect (state.stream);
+    pa_stream_unref (state.stream);
+    state.stream = nullptr; //  Wichtig: Zeiger zurücksetzen, um doppelte Freigaben zu verhindern.
+}
+
+//--------------------------------------------------------------------------------------------------
+
+qint64 PulseAsyncCaptureThread::streamLatencyFrames (
+    const StreamState &state) const
+{
+    pa_usec_t usec = 0;
+    int negative = 0;
+    if (!state.stream || pa_stream_get_latency (state.stream, &usec, &negative) < 0)
+    {
+        return -1; //  Noch keine Timing-Informationen vom Server.
+    }
+    return negative ? 0 : qint64 (usec * SampleRate / 1000000);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool PulseAsyncCaptureThread::alignStreams ()
+{
+    const quint64 received = std::max (m_sys.framesReceived, m_mic.framesReceived);
+    const qint64 latSys = streamLatencyFrames (m_sys);
+    const qint64 latMic = streamLatencyFrames (m_mic);
+
+    if (m_sys.framesReceived == 0 || m_mic.framesReceived == 0 || latSys < 0 || latMic < 0)
+    {
+        //  Liefert nur ein Stream oder fehlen die Timing-Daten zu lange,
+        //  wird ohne Ausrichtung weitergemacht, statt die Aufnahme aufzuhalten.
+        if (received >= quint64 (StallFrames))
+        {
+            qWarning () << "PulseAsyncCapture: Latenz-Ausrichtung übersprungen.";
+            m_aligned = true;
+        }
+        return m_aligned;
+    }
+
+    //  Das älteste gepufferte Sample eines Streams liegt (Latenz + Füllstand) in der
+    //  Vergangenheit. Beim älteren Stream wird die Differenz verworfen, damit beide
+    //  Puffer mit derselben Wanduhrzeit beginnen. Das Mikrofon durchläuft zusätzlich
+    //  den Loopback.
+    const qint64 ageSys = latSys + qint64 (m_sys.fifo.size () / BlockChannels);
+    const qint64 ageMic = latMic + LoopbackLatencyMs * SampleRate / 1000
+                          + qint64 (m_mic.fifo.size () / BlockChannels);
+    const qint64 diff = ageSys - ageMic;
+
+    if (diff > 0)
+    {
+        m_sys.fifo.consume (size_t (diff) * BlockChannels);
+    }
+    else if (diff < 0)
+    {
+        m_mic.fifo.consume (size_t (-diff) * BlockChannels);
+    }
+
+    qDebug () << "PulseAsyncCapture: Latenz System" << latSys * 1000 / SampleRate << "ms, Mikrofon"
+              << latMic * 1000 / SampleRate << "ms, Versatz" << diff * 1000 / SampleRate << "ms";
+    m_aligned = true;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::takeBlock ()
+{
+    const size_t blockSamples = size_t (BlockFrames) * BlockChannels;
+
+    const size_t sysRead = m_sys.fifo.read (bufSys.data (), blockSamples);
+    std::fill (bufSys.begin () + sysRead, bufSys.end (), 0.0f);
+
+    const size_t micRead = m_mic.fifo.read (bufMic.data (), blockSamples);
+    std::fill (bufMic.begin () + micRead, bufMic.end (), 0.0f);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::mixAndPublish ()
+{
+    //  Der Block wird direkt im Pool des AudioBus gefüllt; es entsteht keine Kopie.
+    //  Ist der Pool erschöpft, wird in den lokalen Puffer gemischt und der Block verworfen.
+    AudioBlock *block = acquireBlock ();
+    float *out = block ? block->data : bufMix.data ();
+
+    //  Die Audiodaten von System und Mikrofon werden vom gemeinsamen Mixer additiv gemischt,
+    //  durch die DSP-Kette geschickt und auf den Bereich [-1.0, 1.0] begrenzt.
+    mix (bufSys.data (), bufMic.data (), out, BlockFrames);
+
+    if (block)
+    {
+        block->frames = BlockFrames;
+        publishBlock (block);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::contextStateCallback (
+    pa_context *, void *userdata)
+{
+    auto *self = static_cast<PulseAsyncCaptureThread *> (userdata);
+    pa_threaded_mainloop_signal (self->m_mainloop, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::serverInfoCallback (
+    pa_context *, const pa_server_info *info, void *userdata)
+{
+    auto *self = static_cast<PulseAsyncCaptureThread *> (userdata);
+    if (info)
+    {
+        self->m_defaultSink = QString::fromUtf8 (info->default_sink_name);
+        self->m_defaultSource = QString::fromUtf8 (info->default_source_name);
+    }
+    pa_threaded_mainloop_signal (self->m_mainloop, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::moduleIndexCallback (
+    pa_context *, uint32_t index, void *userdata)
+{
+    auto *self = static_cast<PulseAsyncCaptureThread *> (userdata);
+    self->m_lastIndex = index;
+    pa_threaded_mainloop_signal (self->m_mainloop, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::successCallback (
+    pa_context *, int success, void *userdata)
+{
+    auto *self = static_cast<PulseAsyncCaptureThread *> (userdata);
+    if (!success)
+    {
+        qWarning () << "PulseAsyncCapture: Entladen eines Moduls fehlgeschlagen.";
+    }
+    pa_threaded_mainloop_signal (self->m_mainloop, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::streamStateCallback (
+    pa_stream *, void *userdata)
+{
+    auto *self = static_cast<PulseAsyncCaptureThread *> (userdata);
+    pa_threaded_mainloop_signal (self->m_mainloop, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::streamReadCallback (
+    pa_stream *stream, size_t, void *userdata)
+{
+    //  Läuft im Mainloop-Thread mit gesperrtem Mainloop. Alle verfügbaren Fragmente
+    //  werden direkt in den Ringpuffer des Streams übernommen.
+    auto *state = static_cast<StreamState *> (userdata);
+
+    while (pa_stream_readable_size (stream) > 0)
+    {
+        const void *data = nullptr;
+        size_t bytes = 0;
+        if (pa_stream_peek (stream, &data, &bytes) < 0 || bytes == 0)
+        {
+            break;
+        }
+
+        const size_t samples = bytes / sizeof (float);
+        if (data)
+        {
+            state->fifo.write (static_cast<const float *> (data), samples);
+        }
+        else
+        {
+            state->fifo.writeSilence (samples); //  Ein "Loch" im Stream wird als Stille übernommen.
+            state->owner->countXrun ();
+        }
+        state->framesReceived += samples / BlockChannels;
+        pa_stream_drop (stream);
+    }
+
+    pa_threaded_mainloop_signal (state->owner->m_mainloop, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PulseAsyncCaptureThread::streamOverflowCallback (
+    pa_stream *, void *userdata)
+{
+    //  Der Server musste Daten verwerfen, weil sie nicht rechtzeitig gelesen wurden.
+    static_cast<StreamState *> (userdata)->owner->countXrun ();
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,155 @@
+/**
+ * @file pulseasynccapturethread.h
+ * @brief Enthält die Deklaration der PulseAsyncCaptureThread-Klasse (asynchrone libpulse-API).
+ * @author Mike Wild
+ */
+#ifndef PULSEASYNCCAPTURETHREAD_H
+#define PULSEASYNCCAPTURETHREAD_H
+
+#include "capturethread.h"
+#include "ringbuffer.h"
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+// Forward-Deklarationen für die undurchsichtigen PulseAudio-Strukturen
+struct pa_threaded_mainloop;
+struct pa_context;
+struct pa_stream;
+struct pa_server_info;
+
+/**
+ * @brief Eine CaptureThread-Implementierung für PulseAudio auf Basis der asynchronen API.
+ *
+ * Im Gegensatz zum PulseCaptureThread werden hier weder `pactl`-Prozesse gestartet noch
+ * blockierende `pa_simple`-Streams verwendet. Ein `pa_threaded_mainloop` verwaltet die
+ * Verbindung zum Server, die Module werden direkt über den `pa_context` geladen und beide
+ * Quellen liefern ihre Daten per Callback in je einen Ringpuffer. Dadurch kann ein
+ * stockender Stream den anderen nicht mehr ausbremsen.
+ *
+ * Beim ersten vollständigen Block werden die Streams anhand der vom Server gemeldeten
+ * Latenzen zeitlich ausgerichtet. Beim Stoppen wird genau so viel nachgelesen, wie laut
+ * aktueller Server-Latenz noch unterwegs ist.
+ */
+class PulseAsyncCaptureThread : public CaptureThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Standard-Konstruktor.
+     * @param parent Das QObject-Elternteil für die Speicherverwaltung.
+     */
+    explicit PulseAsyncCaptureThread (QObject *parent = nullptr);
+
+    /**
+     * @brief Fordert das Beenden der Aufnahme an und weckt die wartende Aufnahmeschleife.
+     */
+    void stopCapture () override;
+
+protected:
+    /**
+     * @brief Verbindet sich mit dem Server, lädt die Module und öffnet beide Streams.
+     * @return true bei Erfolg, andernfalls false.
+     */
+    bool initializeCapture () override;
+
+    /**
+     * @brief Wartet, bis von beiden Streams ein Block vorliegt, mischt ihn und veröffentlicht ihn.
+     */
+    void captureLoopIteration () override;
+
+    /**
+     * @brief Liest die noch im Server gepufferten Daten nach und gibt alle Ressourcen frei.
+     */
+    void cleanupCapture () override;
+
+private:
+    /**
+     * @brief Der Zustand eines einzelnen Aufnahme-Streams.
+     *
+     * Wird vom Mainloop-Thread (Callbacks) beschrieben und vom Aufnahme-Thread gelesen;
+     * jeder Zugriff erfolgt unter der Sperre des Mainloops.
+     */
+    struct StreamState
+    {
+        PulseAsyncCaptureThread *owner = nullptr; ///< Rückverweis für die Callbacks.
+        pa_stream *stream = nullptr;              ///< Der Aufnahme-Stream.
+        RingBuffer fifo;                          ///< Interleavte Stereo-Samples des Streams.
+        quint64 framesReceived = 0;               ///< Anzahl der empfangenen Frames.
+    };
+
+    //  Callbacks für den Mainloop-Thread (C-API, daher statisch).
+    static void contextStateCallback (pa_context *context, void *userdata);
+    static void serverInfoCallback (pa_context *context, const pa_server_info *info, void *userdata);
+    static void moduleIndexCallback (pa_context *context, uint32_t index, void *userdata);
+    static void successCallback (pa_context *context, int success, void *userdata);
+    static void streamStateCallback (pa_stream *stream, void *userdata);
+    static void streamReadCallback (pa_stream *stream, size_t nbytes, void *userdata);
+    static void streamOverflowCallback (pa_stream *stream, void *userdata);
+
+    /**
+     * @brief Lädt ein PulseAudio-Modul über den Kontext (Mainloop muss gesperrt sein).
+     * @return Der Modul-Index oder -1 bei einem Fehler.
+     */
+    int loadModule (const char *name, const QString &arguments);
+
+    /**
+     * @brief Entlädt ein zuvor geladenes Modul (Mainloop muss gesperrt sein).
+     */
+    void unloadModule (int index);
+
+    /**
+     * @brief Öffnet einen Aufnahme-Stream auf der angegebenen Quelle (Mainloop muss gesperrt sein).
+     * @return true, sobald der Stream bereit ist.
+     */
+    bool openStream (StreamState &state, const char *name, const QString &device);
+
+    /**
+     * @brief Schließt einen Aufnahme-Stream (Mainloop muss gesperrt sein).
+     */
+    void closeStream (StreamState &state);
+
+    /**
+     * @brief Liefert die aktuelle Latenz eines Streams in Frames oder -1, wenn sie noch unbekannt ist.
+     */
+    qint64 streamLatencyFrames (const StreamState &state) const;
+
+    /**
+     * @brief Verwirft einmalig Frames am Anfang des älteren Streams, damit beide Streams
+     * dieselbe Wanduhrzeit abbilden (Mainloop muss gesperrt sein).
+     * @return true, wenn die Ausrichtung abgeschlossen ist.
+     */
+    bool alignStreams ();
+
+    /**
+     * @brief Entnimmt je einen Block aus beiden Ringpuffern (Mainloop muss gesperrt sein).
+     *
+     * Fehlende Frames eines stockenden Streams werden mit Stille aufgefüllt.
+     */
+    void takeBlock ();
+
+    /**
+     * @brief Mischt bufSys und bufMic direkt in einen Block des AudioBus und veröffentlicht ihn.
+     */
+    void mixAndPublish ();
+
+    pa_threaded_mainloop *m_mainloop; ///< Der Mainloop-Thread von libpulse.
+    pa_context *m_context;            ///< Die Verbindung zum PulseAudio-Server.
+    QMutex m_mainloopGuard;           ///< Schützt m_mainloop gegen stopCapture() aus anderen Threads.
+
+    StreamState m_sys; ///< Zustand des System-Audio-Streams (Monitor der Standard-Senke).
+    StreamState m_mic; ///< Zustand des Mikrofon-Streams (Monitor der virtuellen Senke).
+
+    int m_modNull;  ///< Index des geladenen module-null-sink.
+    int m_modLoop;  ///< Index des geladenen module-loopback.
+    bool m_aligned; ///< Gibt an, ob die Latenz-Ausrichtung bereits erfolgt ist.
+
+    //  Ergebnisse der asynchronen Operationen (nur unter der Mainloop-Sperre verwendet).
+    QString m_defaultSink;   ///< Name der Standard-Senke laut Server.
+    QString m_defaultSource; ///< Name der Standard-Quelle laut Server.
+    uint32_t m_lastIndex;    ///< Ergebnis des letzten pa_context_load_module().
+
+    std::vector<float> bufSys, bufMic, bufMix; ///< Puffer für die Audio-Samples (bufMix nur bei Overrun).
+};
+
+#endif // PULSEASYNCCAPTURETHREAD_H
@@ -1,8 +1,8 @@
 #include "pulsecapturethread.h"
 
+#include <QDebug>
 #include <QProcess>
 #include <QRegularExpression>
-#include <QSettings>
 #include <pulse/error.h>
 #include <pulse/simple.h>
 
@@ -15,8 +15,6 @@ PulseCaptureThread::PulseCaptureThread (
     , m_paMic (nullptr)
     , m_modLoop (-1)
     , m_modNull (-1)
-    , m_sysGain (1.0f)
-    , m_micGain (1.0f)
 {
 }
 
@@ -24,12 +22,7 @@ PulseCaptureThread::PulseCaptureThread (
 
 bool PulseCaptureThread::initializeCapture ()
 {
-    //  ---- 1. Gain-Werte aus Settings lesen ----
-    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
-    m_sysGain = settings.value ("sysGain", 0.5f).toFloat ();
-    m_micGain = settings.value ("micGain", 6.0f).toFloat ();
-
-    //  ---- 2. Default-Sink & -Source ermitteln ----
+    //  ---- 1. Default-Sink & -Source ermitteln ----
     //  Führt 'pactl info' aus, um die Namen der Standard-Audio-Geräte zu ermitteln.
     QProcess infoProc;
     infoProc.start ("pactl", {"info"});
@@ -74,7 +67,7 @@ bool PulseCaptureThread::initializeCapture ()
         return false;
     }
 
-    //  ---- 3. Null-Sink + Loopback für's Mikrofon erstellen ----
+    //  ---- 2. Null-Sink + Loopback für's Mikrofon erstellen ----
     //  Dieser Lambda-Ausdruck kapselt den Aufruf von 'pactl load-module'.
     auto loadModule = [&] (const QString& params) -> int
     {
@@ -103,7 +96,7 @@ bool PulseCaptureThread::initializeCapture ()
         return false;
     }
 
-    //  ---- 4. pa_simple Streams öffnen ----
+    //  ---- 3. pa_simple Streams öffnen ----
     //  Ein ".monitor"-Source in PulseAudio erlaubt das "Mithören" eines Geräts.
     QString sysMon = origSink + ".monitor";
     QString micMon = "mic_sink.monitor";
@@ -143,11 +136,11 @@ bool PulseCaptureThread::initializeCapture ()
         return false;
     }
 
-    //  ---- 5. Puffer vorbereiten ----
-    const int FRAMES = 1024;    //  Anzahl der Audio-Frames pro Lese-Iteration.
-    bufSys.resize (FRAMES * 2); //  Größe = Frames * Anzahl der Kanäle.
-    bufMic.resize (FRAMES * 2);
-    bufMix.resize (FRAMES * 2);
+    //  ---- 4. Puffer vorbereiten ----
+    //  Ein Lesevorgang liefert genau einen Block des AudioBus (BlockFrames Frames).
+    bufSys.resize (BlockFrames * BlockChannels); //  Größe = Frames * Anzahl der Kanäle.
+    bufMic.resize (BlockFrames * BlockChannels);
+    bufMix.resize (BlockFrames * BlockChannels);
 
     return true; //  Alles hat geklappt!
 }
@@ -167,19 +160,7 @@ void PulseCaptureThread::captureLoopIteration ()
         return;
     }
 
-    //  Die Audiodaten von System und Mikrofon werden hier additiv gemischt.
-    for (size_t i = 0; i < bufMix.size (); ++i)
-    {
-        float v = m_sysGain * bufSys[i] + m_micGain * bufMic[i];
-        //  qBound verhindert Übersteuerung (Clipping), indem der Wert auf den Bereich [-1.0, 1.0] begrenzt wird.
-        bufMix[i] = qBound (-1.0f, v, 1.0f);
-    }
-
-    //  Der fertige Audio-Block wird zur weiteren Verarbeitung an den WavWriterThread gesendet.
-    QList<float> chunk;
-    chunk.reserve (bufMix.size ());
-    std::copy (bufMix.begin (), bufMix.end (), std::back_inserter (chunk));
-    emit pcmChunkReady (chunk);
+    mixAndPublish ();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -198,7 +179,7 @@ void PulseCaptureThread::cleanupCapture ()
 
         //  Versuche, bis zu 2 Sekunden nachzulesen.
         int remaining_frames = ss.rate * 2;
-        const int read_frames = 1024;
+        const int read_frames = BlockFrames;
 
         while (remaining_frames > 0)
         {
@@ -219,15 +200,8 @@ void PulseCaptureThread::cleanupCapture ()
                 break;
             }
 
-            //  Mischen und Senden des letzten Chunks.
-            for (size_t i = 0; i < bufMix.size (); ++i)
-            {
-                bufMix[i] = qBound (-1.0f, m_sysGain * bufSys[i] + m_micGain * bufMic[i], 1.0f);
-            }
-            QList<float> chunk;
-            chunk.reserve (bufMix.size ());
-            std::copy (bufMix.begin (), bufMix.end (), std::back_inserter (chunk));
-            emit pcmChunkReady (chunk);
+            //  Mischen und Veröffentlichen des letzten Blocks.
+            mixAndPublish ();
 
             remaining_frames -= read_frames;
         }
@@ -259,5 +233,26 @@ void PulseCaptureThread::cleanupCapture ()
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+
+void PulseCaptureThread::mixAndPublish ()
+{
+    //  Der Block wird direkt im Pool des AudioBus gefüllt; es entsteht keine Kopie.
+    //  Ist der Pool erschöpft, wird in den lokalen Puffer gemischt und der Block verworfen.
+    AudioBlock *block = acquireBlock ();
+    float *out = block ? block->data : bufMix.data ();
+
+    //  Die Audiodaten von System und Mikrofon werden vom gemeinsamen Mixer additiv gemischt,
+    //  durch die DSP-Kette geschickt und auf den Bereich [-1.0, 1.0] begrenzt.
+    mix (bufSys.data (), bufMic.data (), out, BlockFrames);
+
+    //  Der fertige Audio-Block wird an alle Consumer (z.B. den WavWriterThread) verteilt.
+    if (block)
+    {
+        block->frames = BlockFrames;
+        publishBlock (block);
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 //--------------------------------------------------------------------------------------------------
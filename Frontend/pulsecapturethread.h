@@ -46,8 +46,8 @@ protected:
      * @brief Führt eine einzelne Iteration der Aufnahmeschleife aus.
      *
      * Liest Audio-Daten vom System- und Mikrofon-Stream, mischt diese unter
-     * Berücksichtigung der Gain-Faktoren und sendet das Ergebnis über das
-     * pcmChunkReady-Signal.
+     * Berücksichtigung der Gain-Faktoren und der DSP-Kette und veröffentlicht das Ergebnis als
+     * Block auf dem AudioBus.
      */
     void captureLoopIteration () override;
 
@@ -60,13 +60,17 @@ protected:
     void cleanupCapture () override;
 
 private:
+    /**
+     * @brief Mischt bufSys und bufMic direkt in einen Block des AudioBus und veröffentlicht ihn.
+     */
+    void mixAndPublish ();
+
     pa_simple *m_paSys; ///< Handle für den PulseAudio-Stream der System-Sounds.
     pa_simple *m_paMic; ///< Handle für den PulseAudio-Stream des Mikrofons.
     int m_modNull;      ///< ID des geladenen module-null-sink.
     int m_modLoop;      ///< ID des geladenen module-loopback.
 
-    std::vector<float> bufSys, bufMic, bufMix; ///< Puffer für die Audio-Samples.
-    float m_sysGain, m_micGain; ///< Verstärkungsfaktoren für System- und Mikrofon-Audio.
+    std::vector<float> bufSys, bufMic, bufMix; ///< Puffer für die Audio-Samples (bufMix nur bei Overrun).
 };
 
 #endif // PULSECAPTURETHREAD_H
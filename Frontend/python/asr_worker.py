@@ -0,0 +1,438 @@
+#!/usr/bin/env python3
+"""Langlebiger ASR-Worker: lädt Whisper und pyannote einmalig und bearbeitet dann Jobs.
+
+Das Protokoll ist zeilenbasiertes JSON über stdin/stdout (eine Nachricht pro Zeile).
+
+Anfragen (stdin):
+    {"cmd": "transcribe", "id": 1, "path": "/pfad/zur/datei.wav"}
+    {"cmd": "transcribe", "id": 4, "path": "...", "start": 0, "end": 960000, "diarize": false, "threads": 2}
+    {"cmd": "transcribe", "id": 6, "path": "...", "model": "large", "draft": "small", "escalate_below": 0.6}
+    {"cmd": "diarize", "id": 5, "path": "...", "segments": [{"start": 0.02, "end": 1.55}]}
+    {"cmd": "stream_start", "id": 3}
+    {"cmd": "audio", "id": 3, "pcm": "<base64, PCM16 16 kHz mono>"}
+    {"cmd": "stream_end", "id": 3, "path": "/pfad/zur/aufnahme.wav"}
+    {"cmd": "ping", "id": 2}
+    {"cmd": "shutdown"}
+
+Antworten (stdout):
+    {"type": "ready", "load": 12.3, "protocol": 1}
+    {"type": "pong", "id": 2, "busy": true}
+    {"type": "segment", "id": 1, "start": 0.02, "end": 1.55, "speaker": "SPEAKER_00", "text": "...",
+     "confidence": 0.91, "words": [[0.02, 0.6, " Hallo", 0.98], ...]}
+    {"type": "progress", "id": 1, "stage": "transcribe", "fraction": 1.0}
+    {"type": "partial", "id": 3, "segments": [{"start": 12.0, "end": 14.1, "text": "..."}]}
+    {"type": "speaker", "id": 3, "index": 0, "speaker": "SPEAKER_01"}
+    {"type": "done", "id": 1, "timing": {"load": 0.0, "transcribe": 8.1, "diarize": 3.2, "total": 11.4}}
+    {"type": "done", "id": 6, "timing": {..., "audio": 600.0, "escalated": 84.5, "saved": 112.3,
+                                         "final_load": 0.0}}
+    {"type": "error", "id": 1, "message": "..."}
+
+Die Felder der Segmente entsprechen dem Protokoll von run_asr.py ("confidence" und
+"words" fehlen bei Live-Streams).
+
+Mit "start"/"end" (in Samples) wird nur dieser Ausschnitt der Datei transkribiert; so
+können mehrere Worker parallel an Teilen einer langen Aufnahme arbeiten. "diarize": false
+überspringt die Sprecherzuordnung, die dann einmalig per "diarize"-Anfrage für die
+zusammengeführten Segmente erfolgt ("speaker"-Antworten mit "index"). Mit Diarisierung
+laufen Whisper und pyannote gleichzeitig; "total" ist daher kleiner als die Summe der Phasen. "threads" begrenzt
+die Anzahl der Torch-Threads, damit parallele Worker die Kerne nicht überbuchen.
+
+"model" wählt das Whisper-Modell (Standard: large, auch für "stream_start"). Mit "draft"
+transkribiert zuerst das kleine Modell und das große nur Bereiche unter "escalate_below"
+Konfidenz (siehe run_asr.py); "done" meldet dann Audiodauer, erneut transkribierte Sekunden
+und die geschätzte Ersparnis. Modelle werden beim ersten Bedarf geladen; nicht mehr
+benötigte gibt der Worker beim nächsten Job wieder frei.
+
+Live-Streams: Während der Aufnahme werden die Samples fortlaufend gesendet. Etwa alle
+zwei Sekunden wird das noch nicht übernommene Fenster dekodiert. Alle Segmente außer dem
+letzten (das noch weiterwachsen kann) werden als endgültige "segment"-Nachrichten mit
+dem Sprecher LIVE gesendet, der Rest als vorläufige "partial"-Nachricht, die die
+vorherige ersetzt. Nach "stream_end" muss nur noch das letzte Fenster dekodiert werden;
+anschließend ordnet eine Diarisierung der vollständigen Aufnahme allen endgültigen
+Segmenten (in Sendereihenfolge, "index") ihren Sprecher zu.
+
+Pings werden von einem eigenen Lese-Thread sofort beantwortet, auch während ein Job
+läuft. So kann die Anwendung einen hängenden oder abgestürzten Worker erkennen.
+Alle Ausgaben der Bibliotheken werden nach stderr umgeleitet, damit stdout
+ausschließlich Protokollzeilen enthält.
+"""
+import base64
+import json
+import queue
+import sys
+import threading
+import time
+import wave
+
+import numpy as np
+
+from run_asr import (LANGUAGE, MODEL_NAME, PROTOCOL_VERSION, assign_speakers, cascade_transcribe,
+                     load_pipeline, load_whisper, segment_confidence, segment_words,
+                     transcribe_and_diarize, unknown_rate)
+
+#  stdout ist für das Protokoll reserviert; alles andere (auch print() in Bibliotheken) geht nach stderr.
+_protocol_out = sys.stdout
+sys.stdout = sys.stderr
+_write_lock = threading.Lock()
+_busy = threading.Event()
+_models = {}                # Geladene Whisper-Modelle nach Namen.
+
+SAMPLE_RATE = 16000
+STREAM_STEP = 2.0           # Sekunden neuer Audiodaten zwischen zwei Dekodierungen.
+STREAM_MAX_WINDOW = 20.0    # Ab dieser Fensterlänge werden alle Segmente übernommen.
+STREAM_MIN_AUDIO = 0.5      # Kürzere Fenster werden nicht dekodiert.
+LIVE_SPEAKER = "LIVE"       # Vorläufiger Sprecher bis zur Diarisierung am Ende.
+
+
+def send(message):
+    """Schreibt eine Protokollnachricht als eine JSON-Zeile nach stdout."""
+    line = json.dumps(message, ensure_ascii=False)
+    with _write_lock:
+        _protocol_out.write(line + "\n")
+        _protocol_out.flush()
+
+
+class AudioStream:
+    """Sammelt die vom Lese-Thread empfangenen Samples eines Live-Streams.
+
+    Bereits übernommene Samples werden mit discard() verworfen; alle Positionen sind
+    absolute Sample-Indizes ab Beginn des Streams.
+    """
+
+    def __init__(self, stream_id):
+        self.id = stream_id
+        self.path = None
+        self._chunks = []
+        self._base = 0
+        self._total = 0
+        self._ended = False
+        self._cond = threading.Condition()
+
+    def append(self, pcm):
+        samples = np.frombuffer(pcm, dtype=np.int16)
+        with self._cond:
+            self._chunks.append(samples)
+            self._total += len(samples)
+            self._cond.notify()
+
+    def end(self, path):
+        with self._cond:
+            self.path = path
+            self._ended = True
+            self._cond.notify()
+
+    def wait(self, min_total):
+        """Wartet, bis min_total Samples vorliegen oder der Stream beendet ist; gibt "beendet" zurück."""
+        with self._cond:
+            self._cond.wait_for(lambda: self._ended or self._total >= min_total)
+            return self._ended
+
+    def window(self, start):
+        """Gibt die Samples ab start als float32 sowie die aktuelle Gesamtlänge zurück."""
+        with self._cond:
+            if len(self._chunks) > 1:
+                self._chunks = [np.concatenate(self._chunks)]
+            data = self._chunks[0] if self._chunks else np.zeros(0, dtype=np.int16)
+            total = self._total
+        return data[start - self._base:].astype(np.float32) / 32768.0, total
+
+    def discard(self, upto):
+        """Verwirft alle Samples vor der absoluten Position upto."""
+        with self._cond:
+            if self._chunks and upto > self._base:
+                self._chunks = [self._chunks[0][upto - self._base:]] + self._chunks[1:]
+                self._base = upto
+
+
+_stream = None
+
+
+def read_requests(jobs):
+    """Liest Anfragen von stdin; Pings und Audiodaten werden direkt verarbeitet, Jobs eingereiht."""
+    global _stream
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            request = json.loads(line)
+        except json.JSONDecodeError as e:
+            send({"type": "error", "id": None, "message": f"Ungültiges JSON: {e}"})
+            continue
+
+        cmd = request.get("cmd")
+        if cmd == "ping":
+            send({"type": "pong", "id": request.get("id"), "busy": _busy.is_set()})
+        elif cmd == "audio":
+            if _stream is not None and _stream.id == request.get("id"):
+                _stream.append(base64.b64decode(request.get("pcm", "")))
+        elif cmd == "stream_start":
+            _stream = AudioStream(request.get("id"))
+            jobs.put(request)
+        elif cmd == "stream_end":
+            if _stream is not None and _stream.id == request.get("id"):
+                _stream.end(request.get("path"))
+        elif cmd == "shutdown":
+            break
+        else:
+            jobs.put(request)
+
+    #  stdin geschlossen oder "shutdown": Ein offener Stream wird abgeschlossen, danach
+    #  beendet sich die Hauptschleife nach dem aktuellen Job.
+    if _stream is not None:
+        _stream.end(None)
+    jobs.put(None)
+
+
+def load_models():
+    """Lädt das Standard-Whisper-Modell und gibt die Diarisierungs-Pipeline zurück."""
+    get_model(MODEL_NAME)
+    print("Lade Diarisierungs-Pipeline...", file=sys.stderr)
+    return load_pipeline()
+
+
+def get_model(name):
+    """Gibt ein Whisper-Modell zurück und lädt es beim ersten Bedarf."""
+    if name not in _models:
+        print(f"Lade Whisper-Modell {name}...", file=sys.stderr)
+        _models[name] = load_whisper(name)
+    return _models[name]
+
+
+def retain_models(names):
+    """Gibt alle Whisper-Modelle außer den genannten frei."""
+    for name in list(_models):
+        if name not in names:
+            del _models[name]
+
+
+def apply_threads(job):
+    """Setzt die Anzahl der Torch-Threads, falls die Anfrage sie vorgibt."""
+    threads = job.get("threads")
+    if threads:
+        import torch
+        torch.set_num_threads(max(1, int(threads)))
+
+
+def load_job_audio(job):
+    """Gibt den Pfad bzw. bei "start"/"end" den Ausschnitt der Datei als float32 zurück."""
+    path = job["path"]
+    if "start" not in job:
+        return path
+    start, end = int(job["start"]), int(job["end"])
+    with wave.open(path, "rb") as wav:
+        wav.setpos(start)
+        frames = wav.readframes(end - start)
+    return np.frombuffer(frames, dtype=np.int16).astype(np.float32) / 32768.0
+
+
+def run_job(job_id, job, pipeline, load_seconds):
+    """Transkribiert (und diarisiert) eine Datei und sendet Segmente sowie die Zeitmessung.
+
+    Mit Diarisierung laufen Whisper und pyannote gleichzeitig auf derselben Datei.
+    """
+    t0 = time.perf_counter()
+    options = {"language": LANGUAGE, "fp16": False, "word_timestamps": True}
+    model_name = job.get("model") or MODEL_NAME
+    draft_name = job.get("draft")
+    audio = load_job_audio(job)
+
+    def transcribe():
+        if draft_name:
+            return cascade_transcribe(get_model(draft_name), lambda: get_model(model_name), audio,
+                                      (draft_name, model_name), float(job.get("escalate_below", 0.6)),
+                                      **options)
+        return get_model(model_name).transcribe(audio, **options), None
+
+    if job.get("diarize", True):
+        (result, cascade), diarization, transcribe_seconds, diarize_seconds = transcribe_and_diarize(
+            transcribe, lambda: pipeline(job["path"]))
+        entries = assign_speakers(result["segments"], diarization)
+    else:
+        result, cascade = transcribe()
+        transcribe_seconds, diarize_seconds = time.perf_counter() - t0, 0.0
+        entries = [{"start": seg["start"], "end": seg["end"], "speaker": "", "text": seg["text"].strip(),
+                    "confidence": segment_confidence(seg), "words": segment_words(seg)}
+                   for seg in speech_segments(result)]
+    wall = time.perf_counter() - t0
+    send({"type": "progress", "id": job_id, "stage": "transcribe", "fraction": 1.0})
+
+    for entry in entries:
+        send({
+            "type": "segment",
+            "id": job_id,
+            "start": round(entry["start"], 2),
+            "end": round(entry["end"], 2),
+            "speaker": entry["speaker"],
+            "text": entry["text"],
+            "confidence": entry["confidence"],
+            "words": entry["words"],
+        })
+
+    timing = {
+        "load": round(load_seconds, 3),
+        "transcribe": round(transcribe_seconds, 3),
+        "diarize": round(diarize_seconds, 3),
+        "total": round(load_seconds + wall, 3),
+    }
+    if cascade:
+        timing.update(cascade)
+    send({"type": "done", "id": job_id, "timing": timing})
+    if job.get("diarize", True):
+        print(f"Job {job_id}: {wall:.1f} s (Transkription {transcribe_seconds:.1f} s, Diarisierung "
+              f"{diarize_seconds:.1f} s parallel), ohne Sprecher: {unknown_rate(entries):.1%}",
+              file=sys.stderr)
+
+
+def speech_segments(result):
+    """Filtert leere Segmente und typische Halluzinationen in Stille heraus."""
+    return [seg for seg in result["segments"]
+            if seg["text"].strip()
+            and not (seg.get("no_speech_prob", 0.0) > 0.6 and seg.get("avg_logprob", 0.0) < -1.0)]
+
+
+def run_stream(stream, model, pipeline, load_seconds):
+    """Transkribiert einen Live-Stream fortlaufend und ordnet am Ende die Sprecher zu."""
+    step = int(STREAM_STEP * SAMPLE_RATE)
+    committed = 0          # Absolute Position, bis zu der alle Segmente endgültig sind.
+    decoded_until = 0      # Gesamtlänge beim letzten Dekodieren.
+    finals = []
+    prompt = None
+    transcribe_seconds = 0.0
+    tail_start = None
+
+    while True:
+        ended = stream.wait(decoded_until + step)
+        if ended and tail_start is None:
+            tail_start = time.perf_counter()
+        audio, decoded_until = stream.window(committed)
+        window = len(audio) / SAMPLE_RATE
+        if window < STREAM_MIN_AUDIO:
+            if ended:
+                break
+            continue
+
+        t0 = time.perf_counter()
+        result = model.transcribe(audio, language=LANGUAGE, fp16=False,
+                                  condition_on_previous_text=False, initial_prompt=prompt)
+        transcribe_seconds += time.perf_counter() - t0
+        segments = speech_segments(result)
+
+        #  Das letzte Segment kann mit neuen Daten noch weiterwachsen und bleibt vorläufig,
+        #  außer der Stream ist beendet oder das Fenster wird zu lang.
+        if ended or window >= STREAM_MAX_WINDOW:
+            final, pending = segments, []
+        else:
+            final, pending = segments[:-1], segments[-1:]
+
+        offset = committed / SAMPLE_RATE
+        for seg in final:
+            entry = {"start": offset + seg["start"], "end": offset + seg["end"], "text": seg["text"].strip()}
+            finals.append(entry)
+            send({"type": "segment", "id": stream.id, "start": round(entry["start"], 2),
+                  "end": round(entry["end"], 2), "speaker": LIVE_SPEAKER, "text": entry["text"]})
+
+        if final:
+            committed += int(min(final[-1]["end"], window) * SAMPLE_RATE)
+            prompt = " ".join(entry["text"] for entry in finals[-3:])
+        elif window >= STREAM_MAX_WINDOW:
+            #  Keine Sprache im ganzen Fenster: bis auf die letzte Sekunde verwerfen.
+            committed += int((window - 1.0) * SAMPLE_RATE)
+        stream.discard(committed)
+
+        send({"type": "partial", "id": stream.id, "segments": [
+            {"start": round(offset + seg["start"], 2), "end": round(offset + seg["end"], 2),
+             "text": seg["text"].strip()} for seg in pending]})
+        if ended:
+            break
+
+    #  Die Diarisierung braucht die vollständige Aufnahme und läuft daher erst nach dem Ende.
+    t1 = time.perf_counter()
+    if finals and stream.path:
+        diarization = pipeline(stream.path)
+        for index, entry in enumerate(assign_speakers(finals, diarization)):
+            send({"type": "speaker", "id": stream.id, "index": index, "speaker": entry["speaker"]})
+    t2 = time.perf_counter()
+
+    send({
+        "type": "done",
+        "id": stream.id,
+        "timing": {
+            "load": round(load_seconds, 3),
+            "transcribe": round(transcribe_seconds, 3),
+            "diarize": round(t2 - t1, 3),
+            "total": round(load_seconds + transcribe_seconds + (t2 - t1), 3),
+            "tail": round(t2 - (tail_start or t1), 3),
+        },
+    })
+
+
+def run_diarize(job_id, job, pipeline, load_seconds):
+    """Ordnet bereits transkribierten Segmenten anhand der ganzen Datei die Sprecher zu."""
+    t0 = time.perf_counter()
+    diarization = pipeline(job["path"])
+    segments = [{"start": seg["start"], "end": seg["end"], "text": ""} for seg in job.get("segments", [])]
+    for index, entry in enumerate(assign_speakers(segments, diarization)):
+        send({"type": "speaker", "id": job_id, "index": index, "speaker": entry["speaker"]})
+    t1 = time.perf_counter()
+
+    send({
+        "type": "done",
+        "id": job_id,
+        "timing": {
+            "load": round(load_seconds, 3),
+            "transcribe": 0.0,
+            "diarize": round(t1 - t0, 3),
+            "total": round(load_seconds + (t1 - t0), 3),
+        },
+    })
+
+
+def main():
+    """Startet den Lese-Thread, lädt die Modelle und arbeitet Jobs nacheinander ab."""
+    jobs = queue.Queue()
+    threading.Thread(target=read_requests, args=(jobs,), daemon=True).start()
+
+    t0 = time.perf_counter()
+    try:
+        pipeline = load_models()
+    except Exception as e:
+        send({"type": "error", "id": None, "message": f"Modelle konnten nicht geladen werden: {e}"})
+        sys.exit(1)
+    load_seconds = time.perf_counter() - t0
+    send({"type": "ready", "load": round(load_seconds, 3), "protocol": PROTOCOL_VERSION})
+
+    #  Die Ladezeit wird dem ersten Job zugerechnet; alle weiteren Jobs laden nichts mehr.
+    pending_load = load_seconds
+    while True:
+        job = jobs.get()
+        if job is None:
+            break
+
+        job_id = job.get("id")
+        cmd = job.get("cmd")
+        is_stream = cmd == "stream_start" and _stream is not None and _stream.id == job_id
+        if not is_stream and (cmd not in ("transcribe", "diarize") or not job.get("path")):
+            send({"type": "error", "id": job_id, "message": f"Unbekannte Anfrage: {job}"})
+            continue
+
+        _busy.set()
+        try:
+            apply_threads(job)
+            if cmd != "diarize":
+                retain_models({job.get("model") or MODEL_NAME, job.get("draft")})
+            if is_stream:
+                run_stream(_stream, get_model(job.get("model") or MODEL_NAME), pipeline, pending_load)
+            elif cmd == "diarize":
+                run_diarize(job_id, job, pipeline, pending_load)
+            else:
+                run_job(job_id, job, pipeline, pending_load)
+        except Exception as e:
+            send({"type": "error", "id": job_id, "message": str(e)})
+        finally:
+            _busy.clear()
+            pending_load = 0.0
+
+
+if __name__ == "__main__":
+    main()
@@ -3,6 +3,51 @@ import sys
 import spacy
 from collections import Counter
 
+MODEL_NAME = "de_core_news_lg"
+ALLOWED_ENTITIES = ["PER", "LOC", "ORG", "MISC"]
+MEETING_KEYWORDS = 10   # Häufigste Substantive, die als Meeting-Tags übernommen werden.
+SEGMENT_KEYWORDS = 3    # Häufigste Substantive eines einzelnen Segments.
+
+
+def load_nlp():
+    """Lädt das deutsche spaCy-Modell.
+
+    Raises:
+        OSError: Wenn das Modell nicht installiert ist.
+    """
+    return spacy.load(MODEL_NAME)
+
+
+def doc_entities(doc):
+    """Gibt die Eigennamen (Personen, Orte, Organisationen, Sonstiges) eines Dokuments zurück."""
+    return [ent.text.strip() for ent in doc.ents if ent.label_ in ALLOWED_ENTITIES and ent.text.strip()]
+
+
+def doc_keywords(doc):
+    """Gibt die Grundformen (Lemmata) aller Substantive eines Dokuments zurück."""
+    return [token.lemma_.capitalize() for token in doc
+            if token.pos_ in ["NOUN", "PROPN"] and not token.is_stop and not token.is_punct]
+
+
+def segment_tags(entities, keywords):
+    """Bildet die Tags eines einzelnen Segments aus seinen Eigennamen und Substantiven."""
+    tags = set(entities)
+    tags.update(keyword for keyword, _ in Counter(keywords).most_common(SEGMENT_KEYWORDS))
+    return sorted(tags)
+
+
+def meeting_tags(entities, keyword_counts):
+    """Bildet die Tags des ganzen Meetings aus allen Eigennamen und den häufigsten Substantiven.
+
+    Args:
+        entities (set): Alle gefundenen Eigennamen.
+        keyword_counts (Counter): Häufigkeit der Substantiv-Lemmata.
+    """
+    tags = set(entities)
+    tags.update(keyword for keyword, _ in keyword_counts.most_common(MEETING_KEYWORDS))
+    return sorted(tags)
+
+
 def generate_tags(text):
     """Analysiert einen deutschen Text und extrahiert zwei Arten von Tags.
 
@@ -18,7 +63,7 @@ def generate_tags(text):
         list: Eine alphabetisch sortierte Liste der gefundenen, einzigartigen Tags.
     """
     try:
-        nlp = spacy.load("de_core_news_lg")
+        nlp = load_nlp()
     except OSError:
         #  Gibt eine klare Fehlermeldung aus, wenn das Sprachmodell fehlt.
         print("FEHLER: Deutsches spaCy-Modell 'de_core_news_lg' nicht gefunden.", file=sys.stderr)
@@ -26,27 +71,7 @@ def generate_tags(text):
         sys.exit(1)
 
     doc = nlp(text)
-    tags = set()
-
-    # --- Methode 1: Eigennamen extrahieren (NER) ---
-    allowed_entities = ["PER", "LOC", "ORG", "MISC"]
-    for ent in doc.ents:
-        if ent.label_ in allowed_entities:
-            tags.add(ent.text.strip())
-
-    # --- Methode 2: Schlüsselwörter (häufigste Substantive) extrahieren ---
-    keywords = []
-    for token in doc:
-        if (token.pos_ in ["NOUN", "PROPN"] and not token.is_stop and not token.is_punct):
-            #  Verwendung der Grundform (Lemma), um Wortvarianten zu gruppieren.
-            keywords.append(token.lemma_.capitalize())
-
-    #  Fügt die 10 häufigsten gefundenen Schlüsselwörter zu den Tags hinzu.
-    most_common_keywords = Counter(keywords).most_common(10)
-    for keyword, count in most_common_keywords:
-        tags.add(keyword)
-
-    return sorted(list(tags))
+    return meeting_tags(set(doc_entities(doc)), Counter(doc_keywords(doc)))
 
 
 if __name__ == "__main__":
@@ -1,83 +1,376 @@
 #!/usr/bin/env python3
+"""Transkribiert eine WAV-Datei mit Whisper und ordnet mit pyannote die Sprecher zu.
+
+Die Ausgabe auf stdout folgt dem ASR-Protokoll (Version 1), eine JSON-Nachricht pro Zeile:
+    {"type": "hello", "protocol": 1, "language": "de", "model": "large"}
+    {"type": "progress", "stage": "transcribe", "fraction": 0.0}
+    {"type": "segment", "start": 0.02, "end": 1.55, "speaker": "SPEAKER_00", "text": "...",
+     "confidence": 0.91, "words": [[0.02, 0.6, " Hallo", 0.98], ...]}
+    {"type": "done", "load": 9.1, "transcribe": 41.7, "diarize": 18.2, "total": 52.4, "unknown_rate": 0.03,
+     "audio": 600.0, "escalated": 84.5, "saved": 112.3, "final_load": 14.2}
+    {"type": "error", "message": "..."}
+
+"confidence" ist exp(avg_logprob) des Segments, "words" enthält je Wort Start, Ende (in
+Sekunden), Text und Wahrscheinlichkeit. Transkription und Diarisierung laufen gleichzeitig;
+"done" meldet die Dauer beider Phasen, die Wanduhrzeit ("total") und den Anteil der Segmente
+ohne Sprecher ("unknown_rate"). Diagnose-Ausgaben gehen nach stderr.
+
+Kaskade (--draft): Ein kleines Modell transkribiert zuerst die ganze Datei; nur Bereiche mit
+Segmenten unter --escalate-below Konfidenz transkribiert das große Modell erneut und ersetzt
+sie. "done" meldet dann zusätzlich die Audiodauer, die erneut transkribierten Sekunden
+("escalated") und die geschätzte Ersparnis gegenüber nur dem großen Modell ("saved").
+Muss das große Modell dafür erst geladen werden, steht die Ladezeit getrennt in "final_load";
+die Ersparnis rechnet nur mit der reinen Transkriptionszeit.
+
+Benutzung: run_asr.py <datei.wav> [--model large] [--draft small] [--escalate-below 0.6]
+"""
+import argparse
+import json
+import math
+import os
 import sys
-import whisper
-from pyannote.audio import Pipeline
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+PROTOCOL_VERSION = 1
+MODEL_NAME = "large"
+LANGUAGE = "de"
+SAMPLE_RATE = 16000
+
+#  Ungefähre Geschwindigkeit der Whisper-Modelle relativ zu "large" (laut Whisper-README, nicht
+#  genannte Modelle zählen wie "large"); dient nur zur Schätzung der Ersparnis, wenn kein
+#  Bereich erneut transkribiert wurde.
+RELATIVE_SPEED = {"tiny": 10.0, "base": 7.0, "small": 4.0, "medium": 2.0, "turbo": 8.0}
+ESCALATE_PADDING = 0.3      # Sekunden Kontext vor und nach einem erneut transkribierten Bereich.
+ESCALATE_JOIN_GAP = 2.0     # Bereiche mit kleinerem Abstand werden zusammen transkribiert.
+MAX_COMPRESSION_RATIO = 2.4 # Darüber wiederholt sich Whisper meist (wie in Whispers Fallback).
+
+
+_send_lock = threading.Lock()
+
+
+def send(message):
+    """Schreibt eine Protokollnachricht als eine JSON-Zeile nach stdout (aus jedem Thread)."""
+    line = json.dumps(message, ensure_ascii=False)
+    with _send_lock:
+        print(line, flush=True)
+
+
+def segment_confidence(seg):
+    """Gibt die Konfidenz eines Whisper-Segments (0..1) zurück, None falls unbekannt."""
+    if "avg_logprob" not in seg:
+        return None
+    return round(min(1.0, math.exp(seg["avg_logprob"])), 3)
+
+
+def segment_words(seg):
+    """Gibt die Wort-Zeitstempel eines Whisper-Segments kompakt als Liste von Arrays zurück."""
+    return [[round(w["start"], 2), round(w["end"], 2), w["word"], round(w.get("probability", -1.0), 3)]
+            for w in seg.get("words", [])]
+
+
+def load_whisper(name):
+    """Lädt ein Whisper-Modell; "-int8" am Namen quantisiert dessen lineare Schichten (nur CPU)."""
+    import whisper
+
+    quantized = name.endswith("-int8")
+    model = whisper.load_model(name[:-len("-int8")] if quantized else name)
+    if quantized:
+        import torch
+        model = torch.quantization.quantize_dynamic(model, {torch.nn.Linear}, dtype=torch.qint8)
+    return model
+
+
+def needs_escalation(seg, threshold):
+    """Gibt an, ob ein Segment des kleinen Modells vom großen Modell erneut transkribiert wird."""
+    confidence = segment_confidence(seg)
+    return ((confidence is not None and confidence < threshold)
+            or seg.get("compression_ratio", 0.0) > MAX_COMPRESSION_RATIO)
+
+
+def escalation_ranges(segments, threshold, duration):
+    """Fasst unsichere Segmente zu Zeitbereichen zusammen, die erneut transkribiert werden.
+
+    Der zusätzliche Kontext reicht höchstens bis an die sicheren Nachbarsegmente heran, damit
+    deren Wörter nicht doppelt im Ergebnis landen.
+    """
+    ranges = []
+    for i, seg in enumerate(segments):
+        if not needs_escalation(seg, threshold):
+            continue
+        previous_end = segments[i - 1]["end"] if i > 0 else 0.0
+        next_start = segments[i + 1]["start"] if i + 1 < len(segments) else duration
+        start = max(0.0, min(seg["start"], max(previous_end, seg["start"] - ESCALATE_PADDING)))
+        end = min(duration, max(seg["end"], min(next_start, seg["end"] + ESCALATE_PADDING)))
+        if ranges and start - ranges[-1][1] < ESCALATE_JOIN_GAP:
+            ranges[-1][1] = max(ranges[-1][1], end)
+        else:
+            ranges.append([start, end])
+    return ranges
+
+
+def shift_segment(seg, offset):
+    """Verschiebt ein Whisper-Segment samt Wörtern um offset Sekunden."""
+    seg = dict(seg, start=seg["start"] + offset, end=seg["end"] + offset)
+    seg["words"] = [dict(w, start=w["start"] + offset, end=w["end"] + offset) for w in seg.get("words", [])]
+    return seg
+
+
+def cascade_transcribe(draft_model, final_model, audio, names, threshold, **options):
+    """Transkribiert erst mit dem kleinen Modell und nur unsichere Bereiche mit dem großen.
+
+    Die Ergebnisse des großen Modells ersetzen alle Segmente des kleinen, deren Mitte im
+    jeweiligen Bereich liegt, und werden nach Zeit einsortiert.
+
+    Args:
+        draft_model: Das kleine Whisper-Modell.
+        final_model (callable): Liefert das große Modell (wird erst bei Bedarf geladen).
+        audio: Pfad oder float32-Samples (16 kHz).
+        names (tuple): Namen des kleinen und des großen Modells für die Schätzung der Ersparnis.
+        threshold (float): Segmente mit geringerer Konfidenz werden erneut transkribiert.
+        **options: Weitere Argumente für transcribe().
+
+    Returns:
+        tuple: (Ergebnis mit "segments", Statistik mit "audio", "escalated", "saved" und
+            "final_load" in Sekunden)
+    """
+    import numpy as np
+
+    if isinstance(audio, str):
+        import whisper
+        audio = whisper.load_audio(audio)
+    duration = len(audio) / SAMPLE_RATE
+
+    t0 = time.perf_counter()
+    segments = draft_model.transcribe(audio, **options)["segments"]
+    draft_seconds = time.perf_counter() - t0
+
+    ranges = escalation_ranges(segments, threshold, duration)
+
+    #  Das große Modell wird vor der Zeitmessung geladen; sonst ginge die Ladezeit in die
+    #  Hochrechnung ein und würde die Ersparnis um ein Vielfaches überschätzen.
+    model, load_seconds = None, 0.0
+    if ranges:
+        t_load = time.perf_counter()
+        model = final_model()
+        load_seconds = time.perf_counter() - t_load
+
+    t1 = time.perf_counter()
+    for start, end in ranges:
+        clip = np.ascontiguousarray(audio[int(start * SAMPLE_RATE):int(end * SAMPLE_RATE)])
+        result = model.transcribe(clip, condition_on_previous_text=False, **options)
+        segments = [seg for seg in segments if not start <= (seg["start"] + seg["end"]) / 2 < end]
+        for seg in result["segments"]:
+            seg = shift_segment(seg, start)
+            seg["start"], seg["end"] = max(seg["start"], start), min(seg["end"], end)
+            segments.append(seg)
+    final_seconds = time.perf_counter() - t1
+    segments.sort(key=lambda seg: seg["start"])
+
+    #  Die Zeit für nur das große Modell wird aus seiner gemessenen Geschwindigkeit auf den
+    #  erneut transkribierten Bereichen hochgerechnet, sonst aus der relativen Geschwindigkeit.
+    escalated = sum(end - start for start, end in ranges)
+    if escalated >= 1.0:
+        large_only = final_seconds * duration / escalated
+    else:
+        draft_name, final_name = (name[:-len("-int8")] if name.endswith("-int8") else name for name in names)
+        large_only = draft_seconds * RELATIVE_SPEED.get(draft_name, 1.0) / RELATIVE_SPEED.get(final_name, 1.0)
+    stats = {
+        "audio": round(duration, 2),
+        "escalated": round(escalated, 2),
+        "saved": round(large_only - draft_seconds - final_seconds, 2),
+        "final_load": round(load_seconds, 2),
+    }
+    return {"segments": segments}, stats
+
 
 def assign_speakers(transcript_segments, diarization):
     """Ordnet Transkript-Segmenten die erkannten Sprecher zu.
 
-    Die Funktion iteriert durch die von Whisper erkannten Textsegmente und gleicht
-    deren Zeitstempel mit den von pyannote erkannten Sprecher-Zeitintervallen
-    (diarization) ab.
+    Segmente und Sprecherabschnitte werden gemeinsam einmal nach Startzeit durchlaufen
+    (O(Segmente + Abschnitte) statt O(Segmente × Abschnitte)). Jedes Segment erhält den Sprecher
+    mit der größten zeitlichen Überlappung; nur Segmente, die keinen Abschnitt berühren,
+    bleiben UNKNOWN.
 
     Args:
         transcript_segments (list): Eine Liste von Segmenten aus der Whisper-Transkription.
         diarization (pyannote.core.Annotation): Das Diarisierungs-Ergebnis von pyannote.
 
     Returns:
-        list: Eine Liste von Segmenten, bei denen jedes einen "speaker"-Schlüssel enthält.
+        list: Die Segmente in der ursprünglichen Reihenfolge, jedes mit einem "speaker"-Schlüssel.
     """
-    final_output = []
-    for seg in transcript_segments:
-        t_start, t_end = seg["start"], seg["end"]
-        speaker = "UNKNOWN"
-        #  Finde heraus, welcher Sprecher im Zeitintervall des Textsegments aktiv war.
-        for turn, _, label in diarization.itertracks(yield_label=True):
-            if turn.start <= t_start and turn.end >= t_end:
-                speaker = label
-                break
-        final_output.append({
-            "start": t_start,
-            "end": t_end,
-            "speaker": speaker,
-            "text": seg["text"].strip()
-        })
-    return final_output
+    turns = sorted((turn.start, turn.end, label) for turn, _, label in diarization.itertracks(yield_label=True))
+    order = sorted(range(len(transcript_segments)), key=lambda i: transcript_segments[i]["start"])
+    speakers = ["UNKNOWN"] * len(transcript_segments)
+
+    active = []      # Abschnitte, die das aktuelle Segment noch berühren können.
+    next_turn = 0
+    for i in order:
+        t_start, t_end = transcript_segments[i]["start"], transcript_segments[i]["end"]
+        while next_turn < len(turns) and turns[next_turn][0] < t_end:
+            active.append(turns[next_turn])
+            next_turn += 1
+        #  Die Segmente sind nach Start sortiert: Was vor diesem Segment endet, endet auch
+        #  vor allen weiteren.
+        active = [turn for turn in active if turn[1] > t_start]
+
+        overlap = {}
+        for turn_start, turn_end, label in active:
+            shared = min(t_end, turn_end) - max(t_start, turn_start)
+            if shared > 0:
+                overlap[label] = overlap.get(label, 0.0) + shared
+        if overlap:
+            speakers[i] = max(overlap, key=overlap.get)
+
+    return [{
+        "start": seg["start"],
+        "end": seg["end"],
+        "speaker": speaker,
+        "text": seg["text"].strip(),
+        "confidence": segment_confidence(seg),
+        "words": segment_words(seg),
+    } for seg, speaker in zip(transcript_segments, speakers)]
+
+
+def unknown_rate(entries):
+    """Gibt den Anteil der Segmente ohne zugeordneten Sprecher zurück (0..1)."""
+    if not entries:
+        return 0.0
+    return sum(1 for entry in entries if entry["speaker"] == "UNKNOWN") / len(entries)
+
+
+def transcribe_and_diarize(transcribe, diarize):
+    """Führt Transkription und Diarisierung gleichzeitig auf derselben Aufnahme aus.
+
+    Beide Modelle verbringen ihre Zeit fast ausschließlich in Torch-Operationen, die den GIL
+    freigeben; ein zweiter Thread genügt daher und spart gegenüber einem eigenen Prozess das
+    doppelte Laden bzw. Übertragen der Modelle.
+
+    Args:
+        transcribe (callable): Liefert ohne Argumente das Ergebnis der Transkription.
+        diarize (callable): Liefert ohne Argumente das Diarisierungs-Ergebnis.
+
+    Returns:
+        tuple: (Transkription, Diarisierung, Sekunden Transkription, Sekunden Diarisierung)
+    """
+    def timed_diarize():
+        t0 = time.perf_counter()
+        return diarize(), time.perf_counter() - t0
+
+    with ThreadPoolExecutor(max_workers=1) as pool:
+        diarization_future = pool.submit(timed_diarize)
+        t0 = time.perf_counter()
+        result = transcribe()
+        transcribe_seconds = time.perf_counter() - t0
+        diarization, diarize_seconds = diarization_future.result()
+    return result, diarization, transcribe_seconds, diarize_seconds
+
+
+def load_pipeline():
+    """Lädt die Diarisierungs-Pipeline von pyannote."""
+    from pyannote.audio import Pipeline
+
+    pipeline = Pipeline.from_pretrained(
+        "pyannote/speaker-diarization-3.0",
+        use_auth_token=os.environ.get("HF_TOKEN")
+    )
+    if pipeline is None:
+        raise RuntimeError("Diarisierungs-Pipeline konnte nicht geladen werden "
+                           "(Modell-Bedingungen auf huggingface.co akzeptiert?)")
+    return pipeline
+
 
 def main():
     """Hauptfunktion des Skripts zur Transkription und Sprecherzuordnung."""
-    if len(sys.argv) != 2:
-        print(f"Benutzung: {sys.argv[0]} <audio_datei.wav>", file=sys.stderr)
-        sys.exit(1)
+    parser = argparse.ArgumentParser(description="Transkription mit Sprecherzuordnung")
+    parser.add_argument("audio_path", help="Die zu transkribierende WAV-Datei.")
+    parser.add_argument("--model", default=MODEL_NAME, help="Whisper-Modell für das Endergebnis.")
+    parser.add_argument("--draft", help="Kleines Modell für den ersten Durchgang (Kaskade).")
+    parser.add_argument("--escalate-below", type=float, default=0.6,
+                        help="Konfidenz, unter der das große Modell erneut transkribiert.")
+    args = parser.parse_args()
+
+    audio_path = args.audio_path
+    model_label = f"{args.draft}>{args.model}" if args.draft else args.model
+    send({"type": "hello", "protocol": PROTOCOL_VERSION, "language": LANGUAGE, "model": model_label})
+    t_begin = time.perf_counter()
+
+    #  Schritt 1: Whisper-Modell laden (in der Kaskade zunächst nur das kleine; das große
+    #  folgt erst, wenn ein Bereich unsicher ist)
+    print("Lade Whisper-Modell...", file=sys.stderr)
+    send({"type": "progress", "stage": "load", "fraction": 0.0})
+    model = load_whisper(args.draft or args.model)
+    load_seconds = time.perf_counter() - t_begin
+
+    final_model = []
+    def get_final_model():
+        if not final_model:
+            final_model.append(load_whisper(args.model))
+        return final_model[0]
 
-    audio_path = sys.argv[1]
-    #  WICHTIGER HINWEIS: Der Hugging Face Token wird für das pyannote-Modell benötigt.
-    #  Er sollte idealerweise als Umgebungsvariable gesetzt oder sicher verwaltet werden.
-    HF_TOKEN = os.environ["HF_TOKEN"]
+    options = {"language": LANGUAGE, "fp16": False, "word_timestamps": True}
+    def transcribe():
+        if args.draft:
+            return cascade_transcribe(model, get_final_model, audio_path, (args.draft, args.model),
+                                      args.escalate_below, **options)
+        return model.transcribe(audio_path, **options), None
 
-    #  Schritt 1: Transkription mit Whisper ASR
-    print("Starte Transkription mit Whisper...", file=sys.stderr)
-    model = whisper.load_model("large")
-    result = model.transcribe(audio_path, language="de", fp16=False)
-    segments = result["segments"]
-    print("Transkription beendet.", file=sys.stderr)
+    #  Schritt 2: Transkription (mit Wort-Zeitstempeln) und Sprecher-Diarisierung laufen
+    #  gleichzeitig; die Diarisierung lädt ihre Pipeline dabei selbst.
+    #  WICHTIGER HINWEIS: Der Hugging Face Token (HF_TOKEN) wird für das pyannote-Modell benötigt.
+    print("Starte Transkription und Sprecher-Diarisierung...", file=sys.stderr)
+    send({"type": "progress", "stage": "transcribe", "fraction": 0.0})
+
+    def diarize():
+        diarization = load_pipeline()(audio_path)
+        send({"type": "progress", "stage": "diarize", "fraction": 1.0})
+        return diarization
 
-    #  Schritt 2: Sprecher-Diarisierung mit pyannote
-    print("Starte Sprecher-Diarisierung mit pyannote...", file=sys.stderr)
     try:
-        pipeline = Pipeline.from_pretrained(
-            "pyannote/speaker-diarization-3.0",
-            use_auth_token=HF_TOKEN
-        )
+        (result, cascade), diarization, transcribe_seconds, diarize_seconds = transcribe_and_diarize(
+            transcribe, diarize)
     except Exception as e:
-        print("FEHLER beim Laden der Diarisierungs-Pipeline:", e, file=sys.stderr)
-        print("Bitte die Modell-Bedingungen akzeptieren auf:", file=sys.stderr)
+        print("FEHLER bei Transkription oder Diarisierung:", e, file=sys.stderr)
+        print("Für die Diarisierung die Modell-Bedingungen akzeptieren auf:", file=sys.stderr)
         print("  https://huggingface.co/pyannote/speaker-diarization-3.0", file=sys.stderr)
+        send({"type": "error", "message": str(e)})
         sys.exit(1)
-
-    diarization = pipeline(audio_path)
-    print("Diarisierung beendet.", file=sys.stderr)
+    send({"type": "progress", "stage": "transcribe", "fraction": 1.0})
 
     #  Schritt 3: Ergebnisse zusammenführen
-    final_output = assign_speakers(segments, diarization)
+    final_output = assign_speakers(result["segments"], diarization)
 
-    #  Schritt 4: Formattierte Ausgabe für die C++ Anwendung
+    #  Schritt 4: Ausgabe im Protokoll für die C++ Anwendung
     for entry in final_output:
-        start = entry["start"]
-        end = entry["end"]
-        speaker = entry["speaker"]
-        text = entry["text"]
-        print(f"[{start:.2f}s --> {end:.2f}s] {speaker}: {text}")
+        send({
+            "type": "segment",
+            "start": round(entry["start"], 2),
+            "end": round(entry["end"], 2),
+            "speaker": entry["speaker"],
+            "text": entry["text"],
+            "confidence": entry["confidence"],
+            "words": entry["words"],
+        })
+
+    total_seconds = time.perf_counter() - t_begin
+    rate = unknown_rate(final_output)
+    print(f"Fertig in {total_seconds:.1f} s (Laden {load_seconds:.1f} s, Transkription "
+          f"{transcribe_seconds:.1f} s, Diarisierung {diarize_seconds:.1f} s parallel), "
+          f"ohne Sprecher: {rate:.1%} von {len(final_output)} Segmenten", file=sys.stderr)
+    done = {
+        "type": "done",
+        "load": round(load_seconds, 3),
+        "transcribe": round(transcribe_seconds, 3),
+        "diarize": round(diarize_seconds, 3),
+        "total": round(total_seconds, 3),
+        "unknown_rate": round(rate, 4),
+    }
+    if cascade:
+        print(f"Kaskade: {cascade['escalated']:.1f} von {cascade['audio']:.1f} s erneut mit {args.model} "
+              f"transkribiert, ca. {cascade['saved']:.1f} s gespart", file=sys.stderr)
+        done.update(cascade)
+    send(done)
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""Langlebiger Tag-Worker: lädt das spaCy-Modell einmalig und erzeugt dann Tags je Segment.
+
+Das Protokoll ist zeilenbasiertes JSON über stdin/stdout wie beim ASR-Worker.
+
+Anfragen (stdin):
+    {"cmd": "tag", "id": 1, "segments": ["Text des ersten Segments", "..."], "batch_size": 64, "n_process": 1}
+    {"cmd": "ping", "id": 2}
+    {"cmd": "shutdown"}
+
+Antworten (stdout):
+    {"type": "ready", "load": 4.2, "protocol": 1}
+    {"type": "pong", "id": 2, "busy": true}
+    {"type": "segment_tags", "id": 1, "index": 0, "tags": ["Berlin", "Budget"]}
+    {"type": "done", "id": 1, "tags": ["Berlin", "Budget", "Müller", ...], "seconds": 1.8}
+    {"type": "error", "id": 1, "message": "..."}
+
+Die Segmente laufen in Stapeln von "batch_size" durch nlp.pipe(); mit "n_process" > 1
+verteilt spaCy die Stapel auf mehrere Prozesse. Jedes Segment wird gemeldet, sobald sein
+Stapel fertig ist ("index" ist die Position in "segments"), sodass die Anwendung die Tags
+übernehmen kann, während der Rest noch läuft. "done" enthält die Tags des ganzen Meetings:
+alle Eigennamen und die häufigsten Substantive über alle Segmente (wie generate_tags.py).
+
+Pings werden von einem eigenen Lese-Thread sofort beantwortet, auch während ein Auftrag
+läuft. Alle Ausgaben der Bibliotheken werden nach stderr umgeleitet, damit stdout
+ausschließlich Protokollzeilen enthält.
+"""
+import json
+import queue
+import sys
+import threading
+import time
+from collections import Counter
+
+from generate_tags import MODEL_NAME, doc_entities, doc_keywords, load_nlp, meeting_tags, segment_tags
+
+#  stdout ist für das Protokoll reserviert; alles andere (auch print() in Bibliotheken) geht nach stderr.
+_protocol_out = sys.stdout
+sys.stdout = sys.stderr
+
+_write_lock = threading.Lock()
+_busy = threading.Event()
+
+PROTOCOL_VERSION = 1
+DEFAULT_BATCH_SIZE = 64
+
+
+def send(message):
+    """Schreibt eine Protokollnachricht als eine JSON-Zeile nach stdout."""
+    line = json.dumps(message, ensure_ascii=False)
+    with _write_lock:
+        _protocol_out.write(line + "\n")
+        _protocol_out.flush()
+
+
+def read_requests(jobs):
+    """Liest Anfragen von stdin; Pings werden direkt beantwortet, Aufträge eingereiht."""
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            request = json.loads(line)
+        except json.JSONDecodeError as e:
+            send({"type": "error", "id": None, "message": f"Ungültiges JSON: {e}"})
+            continue
+
+        cmd = request.get("cmd")
+        if cmd == "ping":
+            send({"type": "pong", "id": request.get("id"), "busy": _busy.is_set()})
+        elif cmd == "shutdown":
+            break
+        else:
+            jobs.put(request)
+    jobs.put(None)
+
+
+def run_tag_job(nlp, job_id, job):
+    """Taggt alle Segmente eines Auftrags und meldet sie einzeln, danach die Meeting-Tags."""
+    t0 = time.perf_counter()
+    texts = [str(text) for text in job.get("segments", [])]
+    batch_size = max(1, int(job.get("batch_size") or DEFAULT_BATCH_SIZE))
+    n_process = max(1, int(job.get("n_process") or 1))
+
+    entities = set()
+    keyword_counts = Counter()
+    #  Leere Segmente kosten im Modell nichts, werden aber trotzdem (ohne Tags) gemeldet,
+    #  damit die Anwendung jedes Segment abhaken kann.
+    pairs = ((text, index) for index, text in enumerate(texts) if text.strip())
+    for index, text in enumerate(texts):
+        if not text.strip():
+            send({"type": "segment_tags", "id": job_id, "index": index, "tags": []})
+
+    for doc, index in nlp.pipe(pairs, as_tuples=True, batch_size=batch_size, n_process=n_process):
+        seg_entities = doc_entities(doc)
+        seg_keywords = doc_keywords(doc)
+        entities.update(seg_entities)
+        keyword_counts.update(seg_keywords)
+        send({"type": "segment_tags", "id": job_id, "index": index,
+              "tags": segment_tags(seg_entities, seg_keywords)})
+
+    seconds = time.perf_counter() - t0
+    send({"type": "done", "id": job_id, "tags": meeting_tags(entities, keyword_counts),
+          "seconds": round(seconds, 3)})
+    print(f"Tags für {len(texts)} Segmente in {seconds:.2f}s (Stapel {batch_size}, "
+          f"{n_process} Prozess(e))", file=sys.stderr)
+
+
+def main():
+    """Startet den Lese-Thread, lädt das Modell und arbeitet Aufträge nacheinander ab."""
+    jobs = queue.Queue()
+    threading.Thread(target=read_requests, args=(jobs,), daemon=True).start()
+
+    t0 = time.perf_counter()
+    try:
+        nlp = load_nlp()
+    except OSError:
+        send({"type": "error", "id": None,
+              "message": f"Deutsches spaCy-Modell '{MODEL_NAME}' nicht gefunden. Bitte mit "
+                         f"'python -m spacy download {MODEL_NAME}' installieren."})
+        sys.exit(1)
+    send({"type": "ready", "load": round(time.perf_counter() - t0, 3), "protocol": PROTOCOL_VERSION})
+
+    while True:
+        job = jobs.get()
+        if job is None:
+            break
+
+        job_id = job.get("id")
+        if job.get("cmd") != "tag":
+            send({"type": "error", "id": job_id, "message": f"Unbekannte Anfrage: {job}"})
+            continue
+
+        _busy.set()
+        try:
+            run_tag_job(nlp, job_id, job)
+        except Exception as e:
+            send({"type": "error", "id": job_id, "message": str(e)})
+        finally:
+            _busy.clear()
+
+
+if __name__ == "__main__":
+    main()
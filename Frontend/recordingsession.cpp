@@ -0,0 +1,164 @@
+#include "recordingsession.h"
+#include "taggeneratormanager.h"
+
+//--------------------------------------------------------------------------------------------------
+
+RecordingSession::RecordingSession (
+    const QString &id,
+    const QString &directory,
+    const QString &hqPath,
+    const QString &asrPath,
+    AsrProcessManager *asr,
+    QObject *parent)
+    : QObject (parent)
+    , m_id (id)
+    , m_directory (directory)
+    , m_hqPath (hqPath)
+    , m_asrPath (asrPath)
+    , m_state (State::Recording)
+    , m_asr (asr ? asr : new AsrProcessManager)
+    , m_tagger (new TagGeneratorManager (this))
+    , m_own (new Transcription (this))
+    , m_target (m_own)
+{
+    m_asr->setParent (this);
+
+    //  Die Ergebnisse werden nicht fest verbunden, sondern an das jeweils aktuelle Ziel
+    //  weitergereicht, damit attach() bzw. detach() jederzeit möglich sind.
+    connect (m_asr,
+             &AsrProcessManager::segmentReady,
+             this,
+             [this] (const MetaText &segment) { m_target->add (segment); });
+    connect (m_asr,
+             &AsrProcessManager::partialSegments,
+             this,
+             [this] (const QList<MetaText> &segments) { m_target->setPartial (segments); });
+    connect (m_asr,
+             &AsrProcessManager::segmentSpeakerChanged,
+             this,
+             [this] (qint64 startMs, qint64 endMs, const QString &speaker)
+             { m_target->changeSpeakerForSegment (startMs, endMs, speaker); });
+    connect (m_asr,
+             &AsrProcessManager::streamInterrupted,
+             this,
+             &RecordingSession::streamInterrupted);
+    connect (m_asr,
+             &AsrProcessManager::finished,
+             this,
+             [this] (bool success, const QString &errorMsg)
+             {
+                 m_error = errorMsg;
+                 setState (success ? State::Finished : State::Failed);
+                 emit transcriptionFinished (success, errorMsg);
+             });
+
+    connect (m_tagger,
+             &TagGeneratorManager::tagsReady,
+             this,
+             [this] (const QStringList &tags, bool success, const QString &errorMsg)
+             {
+                 if (success)
+                 {
+                     m_target->setTags (tags);
+                 }
+                 setState (State::Finished);
+                 emit tagsReady (tags, success, errorMsg);
+             });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AsrProcessManager *RecordingSession::releaseAsr ()
+{
+    if (!m_asr || m_state == State::Recording || m_state == State::Transcribing)
+    {
+        return nullptr;
+    }
+
+    AsrProcessManager *asr = m_asr;
+    m_asr = nullptr;
+    asr->disconnect (this);
+    asr->setParent (nullptr);
+    return asr;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void RecordingSession::attach (
+    Transcription *view)
+{
+    m_target = view ? view : m_own;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void RecordingSession::detach ()
+{
+    if (!isAttached ())
+    {
+        return;
+    }
+
+    //  Vorläufige Segmente einer Live-Transkription gehören nicht zum Stand; sie werden
+    //  mit den endgültigen Segmenten ohnehin ersetzt.
+    m_own->fromJson (m_target->toJson ().toJson ());
+    m_target = m_own;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void RecordingSession::setState (
+    State state)
+{
+    if (m_state == state)
+    {
+        return;
+    }
+    m_state = state;
+    emit stateChanged ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool RecordingSession::isBusy () const
+{
+    return m_state == State::Recording || m_state == State::Transcribing
+           || m_state == State::Tagging;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString RecordingSession::stateText () const
+{
+    switch (m_state)
+    {
+    case State::Recording:
+        return tr ("nimmt auf");
+    case State::Transcribing:
+        return tr ("wird transkribiert");
+    case State::Tagging:
+        return tr ("Tags werden erzeugt");
+    case State::Finished:
+        return tr ("fertig");
+    case State::Failed:
+        return tr ("fehlgeschlagen: %1").arg (m_error);
+    }
+    return QString ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool RecordingSession::generateTags ()
+{
+    if (isBusy () || m_target->text ().isEmpty ())
+    {
+        return false;
+    }
+
+    setState (State::Tagging);
+    m_tagger->generateTagsFor (m_target);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
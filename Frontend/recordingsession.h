@@ -0,0 +1,149 @@
+/**
+ * @file recordingsession.h
+ * @brief Enthält die Deklaration der RecordingSession-Klasse.
+ * @author Mike Wild
+ */
+#ifndef RECORDINGSESSION_H
+#define RECORDINGSESSION_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "asrprocessmanager.h"
+#include "transcription.h"
+
+class TagGeneratorManager;
+
+/**
+ * @brief Der Job-Datensatz einer einzelnen Aufnahme.
+ *
+ * Jede Aufnahme erhält ein eigenes Verzeichnis (siehe FileManager::createSessionDirectory())
+ * und einen eigenen AsrProcessManager bzw. TagGeneratorManager. Dadurch kann eine neue
+ * Aufnahme beginnen, während die vorherige noch im Hintergrund transkribiert oder getaggt wird.
+ *
+ * Die Ergebnisse der Hintergrundprozesse landen im Ziel-Transkript der Sitzung: Solange
+ * die Sitzung im Hauptfenster angezeigt wird, ist das dessen Transkript (attach()), sonst
+ * eine eigene Kopie (detach()). So aktualisiert sich die Anzeige live, ohne dass eine
+ * Sitzung im Hintergrund das gerade angezeigte Transkript einer anderen überschreibt.
+ */
+class RecordingSession : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief Der Bearbeitungszustand der Sitzung. */
+    enum class State
+    {
+        Recording,    ///< Es wird aufgenommen.
+        Transcribing, ///< Die ASR läuft bzw. wird abgeschlossen.
+        Tagging,      ///< Die Tags werden erzeugt.
+        Finished,     ///< Alle Jobs sind abgeschlossen.
+        Failed        ///< Die Transkription ist fehlgeschlagen.
+    };
+
+    /**
+     * @brief Konstruktor.
+     * @param id Die Kennung der Sitzung (Zeitstempel, zugleich Name des Verzeichnisses).
+     * @param directory Das Verzeichnis der Sitzung.
+     * @param hqPath Der Pfad der HQ-Aufnahme.
+     * @param asrPath Der Pfad der ASR-Aufnahme.
+     * @param asr Ein freigegebener ASR-Manager (siehe releaseAsr()) oder nullptr für einen neuen.
+     * @param parent Das QObject-Elternteil für die Speicherverwaltung.
+     */
+    RecordingSession (const QString &id,
+                      const QString &directory,
+                      const QString &hqPath,
+                      const QString &asrPath,
+                      AsrProcessManager *asr = nullptr,
+                      QObject *parent = nullptr);
+
+    /** @brief Gibt die Kennung der Sitzung zurück. */
+    QString id () const { return m_id; }
+
+    /** @brief Gibt das Verzeichnis der Sitzung zurück. */
+    QString directory () const { return m_directory; }
+
+    /** @brief Gibt den Pfad der HQ-Aufnahme zurück (.wav oder .flac). */
+    QString hqPath () const { return m_hqPath; }
+
+    /** @brief Setzt den Pfad der HQ-Aufnahme, sobald das Format feststeht. */
+    void setHqPath (const QString &path) { m_hqPath = path; }
+
+    /** @brief Gibt den Pfad der ASR-Aufnahme zurück. */
+    QString asrPath () const { return m_asrPath; }
+
+    /** @brief Gibt den ASR-Manager dieser Sitzung zurück (nullptr nach releaseAsr()). */
+    AsrProcessManager *asr () const { return m_asr; }
+
+    /**
+     * @brief Gibt den ASR-Manager einer abgeschlossenen Sitzung zur Weiterverwendung ab.
+     *
+     * So übernimmt die nächste Aufnahme die bereits laufenden Worker samt geladener
+     * Modelle, statt sie neu zu starten.
+     * @return Der ASR-Manager ohne Elternteil oder nullptr, solange die Sitzung beschäftigt ist.
+     */
+    AsrProcessManager *releaseAsr ();
+
+    /** @brief Gibt das Transkript zurück, in das die Ergebnisse geschrieben werden. */
+    Transcription *script () const { return m_target; }
+
+    /** @brief Gibt an, ob die Sitzung gerade im Hauptfenster angezeigt wird. */
+    bool isAttached () const { return m_target != m_own; }
+
+    /**
+     * @brief Leitet alle weiteren Ergebnisse in das angezeigte Transkript @p view.
+     * @note @p view muss den aktuellen Stand der Sitzung bereits enthalten.
+     */
+    void attach (Transcription *view);
+
+    /**
+     * @brief Übernimmt den Stand des angezeigten Transkripts in die eigene Kopie und
+     * schreibt weitere Ergebnisse nur noch dorthin.
+     */
+    void detach ();
+
+    /** @brief Gibt den aktuellen Zustand zurück. */
+    State state () const { return m_state; }
+
+    /** @brief Setzt den Zustand und meldet die Änderung über stateChanged(). */
+    void setState (State state);
+
+    /** @brief Gibt an, ob noch aufgenommen wird oder ein Job läuft. */
+    bool isBusy () const;
+
+    /** @brief Beschreibt den Zustand für die Anzeige in der Sitzungsliste. */
+    QString stateText () const;
+
+    /**
+     * @brief Startet die Tag-Erzeugung für den Text der Sitzung im Hintergrund.
+     * @return false, wenn die Sitzung keinen Text hat oder noch ein Job läuft.
+     */
+    bool generateTags ();
+
+signals:
+    /** @brief Der Zustand der Sitzung hat sich geändert. */
+    void stateChanged ();
+
+    /** @brief Die Live-Transkription wurde abgebrochen (siehe AsrProcessManager::streamInterrupted()). */
+    void streamInterrupted (const QString &errorMsg);
+
+    /** @brief Die Transkription ist abgeschlossen (siehe AsrProcessManager::finished()). */
+    void transcriptionFinished (bool success, const QString &errorMsg);
+
+    /** @brief Die Tag-Erzeugung ist abgeschlossen; die Tags sind bereits übernommen. */
+    void tagsReady (const QStringList &tags, bool success, const QString &errorMsg);
+
+private:
+    QString m_id;                       ///< Kennung der Sitzung.
+    QString m_directory;                ///< Verzeichnis der Sitzung.
+    QString m_hqPath;                   ///< Pfad der HQ-Aufnahme.
+    QString m_asrPath;                  ///< Pfad der ASR-Aufnahme.
+    State m_state;                      ///< Aktueller Zustand.
+    QString m_error;                    ///< Fehlermeldung der Transkription.
+    AsrProcessManager *m_asr;           ///< ASR-Manager dieser Sitzung.
+    TagGeneratorManager *m_tagger;      ///< Tag-Generator dieser Sitzung.
+    Transcription *m_own;               ///< Eigene Kopie des Transkripts.
+    Transcription *m_target;            ///< Ziel der Ergebnisse (m_own oder das angezeigte Transkript).
+};
+
+#endif // RECORDINGSESSION_H
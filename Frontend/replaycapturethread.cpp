@@ -0,0 +1,237 @@
+#include "replaycapturethread.h"
+
+#include <QDebug>
+#include <QSettings>
+
+namespace
+{
+constexpr int TargetSampleRate = 48000; //  Abtastrate der Ausgabe (wie bei den Live-Backends).
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+ReplayCaptureThread::ReplayCaptureThread (
+    QObject *parent)
+    : CaptureThread (parent)
+    , m_realtime (true)
+    , m_framesProduced (0)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ReplayCaptureThread::initializeCapture ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    m_realtime = settings.value ("replay/realtime", true).toBool ();
+
+    const QString sysPath = settings.value ("replay/systemFile").toString ();
+    const QString micPath = settings.value ("replay/micFile").toString ();
+
+    if (!openSource (m_sys, sysPath) || !openSource (m_mic, micPath))
+    {
+        cleanupCapture ();
+        return false;
+    }
+
+    if (m_sys.finished && m_mic.finished)
+    {
+        qWarning () << "ReplayCapture: Keine Eingabedatei konfiguriert (replay/systemFile, replay/micFile).";
+        return false;
+    }
+
+    bufSys.resize (BlockFrames * BlockChannels);
+    bufMic.resize (BlockFrames * BlockChannels);
+    bufMix.resize (BlockFrames * BlockChannels);
+    m_framesProduced = 0;
+    m_clock.start ();
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ReplayCaptureThread::captureLoopIteration ()
+{
+    //  --- Taktung ---
+    //  Im Echtzeit-Modus wird gewartet, bis die Wanduhr den nächsten Block "erreicht" hat.
+    if (m_realtime)
+    {
+        const qint64 dueMs = m_framesProduced * 1000 / TargetSampleRate;
+        const qint64 aheadMs = dueMs - m_clock.elapsed ();
+        if (aheadMs > 0)
+        {
+            msleep (static_cast<unsigned long> (aheadMs));
+        }
+    }
+
+    AudioBlock *block = acquireBlock ();
+    if (!block && !m_realtime)
+    {
+        //  Ungebremst wird nie verworfen: Ist der Pool erschöpft, wartet der Thread kurz,
+        //  bis die Consumer Blöcke zurückgegeben haben. So bleibt die Ausgabe deterministisch.
+        msleep (1);
+        return;
+    }
+
+    //  Im Echtzeit-Modus verhält sich ein erschöpfter Pool wie bei einem Live-Backend:
+    //  Der Block wird erzeugt (die Dateiposition läuft weiter), aber verworfen.
+    float *out = block ? block->data : bufMix.data ();
+    render (out, BlockFrames);
+    m_framesProduced += BlockFrames;
+
+    if (block)
+    {
+        block->frames = BlockFrames;
+        publishBlock (block);
+    }
+
+    //  Sind beide Dateien vollständig ausgegeben, beendet sich die Aufnahme selbst.
+    if (m_sys.finished && m_mic.finished)
+    {
+        stopCapture ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ReplayCaptureThread::cleanupCapture ()
+{
+    const qint64 wallMs = m_clock.isValid () ? m_clock.elapsed () : 0;
+    if (m_framesProduced > 0 && wallMs > 0)
+    {
+        const double audioSec = double (m_framesProduced) / TargetSampleRate;
+        qDebug () << "ReplayCapture:" << audioSec << "s Audio in" << wallMs << "ms ="
+                  << audioSec * 1000.0 / wallMs << "x Echtzeit";
+    }
+
+    m_sys.reader.close ();
+    m_mic.reader.close ();
+    m_sys.finished = true;
+    m_mic.finished = true;
+    m_clock.invalidate ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ReplayCaptureThread::openSource (
+    Source &source, const QString &path)
+{
+    source.fifoL.clear ();
+    source.fifoR.clear ();
+    source.position = 0.0;
+    source.exhausted = false;
+    source.finished = true;
+
+    if (path.isEmpty ())
+    {
+        return true; //  Keine Datei: Die Quelle liefert Stille.
+    }
+
+    if (!source.reader.open (path))
+    {
+        qWarning () << "ReplayCapture:" << path << "-" << source.reader.errorString ();
+        return false;
+    }
+
+    //  Die Puffer reichen für einen Block samt Reserve bei der höchsten üblichen Abtastrate.
+    const int rate = source.reader.sampleRate ();
+    source.step = double (rate) / TargetSampleRate;
+    const size_t capacity = size_t (BlockFrames * source.step) * 4 + 4096;
+    source.fifoL.resize (capacity);
+    source.fifoR.resize (capacity);
+    source.raw.resize (size_t (BlockFrames) * source.reader.channels ());
+    source.finished = false;
+
+    qDebug () << "ReplayCapture:" << path << rate << "Hz," << source.reader.channels ()
+              << "Kanäle," << double (source.reader.frames ()) / rate << "s";
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ReplayCaptureThread::fillSource (
+    Source &source, int frames)
+{
+    //  Für die Interpolation wird ein Frame über die letzte Leseposition hinaus benötigt.
+    const size_t needed = size_t (source.position + frames * source.step) + 2;
+    const int channels = source.reader.channels ();
+
+    while (source.fifoL.size () < needed && !source.exhausted && !source.reader.atEnd ())
+    {
+        const int got = source.reader.readFrames (source.raw.data (), BlockFrames);
+        if (got <= 0)
+        {
+            //  Lesefehler oder abgeschnittene Datei: atEnd() wird dann nie wahr, daher endet
+            //  die Quelle hier, sobald die gepufferten Frames ausgegeben sind.
+            qWarning () << "ReplayCapture: Datei endet vorzeitig:" << source.reader.errorString ();
+            source.exhausted = true;
+            break;
+        }
+
+        //  Aufteilen in getrennte Kanäle; Mono wird auf beide Seiten gelegt,
+        //  weitere Kanäle über Stereo hinaus werden ignoriert.
+        for (int i = 0; i < got; ++i)
+        {
+            const float *frame = source.raw.data () + size_t (i) * channels;
+            source.fifoL.write (&frame[0], 1);
+            source.fifoR.write (&frame[channels > 1 ? 1 : 0], 1);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ReplayCaptureThread::nextFrame (
+    Source &source, float &left, float &right)
+{
+    if (source.finished)
+    {
+        left = right = 0.0f;
+        return;
+    }
+
+    if (source.position >= double (source.fifoL.size ()))
+    {
+        //  Die Datei ist zu Ende und alle gepufferten Frames sind ausgegeben.
+        source.finished = source.exhausted || source.reader.atEnd ();
+        left = right = 0.0f;
+        return;
+    }
+
+    left = source.fifoL.sampleAt (source.position);
+    right = source.fifoR.sampleAt (source.position);
+    source.position += source.step;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ReplayCaptureThread::render (
+    float *out, int frames)
+{
+    fillSource (m_sys, frames);
+    fillSource (m_mic, frames);
+
+    for (int i = 0; i < frames; ++i)
+    {
+        nextFrame (m_sys, bufSys[2 * i], bufSys[2 * i + 1]);
+        nextFrame (m_mic, bufMic[2 * i], bufMic[2 * i + 1]);
+    }
+
+    //  Mischen, DSP-Kette und Begrenzung übernimmt der gemeinsame Mixer der Basisklasse.
+    mix (bufSys.data (), bufMic.data (), out, frames);
+
+    //  "Konsumiere" die bereits gelesenen Daten aus den Ringpuffern.
+    for (Source *source : {&m_sys, &m_mic})
+    {
+        const size_t consumed = static_cast<size_t> (source->position);
+        if (consumed > 0)
+        {
+            source->fifoL.consume (consumed);
+            source->fifoR.consume (consumed);
+            source->position -= consumed;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,112 @@
+/**
+ * @file replaycapturethread.h
+ * @brief Enthält die Deklaration der ReplayCaptureThread-Klasse zum Abspielen aufgezeichneter WAV-Dateien.
+ * @author Mike Wild
+ */
+#ifndef REPLAYCAPTURETHREAD_H
+#define REPLAYCAPTURETHREAD_H
+
+#include "capturethread.h"
+#include "ringbuffer.h"
+#include "wavfilereader.h"
+#include <QElapsedTimer>
+#include <vector>
+
+/**
+ * @brief Ein CaptureThread, der statt Audio-Geräten eine oder zwei WAV-Dateien einspeist.
+ *
+ * Die Dateien für System-Audio und Mikrofon werden über denselben Lebenszyklus
+ * (initializeCapture/captureLoopIteration/cleanupCapture) wie bei einer Live-Aufnahme
+ * gelesen, auf 48 kHz Stereo gebracht, gemischt und auf dem AudioBus veröffentlicht.
+ * Damit lässt sich die komplette Kette Capture → WavWriterThread → AsrProcessManager
+ * ohne Audio-Hardware reproduzierbar ausführen.
+ *
+ * Im Echtzeit-Modus wird die Ausgabe an die Wanduhr gekoppelt. Im ungebremsten Modus
+ * wird so schnell wie möglich gelesen; ist der Block-Pool erschöpft, wartet der Thread
+ * auf die Consumer, statt Daten zu verwerfen. Am Dateiende stoppt die Aufnahme selbst.
+ *
+ * Konfiguration über die Settings-Schlüssel "replay/systemFile", "replay/micFile" und
+ * "replay/realtime"; ausgewählt wird das Backend mit "audio/backend" = "replay".
+ */
+class ReplayCaptureThread : public CaptureThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Standard-Konstruktor.
+     * @param parent Das QObject-Elternteil für die Speicherverwaltung.
+     */
+    explicit ReplayCaptureThread (QObject *parent = nullptr);
+
+protected:
+    /**
+     * @brief Öffnet die konfigurierten WAV-Dateien.
+     * @return true, wenn mindestens eine Datei geöffnet werden konnte.
+     */
+    bool initializeCapture () override;
+
+    /**
+     * @brief Erzeugt einen Block aus den Dateien und veröffentlicht ihn auf dem AudioBus.
+     */
+    void captureLoopIteration () override;
+
+    /**
+     * @brief Schließt die Dateien und gibt die Durchsatz-Statistik aus.
+     */
+    void cleanupCapture () override;
+
+    /**
+     * @brief Die Wiedergabe läuft ohne Echtzeit-Priorität; ungebremst würde sie sonst
+     * RLIMIT_RTTIME überschreiten.
+     */
+    bool wantsRealtimePriority () const override { return false; }
+
+private:
+    /**
+     * @brief Zustand einer einzelnen Eingabedatei.
+     */
+    struct Source
+    {
+        WavFileReader reader;    ///< Liest die Datei blockweise.
+        RingBuffer fifoL;        ///< Linker Kanal mit nativer Abtastrate.
+        RingBuffer fifoR;        ///< Rechter Kanal mit nativer Abtastrate.
+        std::vector<float> raw;  ///< Puffer für interleavte Rohdaten aus der Datei.
+        double position = 0.0;   ///< Leseposition (in nativen Frames) für das Resampling.
+        double step = 1.0;       ///< Native Frames pro Ausgabe-Frame.
+        bool exhausted = false;  ///< Die Datei liefert keine Daten mehr (Ende oder Lesefehler).
+        bool finished = true;    ///< Gibt an, ob die Quelle vollständig ausgegeben wurde.
+    };
+
+    /**
+     * @brief Öffnet eine Quelle; ein leerer Pfad lässt die Quelle stumm.
+     * @return false, wenn ein Pfad angegeben war, die Datei aber nicht gelesen werden kann.
+     */
+    bool openSource (Source &source, const QString &path);
+
+    /**
+     * @brief Liest Daten aus der Datei nach, bis genug für @p frames Ausgabe-Frames vorliegt.
+     */
+    void fillSource (Source &source, int frames);
+
+    /**
+     * @brief Liest das nächste Sample-Paar einer Quelle (linear interpoliert) und rückt vor.
+     */
+    void nextFrame (Source &source, float &left, float &right);
+
+    /**
+     * @brief Erzeugt @p frames gemischte Stereo-Frames in @p out.
+     */
+    void render (float *out, int frames);
+
+    Source m_sys; ///< Die Datei mit dem System-Audio.
+    Source m_mic; ///< Die Datei mit dem Mikrofon-Audio.
+
+    bool m_realtime;            ///< Koppelt die Ausgabe an die Wanduhr.
+    QElapsedTimer m_clock;      ///< Misst die Laufzeit seit Beginn der Wiedergabe.
+    qint64 m_framesProduced;    ///< Anzahl der bereits erzeugten Ausgabe-Frames.
+    std::vector<float> bufSys;  ///< Resampelte Stereo-Frames des System-Audios.
+    std::vector<float> bufMic;  ///< Resampelte Stereo-Frames des Mikrofons.
+    std::vector<float> bufMix;  ///< Ersatzpuffer, falls im Echtzeit-Modus kein Block frei ist.
+};
+
+#endif // REPLAYCAPTURETHREAD_H
@@ -104,6 +104,44 @@ public:
         m_size = std::min (m_size + count, capacity ());
     }
 
+    /**
+     * @brief Schreibt eine Anzahl von Null-Samples (Stille) in den Puffer.
+     *
+     * Wird verwendet, um Lücken in einem Stream aufzufüllen, ohne einen eigenen
+     * Null-Puffer anlegen zu müssen.
+     * @param count Die Anzahl der zu schreibenden Null-Werte.
+     */
+    void writeSilence (
+        size_t count)
+    {
+        const float zero = 0.0f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            write (&zero, 1);
+        }
+    }
+
+    /**
+     * @brief Liest die ältesten Daten aus dem Puffer und entfernt sie.
+     * @param out Das Ziel-Array; muss Platz für `count` Werte haben.
+     * @param count Die maximale Anzahl der zu lesenden float-Werte.
+     * @return Die Anzahl der tatsächlich gelesenen Werte.
+     */
+    size_t read (
+        float* out, size_t count)
+    {
+        count = std::min (count, m_size);
+
+        // Der Lesevorgang wird in maximal zwei zusammenhängende Stücke aufgeteilt,
+        // falls die Daten über das Ende des Speichers hinausragen.
+        size_t first = std::min (count, capacity () - m_tail);
+        std::copy_n (m_buffer.begin () + m_tail, first, out);
+        std::copy_n (m_buffer.begin (), count - first, out + first);
+
+        consume (count);
+        return count;
+    }
+
     /**
      * @brief Liest einen Sample-Wert an einer bestimmten Fließkomma-Position.
      *
@@ -92,17 +92,6 @@ void SearchDialog::loadSpeakerAndTagOptions()
 
 //--------------------------------------------------------------------------------------------------
 
-QTime SearchDialog::parseTimeFromSeconds(const QString &seconds) const
-{
-    bool ok;
-    int sec = seconds.toInt(&ok);
-    if (!ok)
-        return QTime(); // Rückgabe einer ungültigen Zeit bei Fehler
-    return QTime(0, 0, 0).addSecs(sec);
-}
-
-//--------------------------------------------------------------------------------------------------
-
 void SearchDialog::performSearch()
 {
     resultsList->clear(); // Vorherige Ergebnisse löschen
@@ -116,13 +105,13 @@ void SearchDialog::performSearch()
 
     int hits = 0;
 
-    // Alle Transkript-Segmente durchgehen
-    for (const MetaText &segment : m_transcription->getMetaTexts()) {
-        QTime segmentTime = parseTimeFromSeconds(segment.Start);
-
-        // Zeitfilter anwenden
-        if (!segmentTime.isValid() || segmentTime < start || segmentTime > end)
-            continue;
+    // Zeitfilter über den Zeitindex: nur Segmente, die in [start, end] hineinreichen
+    const QList<MetaText> &segments = m_transcription->getMetaTexts();
+    const QList<int> inRange = m_transcription->segmentsInRange(start.msecsSinceStartOfDay(),
+                                                                end.msecsSinceStartOfDay() + 1000);
+    for (int index : inRange) {
+        const MetaText &segment = segments.at(index);
+        QTime segmentTime = QTime::fromMSecsSinceStartOfDay(int(segment.StartMs % 86400000));
 
         // Sprecherfilter
         if (selectedSpeaker != "Alle Sprecher" && segment.Speaker != selectedSpeaker)
@@ -73,13 +73,6 @@ private:
      * @brief Führt die eigentliche Suche anhand der Filterkriterien durch.
      */
     void performSearch();
-
-    /**
-     * @brief Konvertiert Sekundenangabe in ein QTime-Objekt.
-     * @param seconds Zeit in Sekunden als String.
-     * @return QTime entsprechend der Sekundenangabe.
-     */
-    QTime parseTimeFromSeconds(const QString &seconds) const;
 };
 
 #endif // SEARCHDIALOG_H
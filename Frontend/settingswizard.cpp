@@ -1,5 +1,7 @@
 #include "settingswizard.h"
 
+#include <QCheckBox>
+#include <QComboBox>
 #include <QDoubleSpinBox>
 #include <QFileDialog>
 #include <QFontComboBox>
@@ -10,8 +12,11 @@
 #include <QPushButton>
 #include <QSettings>
 #include <QSlider>
+#include <QThread>
 #include <QVBoxLayout>
+#include "asrresultcache.h"
 #include "filemanager.h" // Nötig, um Standard-Pfade abzufragen
+#include "processgovernor.h"
 #include <cmath> //  Für std::log10 und std::pow
 
 //--------------------------------------------------------------------------------------------------
@@ -29,6 +34,35 @@ SettingsWizard::SettingsWizard (
     , sysGainSlider (new QSlider (Qt::Horizontal, this))
     , micGainSpin (new QDoubleSpinBox (this))
     , micGainSlider (new QSlider (Qt::Horizontal, this))
+    , highPassSpin (new QSpinBox (this))
+    , limiterCheck (new QCheckBox (tr ("Spitzen begrenzen"), this))
+    , limiterThresholdSpin (new QDoubleSpinBox (this))
+    , vadCheck (new QCheckBox (tr ("Nur Sprachbereiche transkribieren"), this))
+    , workerCheck (new QCheckBox (tr ("Modelle zwischen Aufnahmen geladen halten"), this))
+    , streamingCheck (new QCheckBox (tr ("Bereits während der Aufnahme transkribieren"), this))
+    , parallelWorkersSpin (new QSpinBox (this))
+    , segmentMinutesSpin (new QSpinBox (this))
+    , flacLevelSpin (new QSpinBox (this))
+    , keepSessionsSpin (new QSpinBox (this))
+    , maxJobsSpin (new QSpinBox (this))
+    , autoTagCheck (new QCheckBox (tr ("Nach jeder Transkription Tags erzeugen"), this))
+    , tagEngineCombo (new QComboBox (this))
+    , cacheSizeSpin (new QSpinBox (this))
+    , cacheAgeSpin (new QSpinBox (this))
+    , cacheStatsLabel (new QLabel (this))
+    , asrModelCombo (new QComboBox (this))
+    , cascadeCheck (new QCheckBox (tr ("Erst mit kleinem Modell, unsichere Stellen mit großem"), this))
+    , draftModelCombo (new QComboBox (this))
+    , escalateSpin (new QDoubleSpinBox (this))
+    , realtimeCheck (new QCheckBox (tr ("Aufnahme und Schreiben mit Echtzeit-Priorität"), this))
+    , governorCheck (new QCheckBox (tr ("Python-Prozesse bremsen"), this))
+    , governorThreadsSpin (new QSpinBox (this))
+    , governorNiceSpin (new QSpinBox (this))
+    , affinityEdit (new QLineEdit (this))
+    , cgroupEdit (new QLineEdit (this))
+    , cgroupCpuSpin (new QSpinBox (this))
+    , cgroupMemorySpin (new QSpinBox (this))
+    , xrunStatsLabel (new QLabel (this))
     , pdfHeadlineSpin (new QSpinBox (this))
     , pdfBodySpin (new QSpinBox (this))
     , pdfMetaSpin (new QSpinBox (this))
@@ -47,6 +81,8 @@ SettingsWizard::SettingsWizard (
     QPushButton *browseScript = new QPushButton (tr ("..."));
     QPushButton *browseWav = new QPushButton (tr ("..."));
     QPushButton *browseAsrWav = new QPushButton (tr ("..."));
+    QPushButton *clearCacheButton = new QPushButton (tr ("Cache leeren"));
+    QPushButton *resetXrunButton = new QPushButton (tr ("Statistik zurücksetzen"));
     QPushButton *okButton = new QPushButton (tr ("Speichern"));
 
     //  Konfiguriert alle Einstellungs-Widgets mit ihren Wertebereichen und Einheiten.
@@ -174,6 +210,140 @@ SettingsWizard::SettingsWizard (
     micGainSpin->setDecimals (2);
     micGainSlider->setRange (0, 1000);
 
+    //  Hochpass: 0 Hz bedeutet "aus".
+    highPassSpin->setRange (0, 300);
+    highPassSpin->setSingleStep (10);
+    highPassSpin->setSuffix (" Hz");
+    highPassSpin->setSpecialValueText (tr ("Aus"));
+    highPassSpin->setValue (settings.value ("audio/highPassHz", 0).toInt ());
+    limiterCheck->setChecked (settings.value ("audio/limiter", false).toBool ());
+    //  Die Schwelle ist ein Anteil der Vollaussteuerung (1.0 = 0 dBFS).
+    limiterThresholdSpin->setRange (0.1, 1.0);
+    limiterThresholdSpin->setSingleStep (0.05);
+    limiterThresholdSpin->setDecimals (2);
+    limiterThresholdSpin->setValue (settings.value ("audio/limiterThreshold", 0.9).toDouble ());
+    limiterThresholdSpin->setEnabled (limiterCheck->isChecked ());
+    connect (limiterCheck, &QCheckBox::toggled, limiterThresholdSpin, &QWidget::setEnabled);
+    vadCheck->setChecked (settings.value ("asr/vad", true).toBool ());
+    workerCheck->setChecked (settings.value ("asr/persistentWorker", true).toBool ());
+    streamingCheck->setChecked (settings.value ("asr/streaming", true).toBool ());
+
+    //  Parallele ASR-Worker: Jeder Worker lädt die Modelle selbst und belegt entsprechend Speicher.
+    parallelWorkersSpin->setRange (1, qMax (1, QThread::idealThreadCount ()));
+    parallelWorkersSpin->setSpecialValueText (tr ("Aus"));
+    parallelWorkersSpin->setValue (settings.value ("asr/parallelWorkers", 1).toInt ());
+
+    //  Teildateien: Nur wirksam, wenn die Live-Transkription aus ist.
+    segmentMinutesSpin->setRange (0, 60);
+    segmentMinutesSpin->setSuffix (" min");
+    segmentMinutesSpin->setSpecialValueText (tr ("Aus"));
+    segmentMinutesSpin->setValue (settings.value ("audio/segmentMinutes", 0).toInt ());
+
+    //  HQ-Datei als FLAC: -1 steht für die bisherige float-WAV, 0 bis 8 für die Kompressionsstufe.
+    flacLevelSpin->setRange (-1, 8);
+    flacLevelSpin->setSpecialValueText (tr ("Aus (WAV)"));
+    flacLevelSpin->setValue (settings.value ("audio/hqFlac", false).toBool ()
+                                 ? settings.value ("audio/flacLevel", 5).toInt ()
+                                 : -1);
+
+    //  Ältere Aufnahme-Sitzungen werden samt Audiodateien gelöscht; 0 behält alle.
+    keepSessionsSpin->setRange (0, 100);
+    keepSessionsSpin->setSpecialValueText (tr ("Alle"));
+    keepSessionsSpin->setValue (settings.value ("audio/keepSessions", 5).toInt ());
+
+    //  Auftragswarteschlange: Jeder gleichzeitige Auftrag startet eigene ASR-Worker.
+    maxJobsSpin->setRange (1, qMax (1, QThread::idealThreadCount ()));
+    maxJobsSpin->setValue (settings.value ("jobs/maxParallel", 1).toInt ());
+    autoTagCheck->setChecked (settings.value ("jobs/autoTag", false).toBool ());
+
+    //  Tag-Erzeugung: TF-IDF im Programm (schnell) oder spaCy über Python (genauer).
+    tagEngineCombo->addItem (tr ("Schnell (TF-IDF, ohne Python)"), "native");
+    tagEngineCombo->addItem (tr ("Genau (spaCy, Python)"), "spacy");
+    tagEngineCombo->setCurrentIndex (
+        qMax (0, tagEngineCombo->findData (settings.value ("tags/engine", "native").toString ())));
+
+    //  ASR-Ergebnis-Cache: 0 MB schaltet ihn ab, 0 Tage behält unbenutzte Einträge unbegrenzt.
+    cacheSizeSpin->setRange (0, 4096);
+    cacheSizeSpin->setSuffix (" MB");
+    cacheSizeSpin->setSpecialValueText (tr ("Aus"));
+    cacheSizeSpin->setValue (settings.value ("asrCache/maxMB", 64).toInt ());
+    cacheAgeSpin->setRange (0, 3650);
+    cacheAgeSpin->setSuffix (tr (" Tage"));
+    cacheAgeSpin->setSpecialValueText (tr ("Unbegrenzt"));
+    cacheAgeSpin->setValue (settings.value ("asrCache/maxAgeDays", 90).toInt ());
+    cacheStatsLabel->setText (tr ("%1 Treffer, %2 Fehlschläge")
+                                  .arg (AsrResultCache::hits ())
+                                  .arg (AsrResultCache::misses ()));
+    connect (clearCacheButton,
+             &QPushButton::clicked,
+             this,
+             [this] ()
+             {
+                 AsrResultCache ().clear ();
+                 AsrResultCache::resetCounters ();
+                 cacheStatsLabel->setText (tr ("%1 Treffer, %2 Fehlschläge").arg (0).arg (0));
+             });
+
+    //  Modelle: In der Kaskade transkribiert das kleine Modell alles, das große nur Segmente
+    //  unter der Konfidenzschwelle. "-int8" quantisiert das kleine Modell zusätzlich (nur CPU).
+    asrModelCombo->addItems ({"large", "large-v3", "turbo", "medium"});
+    asrModelCombo->setCurrentText (settings.value ("asr/model", "large").toString ());
+    draftModelCombo->addItems ({"tiny", "base", "small", "small-int8", "medium-int8"});
+    draftModelCombo->setCurrentText (settings.value ("asr/draftModel", "small").toString ());
+    cascadeCheck->setChecked (settings.value ("asr/cascade", false).toBool ());
+    escalateSpin->setRange (0.0, 1.0);
+    escalateSpin->setSingleStep (0.05);
+    escalateSpin->setDecimals (2);
+    escalateSpin->setValue (settings.value ("asr/escalateBelow", 0.6).toDouble ());
+    escalateSpin->setToolTip (tr ("Segmente, deren Konfidenz (exp. mittlere Log-Wahrscheinlichkeit) "
+                                  "unter diesem Wert liegt, transkribiert das große Modell erneut."));
+    draftModelCombo->setEnabled (cascadeCheck->isChecked ());
+    escalateSpin->setEnabled (cascadeCheck->isChecked ());
+    connect (cascadeCheck, &QCheckBox::toggled, draftModelCombo, &QWidget::setEnabled);
+    connect (cascadeCheck, &QCheckBox::toggled, escalateSpin, &QWidget::setEnabled);
+
+    //  Ressourcen: Der Governor gilt für alle Python-Prozesse (ASR, Worker, Tags) ab ihrem
+    //  nächsten Start; cgroups wirken nur mit einem an den Benutzer delegierten Verzeichnis.
+    realtimeCheck->setChecked (settings.value ("audio/realtime", true).toBool ());
+    governorCheck->setChecked (settings.value ("governor/enabled", true).toBool ());
+    governorThreadsSpin->setRange (0, qMax (1, QThread::idealThreadCount ()));
+    governorThreadsSpin->setSpecialValueText (tr ("Automatisch"));
+    governorThreadsSpin->setValue (settings.value ("governor/threads", 0).toInt ());
+    governorNiceSpin->setRange (0, 19);
+    governorNiceSpin->setValue (settings.value ("governor/nice", 10).toInt ());
+    affinityEdit->setPlaceholderText (tr ("Alle CPUs, z.B. 2-7"));
+    affinityEdit->setText (settings.value ("governor/affinity").toString ());
+    cgroupEdit->setPlaceholderText (tr ("Aus, z.B. /sys/fs/cgroup/user.slice/.../app.slice"));
+    cgroupEdit->setText (settings.value ("governor/cgroupPath").toString ());
+    cgroupCpuSpin->setRange (0, 100);
+    cgroupCpuSpin->setSuffix (" %");
+    cgroupCpuSpin->setSpecialValueText (tr ("Keine"));
+    cgroupCpuSpin->setValue (settings.value ("governor/cgroupCpuPercent", 0).toInt ());
+    cgroupMemorySpin->setRange (0, 262144);
+    cgroupMemorySpin->setSingleStep (512);
+    cgroupMemorySpin->setSuffix (" MB");
+    cgroupMemorySpin->setSpecialValueText (tr ("Keine"));
+    cgroupMemorySpin->setValue (settings.value ("governor/cgroupMemoryMB", 0).toInt ());
+    xrunStatsLabel->setText (ProcessGovernor::xrunSummary ());
+    for (QWidget *widget : {static_cast<QWidget *> (governorThreadsSpin),
+                            static_cast<QWidget *> (governorNiceSpin),
+                            static_cast<QWidget *> (affinityEdit),
+                            static_cast<QWidget *> (cgroupEdit),
+                            static_cast<QWidget *> (cgroupCpuSpin),
+                            static_cast<QWidget *> (cgroupMemorySpin)})
+    {
+        widget->setEnabled (governorCheck->isChecked ());
+        connect (governorCheck, &QCheckBox::toggled, widget, &QWidget::setEnabled);
+    }
+    connect (resetXrunButton,
+             &QPushButton::clicked,
+             this,
+             [this] ()
+             {
+                 ProcessGovernor::resetXrunStats ();
+                 xrunStatsLabel->setText (ProcessGovernor::xrunSummary ());
+             });
+
     //  Setzen der Gain-Werte. Da die Slider logarithmisch sind, ist eine Umrechnung nötig.
     float sysGain = settings.value ("sysGain", 0.5f).toFloat ();
     float micGain = settings.value ("micGain", 6.0f).toFloat ();
@@ -232,9 +402,45 @@ SettingsWizard::SettingsWizard (
     audioLayout->addRow ("", sysGainSlider);
     audioLayout->addRow (tr ("Mikrofon-Gain:"), micGainSpin);
     audioLayout->addRow ("", micGainSlider);
+    audioLayout->addRow (tr ("Hochpassfilter:"), highPassSpin);
+    audioLayout->addRow (tr ("Limiter:"), limiterCheck);
+    audioLayout->addRow (tr ("Limiter-Schwelle:"), limiterThresholdSpin);
+    audioLayout->addRow (tr ("Stille entfernen:"), vadCheck);
+    audioLayout->addRow (tr ("ASR-Worker:"), workerCheck);
+    audioLayout->addRow (tr ("Live-Transkription:"), streamingCheck);
+    audioLayout->addRow (tr ("Parallele ASR-Worker:"), parallelWorkersSpin);
+    audioLayout->addRow (tr ("Whisper-Modell:"), asrModelCombo);
+    audioLayout->addRow (tr ("Modell-Kaskade:"), cascadeCheck);
+    audioLayout->addRow (tr ("Kleines Modell:"), draftModelCombo);
+    audioLayout->addRow (tr ("Großes Modell unter Konfidenz:"), escalateSpin);
+    audioLayout->addRow (tr ("ASR-Teildateien alle:"), segmentMinutesSpin);
+    audioLayout->addRow (tr ("HQ-Aufnahme als FLAC:"), flacLevelSpin);
+    audioLayout->addRow (tr ("Aufbewahrte Aufnahmen:"), keepSessionsSpin);
+    audioLayout->addRow (tr ("Gleichzeitige Aufträge:"), maxJobsSpin);
+    audioLayout->addRow (tr ("Warteschlange:"), autoTagCheck);
+    audioLayout->addRow (tr ("Tag-Erzeugung:"), tagEngineCombo);
+    audioLayout->addRow (tr ("ASR-Cache:"), cacheSizeSpin);
+    audioLayout->addRow (tr ("Cache-Einträge behalten:"), cacheAgeSpin);
+    audioLayout->addRow (tr ("Cache-Statistik:"), cacheStatsLabel);
+    audioLayout->addRow ("", clearCacheButton);
     audioGroup->setLayout (audioLayout);
     form->addRow (audioGroup);
 
+    QGroupBox *resourceGroup = new QGroupBox (tr ("Ressourcen während der Aufnahme"));
+    QFormLayout *resourceLayout = new QFormLayout ();
+    resourceLayout->addRow (tr ("Audio-Threads:"), realtimeCheck);
+    resourceLayout->addRow (tr ("Governor:"), governorCheck);
+    resourceLayout->addRow (tr ("Threads für Python:"), governorThreadsSpin);
+    resourceLayout->addRow (tr ("nice-Stufe:"), governorNiceSpin);
+    resourceLayout->addRow (tr ("CPUs für Python:"), affinityEdit);
+    resourceLayout->addRow (tr ("cgroup-v2-Verzeichnis:"), cgroupEdit);
+    resourceLayout->addRow (tr ("cgroup-CPU-Grenze:"), cgroupCpuSpin);
+    resourceLayout->addRow (tr ("cgroup-Speichergrenze:"), cgroupMemorySpin);
+    resourceLayout->addRow (tr ("Xruns unter ASR-Last:"), xrunStatsLabel);
+    resourceLayout->addRow ("", resetXrunButton);
+    resourceGroup->setLayout (resourceLayout);
+    form->addRow (resourceGroup);
+
     QGroupBox *pdfGroup = new QGroupBox (tr ("PDF-Export Einstellungen"));
     QFormLayout *pdfLayout = new QFormLayout ();
     pdfLayout->addRow (tr ("Schriftart:"), fontFamilyCombo);
@@ -355,6 +561,37 @@ void SettingsWizard::saveSettings ()
     settings.setValue ("audio/bufferThreshold", validateBufferSize (bufferSlider->value ()));
     settings.setValue ("sysGain", sysGainSpin->value ());
     settings.setValue ("micGain", micGainSpin->value ());
+    settings.setValue ("audio/highPassHz", highPassSpin->value ());
+    settings.setValue ("audio/limiter", limiterCheck->isChecked ());
+    settings.setValue ("audio/limiterThreshold", limiterThresholdSpin->value ());
+    settings.setValue ("asr/vad", vadCheck->isChecked ());
+    settings.setValue ("asr/persistentWorker", workerCheck->isChecked ());
+    settings.setValue ("asr/streaming", streamingCheck->isChecked ());
+    settings.setValue ("asr/parallelWorkers", parallelWorkersSpin->value ());
+    settings.setValue ("asr/model", asrModelCombo->currentText ());
+    settings.setValue ("asr/cascade", cascadeCheck->isChecked ());
+    settings.setValue ("asr/draftModel", draftModelCombo->currentText ());
+    settings.setValue ("asr/escalateBelow", escalateSpin->value ());
+    settings.setValue ("audio/segmentMinutes", segmentMinutesSpin->value ());
+    settings.setValue ("audio/hqFlac", flacLevelSpin->value () >= 0);
+    if (flacLevelSpin->value () >= 0)
+    {
+        settings.setValue ("audio/flacLevel", flacLevelSpin->value ());
+    }
+    settings.setValue ("audio/keepSessions", keepSessionsSpin->value ());
+    settings.setValue ("jobs/maxParallel", maxJobsSpin->value ());
+    settings.setValue ("jobs/autoTag", autoTagCheck->isChecked ());
+    settings.setValue ("tags/engine", tagEngineCombo->currentData ().toString ());
+    settings.setValue ("asrCache/maxMB", cacheSizeSpin->value ());
+    settings.setValue ("asrCache/maxAgeDays", cacheAgeSpin->value ());
+    settings.setValue ("audio/realtime", realtimeCheck->isChecked ());
+    settings.setValue ("governor/enabled", governorCheck->isChecked ());
+    settings.setValue ("governor/threads", governorThreadsSpin->value ());
+    settings.setValue ("governor/nice", governorNiceSpin->value ());
+    settings.setValue ("governor/affinity", affinityEdit->text ().trimmed ());
+    settings.setValue ("governor/cgroupPath", cgroupEdit->text ().trimmed ());
+    settings.setValue ("governor/cgroupCpuPercent", cgroupCpuSpin->value ());
+    settings.setValue ("governor/cgroupMemoryMB", cgroupMemorySpin->value ());
 
     //  PDF-Einstellungen
     settings.beginGroup ("PDF");
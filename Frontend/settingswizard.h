@@ -14,6 +14,8 @@ class QSlider;
 class QLabel;
 class QDoubleSpinBox;
 class QSpinBox;
+class QCheckBox;
+class QComboBox;
 class QFontComboBox;
 class QScrollArea;
 
@@ -76,6 +78,39 @@ private:
     QDoubleSpinBox *micGainSpin; ///< SpinBox für den Mikrofon-Verstärkungsfaktor.
     QSlider *micGainSlider;      ///< Slider für den Mikrofon-Verstärkungsfaktor.
 
+    // Echtzeit-DSP
+    QSpinBox *highPassSpin;  ///< SpinBox für die Grenzfrequenz des Hochpassfilters (0 = aus).
+    QCheckBox *limiterCheck; ///< Checkbox zum Aktivieren des Limiters.
+    QDoubleSpinBox *limiterThresholdSpin; ///< SpinBox für die Limiter-Schwelle (1.0 = 0 dBFS).
+    QCheckBox *vadCheck;     ///< Checkbox zum Entfernen der Stille vor der Transkription.
+    QCheckBox *workerCheck;  ///< Checkbox für den langlebigen ASR-Worker.
+    QCheckBox *streamingCheck; ///< Checkbox für die Live-Transkription während der Aufnahme.
+    QSpinBox *parallelWorkersSpin; ///< SpinBox für die Anzahl paralleler ASR-Worker bei langen Aufnahmen.
+    QSpinBox *segmentMinutesSpin;  ///< SpinBox für die Länge der ASR-Teildateien (0 = aus).
+    QSpinBox *flacLevelSpin;       ///< SpinBox für die FLAC-Kompressionsstufe der HQ-Datei (-1 = WAV).
+    QSpinBox *keepSessionsSpin;    ///< SpinBox für die Anzahl aufbewahrter Aufnahme-Sitzungen (0 = alle).
+    QSpinBox *maxJobsSpin;         ///< SpinBox für die Anzahl gleichzeitiger Aufträge der Warteschlange.
+    QCheckBox *autoTagCheck;       ///< Checkbox für automatische Tag-Aufträge nach jeder Transkription.
+    QComboBox *tagEngineCombo;     ///< Auswahl der Tag-Erzeugung (TF-IDF im Programm oder spaCy).
+    QSpinBox *cacheSizeSpin;       ///< SpinBox für die Größe des ASR-Ergebnis-Caches (0 = aus).
+    QSpinBox *cacheAgeSpin;        ///< SpinBox für die Aufbewahrungsdauer unbenutzter Cache-Einträge.
+    QLabel *cacheStatsLabel;       ///< Zeigt Treffer und Fehlschläge des ASR-Caches.
+    QComboBox *asrModelCombo;      ///< Auswahl des Whisper-Modells für das Endergebnis.
+    QCheckBox *cascadeCheck;       ///< Checkbox für die Kaskade (erst kleines, dann großes Modell).
+    QComboBox *draftModelCombo;    ///< Auswahl des kleinen Modells der Kaskade.
+    QDoubleSpinBox *escalateSpin;  ///< Konfidenz, unter der die Kaskade das große Modell einsetzt.
+
+    // Ressourcen der Python-Prozesse und Priorität der Audio-Threads
+    QCheckBox *realtimeCheck;      ///< Checkbox für Echtzeit-Priorität und gesperrten Speicher der Audio-Threads.
+    QCheckBox *governorCheck;      ///< Checkbox zum Bremsen der Python-Prozesse (ProcessGovernor).
+    QSpinBox *governorThreadsSpin; ///< SpinBox für das Thread-Budget der Python-Prozesse (0 = automatisch).
+    QSpinBox *governorNiceSpin;    ///< SpinBox für die nice-Stufe der Python-Prozesse.
+    QLineEdit *affinityEdit;       ///< Eingabefeld für die erlaubten CPUs der Python-Prozesse (z.B. "2-7").
+    QLineEdit *cgroupEdit;         ///< Eingabefeld für ein delegiertes cgroup-v2-Verzeichnis (leer = aus).
+    QSpinBox *cgroupCpuSpin;       ///< SpinBox für die CPU-Grenze der cgroup in % (0 = keine).
+    QSpinBox *cgroupMemorySpin;    ///< SpinBox für die Speichergrenze der cgroup in MB (0 = keine).
+    QLabel *xrunStatsLabel;        ///< Zeigt die Xruns unter ASR-Last mit und ohne Governor.
+
     // PDF-Exporteinstellungen
     QSpinBox *pdfHeadlineSpin;      ///< SpinBox für die Schriftgröße der PDF-Überschrift.
     QSpinBox *pdfBodySpin;          ///< SpinBox für die Schriftgröße des PDF-Haupttextes.
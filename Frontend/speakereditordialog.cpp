@@ -215,8 +215,10 @@ void SpeakerEditorDialog::populateSegmentTable ()
     {
         const MetaText& mt = metaTexts.at (i);
         //  Füllt die ersten vier Spalten mit den Segment-Daten. Diese sind nicht direkt editierbar.
-        m_segmentTable->setItem (i, 0, new QTableWidgetItem (mt.Start));
-        m_segmentTable->setItem (i, 1, new QTableWidgetItem (mt.End));
+        //  Angezeigt wird die Zeit in Sekunden, das Segment wird über seine ID gefunden.
+        m_segmentTable->setItem (i, 0, new QTableWidgetItem (mt.start ()));
+        m_segmentTable->setItem (i, 1, new QTableWidgetItem (mt.end ()));
+        m_segmentTable->item (i, 0)->setData (Qt::UserRole, mt.Id);
         m_segmentTable->setItem (i, 2, new QTableWidgetItem (mt.Speaker));
         m_segmentTable->setItem (i, 3, new QTableWidgetItem (mt.Text));
         for (int col = 0; col <= 3; ++col)
@@ -238,7 +240,7 @@ void SpeakerEditorDialog::populateSegmentTable ()
         m_segmentTable->setCellWidget (i, 4, combo);
 
         //  Initialisiert den Puffer für Segment-Änderungen.
-        m_currentSegmentNames.insert ({mt.Start, mt.End}, mt.Speaker);
+        m_currentSegmentNames.insert (mt.Id, mt.Speaker);
     }
     m_segmentTable->blockSignals (false);
 }
@@ -295,22 +297,21 @@ void SpeakerEditorDialog::applyCurrentTabChanges ()
     }
     else //  Segment-Tab ist aktiv
     {
+        //  Die geänderten Segmente werden gesammelt und in einem Durchlauf über ihre ID geändert.
+        QList<QPair<quint64, QString>> changes;
         for (int i = 0; i < m_segmentTable->rowCount (); ++i)
         {
-            QString start = m_segmentTable->item (i, 0)->text ();
-            QString end = m_segmentTable->item (i, 1)->text ();
+            quint64 id = m_segmentTable->item (i, 0)->data (Qt::UserRole).toULongLong ();
             QString oldSpeaker = m_segmentTable->item (i, 2)->text ();
             QComboBox* combo = qobject_cast<QComboBox*> (m_segmentTable->cellWidget (i, 4));
             QString newSpeaker = combo ? combo->currentText ().trimmed () : oldSpeaker;
 
             if (!newSpeaker.isEmpty () && newSpeaker != oldSpeaker)
             {
-                if (m_transcription->changeSpeakerForSegment (start, end, newSpeaker))
-                {
-                    changed = true;
-                }
+                changes.append ({id, newSpeaker});
             }
         }
+        changed = m_transcription->changeSpeakers (changes) > 0;
         setDialogStatus (tr ("Abschnitts-Änderungen angewendet."), true);
     }
     //  endBatchUpdate() wendet alle Änderungen an und sendet ein einziges 'changed'-Signal, falls nötig.
@@ -352,9 +353,8 @@ void SpeakerEditorDialog::onSegmentSpeakerChanged (
     QString newSpeaker = combo->itemText (index);
     if (row >= 0 && row < m_segmentTable->rowCount ())
     {
-        QString start = m_segmentTable->item (row, 0)->text ();
-        QString end = m_segmentTable->item (row, 1)->text ();
-        m_currentSegmentNames[{start, end}] = newSpeaker;
+        quint64 id = m_segmentTable->item (row, 0)->data (Qt::UserRole).toULongLong ();
+        m_currentSegmentNames[id] = newSpeaker;
     }
 }
 
@@ -403,24 +403,20 @@ void SpeakerEditorDialog::onGlobalSpeakerNameChanged (
 //--------------------------------------------------------------------------------------------------
 
 void SpeakerEditorDialog::setSelectedSegment (
-    const QString& start, const QString& end)
+    qint64 startMs, qint64 endMs)
 {
     //  Diese Methode wird extern aufgerufen, um ein bestimmtes Segment in der Tabelle zu markieren.
-    m_selectedSegmentStart = start;
-    m_selectedSegmentEnd = end;
+    m_selectedSegmentStart = startMs;
+    m_selectedSegmentEnd = endMs;
 
-    //  Sucht die passende Zeile und scrollt dorthin.
-    for (int i = 0; i < m_segmentTable->rowCount (); ++i)
+    //  Die Zeilen der Tabelle entsprechen den Segmenten des Transkripts.
+    const int i = m_transcription ? m_transcription->indexOf (startMs, endMs) : -1;
+    if (i >= 0 && i < m_segmentTable->rowCount ())
     {
-        if (m_segmentTable->item (i, 0)->text () == start
-            && m_segmentTable->item (i, 1)->text () == end)
-        {
-            m_tabWidget->setCurrentIndex (1); //  Zum Segment-Tab wechseln
-            m_segmentTable->selectRow (i);
-            m_segmentTable->scrollToItem (m_segmentTable->item (i, 0),
-                                          QAbstractItemView::PositionAtCenter);
-            break;
-        }
+        m_tabWidget->setCurrentIndex (1); //  Zum Segment-Tab wechseln
+        m_segmentTable->selectRow (i);
+        m_segmentTable->scrollToItem (m_segmentTable->item (i, 0),
+                                      QAbstractItemView::PositionAtCenter);
     }
 }
 
@@ -7,6 +7,7 @@
 #define SPEAKEREDITORDIALOG_H
 
 #include <QDialog>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QPointer>
@@ -46,10 +47,10 @@ public:
 
     /**
      * @brief Ermöglicht das programmatische Vor-Auswählen eines Segments im Dialog.
-     * @param start Der Start-Zeitstempel des zu selektierenden Segments.
-     * @param end Der End-Zeitstempel des zu selektierenden Segments.
+     * @param startMs Der Beginn des zu selektierenden Segments in Millisekunden.
+     * @param endMs Das Ende des zu selektierenden Segments in Millisekunden.
      */
-    void setSelectedSegment (const QString& start, const QString& end);
+    void setSelectedSegment (qint64 startMs, qint64 endMs);
 
 public slots:
     /**
@@ -112,11 +113,11 @@ private:
     // Interne Zustands- und Puffer-Variablen
     QSet<QString> m_allKnownSpeakers; ///< Eine Menge aller einzigartigen Sprechernamen im Transkript.
     QMap<QString, QString> m_currentGlobalNames; ///< Puffer für globale Namensänderungen.
-    QMap<QPair<QString, QString>, QString>
-        m_currentSegmentNames; ///< Puffer für segmentweise Sprecheränderungen.
+    QHash<quint64, QString>
+        m_currentSegmentNames; ///< Puffer für segmentweise Sprecheränderungen (Schlüssel: Segment-ID).
 
-    QString m_selectedSegmentStart; ///< Merker für das programmatisch ausgewählte Segment.
-    QString m_selectedSegmentEnd;
+    qint64 m_selectedSegmentStart = -1; ///< Merker für das programmatisch ausgewählte Segment.
+    qint64 m_selectedSegmentEnd = -1;
 };
 
 #endif // SPEAKEREDITORDIALOG_H
@@ -1,7 +1,40 @@
 #include "taggeneratormanager.h"
+#include "asrworker.h"
+#include "keywordextractor.h"
+#include "processgovernor.h"
+#include "transcription.h"
 
 #include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
 #include <QSettings>
+#include <QTimer>
+
+namespace
+{
+QPointer<AsrWorker> s_worker;   //  Der gemeinsame Tag-Worker aller TagGeneratorManager.
+QPointer<QTimer> s_idleTimer;   //  Beendet den Worker nach "tags/workerIdleSec" ohne Anfrage.
+int s_pendingRequests = 0;      //  Anfragen, die am Worker noch laufen.
+qint64 s_nextRequestId = 0;     //  Zuletzt vergebene Anfrage-ID (anwendungsweit eindeutig).
+
+//  Startet den Leerlauf-Timer, sobald keine Anfrage mehr läuft.
+void startIdleTimer ()
+{
+    if (s_pendingRequests > 0 || !s_idleTimer)
+    {
+        return;
+    }
+
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const int idleSec = settings.value ("tags/workerIdleSec", 600).toInt ();
+    if (idleSec > 0)
+    {
+        s_idleTimer->start (idleSec * 1000);
+    }
+}
+} // namespace
 
 //--------------------------------------------------------------------------------------------------
 
@@ -9,6 +42,7 @@ TagGeneratorManager::TagGeneratorManager (
     QObject *parent)
     : QObject (parent)
     , m_process (new QProcess (this))
+    , m_requestId (0)
 {
     QSettings settings;
     m_pythonPath = settings.value ("pythonPath").toString ();
@@ -16,23 +50,44 @@ TagGeneratorManager::TagGeneratorManager (
     //  Der Pfad zum Tag-Generator-Skript wird relativ zum Anwendungsverzeichnis konstruiert.
     //  Dies stellt sicher, dass es auch nach der Installation noch gefunden wird.
     m_scriptPath = QCoreApplication::applicationDirPath () + "/python/generate_tags.py";
+    m_workerScriptPath = QCoreApplication::applicationDirPath () + "/python/tag_worker.py";
 
     connect (m_process, &QProcess::finished, this, &TagGeneratorManager::onProcessFinished);
 }
 
 //--------------------------------------------------------------------------------------------------
 
+TagGeneratorManager::~TagGeneratorManager ()
+{
+    //  Der Worker rechnet die Anfrage zu Ende; das Ergebnis wird nur nicht mehr abgeholt.
+    if (m_requestId != 0)
+    {
+        m_requestId = 0;
+        --s_pendingRequests;
+        startIdleTimer ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void TagGeneratorManager::generateTagsFor (
     const QString &fullText)
 {
+    if (!useSpacy ())
+    {
+        generateNativeTags (nullptr, fullText);
+        return;
+    }
+
     //  Sicherheitsprüfung, um zu verhindern, dass mehrere Analyse-Prozesse gleichzeitig laufen.
-    if (m_process->state () != QProcess::NotRunning)
+    if (m_process->state () != QProcess::NotRunning || m_requestId != 0)
     {
         emit tagsReady ({}, false, "Ein anderer Prozess zur Tag-Generierung läuft bereits.");
         return;
     }
 
-    //  Startet das Python-Skript.
+    //  Startet das Python-Skript; wie die ASR-Prozesse gebremst, damit eine Aufnahme nicht stockt.
+    ProcessGovernor ().apply (m_process);
     m_process->start (m_pythonPath, {m_scriptPath});
 
     //  Schreibt den gesamten Transkript-Text in die Standardeingabe des Python-Prozesses.
@@ -46,6 +101,250 @@ void TagGeneratorManager::generateTagsFor (
 
 //--------------------------------------------------------------------------------------------------
 
+void TagGeneratorManager::generateTagsFor (
+    Transcription *script)
+{
+    if (!script)
+    {
+        emit tagsReady ({}, false, "Kein Transkript für die Tag-Generierung.");
+        return;
+    }
+
+    if (!useSpacy ())
+    {
+        generateNativeTags (script, QString ());
+        return;
+    }
+
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    if (!settings.value ("tags/persistentWorker", true).toBool ()
+        || !QFileInfo::exists (m_workerScriptPath))
+    {
+        //  Ohne Worker wird wie bisher der Gesamttext in einem eigenen Prozess analysiert.
+        generateTagsFor (script->text ());
+        return;
+    }
+
+    if (m_process->state () != QProcess::NotRunning || m_requestId != 0)
+    {
+        emit tagsReady ({}, false, "Ein anderer Prozess zur Tag-Generierung läuft bereits.");
+        return;
+    }
+
+    //  Die Texte werden gemerkt, damit Tags eines inzwischen bearbeiteten Segments verworfen
+    //  werden können.
+    m_target = script;
+    m_segmentTexts.clear ();
+    QJsonArray segments;
+    for (const MetaText &segment : script->getMetaTexts ())
+    {
+        m_segmentTexts.append (segment.Text);
+        segments.append (segment.Text);
+    }
+
+    const int batchSize = qMax (1, settings.value ("tags/batchSize", 64).toInt ());
+    const int processes = qMax (1, settings.value ("tags/nProcess", 1).toInt ());
+
+    AsrWorker *worker = sharedWorker ();
+    m_requestId = ++s_nextRequestId;
+    ++s_pendingRequests;
+    s_idleTimer->stop ();
+
+    worker->send (QJsonObject{{"cmd", "tag"},
+                              {"id", m_requestId},
+                              {"segments", segments},
+                              {"batch_size", batchSize},
+                              {"n_process", processes}});
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool TagGeneratorManager::useSpacy ()
+{
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    return settings.value ("tags/engine", "native").toString () == "spacy";
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TagGeneratorManager::generateNativeTags (
+    Transcription *script, const QString &fullText)
+{
+    QElapsedTimer timer;
+    timer.start ();
+
+    const KeywordExtractor &extractor = KeywordExtractor::shared ();
+    QStringList tags;
+    if (script)
+    {
+        //  Die Segment-Tags werden sofort übernommen, da das Transkript nur jetzt sicher existiert.
+        const QList<MetaText> &segments = script->getMetaTexts ();
+        for (int i = 0; i < segments.size (); ++i)
+        {
+            const QStringList segmentTags = extractor.suggestForSegment (segments[i]);
+            script->setSegmentTags (i, segmentTags);
+            emit segmentTagsReady (i, segmentTags);
+        }
+        tags = extractor.suggestForTranscription (script);
+    }
+    else
+    {
+        tags = extractor.suggest (fullText, KeywordExtractor::MeetingTags);
+    }
+
+    qDebug () << "TagGeneratorManager: Tags per TF-IDF in" << timer.elapsed () << "ms (Korpus:"
+              << extractor.documentCount () << "Meetings)";
+
+    //  Wie beim Python-Prozess kommt das Ergebnis asynchron, damit der Aufrufer nach dem Start
+    //  noch seinen Zustand setzen kann.
+    QMetaObject::invokeMethod (
+        this, [this, tags] () { emit tagsReady (tags, true); }, Qt::QueuedConnection);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AsrWorker *TagGeneratorManager::sharedWorker ()
+{
+    //  Der Worker gehört der Anwendung, damit das Modell geladen bleibt, auch wenn die
+    //  einzelnen Manager (z.B. je Auftrag) kommen und gehen.
+    if (!s_worker)
+    {
+        s_worker = new AsrWorker (0, QCoreApplication::instance ());
+        s_idleTimer = new QTimer (s_worker);
+        s_idleTimer->setSingleShot (true);
+        QObject::connect (s_idleTimer,
+                          &QTimer::timeout,
+                          s_worker,
+                          [] ()
+                          {
+                              if (s_pendingRequests == 0)
+                              {
+                                  qDebug () << "TagGeneratorManager: Tag-Worker im Leerlauf.";
+                                  s_worker->shutdown ();
+                              }
+                          });
+    }
+
+    connect (s_worker,
+             &AsrWorker::messageReceived,
+             this,
+             &TagGeneratorManager::onWorkerMessage,
+             Qt::UniqueConnection);
+    connect (s_worker,
+             &AsrWorker::exited,
+             this,
+             &TagGeneratorManager::onWorkerExited,
+             Qt::UniqueConnection);
+    connect (s_worker,
+             &AsrWorker::failedToStart,
+             this,
+             &TagGeneratorManager::onWorkerFailed,
+             Qt::UniqueConnection);
+
+    if (!s_worker->isRunning ())
+    {
+        s_worker->start (m_pythonPath, m_workerScriptPath);
+    }
+    return s_worker;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TagGeneratorManager::onWorkerMessage (
+    const QJsonObject &message)
+{
+    const qint64 id = message.value ("id").toInteger ();
+    const QString type = message.value ("type").toString ();
+
+    //  Fehler ohne ID (z.B. fehlendes Modell beim Start) betreffen jede laufende Anfrage.
+    if (m_requestId == 0 || (id != m_requestId && !(type == "error" && id == 0)))
+    {
+        return;
+    }
+
+    if (type == "segment_tags")
+    {
+        const int index = message.value ("index").toInt (-1);
+        QStringList tags;
+        for (const QJsonValue &value : message.value ("tags").toArray ())
+        {
+            tags.append (value.toString ());
+        }
+
+        if (m_target && index >= 0 && index < m_target->getMetaTexts ().size ()
+            && index < m_segmentTexts.size ()
+            && m_target->getMetaTexts ()[index].Text == m_segmentTexts[index])
+        {
+            m_target->setSegmentTags (index, tags);
+            emit segmentTagsReady (index, tags);
+        }
+    }
+    else if (type == "done")
+    {
+        QStringList tags;
+        for (const QJsonValue &value : message.value ("tags").toArray ())
+        {
+            tags.append (value.toString ());
+        }
+        qDebug () << "TagGeneratorManager:" << m_segmentTexts.size () << "Segmente getaggt in"
+                  << message.value ("seconds").toDouble () << "s";
+        finishRequest (tags, true);
+    }
+    else if (type == "error")
+    {
+        finishRequest ({},
+                       false,
+                       "Fehler im Python-Skript zur Tag-Erstellung: "
+                           + message.value ("message").toString ());
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TagGeneratorManager::onWorkerExited (
+    int exitCode, bool wasReady)
+{
+    Q_UNUSED (wasReady)
+
+    if (m_requestId == 0)
+    {
+        return;
+    }
+
+    finishRequest ({},
+                   false,
+                   QString ("Der Tag-Worker wurde unerwartet beendet (Exit-Code %1): %2")
+                       .arg (exitCode)
+                       .arg (s_worker ? s_worker->stderrTail () : QString ()));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TagGeneratorManager::onWorkerFailed (
+    const QString &errorMsg)
+{
+    if (m_requestId != 0)
+    {
+        finishRequest ({}, false, errorMsg);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TagGeneratorManager::finishRequest (
+    const QStringList &tags, bool success, const QString &errorMsg)
+{
+    m_requestId = 0;
+    m_target.clear ();
+    m_segmentTexts.clear ();
+    --s_pendingRequests;
+    startIdleTimer ();
+
+    emit tagsReady (tags, success, errorMsg);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void TagGeneratorManager::onProcessFinished (
     int exitCode, QProcess::ExitStatus exitStatus)
 {
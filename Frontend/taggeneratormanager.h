@@ -6,10 +6,15 @@
 #ifndef TAGGENERATORMANAGER_H
 #define TAGGENERATORMANAGER_H
 
+#include <QJsonObject>
 #include <QObject>
+#include <QPointer>
 #include <QProcess>
 #include <QStringList>
 
+class AsrWorker;
+class Transcription;
+
 /**
  * @brief Steuert den externen Python-Prozess zur automatischen Tag-Erstellung.
  *
@@ -17,6 +22,17 @@
  * Transkripts zu analysieren und relevante Schlüsselwörter sowie Eigennamen
  * (Personen, Orte, etc.) als Tags zu extrahieren.
  * Die Ausführung geschieht asynchron in einem eigenen Prozess.
+ *
+ * Für ganze Transkripte wird ein langlebiger Worker (tag_worker.py) genutzt, den sich alle
+ * TagGeneratorManager der Anwendung teilen: Das spaCy-Modell wird nur einmal geladen, die
+ * Segmente laufen stapelweise durch nlp.pipe() ("tags/batchSize", "tags/nProcess"), und die
+ * Tags jedes Segments werden übernommen, sobald sie vorliegen. Nach "tags/workerIdleSec"
+ * ohne Anfrage beendet sich der Worker. Mit "tags/persistentWorker" = false oder ohne das
+ * Worker-Skript wird wie bisher generate_tags.py für den Gesamttext gestartet.
+ *
+ * Python und spaCy sind der langsamere, genauere Weg ("tags/engine" = "spacy"). Standard ist
+ * der KeywordExtractor ("tags/engine" = "native"), der ohne Python im Prozess in Millisekunden
+ * Vorschläge per TF-IDF gegen den Korpus aller Meetings liefert.
  */
 class TagGeneratorManager : public QObject
 {
@@ -28,6 +44,9 @@ public:
      */
     explicit TagGeneratorManager (QObject *parent = nullptr);
 
+    /** @brief Destruktor. Gibt eine noch laufende Anfrage am gemeinsamen Worker frei. */
+    ~TagGeneratorManager ();
+
 public slots:
     /**
      * @brief Startet die Tag-Analyse für den übergebenen Text.
@@ -38,6 +57,16 @@ public slots:
      */
     void generateTagsFor (const QString &fullText);
 
+    /**
+     * @brief Startet die Tag-Analyse für alle Segmente eines Transkripts.
+     *
+     * Die Tags jedes Segments werden direkt in das Transkript übernommen (sofern sein Text
+     * sich inzwischen nicht geändert hat) und über `segmentTagsReady` gemeldet; die Tags des
+     * ganzen Meetings kommen wie bisher über `tagsReady`.
+     * @param script Das Transkript. Darf während der Analyse gelöscht werden.
+     */
+    void generateTagsFor (Transcription *script);
+
 signals:
     /**
      * @brief Wird gesendet, wenn der Tag-Generierungs-Prozess abgeschlossen ist.
@@ -47,6 +76,13 @@ signals:
      */
     void tagsReady (const QStringList &tags, bool success, const QString &errorMsg = "");
 
+    /**
+     * @brief Die Tags eines Segments liegen vor und wurden in das Transkript übernommen.
+     * @param index Position des Segments im Transkript.
+     * @param tags Die Tags des Segments.
+     */
+    void segmentTagsReady (int index, const QStringList &tags);
+
 private slots:
     /**
      * @brief Interner Slot, der aufgerufen wird, wenn der Python-Prozess beendet ist.
@@ -56,10 +92,35 @@ private slots:
      */
     void onProcessFinished (int exitCode, QProcess::ExitStatus exitStatus);
 
+    /** @brief Wertet eine Nachricht des gemeinsamen Workers aus (nur die eigene Anfrage). */
+    void onWorkerMessage (const QJsonObject &message);
+
+    /** @brief Bricht die laufende Anfrage ab, wenn sich der Worker beendet hat. */
+    void onWorkerExited (int exitCode, bool wasReady);
+
+    /** @brief Bricht die laufende Anfrage ab, wenn der Worker nicht starten konnte. */
+    void onWorkerFailed (const QString &errorMsg);
+
 private:
-    QProcess *m_process;  ///< Zeiger auf das QProcess-Objekt.
-    QString m_pythonPath; ///< Pfad zum Python-Interpreter.
-    QString m_scriptPath; ///< Pfad zum 'generate_tags.py'-Skript.
+    /** @brief Gibt an, ob spaCy statt des KeywordExtractor genutzt wird ("tags/engine"). */
+    static bool useSpacy ();
+
+    /** @brief Erzeugt die Tags mit dem KeywordExtractor; `tagsReady` folgt asynchron. */
+    void generateNativeTags (Transcription *script, const QString &fullText);
+
+    /** @brief Gibt den gemeinsamen Worker zurück und startet ihn bei Bedarf. */
+    AsrWorker *sharedWorker ();
+
+    /** @brief Beendet die laufende Anfrage und meldet das Ergebnis über `tagsReady`. */
+    void finishRequest (const QStringList &tags, bool success, const QString &errorMsg = "");
+
+    QProcess *m_process;              ///< Zeiger auf das QProcess-Objekt.
+    QString m_pythonPath;             ///< Pfad zum Python-Interpreter.
+    QString m_scriptPath;             ///< Pfad zum 'generate_tags.py'-Skript.
+    QString m_workerScriptPath;       ///< Pfad zum 'tag_worker.py'-Skript.
+    qint64 m_requestId;               ///< Laufende Anfrage am Worker (0 = keine).
+    QPointer<Transcription> m_target; ///< Transkript, dessen Segmente getaggt werden.
+    QStringList m_segmentTexts;       ///< Texte der Segmente zum Zeitpunkt der Anfrage.
 };
 
 #endif // TAGGENERATORMANAGER_H
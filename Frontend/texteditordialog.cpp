@@ -130,11 +130,13 @@ void TextEditorDialog::populateTable ()
         const MetaText& mt = list.at (i);
 
         //  Die ersten drei Spalten sind nicht editierbar.
-        auto* startItem = new QTableWidgetItem (mt.Start);
+        //  Angezeigt wird die Zeit in Sekunden, das Segment wird über seine ID gefunden.
+        auto* startItem = new QTableWidgetItem (mt.start ());
+        startItem->setData (Qt::UserRole, mt.Id);
         startItem->setFlags (Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         m_table->setItem (i, 0, startItem);
 
-        auto* endItem = new QTableWidgetItem (mt.End);
+        auto* endItem = new QTableWidgetItem (mt.end ());
         endItem->setFlags (Qt::ItemIsSelectable | Qt::ItemIsEnabled);
         m_table->setItem (i, 1, endItem);
 
@@ -171,10 +173,9 @@ void TextEditorDialog::onTextItemChanged (
     if (newText != oldText)
     {
         //  Die Änderung wird nicht sofort übernommen, sondern in einer Map zwischengespeichert.
-        //  Als eindeutiger Schlüssel für das Segment dient das Paar aus Start- und Endzeit.
-        QString start = m_table->item (row, 0)->text ();
-        QString end = m_table->item (row, 1)->text ();
-        m_pendingTextChanges[{start, end}] = newText;
+        //  Als eindeutiger Schlüssel für das Segment dient seine ID.
+        quint64 id = m_table->item (row, 0)->data (Qt::UserRole).toULongLong ();
+        m_pendingTextChanges[id] = newText;
     }
 }
 
@@ -187,25 +188,17 @@ void TextEditorDialog::applyChanges ()
         return;
     }
 
-    bool changed = false;
-    //  Verhindert, dass für jede Textänderung ein separates Signal ausgelöst wird.
-    m_transcription->beginBatchUpdate ();
-
-    //  Iteriert durch alle gepufferten Änderungen und wendet sie auf das Datenmodell an.
+    //  Alle gepufferten Änderungen werden in einem Durchlauf übernommen; das Datenmodell
+    //  sendet dafür ein einziges 'changed'-Signal.
+    QList<QPair<quint64, QString>> changes;
+    changes.reserve (m_pendingTextChanges.size ());
     for (auto it = m_pendingTextChanges.constBegin (); it != m_pendingTextChanges.constEnd (); ++it)
     {
-        const QString& start = it.key ().first;
-        const QString& end = it.key ().second;
-        const QString& newText = it.value ();
-
-        if (m_transcription->changeText (start, end, newText))
-        {
-            changed = true;
-        }
+        changes.append ({it.key (), it.value ()});
     }
 
-    m_pendingTextChanges.clear ();      //  Puffer leeren, nachdem die Änderungen übernommen wurden.
-    m_transcription->endBatchUpdate (); //  Sendet ein einziges 'changed'-Signal, falls nötig.
+    const bool changed = m_transcription->changeTexts (changes) > 0;
+    m_pendingTextChanges.clear (); //  Puffer leeren, nachdem die Änderungen übernommen wurden.
 
     if (changed)
     {
@@ -7,7 +7,7 @@
 #define TEXTEDITORDIALOG_H
 
 #include <QDialog>
-#include <QMap>
+#include <QHash>
 #include <QPointer>
 
 #include "transcription.h"
@@ -84,9 +84,9 @@ private:
 
     /**
      * @brief Puffer für noch nicht gespeicherte Textänderungen.
-     * Der Key ist ein Paar aus Start-/End-Zeitstempel, der Value ist der neue Text.
+     * Der Key ist die Segment-ID, der Value ist der neue Text.
      */
-    QMap<QPair<QString, QString>, QString> m_pendingTextChanges;
+    QHash<quint64, QString> m_pendingTextChanges;
 };
 
 #endif // TEXTEDITORDIALOG_H
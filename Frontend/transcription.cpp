@@ -4,9 +4,42 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QRandomGenerator>
 #include <QRegularExpression>
 #include <QStringList>
 
+#include <algorithm>
+
+namespace
+{
+//  Liest eine Zeit in Sekunden aus dem JSON (als String wie "12.34" oder als Zahl).
+bool readTime (
+    const QJsonValue &value, qint64 *ms)
+{
+    if (value.isDouble ())
+    {
+        *ms = qRound64 (value.toDouble () * 1000.0);
+        return true;
+    }
+
+    bool ok = false;
+    *ms = MetaText::parseTime (value.toString (), &ok);
+    return ok;
+}
+
+//  Liest eine Segment-ID aus dem JSON. Geschrieben wird sie als String, weil JSON-Zahlen
+//  (double) nur 53 Bit genau sind; ältere Dateien ohne "id" liefern 0.
+quint64 readId (
+    const QJsonValue &value)
+{
+    if (value.isDouble ())
+    {
+        return quint64 (value.toInteger ());
+    }
+    return value.toString ().toULongLong ();
+}
+} // namespace
+
 Transcription::Transcription (
     QObject *parent)
     : QObject (parent)
@@ -45,12 +78,17 @@ QString Transcription::script () const
         //  Jedem Sprecher wird eine deterministische Farbe basierend auf seinem Namen zugewiesen.
         QColor farbe = speakerColor (item.Speaker);
         erg += QString ("<font color='%1'>").arg (farbe.name ());
-        //  HINWEIS: Die Zeile `item.Start += ...` modifiziert den Start-String des Objekts.
-        //  Dies ist wahrscheinlich nicht beabsichtigt.
-        erg += '[' + item.Start + "s - " + item.End + "s] <b>" + item.Speaker + ":</b>";
+        erg += '[' + item.start () + "s - " + item.end () + "s] <b>" + item.Speaker + ":</b>";
         erg += "&nbsp;&nbsp;&nbsp;&nbsp;" + item.Text.toHtmlEscaped () + " </font> <br>";
     }
 
+    //  Vorläufige Segmente der Live-Transkription werden grau und kursiv angehängt.
+    for (const auto &item : m_partial)
+    {
+        erg += "<font color='gray'><i>[" + item.start () + "s - " + item.end () + "s] … ";
+        erg += item.Text.toHtmlEscaped () + "</i></font> <br>";
+    }
+
     return erg;
 }
 
@@ -94,19 +132,17 @@ bool Transcription::changeSpeaker (
 //--------------------------------------------------------------------------------------------------
 
 bool Transcription::changeText (
-    const QString &start, const QString &end, const QString &newText)
+    qint64 startMs, qint64 endMs, const QString &newText)
 {
     bool erg = false;
 
     //  Findet das spezifische Segment anhand der exakten Zeitstempel und aktualisiert den Text.
-    for (qsizetype i = 0; i < m_content.length (); i++)
+    const int i = indexOf (startMs, endMs);
+    if (i >= 0)
     {
-        if (m_content[i].Start == start && m_content[i].End == end)
-        {
-            m_content[i].Text = newText;
-            erg = true;
-            break; //  Da jedes Segment einzigartig sein sollte, kann die Schleife hier abbrechen.
-        }
+        m_content[i].Text = newText;
+        m_content[i].Words.clear (); //  Die Wort-Zeitstempel passen nicht mehr zum Text.
+        erg = true;
     }
 
     if (erg)
@@ -128,20 +164,14 @@ bool Transcription::changeText (
 //--------------------------------------------------------------------------------------------------
 
 bool Transcription::changeSpeakerForSegment (
-    const QString &start, const QString &end, const QString &newSpeaker)
+    qint64 startMs, qint64 endMs, const QString &newSpeaker)
 {
     bool hasChanged = false;
-    for (MetaText &item : m_content)
+    const int i = indexOf (startMs, endMs);
+    if (i >= 0)
     {
-        //  Hier ist Vorsicht geboten bei String-Vergleichen von Zeitstempeln
-        //  Besser wäre es, die Zeitstempel als numerische Werte zu speichern
-        //  oder eine Toleranz beim Vergleich zu verwenden.
-        if (item.Start == start && item.End == end)
-        {
-            item.Speaker = newSpeaker;
-            hasChanged = true;
-            break;
-        }
+        m_content[i].Speaker = newSpeaker;
+        hasChanged = true;
     }
 
     if (hasChanged)
@@ -162,6 +192,206 @@ bool Transcription::changeSpeakerForSegment (
 
 //--------------------------------------------------------------------------------------------------
 
+int Transcription::indexOfId (
+    quint64 id) const
+{
+    return m_idIndex.value (id, -1);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int Transcription::changeTexts (
+    const QList<QPair<quint64, QString>> &changes)
+{
+    int count = 0;
+    for (const auto &change : changes)
+    {
+        const int i = indexOfId (change.first);
+        if (i < 0 || m_content[i].Text == change.second)
+        {
+            continue;
+        }
+        m_content[i].Text = change.second;
+        m_content[i].Words.clear (); //  Die Wort-Zeitstempel passen nicht mehr zum Text.
+        ++count;
+    }
+
+    if (count > 0)
+    {
+        notifyEdited ();
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int Transcription::changeSpeakers (
+    const QList<QPair<quint64, QString>> &changes)
+{
+    int count = 0;
+    for (const auto &change : changes)
+    {
+        const int i = indexOfId (change.first);
+        if (i < 0 || m_content[i].Speaker == change.second)
+        {
+            continue;
+        }
+        m_content[i].Speaker = change.second;
+        ++count;
+    }
+
+    if (count > 0)
+    {
+        notifyEdited ();
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Transcription::renewSegmentIds ()
+{
+    m_idIndex.clear ();
+    for (int i = 0; i < m_content.size (); ++i)
+    {
+        m_content[i].Id = newSegmentId ();
+        m_idIndex.insert (m_content[i].Id, i);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Transcription::notifyEdited ()
+{
+    if (m_batchUpdateCounter > 0)
+    {
+        m_changesPending = true;
+    }
+    else
+    {
+        emit changed ();
+    }
+    emit edited ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+quint64 Transcription::newSegmentId () const
+{
+    //  Zufällig statt fortlaufend, damit die ID auch über Meetings hinweg eindeutig ist und
+    //  direkt als Schlüssel in der Datenbank dienen kann. 63 Bit passen in ein BIGINT.
+    quint64 id = 0;
+    while (id == 0 || m_idIndex.contains (id))
+    {
+        id = QRandomGenerator::global ()->generate64 () >> 1;
+    }
+    return id;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int Transcription::indexOf (
+    qint64 startMs, qint64 endMs) const
+{
+    ensureTimeIndex ();
+    const auto it = std::lower_bound (m_timeOrder.cbegin (),
+                                      m_timeOrder.cend (),
+                                      qMakePair (startMs, endMs),
+                                      [this] (int index, const QPair<qint64, qint64> &key)
+                                      {
+                                          const MetaText &item = m_content[index];
+                                          return qMakePair (item.StartMs, item.EndMs) < key;
+                                      });
+    if (it == m_timeOrder.cend () || m_content[*it].StartMs != startMs
+        || m_content[*it].EndMs != endMs)
+    {
+        return -1;
+    }
+    return *it;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int Transcription::segmentAt (
+    qint64 ms) const
+{
+    const QList<int> hits = segmentsInRange (ms, ms + 1);
+    return hits.isEmpty () ? -1 : hits.last ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QList<int> Transcription::segmentsInRange (
+    qint64 fromMs, qint64 toMs) const
+{
+    ensureTimeIndex ();
+
+    //  Vorne: das erste Segment, bis zu dem schon ein Ende nach fromMs liegt (m_maxEnd ist
+    //  monoton). Hinten: das erste Segment, das erst ab toMs beginnt. Dazwischen liegen nur
+    //  Segmente, die überlappen könnten; bei Überlappungen werden die schon beendeten übersprungen.
+    const qsizetype first
+        = std::upper_bound (m_maxEnd.cbegin (), m_maxEnd.cend (), fromMs) - m_maxEnd.cbegin ();
+    const qsizetype last = std::lower_bound (m_timeOrder.cbegin (),
+                                             m_timeOrder.cend (),
+                                             toMs,
+                                             [this] (int index, qint64 time)
+                                             { return m_content[index].StartMs < time; })
+                           - m_timeOrder.cbegin ();
+
+    QList<int> result;
+    for (qsizetype i = first; i < last; ++i)
+    {
+        if (m_content[m_timeOrder[i]].EndMs > fromMs)
+        {
+            result.append (m_timeOrder[i]);
+        }
+    }
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+qint64 Transcription::durationMs () const
+{
+    ensureTimeIndex ();
+    return m_maxEnd.isEmpty () ? 0 : m_maxEnd.last ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Transcription::ensureTimeIndex () const
+{
+    if (m_timeIndexValid)
+    {
+        return;
+    }
+
+    m_timeOrder.resize (m_content.size ());
+    for (int i = 0; i < m_timeOrder.size (); ++i)
+    {
+        m_timeOrder[i] = i;
+    }
+    std::stable_sort (m_timeOrder.begin (),
+                      m_timeOrder.end (),
+                      [this] (int a, int b)
+                      {
+                          return qMakePair (m_content[a].StartMs, m_content[a].EndMs)
+                                 < qMakePair (m_content[b].StartMs, m_content[b].EndMs);
+                      });
+
+    m_maxEnd.resize (m_timeOrder.size ());
+    qint64 maxEnd = 0;
+    for (int i = 0; i < m_timeOrder.size (); ++i)
+    {
+        maxEnd = i == 0 ? m_content[m_timeOrder[i]].EndMs
+                        : qMax (maxEnd, m_content[m_timeOrder[i]].EndMs);
+        m_maxEnd[i] = maxEnd;
+    }
+    m_timeIndexValid = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 QJsonDocument Transcription::toJson () const
 {
     //  Serialisiert das gesamte Transcription-Objekt in ein JSON-Format.
@@ -169,15 +399,31 @@ QJsonDocument Transcription::toJson () const
     for (const MetaText &item : m_content)
     {
         QJsonObject entry;
+        entry["id"] = QString::number (item.Id);
         entry["speaker"] = item.Speaker;
         entry["text"] = item.Text;
-        entry["start"] = item.Start;
-        entry["end"] = item.End;
+        //  Als Sekunden-String wie bisher, aber mit Millisekunden, damit nichts verloren geht.
+        entry["start"] = MetaText::formatTime (item.StartMs, 3);
+        entry["end"] = MetaText::formatTime (item.EndMs, 3);
 
         if (!item.Tags.isEmpty ())
         {
             entry["tags"] = QJsonArray::fromStringList (item.Tags);
         }
+        if (item.Confidence >= 0.0)
+        {
+            entry["confidence"] = item.Confidence;
+        }
+        if (!item.Words.isEmpty ())
+        {
+            //  Kompakt als [start_ms, end_ms, "wort", wahrscheinlichkeit], wie im ASR-Protokoll.
+            QJsonArray words;
+            for (const MetaWord &word : item.Words)
+            {
+                words.append (QJsonArray{word.StartMs, word.EndMs, word.Text, word.Probability});
+            }
+            entry["words"] = words;
+        }
 
         contentArray.append (entry);
     }
@@ -258,13 +504,12 @@ bool Transcription::fromJson (
         QJsonObject obj = val.toObject ();
         QString speaker = obj.value ("speaker").toString ();
         QString text = obj.value ("text").toString ();
-        QString start = obj.value ("start").toString ();
-        QString end = obj.value ("end").toString ();
 
         //  Validierung der gelesenen Daten, um ungültige Einträge zu überspringen.
-        bool ok1 = false, ok2 = false;
-        double startSec = start.toDouble (&ok1);
-        double endSec = end.toDouble (&ok2);
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+        const bool ok1 = readTime (obj.value ("start"), &startMs);
+        const bool ok2 = readTime (obj.value ("end"), &endMs);
 
         if (speaker.trimmed ().isEmpty ())
         {
@@ -272,14 +517,15 @@ bool Transcription::fromJson (
             continue;
         }
 
-        if (!ok1 || !ok2 || startSec >= endSec)
+        if (!ok1 || !ok2 || startMs >= endMs)
         {
-            qWarning () << "Eintrag übersprungen: ungültiger Zeitbereich [" << start << " – " << end
-                       << "]";
+            qWarning () << "Eintrag übersprungen: ungültiger Zeitbereich [" << obj.value ("start")
+                        << " – " << obj.value ("end") << "]";
             continue;
         }
 
-        MetaText mt (start, end, speaker, text);
+        MetaText mt (startMs, endMs, speaker, text);
+        mt.Id = readId (obj.value ("id"));
 
         //  Laden der optionalen, segment-spezifischen Tags.
         if (obj.contains ("tags") && obj["tags"].isArray ())
@@ -293,6 +539,21 @@ bool Transcription::fromJson (
                 }
             }
         }
+
+        //  Optionale Daten der Spracherkennung.
+        mt.Confidence = obj.value ("confidence").toDouble (-1.0);
+        const QJsonArray words = obj.value ("words").toArray ();
+        for (const QJsonValue &v : words)
+        {
+            const QJsonArray w = v.toArray ();
+            if (w.size () >= 3)
+            {
+                mt.Words.append ({w.at (2).toString (),
+                                  w.at (0).toInteger (),
+                                  w.at (1).toInteger (),
+                                  w.at (3).toDouble (-1.0)});
+            }
+        }
         add (mt); //  Fügt das Segment hinzu, ohne ein Signal auszulösen (wegen Batch-Update).
     }
 
@@ -312,6 +573,21 @@ void Transcription::setTags (
 
 //--------------------------------------------------------------------------------------------------
 
+bool Transcription::setSegmentTags (
+    int index, const QStringList &tags)
+{
+    //  Tags werden nicht angezeigt, daher wird (wie bei setTags) kein changed() gesendet.
+    if (index < 0 || index >= m_content.size ())
+    {
+        return false;
+    }
+
+    m_content[index].Tags = tags;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void Transcription::addTag (
     const QString &tag)
 {
@@ -361,14 +637,13 @@ QList<MetaText> Transcription::segmentsWithTag (
 
 QString Transcription::getDurationAsString () const
 {
-    //  Berechnet die Gesamtdauer des Transkripts basierend auf dem Endzeitstempel des letzten Segments.
+    //  Berechnet die Gesamtdauer des Transkripts basierend auf dem spätesten Segment-Ende.
     if (m_content.isEmpty ())
     {
         return "00:00:00";
     }
 
-    double endTimeSec = m_content.last ().End.toDouble ();
-    int durationTotalSeconds = static_cast<int> (endTimeSec);
+    int durationTotalSeconds = static_cast<int> (durationMs () / 1000);
 
     int hours = durationTotalSeconds / 3600;
     int minutes = (durationTotalSeconds % 3600) / 60;
@@ -387,6 +662,32 @@ void Transcription::add (
 {
     //  Fügt ein neues Segment hinzu und behandelt die Signal-Emission im Batch-Modus.
     m_content.append (part);
+
+    //  Eine mitgebrachte ID (aus JSON oder Datenbank) bleibt erhalten; fehlt sie oder ist sie
+    //  hier schon vergeben, bekommt das Segment eine neue.
+    MetaText &added = m_content.last ();
+    if (added.Id == 0 || m_idIndex.contains (added.Id))
+    {
+        added.Id = newSegmentId ();
+    }
+    m_idIndex.insert (added.Id, int (m_content.size () - 1));
+
+    //  Segmente kommen fast immer in zeitlicher Reihenfolge; dann wird der Zeitindex nur
+    //  verlängert, sonst beim nächsten Zugriff neu aufgebaut.
+    if (m_timeIndexValid)
+    {
+        const MetaText *last = m_timeOrder.isEmpty () ? nullptr : &m_content[m_timeOrder.last ()];
+        if (!last || last->StartMs < part.StartMs
+            || (last->StartMs == part.StartMs && last->EndMs <= part.EndMs))
+        {
+            m_timeOrder.append (int (m_content.size () - 1));
+            m_maxEnd.append (qMax (m_maxEnd.isEmpty () ? part.EndMs : m_maxEnd.last (), part.EndMs));
+        }
+        else
+        {
+            m_timeIndexValid = false;
+        }
+    }
     if (m_batchUpdateCounter > 0)
     {
         m_changesPending = true;
@@ -403,6 +704,11 @@ void Transcription::clear ()
 {
     //  Setzt den Inhalt des Datenmodells zurück.
     m_content.clear ();
+    m_partial.clear ();
+    m_timeOrder.clear ();
+    m_maxEnd.clear ();
+    m_timeIndexValid = true;
+    m_idIndex.clear ();
     m_unknownCounter = 0;
     if (m_batchUpdateCounter > 0)
     {
@@ -416,6 +722,27 @@ void Transcription::clear ()
 
 //--------------------------------------------------------------------------------------------------
 
+void Transcription::setPartial (
+    const QList<MetaText> &parts)
+{
+    if (parts.isEmpty () && m_partial.isEmpty ())
+    {
+        return;
+    }
+
+    m_partial = parts;
+    if (m_batchUpdateCounter > 0)
+    {
+        m_changesPending = true;
+    }
+    else
+    {
+        emit changed ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void Transcription::beginBatchUpdate ()
 {
     //  Erhöht den Zähler. Solange dieser > 0 ist, werden `changed`-Signale unterdrückt.
@@ -8,34 +8,81 @@
 
 #include <QColor>
 #include <QDateTime>
+#include <QHash>
 #include <QJsonDocument> // Nötig für den Rückgabetyp von toJson()
 #include <QList>
 #include <QObject>
+#include <QPair>
 #include <QString>
 
+/**
+ * @struct MetaWord
+ * @brief Ein einzelnes Wort eines Segments mit Zeitstempeln aus der Spracherkennung.
+ */
+struct MetaWord
+{
+    QString Text;              ///< Das Wort, wie von Whisper geliefert (ggf. mit führendem Leerzeichen).
+    qint64 StartMs = 0;        ///< Beginn in Millisekunden (bezogen auf die Aufnahme).
+    qint64 EndMs = 0;          ///< Ende in Millisekunden.
+    double Probability = -1.0; ///< Wahrscheinlichkeit 0..1 (-1 = unbekannt).
+};
+
 /**
  * @struct MetaText
  * @brief Eine einfache Datenstruktur, die ein einzelnes Segment eines Transkripts repräsentiert.
  *
  * Enthält den Text selbst sowie Metadaten wie Sprecher, Zeitstempel und zugeordnete Tags.
+ * Die Id identifiziert das Segment dauerhaft, auch über JSON-Export und Datenbank hinweg;
+ * sie wird von Transcription::add() vergeben, falls das Segment noch keine hat.
  */
 struct MetaText
 {
     MetaText () = default;
     MetaText (
-        const QString &start, const QString &end, const QString &speaker, const QString &text)
+        qint64 startMs, qint64 endMs, const QString &speaker, const QString &text)
         : Speaker (speaker)
         , Text (text)
-        , Start (start)
-        , End (end)
+        , StartMs (startMs)
+        , EndMs (endMs)
     {
     }
 
     QString Speaker;  ///< Der Name des Sprechers für dieses Segment.
     QString Text;     ///< Der transkribierte Text des Segments.
-    QString Start;    ///< Start-Zeitstempel des Segments (als String in Sekunden).
-    QString End;      ///< End-Zeitstempel des Segments (als String in Sekunden).
+    qint64 StartMs = 0; ///< Beginn in Millisekunden (bezogen auf die Aufnahme).
+    qint64 EndMs = 0;   ///< Ende in Millisekunden.
     QStringList Tags; ///< Eine Liste von Tags, die diesem spezifischen Segment zugeordnet sind.
+    double Confidence = -1.0; ///< Konfidenz der Spracherkennung 0..1 (-1 = unbekannt).
+    QList<MetaWord> Words;    ///< Wort-Zeitstempel der Spracherkennung (leer nach einer Textänderung).
+    quint64 Id = 0;           ///< Stabile Segment-ID (0 = noch keine vergeben).
+
+    /** @brief Gibt den Beginn für die Anzeige in Sekunden zurück (z.B. "12.34"). */
+    QString start () const { return formatTime (StartMs); }
+
+    /** @brief Gibt das Ende für die Anzeige in Sekunden zurück. */
+    QString end () const { return formatTime (EndMs); }
+
+    /**
+     * @brief Wandelt eine Zeit in Millisekunden in einen Sekunden-String um.
+     * @param ms Die Zeit in Millisekunden.
+     * @param decimals Nachkommastellen (2 für die Anzeige, 3 für verlustfreies JSON).
+     */
+    static QString formatTime (
+        qint64 ms, int decimals = 2)
+    {
+        return QString::number (ms / 1000.0, 'f', decimals);
+    }
+
+    /**
+     * @brief Wandelt einen Sekunden-String ("12.34") in Millisekunden um.
+     * @param seconds Die Zeit in Sekunden.
+     * @param ok Wird auf false gesetzt, wenn der String keine Zahl ist.
+     */
+    static qint64 parseTime (
+        const QString &seconds, bool *ok = nullptr)
+    {
+        return qRound64 (seconds.toDouble (ok) * 1000.0);
+    }
 
     void addTag (
         const QString &tag)
@@ -91,13 +138,54 @@ public:
     /** @brief Ändert einen Sprechernamen global im gesamten Transkript. */
     bool changeSpeaker (const QString &oldSpeaker, const QString &newSpeaker);
 
-    /** @brief Ändert den Text eines einzelnen, durch Zeitstempel identifizierten Segments. */
-    bool changeText (const QString &start, const QString &end, const QString &newText);
+    /** @brief Ändert den Text eines einzelnen, durch Zeitstempel (ms) identifizierten Segments. */
+    bool changeText (qint64 startMs, qint64 endMs, const QString &newText);
 
-    /** @brief Ändert den Sprecher für ein einzelnes, durch Zeitstempel identifiziertes Segment. */
-    bool changeSpeakerForSegment (const QString &start,
-                                 const QString &end,
-                                 const QString &newSpeaker);
+    /** @brief Ändert den Sprecher für ein einzelnes, durch Zeitstempel (ms) identifiziertes Segment. */
+    bool changeSpeakerForSegment (qint64 startMs, qint64 endMs, const QString &newSpeaker);
+
+    // --- Bearbeitung über die Segment-ID (jede Suche in O(1)) ---
+    /** @brief Gibt den Index des Segments mit dieser ID zurück (-1 = keins). */
+    int indexOfId (quint64 id) const;
+
+    /**
+     * @brief Ändert die Texte mehrerer Segmente in einem Durchlauf.
+     * @param changes Paare aus Segment-ID und neuem Text; unbekannte IDs werden übersprungen.
+     * @return Die Anzahl der tatsächlich geänderten Segmente. Signale werden höchstens einmal gesendet.
+     */
+    int changeTexts (const QList<QPair<quint64, QString>> &changes);
+
+    /**
+     * @brief Ändert die Sprecher mehrerer Segmente in einem Durchlauf.
+     * @param changes Paare aus Segment-ID und neuem Sprecher; unbekannte IDs werden übersprungen.
+     * @return Die Anzahl der tatsächlich geänderten Segmente. Signale werden höchstens einmal gesendet.
+     */
+    int changeSpeakers (const QList<QPair<quint64, QString>> &changes);
+
+    /**
+     * @brief Vergibt allen Segmenten neue IDs, z.B. wenn das Transkript als Kopie gespeichert wird.
+     * @note Inhalt und Anzeige ändern sich nicht, daher werden keine Signale gesendet.
+     */
+    void renewSegmentIds ();
+
+    // --- Zeitindex (alle Suchen in O(log n), bei Überlappungen zzgl. der Treffer) ---
+    /** @brief Gibt den Index des Segments mit genau diesen Zeiten zurück (-1 = keins). */
+    int indexOf (qint64 startMs, qint64 endMs) const;
+
+    /**
+     * @brief Gibt den Index des Segments zurück, das zum Zeitpunkt läuft (-1 = keins).
+     * @note Überlappen sich Segmente, wird das zuletzt begonnene geliefert.
+     */
+    int segmentAt (qint64 ms) const;
+
+    /**
+     * @brief Gibt die Indizes aller Segmente zurück, die in den Zeitraum [fromMs, toMs) hineinreichen.
+     * @return Die Indizes in getMetaTexts(), nach Beginn sortiert.
+     */
+    QList<int> segmentsInRange (qint64 fromMs, qint64 toMs) const;
+
+    /** @brief Gibt das späteste Segment-Ende in Millisekunden zurück (0 ohne Segmente). */
+    qint64 durationMs () const;
 
     /** @brief Gibt eine konstante Referenz auf die Liste aller Textsegmente zurück. */
     const QList<MetaText> &getMetaTexts () const { return m_content; }
@@ -119,6 +207,8 @@ public:
     // --- Tag-Management ---
     QStringList tags () const { return m_tags; }
     void setTags (const QStringList &tags);
+    /** @brief Setzt die lokalen Tags eines Segments. Gibt false zurück, wenn der Index ungültig ist. */
+    bool setSegmentTags (int index, const QStringList &tags);
     void addTag (const QString &tag);
     void removeTag (const QString &tag);
     bool hasTag (const QString &tag) const;
@@ -133,6 +223,14 @@ public slots:
     /** @brief Löscht alle Inhalte und Metadaten des Transkripts. */
     void clear ();
 
+    /**
+     * @brief Setzt die vorläufigen Segmente der Live-Transkription.
+     *
+     * Diese werden nur angezeigt (script()), aber weder gespeichert noch exportiert und
+     * bei jedem Aufruf vollständig ersetzt.
+     */
+    void setPartial (const QList<MetaText> &parts);
+
     /** @brief Startet einen Batch-Update-Modus, um mehrere Änderungen ohne exzessive Signal-Emissionen durchzuführen. */
     void beginBatchUpdate ();
 
@@ -166,9 +264,27 @@ private:
     /** @brief Generiert eine deterministische Farbe basierend auf dem Sprechernamen. */
     QColor speakerColor (const QString &speaker) const;
 
+    /** @brief Baut den Zeitindex neu auf, falls er nicht mehr gültig ist. */
+    void ensureTimeIndex () const;
+
+    /** @brief Erzeugt eine neue, in diesem Transkript noch unbenutzte Segment-ID. */
+    quint64 newSegmentId () const;
+
+    /** @brief Sendet nach einer Bearbeitung `changed` (bzw. merkt es im Batch-Modus vor) und `edited`. */
+    void notifyEdited ();
+
     QList<MetaText> m_content; ///< Die Liste aller transkribierten Textsegmente.
+    QList<MetaText> m_partial; ///< Vorläufige Segmente der Live-Transkription (nur Anzeige).
     QStringList m_tags;        ///< Globale Tags, die für das gesamte Meeting gelten.
 
+    //  Zeitindex: wird beim Anhängen in zeitlicher Reihenfolge mitgeführt, sonst beim nächsten
+    //  Zugriff neu aufgebaut.
+    mutable QList<int> m_timeOrder;       ///< Indizes in m_content, sortiert nach (StartMs, EndMs).
+    mutable QList<qint64> m_maxEnd;       ///< Größtes EndMs bis zur jeweiligen Position in m_timeOrder.
+    mutable bool m_timeIndexValid = true; ///< m_timeOrder und m_maxEnd passen zu m_content.
+
+    QHash<quint64, int> m_idIndex; ///< Segment-ID → Index in m_content.
+
     // Zähler für den internen Zustand
     int m_unknownCounter{0};     ///< Zähler für die Benennung anonymer Sprecher.
     int m_batchUpdateCounter{0}; ///< Zähler für verschachtelte Batch-Updates.
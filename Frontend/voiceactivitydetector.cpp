@@ -0,0 +1,227 @@
+#include "voiceactivitydetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr int FrameMs = 20;              //  Länge eines Analyse-Frames.
+constexpr int HangoverMs = 300;          //  Pausen bis zu dieser Länge beenden einen Bereich nicht.
+constexpr int MinSpeechMs = 150;         //  Kürzere Bereiche (Klicks, Husten) werden verworfen.
+constexpr int PaddingMs = 200;           //  Vor- und Nachlauf um jeden Bereich.
+constexpr int MergeGapMs = 600;          //  Bereiche mit kleinerem Abstand werden zusammengefasst.
+constexpr double AbsoluteFloorDb = -55.0; //  Leiser als das ist nie Sprache.
+constexpr double NoiseRiseDb = 0.01;     //  Anstieg des Rauschpegels pro Frame (0,5 dB/s).
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+SpeechTimeline::SpeechTimeline (
+    const QList<SpeechRegion> &regions, int sampleRate, qint64 totalSamples, qint64 gapSamples)
+    : m_regions (regions)
+    , m_sampleRate (sampleRate > 0 ? sampleRate : 16000)
+    , m_total (totalSamples)
+    , m_gap (gapSamples)
+{
+    //  Position jedes Bereichs in der verkürzten Datei vorab berechnen.
+    qint64 position = 0;
+    m_compactStarts.reserve (m_regions.size ());
+    for (const SpeechRegion &region : m_regions)
+    {
+        m_compactStarts.append (position);
+        position += region.length () + m_gap;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double SpeechTimeline::totalSeconds () const
+{
+    return double (m_total) / m_sampleRate;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double SpeechTimeline::speechSeconds () const
+{
+    qint64 speech = 0;
+    for (const SpeechRegion &region : m_regions)
+    {
+        speech += region.length ();
+    }
+    return double (speech) / m_sampleRate;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double SpeechTimeline::speechRatio () const
+{
+    if (m_total <= 0)
+    {
+        return isEmpty () ? 1.0 : 0.0;
+    }
+    return std::min (1.0, speechSeconds () / totalSeconds ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double SpeechTimeline::toOriginalSeconds (
+    double compactSeconds) const
+{
+    if (isEmpty ())
+    {
+        return compactSeconds;
+    }
+
+    //  Den letzten Bereich suchen, der in der verkürzten Datei vor dem Zeitpunkt beginnt.
+    const qint64 compact = qMax<qint64> (0, qint64 (std::llround (compactSeconds * m_sampleRate)));
+    const auto it = std::upper_bound (m_compactStarts.cbegin (), m_compactStarts.cend (), compact);
+    const qsizetype index = qMax<qsizetype> (0, qsizetype (it - m_compactStarts.cbegin ()) - 1);
+
+    const SpeechRegion &region = m_regions[index];
+    const qint64 offset = compact - m_compactStarts[index];
+    if (offset >= region.length ())
+    {
+        //  Der Zeitpunkt liegt in der Pause nach dem Bereich.
+        return double (region.end) / m_sampleRate;
+    }
+    return double (region.start + offset) / m_sampleRate;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+VoiceActivityDetector::VoiceActivityDetector (
+    int sampleRate)
+    : m_sampleRate (sampleRate)
+    , m_frameLength (sampleRate * FrameMs / 1000)
+    , m_thresholdDb (10.0)
+{
+    reset ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void VoiceActivityDetector::reset ()
+{
+    m_frameEnergy = 0.0;
+    m_frameFill = 0;
+    m_frameIndex = 0;
+    m_samples = 0;
+    m_noiseFloorDb = AbsoluteFloorDb;
+    m_haveNoiseFloor = false;
+    m_inSpeech = false;
+    m_regionStart = 0;
+    m_lastSpeech = 0;
+    m_regions.clear ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void VoiceActivityDetector::process (
+    const float *samples, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const double v = samples[i];
+        m_frameEnergy += v * v;
+        if (++m_frameFill == m_frameLength)
+        {
+            processFrame (m_frameEnergy / m_frameLength);
+            m_frameEnergy = 0.0;
+            m_frameFill = 0;
+        }
+    }
+    m_samples += count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void VoiceActivityDetector::finish ()
+{
+    if (m_inSpeech)
+    {
+        closeRegion ();
+        m_inSpeech = false;
+    }
+
+    //  Der Nachlauf des letzten Bereichs darf nicht über das Ende der Aufnahme hinausgehen.
+    if (!m_regions.isEmpty ())
+    {
+        m_regions.last ().end = qMin (m_regions.last ().end, m_samples);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void VoiceActivityDetector::processFrame (
+    double energy)
+{
+    const double db = 10.0 * std::log10 (energy + 1e-12);
+
+    //  Der Rauschpegel folgt Minima schnell und steigt nur langsam an. Da auch bei
+    //  durchgehender Sprache immer wieder leise Frames auftreten, bleibt er dadurch
+    //  am Hintergrundrauschen statt am Sprachpegel.
+    if (!m_haveNoiseFloor)
+    {
+        m_noiseFloorDb = db;
+        m_haveNoiseFloor = true;
+    }
+    else if (db < m_noiseFloorDb)
+    {
+        m_noiseFloorDb += 0.5 * (db - m_noiseFloorDb);
+    }
+    else
+    {
+        m_noiseFloorDb += NoiseRiseDb;
+    }
+
+    const bool speech = db > m_noiseFloorDb + m_thresholdDb && db > AbsoluteFloorDb;
+    const qint64 hangoverFrames = HangoverMs / FrameMs;
+
+    if (speech)
+    {
+        if (!m_inSpeech)
+        {
+            m_inSpeech = true;
+            m_regionStart = m_frameIndex;
+        }
+        m_lastSpeech = m_frameIndex;
+    }
+    else if (m_inSpeech && m_frameIndex - m_lastSpeech > hangoverFrames)
+    {
+        closeRegion ();
+        m_inSpeech = false;
+    }
+
+    ++m_frameIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void VoiceActivityDetector::closeRegion ()
+{
+    const qint64 frames = m_lastSpeech - m_regionStart + 1;
+    if (frames < MinSpeechMs / FrameMs)
+    {
+        return;
+    }
+
+    const qint64 padding = qint64 (m_sampleRate) * PaddingMs / 1000;
+    SpeechRegion region;
+    region.start = qMax<qint64> (0, m_regionStart * m_frameLength - padding);
+    region.end = (m_lastSpeech + 1) * m_frameLength + padding;
+
+    //  Nahe beieinanderliegende Bereiche werden zu einem zusammengefasst.
+    const qint64 mergeGap = qint64 (m_sampleRate) * MergeGapMs / 1000;
+    if (!m_regions.isEmpty () && region.start <= m_regions.last ().end + mergeGap)
+    {
+        m_regions.last ().end = qMax (m_regions.last ().end, region.end);
+    }
+    else
+    {
+        m_regions.append (region);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,164 @@
+/**
+ * @file voiceactivitydetector.h
+ * @brief Enthält die Deklaration des VoiceActivityDetector und der SpeechTimeline.
+ * @author Mike Wild
+ */
+#ifndef VOICEACTIVITYDETECTOR_H
+#define VOICEACTIVITYDETECTOR_H
+
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @brief Ein zusammenhängender Bereich mit Sprache, angegeben in Samples der Original-Aufnahme.
+ */
+struct SpeechRegion
+{
+    qint64 start = 0; ///< Erstes Sample des Bereichs.
+    qint64 end = 0;   ///< Erstes Sample nach dem Bereich.
+
+    qint64 length () const { return end - start; }
+};
+
+/**
+ * @brief Beschreibt, wie eine auf die Sprachbereiche verkürzte Datei auf die Original-Zeitachse abgebildet wird.
+ *
+ * In der verkürzten Datei folgen die Sprachbereiche direkt aufeinander, jeweils getrennt
+ * durch eine kurze Pause fester Länge. toOriginalSeconds() rechnet einen Zeitstempel
+ * der verkürzten Datei (z.B. aus dem ASR-Skript) auf die Original-Aufnahme zurück.
+ * Eine leere Timeline steht für "keine Verkürzung" und bildet jede Zeit auf sich selbst ab.
+ */
+class SpeechTimeline
+{
+public:
+    SpeechTimeline () = default;
+
+    /**
+     * @brief Erstellt eine Timeline.
+     * @param regions Die Sprachbereiche (aufsteigend, nicht überlappend).
+     * @param sampleRate Die Abtastrate, auf die sich die Sample-Angaben beziehen.
+     * @param totalSamples Die Länge der Original-Aufnahme in Samples.
+     * @param gapSamples Die Länge der Pause zwischen zwei Bereichen in der verkürzten Datei.
+     */
+    SpeechTimeline (const QList<SpeechRegion> &regions,
+                    int sampleRate,
+                    qint64 totalSamples,
+                    qint64 gapSamples);
+
+    /** @brief Gibt an, ob die Timeline leer ist (keine Verkürzung). */
+    bool isEmpty () const { return m_regions.isEmpty (); }
+
+    /** @brief Gibt die Sprachbereiche zurück. */
+    const QList<SpeechRegion> &regions () const { return m_regions; }
+
+    /** @brief Gibt die Länge der Pause zwischen zwei Bereichen in Samples zurück. */
+    qint64 gapSamples () const { return m_gap; }
+
+    /** @brief Gibt die Länge der Original-Aufnahme in Sekunden zurück. */
+    double totalSeconds () const;
+
+    /** @brief Gibt die Gesamtlänge aller Sprachbereiche in Sekunden zurück. */
+    double speechSeconds () const;
+
+    /** @brief Gibt den Anteil der Sprache an der Aufnahme zurück (0.0 bis 1.0). */
+    double speechRatio () const;
+
+    /**
+     * @brief Rechnet einen Zeitstempel der verkürzten Datei auf die Original-Aufnahme um.
+     *
+     * Zeiten innerhalb einer Pause werden auf das Ende des vorherigen Bereichs abgebildet.
+     * @param compactSeconds Zeit in Sekunden bezogen auf die verkürzte Datei.
+     * @return Zeit in Sekunden bezogen auf die Original-Aufnahme.
+     */
+    double toOriginalSeconds (double compactSeconds) const;
+
+private:
+    QList<SpeechRegion> m_regions; ///< Die Sprachbereiche in Original-Samples.
+    QList<qint64> m_compactStarts; ///< Startposition jedes Bereichs in der verkürzten Datei.
+    int m_sampleRate = 16000;      ///< Abtastrate der Sample-Angaben.
+    qint64 m_total = 0;            ///< Länge der Original-Aufnahme in Samples.
+    qint64 m_gap = 0;              ///< Pause zwischen zwei Bereichen in Samples.
+};
+
+/**
+ * @brief Erkennt Sprachbereiche in einem Mono-Datenstrom anhand der Energie.
+ *
+ * Das Signal wird in 20-ms-Frames zerlegt. Ein Frame gilt als Sprache, wenn seine Energie
+ * deutlich über dem adaptiv nachgeführten Rauschpegel und über einer absoluten
+ * Mindestschwelle liegt. Kurze Pausen innerhalb eines Satzes werden über eine
+ * Nachlaufzeit überbrückt, jeder Bereich erhält einen kleinen Vor- und Nachlauf, und
+ * nahe beieinanderliegende Bereiche werden zusammengefasst, damit keine Wortanfänge
+ * oder -enden abgeschnitten werden.
+ *
+ * Die Klasse arbeitet streamend und kann direkt im Schreibpfad mit beliebig großen
+ * Stücken gefüttert werden; nach dem letzten Stück muss finish() aufgerufen werden.
+ */
+class VoiceActivityDetector
+{
+public:
+    /**
+     * @brief Erstellt einen Detektor.
+     * @param sampleRate Die Abtastrate des Datenstroms in Hz.
+     */
+    explicit VoiceActivityDetector (int sampleRate = 16000);
+
+    /**
+     * @brief Setzt den Detektor für eine neue Aufnahme zurück.
+     */
+    void reset ();
+
+    /**
+     * @brief Verarbeitet ein Stück des Datenstroms.
+     * @param samples Mono-Samples im Bereich [-1.0, 1.0].
+     * @param count Anzahl der Samples.
+     */
+    void process (const float *samples, int count);
+
+    /**
+     * @brief Schließt einen noch offenen Sprachbereich am Ende des Datenstroms ab.
+     */
+    void finish ();
+
+    /** @brief Gibt die bisher erkannten Sprachbereiche zurück. */
+    const QList<SpeechRegion> &regions () const { return m_regions; }
+
+    /** @brief Gibt an, ob gerade ein Sprachbereich offen ist (inkl. Nachlauf). */
+    bool inSpeech () const { return m_inSpeech; }
+
+    /** @brief Gibt die Anzahl der bisher verarbeiteten Samples zurück. */
+    qint64 samplesProcessed () const { return m_samples; }
+
+    /** @brief Gibt die Abtastrate zurück. */
+    int sampleRate () const { return m_sampleRate; }
+
+    /**
+     * @brief Setzt den Abstand zum Rauschpegel, ab dem ein Frame als Sprache gilt.
+     * @param db Abstand in dB (Standard: 10 dB).
+     */
+    void setThresholdDb (double db) { m_thresholdDb = db; }
+
+private:
+    /** @brief Wertet einen vollständigen Frame aus. */
+    void processFrame (double energy);
+
+    /** @brief Schließt den aktuellen Sprachbereich ab und fügt ihn (ggf. zusammengefasst) hinzu. */
+    void closeRegion ();
+
+    const int m_sampleRate;  ///< Abtastrate in Hz.
+    const int m_frameLength; ///< Samples pro Frame (20 ms).
+    double m_thresholdDb;    ///< Abstand zum Rauschpegel in dB.
+
+    double m_frameEnergy;   ///< Summe der Quadrate des aktuellen Frames.
+    int m_frameFill;        ///< Anzahl der Samples im aktuellen Frame.
+    qint64 m_frameIndex;    ///< Index des aktuellen Frames.
+    qint64 m_samples;       ///< Anzahl der verarbeiteten Samples.
+    double m_noiseFloorDb;  ///< Adaptiv nachgeführter Rauschpegel in dBFS.
+    bool m_haveNoiseFloor;  ///< Gibt an, ob der Rauschpegel bereits initialisiert wurde.
+
+    bool m_inSpeech;         ///< Gibt an, ob gerade ein Sprachbereich offen ist.
+    qint64 m_regionStart;    ///< Erster Sprach-Frame des offenen Bereichs.
+    qint64 m_lastSpeech;     ///< Letzter Sprach-Frame des offenen Bereichs.
+    QList<SpeechRegion> m_regions; ///< Die erkannten Bereiche in Samples.
+};
+
+#endif // VOICEACTIVITYDETECTOR_H
@@ -0,0 +1,222 @@
+#include "wavfilereader.h"
+
+#include <QtEndian>
+#include <cstring>
+
+namespace
+{
+constexpr quint16 FormatPcm = 1;           //  WAVE_FORMAT_PCM
+constexpr quint16 FormatFloat = 3;         //  WAVE_FORMAT_IEEE_FLOAT
+constexpr quint16 FormatExtensible = 0xFFFE; //  WAVE_FORMAT_EXTENSIBLE
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+bool WavFileReader::open (
+    const QString &path)
+{
+    close ();
+    m_file.setFileName (path);
+    if (!m_file.open (QIODevice::ReadOnly))
+    {
+        m_error = QString ("Datei kann nicht geöffnet werden: %1").arg (path);
+        return false;
+    }
+
+    //  --- RIFF-Header prüfen (RF64 für Dateien über 4 GB) ---
+    char riff[12];
+    if (m_file.read (riff, 12) != 12
+        || (std::memcmp (riff, "RIFF", 4) != 0 && std::memcmp (riff, "RF64", 4) != 0)
+        || std::memcmp (riff + 8, "WAVE", 4) != 0)
+    {
+        m_error = "Keine gültige RIFF/WAVE-Datei.";
+        close ();
+        return false;
+    }
+
+    //  --- Chunks durchlaufen, bis "fmt " und "data" gefunden sind ---
+    bool haveFormat = false;
+    quint16 format = 0;
+    int bitsPerSample = 0;
+    qint64 ds64DataBytes = -1; //  64-bit-Größe des data-Chunks aus dem ds64-Chunk (RF64).
+    for (;;)
+    {
+        char header[8];
+        if (m_file.read (header, 8) != 8)
+        {
+            m_error = "Kein data-Chunk gefunden.";
+            close ();
+            return false;
+        }
+        const quint32 size = qFromLittleEndian<quint32> (header + 4);
+
+        if (std::memcmp (header, "fmt ", 4) == 0)
+        {
+            const QByteArray fmt = m_file.read (size);
+            if (fmt.size () < 16)
+            {
+                m_error = "fmt-Chunk ist zu kurz.";
+                close ();
+                return false;
+            }
+            format = qFromLittleEndian<quint16> (fmt.constData ());
+            m_channels = qFromLittleEndian<quint16> (fmt.constData () + 2);
+            m_sampleRate = int (qFromLittleEndian<quint32> (fmt.constData () + 4));
+            bitsPerSample = qFromLittleEndian<quint16> (fmt.constData () + 14);
+
+            //  Bei WAVE_FORMAT_EXTENSIBLE steckt das eigentliche Format im Sub-Format-GUID.
+            if (format == FormatExtensible && fmt.size () >= 26)
+            {
+                format = qFromLittleEndian<quint16> (fmt.constData () + 24);
+            }
+            haveFormat = true;
+        }
+        else if (std::memcmp (header, "ds64", 4) == 0)
+        {
+            const QByteArray ds64 = m_file.read (size);
+            if (ds64.size () >= 16)
+            {
+                ds64DataBytes = qint64 (qFromLittleEndian<quint64> (ds64.constData () + 8));
+            }
+        }
+        else if (std::memcmp (header, "data", 4) == 0)
+        {
+            if (!haveFormat)
+            {
+                m_error = "data-Chunk vor fmt-Chunk.";
+                close ();
+                return false;
+            }
+
+            //  Bei noch nicht finalisierten Dateien (Größe 0) wird bis zum Dateiende gelesen.
+            qint64 dataBytes = (size == 0xFFFFFFFFu && ds64DataBytes >= 0) ? ds64DataBytes : size;
+            const qint64 remaining = m_file.size () - m_file.pos ();
+            if (dataBytes == 0 || dataBytes > remaining)
+            {
+                dataBytes = remaining;
+            }
+
+            m_bytesPerSample = bitsPerSample / 8;
+            if (m_channels <= 0 || m_sampleRate <= 0 || m_bytesPerSample <= 0)
+            {
+                m_error = "Ungültiges Audio-Format.";
+                close ();
+                return false;
+            }
+            m_totalFrames = dataBytes / (qint64 (m_bytesPerSample) * m_channels);
+            break;
+        }
+        else
+        {
+            //  Unbekannte Chunks (LIST, JUNK, ...) werden übersprungen; Chunks sind 2-Byte-ausgerichtet.
+            m_file.seek (m_file.pos () + size + (size & 1));
+        }
+    }
+
+    if (format == FormatFloat && bitsPerSample == 32)
+    {
+        m_encoding = Encoding::Float32;
+    }
+    else if (format == FormatPcm && bitsPerSample == 16)
+    {
+        m_encoding = Encoding::Int16;
+    }
+    else if (format == FormatPcm && bitsPerSample == 24)
+    {
+        m_encoding = Encoding::Int24;
+    }
+    else if (format == FormatPcm && bitsPerSample == 32)
+    {
+        m_encoding = Encoding::Int32;
+    }
+    else
+    {
+        m_error = QString ("Nicht unterstütztes Format %1 mit %2 Bit.").arg (format).arg (bitsPerSample);
+        close ();
+        return false;
+    }
+
+    m_framesRead = 0;
+    m_error.clear ();
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void WavFileReader::close ()
+{
+    if (m_file.isOpen ())
+    {
+        m_file.close ();
+    }
+    m_totalFrames = 0;
+    m_framesRead = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int WavFileReader::readFrames (
+    float *out, int maxFrames)
+{
+    if (!isOpen () || maxFrames <= 0)
+    {
+        return 0;
+    }
+
+    const qint64 frames = qMin<qint64> (maxFrames, m_totalFrames - m_framesRead);
+    if (frames <= 0)
+    {
+        return 0;
+    }
+
+    const qint64 frameBytes = qint64 (m_bytesPerSample) * m_channels;
+    m_raw.resize (size_t (frames * frameBytes));
+    const qint64 got = m_file.read (m_raw.data (), frames * frameBytes);
+    if (got <= 0)
+    {
+        m_error = m_file.errorString ();
+        return 0;
+    }
+
+    const int framesGot = int (got / frameBytes);
+    const qint64 count = qint64 (framesGot) * m_channels;
+    const char *src = m_raw.data ();
+
+    //  Umwandlung in float im Bereich [-1.0, 1.0].
+    switch (m_encoding)
+    {
+    case Encoding::Float32:
+        std::memcpy (out, src, size_t (count) * sizeof (float));
+        break;
+    case Encoding::Int16:
+        for (qint64 i = 0; i < count; ++i)
+        {
+            out[i] = qFromLittleEndian<qint16> (src + 2 * i) / 32768.0f;
+        }
+        break;
+    case Encoding::Int24:
+        for (qint64 i = 0; i < count; ++i)
+        {
+            const unsigned char *p = reinterpret_cast<const unsigned char *> (src + 3 * i);
+            qint32 v = qint32 (p[0]) | (qint32 (p[1]) << 8) | (qint32 (p[2]) << 16);
+            if (v & 0x800000)
+            {
+                v |= ~0xFFFFFF; //  Vorzeichenerweiterung auf 32 Bit.
+            }
+            out[i] = v / 8388608.0f;
+        }
+        break;
+    case Encoding::Int32:
+        for (qint64 i = 0; i < count; ++i)
+        {
+            out[i] = float (qFromLittleEndian<qint32> (src + 4 * i) / 2147483648.0);
+        }
+        break;
+    }
+
+    m_framesRead += framesGot;
+    return framesGot;
+}
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
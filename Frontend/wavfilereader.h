@@ -0,0 +1,90 @@
+/**
+ * @file wavfilereader.h
+ * @brief Enthält die Deklaration des WavFileReader zum blockweisen Lesen von WAV-Dateien.
+ * @author Mike Wild
+ */
+#ifndef WAVFILEREADER_H
+#define WAVFILEREADER_H
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief Liest PCM- und Float-WAV-Dateien blockweise als interleavte float-Samples.
+ *
+ * Unterstützt werden 16/24/32-bit Integer-PCM sowie 32-bit IEEE Float (auch im
+ * WAVE_FORMAT_EXTENSIBLE-Container), auch in RF64-Dateien über 4 GB. Die Datei wird nicht komplett in den Speicher
+ * geladen, sodass auch lange Aufnahmen mit konstantem Speicherbedarf gelesen werden.
+ */
+class WavFileReader
+{
+public:
+    /**
+     * @brief Standard-Konstruktor.
+     */
+    WavFileReader () = default;
+
+    /**
+     * @brief Öffnet eine WAV-Datei und liest deren Header.
+     * @param path Der Pfad zur Datei.
+     * @return true, wenn die Datei gültig ist und gelesen werden kann.
+     */
+    bool open (const QString &path);
+
+    /**
+     * @brief Schließt die Datei.
+     */
+    void close ();
+
+    /**
+     * @brief Liest bis zu @p maxFrames Frames ab der aktuellen Position.
+     * @param out Ziel-Array mit Platz für maxFrames * channels() float-Werte.
+     * @param maxFrames Die maximale Anzahl an Frames.
+     * @return Die Anzahl der gelesenen Frames (0 am Dateiende oder bei einem Fehler).
+     */
+    int readFrames (float *out, int maxFrames);
+
+    /** @brief Gibt an, ob eine Datei geöffnet ist. */
+    bool isOpen () const { return m_file.isOpen (); }
+
+    /** @brief Abtastrate der Datei in Hz. */
+    int sampleRate () const { return m_sampleRate; }
+
+    /** @brief Anzahl der Kanäle der Datei. */
+    int channels () const { return m_channels; }
+
+    /** @brief Gesamtzahl der Frames in der Datei. */
+    qint64 frames () const { return m_totalFrames; }
+
+    /** @brief Anzahl der bereits gelesenen Frames. */
+    qint64 position () const { return m_framesRead; }
+
+    /** @brief Gibt an, ob alle Frames gelesen wurden. */
+    bool atEnd () const { return m_framesRead >= m_totalFrames; }
+
+    /** @brief Beschreibung des letzten Fehlers. */
+    QString errorString () const { return m_error; }
+
+private:
+    /** @brief Die unterstützten Sample-Formate. */
+    enum class Encoding
+    {
+        Int16,
+        Int24,
+        Int32,
+        Float32
+    };
+
+    QFile m_file;               ///< Das Dateihandle.
+    QString m_error;            ///< Beschreibung des letzten Fehlers.
+    Encoding m_encoding = Encoding::Int16; ///< Das Sample-Format der Daten.
+    int m_sampleRate = 0;       ///< Abtastrate in Hz.
+    int m_channels = 0;         ///< Anzahl der Kanäle.
+    int m_bytesPerSample = 0;   ///< Bytes pro Sample (2, 3 oder 4).
+    qint64 m_totalFrames = 0;   ///< Anzahl der Frames im data-Chunk.
+    qint64 m_framesRead = 0;    ///< Anzahl der bereits gelesenen Frames.
+    std::vector<char> m_raw;    ///< Wiederverwendeter Puffer für die Rohdaten.
+};
+
+#endif // WAVFILEREADER_H
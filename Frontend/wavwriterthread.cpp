@@ -1,27 +1,53 @@
 #include "wavwriterthread.h"
+#include "audiobus.h"
+#include "processgovernor.h"
 
 #include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QSettings>
+#include <cstring>
+#include <utility>
 
 //--------------------------------------------------------------------------------------------------
 
 WavWriterThread::WavWriterThread (
     QObject *parent)
     : QThread (parent)
+    , m_reader (nullptr)
     , m_hqBytesWritten (0)
     , m_asrBytesWritten (0)
     , m_flushThresholdBytes (384 * 1024)
-    , m_downsampleOffset (0)
+    , m_headerIntervalMs (10000)
     , m_sampleRateHQ (48000)
     , m_channelsHQ (2)
     , m_bitsPerSampleHQ (32)
     , m_sampleRateASR (16000)
+    , m_asrResampler (m_sampleRateHQ, m_sampleRateASR, 1)
+    , m_vad (m_sampleRateASR)
+    , m_vadEnabled (true)
+    , m_streamAsr (false)
+    , m_segmentSamples (0)
+    , m_segmentWritten (0)
+    , m_segmentStart (0)
+    , m_segmentIndex (0)
 {
     m_active.store (false);
     m_shutdown.store (false);
 
-    QSettings settings;
-    m_flushThresholdBytes = settings.value ("audio/bufferThreshold", 384 * 1024).toInt ();
+    //  Der Einstellungsdialog speichert die Schwelle in KB.
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    m_flushThresholdBytes = qint64 (settings.value ("audio/bufferThreshold", 384).toInt ()) * 1024;
+
+    //  Die Puffer werden einmalig auf die Flush-Schwelle reserviert, damit während der
+    //  Aufnahme keine Allokationen mehr stattfinden.
+    m_pending.reserve (size_t (m_flushThresholdBytes / sizeof (float)) + 8192);
+    const size_t maxFrames = m_pending.capacity () / 2;
+    m_asrMono.reserve (maxFrames);
+    m_asrResampled.reserve (size_t (m_asrResampler.maxOutputFrames (int (maxFrames))));
+    m_asrBuffer.reserve (m_asrResampled.capacity ());
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -34,29 +60,74 @@ WavWriterThread::~WavWriterThread ()
 //--------------------------------------------------------------------------------------------------
 
 void WavWriterThread::startWriting (
-    const QString &hqPath, const QString &asrPath)
+    const QString &hqPath, const QString &asrPath, bool streamAsr, int segmentMinutes)
 {
     QMutexLocker locker (&m_mutex);
 
-    m_bufferFloat.clear ();
+    m_pending.clear ();
     m_hqBytesWritten = 0;
     m_asrBytesWritten = 0;
-    m_downsampleOffset = 0;
+    m_asrResampler.reset ();
+    m_vad.reset ();
+    m_vadEnabled = QSettings ("SS2025FP_T2", "AudioTranskriptor").value ("asr/vad", true).toBool ();
+    m_streamAsr = streamAsr;
+    m_segmentSamples = qint64 (qMax (0, segmentMinutes)) * 60 * m_sampleRateASR;
+    m_segmentWritten = 0;
+    m_segmentStart = 0;
+    m_segmentIndex = 0;
+
+    //  Teildateien einer früheren Aufnahme werden entfernt, damit keine veralteten
+    //  Dateien neben der neuen Aufnahme liegen bleiben.
+    const QFileInfo asrInfo (asrPath);
+    const QString segmentPattern = asrInfo.completeBaseName () + "_seg*.wav";
+    for (const QString &old : asrInfo.dir ().entryList ({segmentPattern}, QDir::Files))
+    {
+        QFile::remove (asrInfo.dir ().filePath (old));
+    }
 
-    m_hqFile.setFileName (hqPath);
-    m_asrFile.setFileName (asrPath);
+    //  Die HQ-Aufnahme wird wahlweise verlustfrei als FLAC gespeichert (etwa die Hälfte
+    //  der float-WAV). Die Datei im jeweils anderen Format stammt von einer früheren
+    //  Aufnahme und wird entfernt.
+    QSettings settings ("SS2025FP_T2", "AudioTranskriptor");
+    const bool hqFlac = settings.value ("audio/hqFlac", false).toBool ();
+    const QFileInfo hqInfo (hqPath);
+    const QString flacPath = hqInfo.dir ().filePath (hqInfo.completeBaseName () + ".flac");
+    m_hqPath = hqFlac ? flacPath : hqPath;
+    if (hqPath != flacPath)
+    {
+        QFile::remove (hqFlac ? hqPath : flacPath);
+    }
 
-    if (!m_hqFile.open (QIODevice::WriteOnly) || !m_asrFile.open (QIODevice::WriteOnly))
+    //  Jeder Schreiber erhält zwei Puffer in Größe eines Flushs; so passt ein kompletter
+    //  Flush in einen Puffer, während der vorherige noch geschrieben wird.
+    const qint64 hqBuffer = qint64 (m_pending.capacity () * sizeof (float));
+    const qint64 asrBuffer = qint64 (m_asrBuffer.capacity () * sizeof (int16_t));
+    const bool hqOpened = hqFlac ? m_hqFlac.open (flacPath,
+                                                  m_sampleRateHQ,
+                                                  m_channelsHQ,
+                                                  settings.value ("audio/flacLevel", 5).toInt (),
+                                                  qint64 (m_pending.capacity ()))
+                                 : m_hqWriter.open (hqPath, hqBuffer);
+    if (!hqOpened || !m_asrWriter.open (asrPath, asrBuffer, AsrReserve))
     {
         qWarning () << "WavWriterThread: Konnte Ausgabedateien nicht öffnen.";
+        m_hqWriter.close ();
+        m_hqFlac.close ();
         return;
     }
 
-    //  Schreibt einen 44-Byte Platzhalter an den Anfang der Dateien. Dies reserviert den Platz
-    //  für den WAV-Header, der erst am Ende geschrieben werden kann, wenn die
-    //  Gesamtgröße der Audiodaten bekannt ist.
-    m_hqFile.write (QByteArray (44, '\0'));
-    m_asrFile.write (QByteArray (44, '\0'));
+    //  Die Header werden sofort mit der Größe 0 geschrieben, damit die Dateien auch nach
+    //  einem frühen Absturz lesbar sind. Die endgültigen Größen werden regelmäßig
+    //  (updateHeaders()) und am Ende (writeHeaders()) eingetragen.
+    if (m_hqWriter.isOpen ())
+    {
+        const QByteArray hq = hqHeader (0);
+        m_hqWriter.append (hq.constData (), hq.size ());
+    }
+    const QByteArray asr = asrHeader (0);
+    m_asrWriter.append (asr.constData (), asr.size ());
+    m_headerIntervalMs = settings.value ("audio/headerUpdateSec", 10).toInt () * 1000;
+    m_headerTimer.start ();
 
     m_active.store (true);
     m_mainLoopCond.wakeAll ();
@@ -64,15 +135,32 @@ void WavWriterThread::startWriting (
 
 //--------------------------------------------------------------------------------------------------
 
+void WavWriterThread::setAudioSource (
+    AudioBus *bus)
+{
+    QMutexLocker locker (&m_mutex);
+    if (m_reader || !bus)
+    {
+        return;
+    }
+
+    m_reader = bus->subscribe ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void WavWriterThread::shutdown ()
 {
     QMutexLocker locker (&m_mutex);
     m_shutdown.store (true);
     m_active.store (false);
     m_mainLoopCond.wakeAll ();
-    m_dataAvailableCond.wakeAll ();
     locker.unlock ();
 
+    //  Der Leser wird hier bewusst nicht geweckt: Beim Beenden der Anwendung kann der Bus
+    //  (und damit der Leser) bereits zerstört sein. Die Schreibschleife prüft m_active
+    //  ohnehin spätestens nach dem Timeout von waitPop().
+
     //  Wartet, bis die run()-Methode vollständig beendet ist. Dies ist entscheidend,
     //  um Race Conditions zu vermeiden. Ohne wait() könnte das WavWriterThread-Objekt
     //  im Hauptthread zerstört werden, während die run()-Methode noch auf Ressourcen zugreift,
@@ -86,26 +174,38 @@ void WavWriterThread::stopWriting ()
 {
     QMutexLocker locker (&m_mutex);
     m_active.store (false);
-    m_dataAvailableCond.wakeAll ();
+    if (m_reader)
+    {
+        m_reader->wakeUp (); //  Weckt den Consumer (die run() Methode) sofort auf.
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 
-void WavWriterThread::writeChunk (
-    QList<float> chunk)
+void WavWriterThread::appendBlock (
+    const AudioBlock *block)
 {
-    //  Dieser Slot wird vom Capture-Thread aufgerufen (Producer) und ist thread-sicher.
-    QMutexLocker locker (&m_mutex);
-    m_bufferFloat.append (chunk);
-    m_dataAvailableCond.wakeOne (); //  Weckt den Consumer (die run() Methode) auf.
+    //  Die Samples werden einmal in den vorab reservierten Schreibpuffer kopiert;
+    //  danach steht der Block sofort wieder dem Producer zur Verfügung.
+    const size_t offset = m_pending.size ();
+    const size_t count = size_t (block->samples ());
+    m_pending.resize (offset + count);
+    std::memcpy (m_pending.data () + offset, block->data, count * sizeof (float));
+    m_reader->release (block);
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void WavWriterThread::run ()
 {
+    //  Etwas unter dem Aufnahme-Thread: Der Schreib-Thread muss nur mit der Warteschlange des
+    //  AudioBus Schritt halten. Der Schreibpuffer ist vorab reserviert und bleibt gesperrt.
+    const bool realtime = QSettings ("SS2025FP_T2", "AudioTranskriptor").value ("audio/realtime", true).toBool ();
+    const bool locked
+        = realtime && ProcessGovernor::lockMemory (m_pending.data (), m_pending.capacity () * sizeof (float));
+
     //  Die Hauptschleife implementiert ein Producer-Consumer-Muster.
-    //  writeChunk() ist der Producer, diese run()-Schleife ist der Consumer.
+    //  Der CaptureThread ist über den AudioBus der Producer, diese run()-Schleife der Consumer.
     while (!m_shutdown.load ())
     {
         //  --- Phase 1: Warten auf den Startbefehl ---
@@ -122,110 +222,407 @@ void WavWriterThread::run ()
             break;
         }
 
-        QList<float> bufferToWrite;
+        if (!m_reader)
+        {
+            qWarning () << "WavWriterThread: Keine Audioquelle gesetzt (setAudioSource).";
+            m_active.store (false);
+            continue;
+        }
 
         //  --- Phase 2: Aktive Schreib-Schleife ---
+        //  Das Lesen vom Bus ist lock-frei; der Mutex wird hier nicht benötigt.
+        if (realtime && !ProcessGovernor::elevateCurrentThread (RealtimePriority))
+        {
+            qWarning () << "WavWriterThread: Keine erhöhte Priorität erlaubt (RLIMIT_RTPRIO, RealtimeKit).";
+        }
         while (m_active.load ())
         {
-            QList<float> receivedChunk;
+            const AudioBlock *block = m_reader->waitPop (50);
+            if (block)
             {
-                QMutexLocker locker (&m_mutex);
-                if (m_bufferFloat.isEmpty () && m_active.load ())
-                {
-                    m_dataAvailableCond.wait (&m_mutex);
-                }
-                receivedChunk.swap (m_bufferFloat);
+                appendBlock (block);
             }
 
-            if (!receivedChunk.isEmpty ())
+            if (qint64 (m_pending.size () * sizeof (float)) >= m_flushThresholdBytes)
             {
-                bufferToWrite.append (receivedChunk);
-            }
+                writeCurrentBufferToDisk (m_pending.data (), qsizetype (m_pending.size ()));
+                m_pending.clear ();
 
-            if (bufferToWrite.size () * sizeof (float) >= m_flushThresholdBytes)
-            {
-                writeCurrentBufferToDisk (bufferToWrite);
+                //  Der gesammelte Flush geht an die I/O-Threads; geschrieben wird im Hintergrund.
+                m_hqWriter.submit ();
+                m_asrWriter.submit ();
+
+                //  Nur direkt nach einem Flush: zwei kleine Schreibzugriffe am Dateianfang.
+                if (m_headerIntervalMs > 0 && m_headerTimer.elapsed () >= m_headerIntervalMs)
+                {
+                    updateHeaders ();
+                }
             }
         }
 
         //  --- Phase 3: Finalisierung am Ende einer Schreib-Session ---
+        //  Das Erzeugen der Sprachdatei liest die ganze ASR-Datei ohne zu blockieren; mit
+        //  Echtzeit-Priorität würde RLIMIT_RTTIME den Thread beenden.
+        if (realtime)
+        {
+            ProcessGovernor::resetCurrentThread ();
+        }
         {
             QMutexLocker locker (&m_mutex);
-            bufferToWrite.append (m_bufferFloat);
-            m_bufferFloat.clear ();
+            //  Die Warteschlange kann weit mehr Blöcke halten, als der gesperrte Puffer fasst;
+            //  auch hier wird daher an der Schwelle geschrieben, damit er nicht wächst.
+            while (const AudioBlock *block = m_reader->tryPop ())
+            {
+                appendBlock (block);
+                if (qint64 (m_pending.size () * sizeof (float)) >= m_flushThresholdBytes)
+                {
+                    writeCurrentBufferToDisk (m_pending.data (), qsizetype (m_pending.size ()));
+                    m_pending.clear ();
+                    m_hqWriter.submit ();
+                    m_asrWriter.submit ();
+                }
+            }
 
-            if (!bufferToWrite.isEmpty ())
+            if (!m_pending.empty ())
             {
-                writeCurrentBufferToDisk (bufferToWrite);
+                writeCurrentBufferToDisk (m_pending.data (), qsizetype (m_pending.size ()));
+                m_pending.clear ();
             }
 
             writeHeaders (m_hqBytesWritten, m_asrBytesWritten);
+            closeSegment ();
+            finishSpeechDetection ();
+
+            if (m_reader->droppedBlocks () > 0)
+            {
+                qWarning () << "WavWriterThread:" << m_reader->droppedBlocks ()
+                            << "Blöcke verworfen (Warteschlange voll), maximale Tiefe:"
+                            << m_reader->maxQueueDepth ();
+            }
+            m_reader->resetStatistics ();
         }
 
         emit finishedWriting ();
     }
+
+    if (locked)
+    {
+        ProcessGovernor::unlockMemory (m_pending.data (), m_pending.capacity () * sizeof (float));
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void WavWriterThread::writeCurrentBufferToDisk (
-    QList<float> &buffer)
+    const float *samples, qsizetype count)
 {
-    //  HQ-Datei: Die 32-bit float-Daten werden unverändert geschrieben.
-    const char *data = reinterpret_cast<const char *> (buffer.data ());
-    qint64 byteCount = buffer.size () * sizeof (float);
-    m_hqFile.write (data, byteCount);
+    //  HQ-Datei: Die 32-bit float-Daten werden unverändert geschrieben bzw. an den
+    //  FLAC-Encoder übergeben, der sie in seinem eigenen Thread kodiert.
+    const qint64 byteCount = count * qint64 (sizeof (float));
+    if (m_hqFlac.isOpen ())
+    {
+        m_hqFlac.append (samples, count);
+    }
+    else
+    {
+        m_hqWriter.append (samples, byteCount);
+    }
     m_hqBytesWritten += byteCount;
 
     //  ASR-Datei: Konvertierung und Downsampling für die Spracherkennung.
-    int frames = buffer.size () / 2;
-    QByteArray mono;
+    const int frames = int (count / 2);
+
+    //  Downmix von Stereo zu Mono durch Mittelwertbildung.
+    m_asrMono.resize (size_t (frames)); //  Kapazität ist vorab reserviert.
+    for (int i = 0; i < frames; ++i)
+    {
+        m_asrMono[size_t (i)] = 0.5f * (samples[2 * i] + samples[2 * i + 1]);
+    }
+
+    //  Von 48 kHz auf 16 kHz mit Anti-Aliasing-Tiefpass. Der Resampler behält seinen
+    //  Zustand zwischen den Aufrufen, sodass an den Chunk-Grenzen keine Lücken entstehen.
+    m_asrResampled.resize (size_t (m_asrResampler.maxOutputFrames (frames)));
+    const int outFrames = m_asrResampler.process (m_asrMono.data (), frames, m_asrResampled.data ());
 
-    //  Das Downsampling von 48kHz auf 16kHz (Faktor 3) erfordert, dass wir nur jedes dritte Sample nehmen.
-    int available = frames + m_downsampleOffset;
-    int outFrames = available / 3;
-    mono.resize (outFrames * sizeof (int16_t));
-    int16_t *out = reinterpret_cast<int16_t *> (mono.data ());
+    //  Die Sprachaktivität wird auf demselben 16-kHz-Signal bestimmt, das auch die ASR erhält.
+    if (m_vadEnabled)
+    {
+        m_vad.process (m_asrResampled.data (), outFrames);
+    }
 
+    m_asrBuffer.resize (size_t (outFrames));
+    int16_t *out = m_asrBuffer.data ();
     int outIndex = 0;
-    for (int i = m_downsampleOffset; i + 2 < frames; i += 3)
+    for (int i = 0; i < outFrames; ++i)
     {
-        float l = buffer[2 * i];
-        float r = buffer[2 * i + 1];
+        //  Konvertierung von float [-1.0, 1.0] zu 16-bit signed integer [-32767, 32767].
+        const float m = qBound (-1.0f, m_asrResampled[size_t (i)], 1.0f);
+        out[outIndex++] = int16_t (m * 32767.f);
+    }
 
-        //  Downmix von Stereo zu Mono durch Mittelwertbildung.
-        float m = 0.5f * (l + r);
+    const qint64 asrBytes = qint64 (outIndex) * qint64 (sizeof (int16_t));
+    m_asrWriter.append (out, asrBytes);
+    m_asrBytesWritten += asrBytes;
 
-        //  Konvertierung von float [-1.0, 1.0] zu 16-bit signed integer [-32767, 32767].
-        out[outIndex++] = qBound (int16_t (-32768), int16_t (m * 32767.f), int16_t (32767));
+    if (m_segmentSamples > 0)
+    {
+        writeSegment (out, outIndex);
+    }
+
+    //  Für die Live-Transkription gehen dieselben Samples zusätzlich an den ASR-Worker.
+    if (m_streamAsr && asrBytes > 0)
+    {
+        emit asrAudioReady (QByteArray (reinterpret_cast<const char *> (out), asrBytes));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void WavWriterThread::writeSegment (
+    const int16_t *samples, qint64 count)
+{
+    if (!m_segmentWriter.isOpen ())
+    {
+        const QFileInfo info (m_asrWriter.fileName ());
+        const QString name = QString ("%1_seg%2.wav")
+                                 .arg (info.completeBaseName ())
+                                 .arg (m_segmentIndex, 3, 10, QLatin1Char ('0'));
+        const QString path = info.dir ().filePath (name);
+        const qint64 buffer = qint64 (m_asrBuffer.capacity () * sizeof (int16_t));
+        if (!m_segmentWriter.open (path, buffer, AsrReserve))
+        {
+            qWarning () << "WavWriterThread: Teildatei kann nicht erstellt werden:" << path;
+            m_segmentSamples = 0;
+            return;
+        }
+        const QByteArray header = asrHeader (0);
+        m_segmentWriter.append (header.constData (), header.size ());
+        m_segmentWritten = 0;
     }
 
-    //  Der Offset merkt sich, wie viele Samples am Ende des Chunks übrig bleiben,
-    //  um beim nächsten Chunk an der richtigen Position weiterzumachen.
-    m_downsampleOffset = (frames + m_downsampleOffset) % 3;
+    m_segmentWriter.append (samples, count * qint64 (sizeof (int16_t)));
+    m_segmentWriter.submit ();
+    m_segmentWritten += count;
 
-    m_asrFile.write (mono);
-    m_asrBytesWritten += mono.size ();
-    buffer.clear ();
+    //  Geschnitten wird nach Ablauf der Zieldauer in der nächsten Sprechpause, damit kein
+    //  Wort auf zwei Dateien verteilt wird. Ohne Pause (oder ohne VAD) spätestens nach der
+    //  Karenzzeit.
+    const bool quiet = !m_vadEnabled || !m_vad.inSpeech ();
+    if (m_segmentWritten >= m_segmentSamples
+        && (quiet || m_segmentWritten >= m_segmentSamples + qint64 (SegmentGraceSec) * m_sampleRateASR))
+    {
+        closeSegment ();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void WavWriterThread::closeSegment ()
+{
+    if (!m_segmentWriter.isOpen ())
+    {
+        return;
+    }
+
+    //  close() wartet, bis alle Daten und der Header geschrieben sind; erst dann darf die
+    //  Teildatei an die ASR gemeldet werden.
+    m_segmentWriter.writeAt (0, asrHeader (m_segmentWritten * qint64 (sizeof (int16_t))));
+    m_segmentWriter.close ();
+
+    const double offsetSeconds = double (m_segmentStart) / m_sampleRateASR;
+    qDebug () << "WavWriterThread: Teildatei" << m_segmentIndex << "abgeschlossen (ab"
+              << offsetSeconds << "s," << double (m_segmentWritten) / m_sampleRateASR << "s)";
+    emit segmentCompleted (m_segmentWriter.fileName (), offsetSeconds);
+
+    m_segmentStart += m_segmentWritten;
+    m_segmentWritten = 0;
+    ++m_segmentIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void WavWriterThread::finishSpeechDetection ()
+{
+    m_timeline = SpeechTimeline ();
+    m_speechPath.clear ();
+    if (!m_vadEnabled)
+    {
+        return;
+    }
+
+    m_vad.finish ();
+    const SpeechTimeline timeline (m_vad.regions (),
+                                   m_sampleRateASR,
+                                   m_vad.samplesProcessed (),
+                                   qint64 (m_sampleRateASR) * SpeechGapMs / 1000);
+
+    qDebug () << "WavWriterThread: Sprachanteil" << qRound (timeline.speechRatio () * 100.0) << "% ("
+              << timeline.speechSeconds () << "s von" << timeline.totalSeconds () << "s,"
+              << timeline.regions ().size () << "Bereiche)";
+
+    //  Ohne erkannte Sprache oder bei fast durchgehender Sprache lohnt sich keine eigene
+    //  Datei; die ASR arbeitet dann wie bisher auf der vollständigen Aufnahme.
+    if (timeline.isEmpty () || timeline.speechRatio () > MaxSpeechRatio)
+    {
+        return;
+    }
+
+    QFileInfo info (m_asrWriter.fileName ());
+    const QString speechPath = info.dir ().filePath (info.completeBaseName () + "_speech.wav");
+    if (writeSpeechFile (m_asrWriter.fileName (), speechPath, timeline))
+    {
+        m_timeline = timeline;
+        m_speechPath = speechPath;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+SpeechTimeline WavWriterThread::speechTimeline () const
+{
+    QMutexLocker locker (&m_mutex);
+    return m_timeline;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString WavWriterThread::speechWavPath () const
+{
+    QMutexLocker locker (&m_mutex);
+    return m_speechPath;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AsyncFileWriter::Statistics WavWriterThread::hqWriteStatistics () const
+{
+    QMutexLocker locker (&m_mutex);
+    return m_hqStats;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+AsyncFileWriter::Statistics WavWriterThread::asrWriteStatistics () const
+{
+    QMutexLocker locker (&m_mutex);
+    return m_asrStats;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+FlacFileWriter::Statistics WavWriterThread::flacStatistics () const
+{
+    QMutexLocker locker (&m_mutex);
+    return m_flacStats;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QString WavWriterThread::hqFilePath () const
+{
+    QMutexLocker locker (&m_mutex);
+    return m_hqPath;
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void WavWriterThread::writeHeaders (
     qint64 hqBytes, qint64 asrBytes)
+{
+    const bool flac = m_hqFlac.isOpen ();
+    m_hqWriter.writeAt (0, hqHeader (hqBytes));
+    m_asrWriter.writeAt (0, asrHeader (asrBytes));
+
+    const bool hqOk = flac ? m_hqFlac.close () : m_hqWriter.close ();
+    const bool asrOk = m_asrWriter.close ();
+    if (!hqOk || !asrOk)
+    {
+        qWarning () << "WavWriterThread: Nicht alle Daten konnten geschrieben werden.";
+    }
+
+    //  Beim FLAC-Encoder zählen Rechenzeit je Audiosekunde und Kompressionsverhältnis.
+    m_flacStats = flac ? m_hqFlac.statistics () : FlacFileWriter::Statistics ();
+    if (flac)
+    {
+        qDebug () << "WavWriterThread: FLAC -" << m_flacStats.audioSeconds << "s Audio,"
+                  << m_flacStats.msPerAudioSecond () << "ms Rechenzeit je Audiosekunde, Größe"
+                  << qRound (m_flacStats.ratio () * 100.0) << "% der float-WAV,"
+                  << m_flacStats.stalls << "Wartezeiten";
+    }
+
+    //  Die Latenzen zeigen, ob die Platte mit dem Datenstrom Schritt hält; "stalls" zählt,
+    //  wie oft der Writer-Thread dennoch auf einen freien Puffer warten musste.
+    m_hqStats = flac ? AsyncFileWriter::Statistics () : m_hqWriter.statistics ();
+    m_asrStats = m_asrWriter.statistics ();
+    for (const auto &[name, stats] : {std::pair {"HQ", m_hqStats}, std::pair {"ASR", m_asrStats}})
+    {
+        if (stats.writes == 0)
+        {
+            continue;
+        }
+        qDebug () << "WavWriterThread:" << name << "-" << stats.writes << "Schreibzugriffe, p50"
+                  << stats.p50Ms << "ms, p95" << stats.p95Ms << "ms, p99" << stats.p99Ms
+                  << "ms, max" << stats.maxMs << "ms," << stats.bytesPerSecond / (1024.0 * 1024.0)
+                  << "MB/s," << stats.stalls << "Wartezeiten";
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void WavWriterThread::updateHeaders ()
+{
+    //  Die Header werden mit dem aktuellen Stand neu geschrieben. Da die I/O-Threads die
+    //  Aufträge der Reihe nach abarbeiten, landet der Header erst nach den Daten, die er
+    //  beschreibt. Stürzt die Anwendung ab, bleiben so zwei gültige Dateien zurück, denen
+    //  höchstens die Daten seit der letzten Aktualisierung fehlen.
+    m_hqWriter.writeAt (0, hqHeader (m_hqBytesWritten));
+    m_asrWriter.writeAt (0, asrHeader (m_asrBytesWritten));
+    m_headerTimer.restart ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+QByteArray WavWriterThread::hqHeader (
+    qint64 hqBytes) const
 {
     //  --- Header für die High-Quality-Datei (Stereo, 48kHz, 32-bit Float) ---
-    m_hqFile.seek (0);
-    QDataStream hqs (&m_hqFile);
+    QByteArray header;
+    header.reserve (HqHeaderBytes);
+    QDataStream hqs (&header, QIODevice::WriteOnly);
     hqs.setByteOrder (QDataStream::LittleEndian);
 
+    //  Ab 4 GB passen die Größen nicht mehr in die 32-bit-Felder des RIFF-Headers (bei
+    //  384 KB/s nach gut drei Stunden). Dann wird die Datei zu RF64 (EBU Tech 3306): Die
+    //  32-bit-Felder werden auf 0xFFFFFFFF gesetzt, die echten Größen stehen im ds64-Chunk.
+    //  Dieser ersetzt den gleich großen JUNK-Platzhalter, sodass die Audiodaten nicht
+    //  verschoben werden müssen.
+    const quint64 riffSize = quint64 (HqHeaderBytes - 8 + hqBytes);
+    const bool rf64 = riffSize > 0xFFFFFFFFull;
+
     //  "RIFF" (Resource Interchange File Format) ist der Container für die WAV-Daten.
-    hqs.writeRawData ("RIFF", 4);
-    hqs << quint32 (36 + hqBytes); //  Gesamtdateigröße minus der ersten 8 Bytes.
+    hqs.writeRawData (rf64 ? "RF64" : "RIFF", 4);
+    hqs << quint32 (rf64 ? 0xFFFFFFFFu : riffSize); //  Gesamtdateigröße minus der ersten 8 Bytes.
 
     //  "WAVE" deklariert den spezifischen RIFF-Typ.
     hqs.writeRawData ("WAVE", 4);
 
+    const int frameBytes = m_channelsHQ * (m_bitsPerSampleHQ / 8);
+    if (rf64)
+    {
+        hqs.writeRawData ("ds64", 4);
+        hqs << quint32 (Ds64Bytes);
+        hqs << quint64 (riffSize);
+        hqs << quint64 (hqBytes);              //  Größe des data-Chunks.
+        hqs << quint64 (hqBytes / frameBytes); //  Anzahl der Sample-Frames.
+        hqs << quint32 (0);                    //  Keine weiteren Einträge in der Größentabelle.
+    }
+    else
+    {
+        hqs.writeRawData ("JUNK", 4);
+        hqs << quint32 (Ds64Bytes);
+        hqs.writeRawData (QByteArray (Ds64Bytes, '\0').constData (), Ds64Bytes);
+    }
+
     //  "fmt " (mit Leerzeichen) leitet den Format-Block ein.
     hqs.writeRawData ("fmt ", 4);
 
@@ -233,18 +630,24 @@ void WavWriterThread::writeHeaders (
     hqs << quint16 (3);  //  Audio-Format-Code: 3 = 32-bit IEEE Float.
     hqs << quint16 (m_channelsHQ);
     hqs << quint32 (m_sampleRateHQ);
-    hqs << quint32 (m_sampleRateHQ * m_channelsHQ
-                    * (m_bitsPerSampleHQ / 8)); //  ByteRate = wie viele Bytes pro Sekunde.
-    hqs << quint16 (m_channelsHQ * (m_bitsPerSampleHQ / 8)); //  BlockAlign = Bytes pro Sample-Frame.
+    hqs << quint32 (m_sampleRateHQ * frameBytes); //  ByteRate = wie viele Bytes pro Sekunde.
+    hqs << quint16 (frameBytes);                  //  BlockAlign = Bytes pro Sample-Frame.
     hqs << quint16 (m_bitsPerSampleHQ);
 
     //  "data" leitet den Block mit den eigentlichen Audio-Samples ein.
     hqs.writeRawData ("data", 4);
-    hqs << quint32 (hqBytes); //  Größe der reinen Audiodaten.
+    hqs << quint32 (rf64 ? 0xFFFFFFFFu : quint32 (hqBytes)); //  Größe der reinen Audiodaten.
+    return header;
+}
 
-    //  --- Header für die ASR-Datei (Mono, 16kHz, 16-bit PCM) ---
-    m_asrFile.seek (0);
-    QDataStream asrs (&m_asrFile);
+//--------------------------------------------------------------------------------------------------
+
+QByteArray WavWriterThread::asrHeader (
+    qint64 asrBytes) const
+{
+    QByteArray header;
+    header.reserve (44);
+    QDataStream asrs (&header, QIODevice::WriteOnly);
     asrs.setByteOrder (QDataStream::LittleEndian);
 
     asrs.writeRawData ("RIFF", 4);
@@ -260,9 +663,53 @@ void WavWriterThread::writeHeaders (
     asrs << quint16 (16);
     asrs.writeRawData ("data", 4);
     asrs << quint32 (asrBytes);
+    return header;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool WavWriterThread::writeSpeechFile (
+    const QString &asrPath, const QString &speechPath, const SpeechTimeline &timeline)
+{
+    QFile source (asrPath);
+    QFile target (speechPath);
+    if (!source.open (QIODevice::ReadOnly) || !target.open (QIODevice::WriteOnly))
+    {
+        qWarning () << "WavWriterThread: Sprachdatei kann nicht erstellt werden:" << speechPath;
+        return false;
+    }
+
+    //  Platzhalter für den Header; die Größe steht erst am Ende fest.
+    target.write (QByteArray (44, '\0'));
+
+    const qint64 bytesPerSample = qint64 (sizeof (int16_t));
+    const QByteArray gap (int (timeline.gapSamples () * bytesPerSample), '\0');
+    qint64 written = 0;
+
+    //  Die Sprachbereiche werden nacheinander aus der ASR-Datei kopiert, jeweils durch
+    //  eine kurze Pause getrennt, damit Whisper keine Wörter über die Schnitte hinweg verbindet.
+    for (const SpeechRegion &region : timeline.regions ())
+    {
+        source.seek (44 + region.start * bytesPerSample);
+        qint64 remaining = region.length () * bytesPerSample;
+        while (remaining > 0)
+        {
+            const QByteArray data = source.read (qMin<qint64> (remaining, 64 * 1024));
+            if (data.isEmpty ())
+            {
+                break; //  Dateiende: Der letzte Bereich kann wegen des Nachlaufs kürzer sein.
+            }
+            target.write (data);
+            written += data.size ();
+            remaining -= data.size ();
+        }
+        target.write (gap);
+        written += gap.size ();
+    }
 
-    m_hqFile.close ();
-    m_asrFile.close ();
+    target.seek (0);
+    target.write (asrHeader (written));
+    return target.error () == QFile::NoError;
 }
 
 //--------------------------------------------------------------------------------------------------
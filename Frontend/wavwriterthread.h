@@ -6,22 +6,45 @@
 #ifndef WAVWRITERTHREAD_H
 #define WAVWRITERTHREAD_H
 
-#include <QFile>
-#include <QList>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QThread>
 #include <QWaitCondition>
 #include <atomic>
+#include "asyncfilewriter.h"
+#include "flacfilewriter.h"
+#include "polyphaseresampler.h"
+#include "voiceactivitydetector.h"
+#include <vector>
+
+class AudioBus;
+class AudioBusReader;
+struct AudioBlock;
 
 /**
  * @brief Ein dedizierter Thread, der Audio-Daten in WAV-Dateien schreibt.
  *
  * Diese Klasse wird verwendet, um das Schreiben von Dateien von anderen Threads
  * (insbesondere dem Haupt-Thread und dem Aufnahme-Thread) zu entkoppeln.
- * Sie nimmt über den `writeChunk`-Slot Audiodaten entgegen und schreibt diese in
- * ihrem eigenen Thread-Kontext auf die Festplatte. Sie erzeugt parallel zwei Dateien:
+ * Sie liest als Consumer direkt vom AudioBus des CaptureThread und schreibt die Daten
+ * in ihrem eigenen Thread-Kontext auf die Festplatte. Sie erzeugt parallel zwei Dateien:
  * eine hochauflösende Stereo-Datei und eine für die Spracherkennung (ASR)
  * optimierte, heruntergesampelte Mono-Datei.
+ *
+ * Im segmentierten Modus werden die ASR-Samples zusätzlich in fortlaufende Teildateien
+ * (<name>_seg000.wav, ...) geschrieben. Nach der eingestellten Dauer wird die aktuelle
+ * Teildatei an der nächsten Sprechpause abgeschlossen und über segmentCompleted()
+ * gemeldet, sodass die Transkription schon während der Aufnahme beginnen kann.
+ *
+ * Die eigentlichen Schreibzugriffe übernimmt je Datei ein AsyncFileWriter, sodass
+ * Downmix und Resampling nie auf die Festplatte warten müssen.
+ *
+ * Mit der Einstellung "audio/hqFlac" wird die HQ-Aufnahme statt als float-WAV
+ * verlustfrei als FLAC (24 bit) gespeichert; das Kodieren übernimmt ein FlacFileWriter
+ * in einem eigenen Thread.
+ *
+ * Mit "audio/realtime" läuft die Schreib-Schleife mit erhöhter Priorität (knapp unter dem
+ * CaptureThread) und der Schreibpuffer ist im RAM gesperrt (siehe ProcessGovernor).
  */
 class WavWriterThread : public QThread
 {
@@ -43,25 +66,67 @@ public:
      *
      * Öffnet die beiden Zieldateien und bereitet den Thread auf das Empfangen
      * von Audio-Daten vor.
-     * @param hqPath Pfad für die hochauflösende WAV-Datei.
+     * @param hqPath Pfad für die hochauflösende WAV-Datei. Bei FLAC-Ausgabe wird die
+     *        Endung durch ".flac" ersetzt (siehe hqFilePath()).
      * @param asrPath Pfad für die ASR-optimierte WAV-Datei.
+     * @param streamAsr Wenn true, werden die ASR-Samples zusätzlich über asrAudioReady()
+     *        für die Live-Transkription bereitgestellt.
+     * @param segmentMinutes Länge der ASR-Teildateien in Minuten (0 = keine Teildateien).
+     */
+    void startWriting (const QString &hqPath,
+                       const QString &asrPath,
+                       bool streamAsr = false,
+                       int segmentMinutes = 0);
+
+    /**
+     * @brief Meldet den Writer als Leser am AudioBus eines CaptureThread an.
+     *
+     * Muss einmalig aufgerufen werden, bevor die erste Aufnahme startet.
+     * @param bus Der Bus, dessen Blöcke geschrieben werden sollen.
      */
-    void startWriting (const QString &hqPath, const QString &asrPath);
+    void setAudioSource (AudioBus *bus);
 
     /**
      * @brief Beendet den Thread vollständig und wartet auf dessen Terminierung.
      */
     void shutdown ();
 
-public slots:
     /**
-     * @brief Nimmt einen Block von Audio-Daten entgegen und fügt ihn dem internen Puffer hinzu.
-     * @note Dieser Slot ist thread-sicher und dazu gedacht, mit dem
-     * `pcmChunkReady`-Signal des CaptureThread verbunden zu werden.
-     * @param chunk Ein Block von Audio-Daten (2 Kanäle, 32-bit float).
+     * @brief Gibt die Sprachbereiche der zuletzt abgeschlossenen Aufnahme zurück.
+     * @return Die Timeline zur Rückrechnung der ASR-Zeitstempel; leer, wenn keine
+     *         verkürzte Sprachdatei erstellt wurde.
+     */
+    SpeechTimeline speechTimeline () const;
+
+    /**
+     * @brief Gibt den Pfad der auf die Sprachbereiche verkürzten ASR-Datei zurück.
+     * @return Der Pfad, oder ein leerer String, wenn keine Sprachdatei erstellt wurde.
+     */
+    QString speechWavPath () const;
+
+    /**
+     * @brief Gibt die Schreibstatistik der HQ-Datei der zuletzt abgeschlossenen Aufnahme zurück.
      */
-    void writeChunk (QList<float> chunk);
+    AsyncFileWriter::Statistics hqWriteStatistics () const;
 
+    /**
+     * @brief Gibt die Schreibstatistik der ASR-Datei der zuletzt abgeschlossenen Aufnahme zurück.
+     */
+    AsyncFileWriter::Statistics asrWriteStatistics () const;
+
+    /**
+     * @brief Gibt die Kodierstatistik der zuletzt abgeschlossenen FLAC-Aufnahme zurück.
+     * @return Leere Kennzahlen, wenn die HQ-Datei als WAV geschrieben wurde.
+     */
+    FlacFileWriter::Statistics flacStatistics () const;
+
+    /**
+     * @brief Gibt den Pfad der tatsächlich geschriebenen HQ-Datei (.wav oder .flac) zurück.
+     * @return Der Pfad, oder ein leerer String vor der ersten Aufnahme.
+     */
+    QString hqFilePath () const;
+
+public slots:
     /**
      * @brief Beendet die aktuelle Schreib-Session.
      *
@@ -77,6 +142,24 @@ signals:
      */
     void finishedWriting ();
 
+    /**
+     * @brief Liefert bei aktiver Live-Transkription die gerade geschriebenen ASR-Samples.
+     *
+     * Wird aus dem Writer-Thread gesendet, etwa einmal pro Flush (ca. 1 s Audio).
+     * @param pcm16 PCM16-Samples (16 kHz, Mono), identisch mit dem Inhalt der ASR-Datei.
+     */
+    void asrAudioReady (const QByteArray &pcm16);
+
+    /**
+     * @brief Eine ASR-Teildatei wurde abgeschlossen und kann gelesen werden.
+     *
+     * Wird aus dem Writer-Thread gesendet; die letzte Teildatei einer Aufnahme wird
+     * noch vor finishedWriting() gemeldet.
+     * @param path Pfad der vollständigen WAV-Datei (16 kHz, Mono, PCM16).
+     * @param offsetSeconds Beginn der Teildatei innerhalb der Aufnahme in Sekunden.
+     */
+    void segmentCompleted (const QString &path, double offsetSeconds);
+
 protected:
     /**
      * @brief Die Hauptfunktion des Threads (der "Consumer"-Teil).
@@ -94,35 +177,121 @@ private:
      */
     void writeHeaders (qint64 hqBytes, qint64 asrBytes);
 
+    /**
+     * @brief Trägt die aktuellen Größen in die Header ein, ohne die Dateien zu schließen.
+     *
+     * Wird während der Aufnahme alle "audio/headerUpdateSec" Sekunden aufgerufen, damit
+     * eine abgebrochene Aufnahme als gültige WAV-Datei geöffnet werden kann.
+     */
+    void updateHeaders ();
+
+    /**
+     * @brief Erzeugt den Header der HQ-Datei (RIFF bzw. ab 4 GB RF64).
+     * @param hqBytes Die Größe der Audiodaten in Bytes.
+     * @return Die HqHeaderBytes Bytes des Headers.
+     */
+    QByteArray hqHeader (qint64 hqBytes) const;
+
     /**
      * @brief Schreibt den aktuellen Inhalt des internen Puffers auf die Festplatte.
-     * @param buffer Der Puffer, dessen Inhalt geschrieben werden soll.
+     * @param samples Zeiger auf die interleavten Stereo-Samples.
+     * @param count Anzahl der float-Werte.
+     */
+    void writeCurrentBufferToDisk (const float *samples, qsizetype count);
+
+    /**
+     * @brief Hängt einen Block an den Schreibpuffer an und gibt ihn an den Bus zurück.
+     * @param block Der gelesene Block.
      */
-    void writeCurrentBufferToDisk (QList<float> &buffer);
+    void appendBlock (const AudioBlock *block);
 
-    QFile m_hqFile;  ///< Dateihandle für die High-Quality-WAV-Datei.
-    QFile m_asrFile; ///< Dateihandle für die ASR-WAV-Datei.
+    /**
+     * @brief Erzeugt einen WAV-Header für 16-kHz-Mono-PCM.
+     * @param asrBytes Die Größe der Audiodaten in Bytes.
+     * @return Die 44 Bytes des Headers.
+     */
+    QByteArray asrHeader (qint64 asrBytes) const;
+
+    /**
+     * @brief Schreibt ASR-Samples in die aktuelle Teildatei und schließt sie ggf. ab.
+     * @param samples Die gerade in die ASR-Datei geschriebenen Samples.
+     * @param count Anzahl der Samples.
+     */
+    void writeSegment (const int16_t *samples, qint64 count);
+
+    /**
+     * @brief Finalisiert die aktuelle Teildatei und meldet sie über segmentCompleted().
+     */
+    void closeSegment ();
+
+    /**
+     * @brief Schließt die Sprachaktivitätserkennung ab und erstellt ggf. die verkürzte Sprachdatei.
+     */
+    void finishSpeechDetection ();
+
+    /**
+     * @brief Kopiert die Sprachbereiche der ASR-Datei in eine neue, verkürzte WAV-Datei.
+     * @return true, wenn die Datei vollständig geschrieben wurde.
+     */
+    bool writeSpeechFile (const QString &asrPath,
+                          const QString &speechPath,
+                          const SpeechTimeline &timeline);
+
+    static constexpr int SpeechGapMs = 300;        ///< Pause zwischen zwei Sprachbereichen in der Sprachdatei.
+    static constexpr double MaxSpeechRatio = 0.9;  ///< Ab diesem Sprachanteil wird nicht verkürzt.
+    static constexpr int SegmentGraceSec = 30;     ///< So lange wird höchstens auf eine Sprechpause gewartet.
+    static constexpr int Ds64Bytes = 28;           ///< Größe des ds64-Chunks bzw. seines JUNK-Platzhalters.
+    static constexpr int HqHeaderBytes = 80;       ///< RIFF + JUNK/ds64 + fmt + data-Kopf der HQ-Datei.
+    static constexpr int AsrReserve = 1 << 20;     ///< Reservierung der ASR-/Teildateien (~30 s).
+    static constexpr int RealtimePriority = 15;    ///< SCHED_FIFO-Priorität (unter der des CaptureThread).
+
+    AsyncFileWriter m_hqWriter;  ///< Asynchroner Schreiber für die High-Quality-WAV-Datei.
+    AsyncFileWriter m_asrWriter; ///< Asynchroner Schreiber für die ASR-WAV-Datei.
+    AsyncFileWriter::Statistics m_hqStats;  ///< Schreibstatistik der letzten Aufnahme (geschützt durch m_mutex).
+    AsyncFileWriter::Statistics m_asrStats; ///< Schreibstatistik der letzten Aufnahme (geschützt durch m_mutex).
+    FlacFileWriter m_hqFlac;     ///< FLAC-Encoder für die HQ-Aufnahme (statt m_hqWriter).
+    FlacFileWriter::Statistics m_flacStats; ///< Kodierstatistik der letzten Aufnahme (geschützt durch m_mutex).
+    QString m_hqPath;            ///< Pfad der aktuellen HQ-Datei (geschützt durch m_mutex).
 
     // Synchronisation und Zustand
-    QMutex m_mutex;
+    mutable QMutex m_mutex;
     QWaitCondition m_mainLoopCond; ///< Weckt den Thread auf, wenn startWriting() gerufen wird.
-    QWaitCondition
-        m_dataAvailableCond;    ///< Weckt den Thread auf, wenn neue Daten in writeChunk() ankommen.
     std::atomic<bool> m_active; ///< Steuert die aktive Schreibschleife.
     std::atomic<bool> m_shutdown; ///< Signalisiert dem Thread, sich komplett zu beenden.
 
     // Puffer und Zähler
-    QList<float> m_bufferFloat;   ///< Interner Puffer für ankommende Audio-Chunks.
+    AudioBusReader *m_reader;         ///< Leseseite des AudioBus (gehört dem Bus).
+    std::vector<float> m_pending;     ///< Vorab reservierter Schreibpuffer für die HQ-Samples.
+    std::vector<float> m_asrMono;     ///< Vorab reservierter Puffer für den Mono-Downmix (48 kHz).
+    std::vector<float> m_asrResampled; ///< Vorab reservierter Puffer für das resampelte Mono-Signal.
+    std::vector<int16_t> m_asrBuffer; ///< Vorab reservierter Puffer für die ASR-Samples.
     qint64 m_hqBytesWritten;      ///< Zähler für geschriebene Bytes (HQ).
     qint64 m_asrBytesWritten;     ///< Zähler für geschriebene Bytes (ASR).
     qint64 m_flushThresholdBytes; ///< Pufferschwelle in Bytes, bevor auf die Platte geschrieben wird.
-    int m_downsampleOffset;       ///< Offset für das Downsampling zur ASR-Version.
+    int m_headerIntervalMs;       ///< Abstand der Header-Aktualisierungen (0 = nur am Ende).
+    QElapsedTimer m_headerTimer;  ///< Zeit seit der letzten Header-Aktualisierung.
 
     // Audio-Format-Konstanten
     const int m_sampleRateHQ;    ///< Sample-Rate für die HQ-Aufnahme (z.B. 48000 Hz).
     const int m_channelsHQ;      ///< Anzahl der Kanäle für die HQ-Aufnahme (z.B. 2 für Stereo).
     const int m_bitsPerSampleHQ; ///< Bittiefe für die HQ-Aufnahme (z.B. 32 für float).
     const int m_sampleRateASR;   ///< Ziel-Sample-Rate für die ASR-Aufnahme (z.B. 16000 Hz).
+
+    PolyphaseResampler m_asrResampler; ///< Tiefpass + Dezimation von 48 kHz auf 16 kHz (Mono).
+
+    // Sprachaktivität
+    VoiceActivityDetector m_vad; ///< Erkennt Sprachbereiche im 16-kHz-Signal.
+    bool m_vadEnabled;           ///< Einstellung "asr/vad", pro Session gelesen.
+    bool m_streamAsr;            ///< ASR-Samples zusätzlich per asrAudioReady() senden.
+    SpeechTimeline m_timeline;   ///< Sprachbereiche der letzten Aufnahme (geschützt durch m_mutex).
+    QString m_speechPath;        ///< Pfad der verkürzten Sprachdatei (geschützt durch m_mutex).
+
+    // ASR-Teildateien
+    AsyncFileWriter m_segmentWriter; ///< Schreiber für die aktuelle Teildatei.
+    qint64 m_segmentSamples;     ///< Zielgröße einer Teildatei in Samples (0 = aus).
+    qint64 m_segmentWritten;     ///< Samples in der aktuellen Teildatei.
+    qint64 m_segmentStart;       ///< Erstes Sample der aktuellen Teildatei in der Aufnahme.
+    int m_segmentIndex;          ///< Nummer der aktuellen Teildatei.
 };
 
 #endif // WAVWRITERTHREAD_H
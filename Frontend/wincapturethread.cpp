@@ -1,7 +1,7 @@
 #include "wincapturethread.h"
 
 #include <QDebug>
-#include <QSettings>
+#include <algorithm>
 #include <comdef.h> //  Für _com_error zur lesbaren Ausgabe von HRESULT-Fehlercodes.
 
 #pragma comment(lib, "ole32.lib") //  Stellt sicher, dass die COM-Bibliothek gelinkt wird.
@@ -166,29 +166,24 @@ bool WinCaptureThread::initializeCapture()
         return false;
     }
 
-    //  --- Puffer und Timer für das Resampling vorbereiten ---
-    const int bufferDurationInSeconds = 5;
-    size_t bufferSizeSys = m_nativeSampleRateSys * bufferDurationInSeconds;
-    size_t bufferSizeMic = m_nativeSampleRateMic * bufferDurationInSeconds;
+    //  --- Resampler, Puffer und Timer vorbereiten ---
+    //  Beide Geräte werden unmittelbar beim Eintreffen der Pakete auf 48 kHz Stereo
+    //  gebracht; die Ringpuffer enthalten danach bereits interleavte 48-kHz-Frames.
+    const int targetSampleRate = 48000;
+    m_resamplerSys = std::make_unique<PolyphaseResampler> (int (m_nativeSampleRateSys),
+                                                           targetSampleRate,
+                                                           BlockChannels);
+    m_resamplerMic = std::make_unique<PolyphaseResampler> (int (m_nativeSampleRateMic),
+                                                           targetSampleRate,
+                                                           BlockChannels);
 
-    m_fifoSysL.resize(bufferSizeSys);
-    if (m_nativeChannelsSys > 1)
-    {
-        m_fifoSysR.resize(bufferSizeSys);
-    }
-    m_fifoMicL.resize(bufferSizeMic);
-    if (m_nativeChannelsMic > 1)
-    {
-        m_fifoMicR.resize(bufferSizeMic);
-    }
-
-    m_fifoSysL.clear();
-    m_fifoSysR.clear();
-    m_fifoMicL.clear();
-    m_fifoMicR.clear();
-    m_resampPosSys = 0.0;
-    m_resampPosMic = 0.0;
+    const int bufferDurationInSeconds = 5;
+    m_fifoSys.resize(size_t (targetSampleRate) * bufferDurationInSeconds * BlockChannels);
+    m_fifoMic.resize(size_t (targetSampleRate) * bufferDurationInSeconds * BlockChannels);
     m_sampleAccumulator = 0.0;
+    m_bufSys.resize(BlockFrames * BlockChannels);
+    m_bufMic.resize(BlockFrames * BlockChannels);
+    m_bufMix.resize(BlockFrames * BlockChannels);
 
     QueryPerformanceFrequency(&m_perfCounterFreq);
     QueryPerformanceCounter(&m_lastTime);
@@ -226,19 +221,15 @@ void WinCaptureThread::captureLoopIteration()
     hr = m_captureClientSys->GetNextPacketSize(&packetLengthInFrames);
     if (SUCCEEDED(hr) && packetLengthInFrames > 0)
     {
-        //  Holt die Daten aus dem Puffer und schreibt sie kanalgetrennt in die Ringpuffer.
+        //  Holt die Daten aus dem Puffer und schreibt sie resampelt in den Ringpuffer.
         hr = m_captureClientSys->GetBuffer (&pData, &packetLengthInFrames, &flags, nullptr, nullptr);
         if (SUCCEEDED(hr))
         {
-            auto* floatData = reinterpret_cast<float*>(pData);
-            for (UINT32 i = 0; i < packetLengthInFrames; ++i)
-            {
-                m_fifoSysL.write(&floatData[i * m_nativeChannelsSys], 1);
-                if (m_nativeChannelsSys > 1)
-                {
-                    m_fifoSysR.write(&floatData[i * m_nativeChannelsSys + 1], 1);
-                }
-            }
+            pushPacket(reinterpret_cast<const float*>(pData),
+                       packetLengthInFrames,
+                       m_nativeChannelsSys,
+                       *m_resamplerSys,
+                       m_fifoSys);
             m_captureClientSys->ReleaseBuffer(packetLengthInFrames);
         }
     }
@@ -256,15 +247,11 @@ void WinCaptureThread::captureLoopIteration()
             );
         if (SUCCEEDED(hr))
         {
-            auto* floatData = reinterpret_cast<float*>(pData);
-            for (UINT32 i = 0; i < packetLengthInFrames; ++i)
-            {
-                m_fifoMicL.write(&floatData[i * m_nativeChannelsMic], 1);
-                if (m_nativeChannelsMic > 1)
-                {
-                    m_fifoMicR.write(&floatData[i * m_nativeChannelsMic + 1], 1);
-                }
-            }
+            pushPacket(reinterpret_cast<const float*>(pData),
+                       packetLengthInFrames,
+                       m_nativeChannelsMic,
+                       *m_resamplerMic,
+                       m_fifoMic);
             m_captureClientMic->ReleaseBuffer(packetLengthInFrames);
         }
     }
@@ -297,68 +284,53 @@ void WinCaptureThread::captureLoopIteration()
         return;
     }
 
-    //  Berechnet das Verhältnis zwischen nativer und Ziel-Samplerate für das Resampling.
-    const double resampRatioSys = static_cast<double> (m_nativeSampleRateSys) / targetSampleRate;
-    const double resampRatioMic = static_cast<double>(m_nativeSampleRateMic) / targetSampleRate;
-
-    QList<float> chunk;
-    chunk.reserve(framesToGenerate * 2);
-
-    QSettings settings("SS2025FP_T2", "AudioTranskriptor");
-    float sysGain = settings.value("sysGain", 0.4f).toFloat();
-    float micGain = settings.value("micGain", 1.0f).toFloat();
-
-    for (size_t i = 0; i < framesToGenerate; ++i)
+    //  Die Frames werden blockweise erzeugt: Liegen in einem Ringpuffer weniger Frames vor
+    //  als benötigt, wird der Rest mit Stille aufgefüllt. Danach mischt der gemeinsame Mixer
+    //  direkt in einen Block des AudioBus. Ist der Pool erschöpft, wird in den Ersatzpuffer
+    //  gemischt und der Block verworfen; die Ringpuffer werden trotzdem geleert.
+    while (framesToGenerate > 0)
     {
-        float sysL = 0.0f, sysR = 0.0f, micL = 0.0f, micR = 0.0f;
-
-        if ((m_resampPosSys + resampRatioSys) < m_fifoSysL.size())
-        {
-            sysL = m_fifoSysL.sampleAt(m_resampPosSys);
-            sysR = (m_nativeChannelsSys > 1) ? m_fifoSysR.sampleAt(m_resampPosSys) : sysL;
-        }
-
-        if ((m_resampPosMic + resampRatioMic) < m_fifoMicL.size())
+        const int chunk = static_cast<int> (qMin<size_t> (framesToGenerate, BlockFrames));
+        const size_t samples = size_t (chunk) * BlockChannels;
+
+        const size_t gotSys = m_fifoSys.read(m_bufSys.data(), samples);
+        std::fill(m_bufSys.begin() + gotSys, m_bufSys.begin() + samples, 0.0f);
+        const size_t gotMic = m_fifoMic.read(m_bufMic.data(), samples);
+        std::fill(m_bufMic.begin() + gotMic, m_bufMic.begin() + samples, 0.0f);
+
+        //  Ein angefangener Block wird noch in dieser Iteration veröffentlicht, damit die
+        //  Latenz nicht von der Blockgröße abhängt.
+        AudioBlock *block = acquireBlock ();
+        mix (m_bufSys.data (), m_bufMic.data (), block ? block->data : m_bufMix.data (), chunk);
+        if (block)
         {
-            micL = m_fifoMicL.sampleAt(m_resampPosMic);
-            micR = (m_nativeChannelsMic > 1) ? m_fifoMicR.sampleAt(m_resampPosMic) : micL;
+            block->frames = chunk;
+            publishBlock (block);
         }
 
-        //  Mische die Samples und verhindere Übersteuerung (Clipping).
-        chunk.append (qBound (-1.0f, sysL * sysGain + micL * micGain, 1.0f));
-        chunk.append(qBound(-1.0f, sysR * sysGain + micR * micGain, 1.0f));
-
-        //  Rücke die Lese-Positionen für den nächsten Sample-Frame vor.
-        m_resampPosSys += resampRatioSys;
-        m_resampPosMic += resampRatioMic;
+        framesToGenerate -= chunk;
     }
 
-    emit pcmChunkReady(chunk);
+    msleep(5);
+}
 
-    //  "Konsumiere" die bereits gelesenen Daten aus den Ringpuffern, um Speicher freizugeben.
-    size_t sysFramesToConsume = static_cast<size_t> (m_resampPosSys);
-    if (sysFramesToConsume > 0)
-    {
-        m_fifoSysL.consume(sysFramesToConsume);
-        if (m_nativeChannelsSys > 1)
-        {
-            m_fifoSysR.consume(sysFramesToConsume);
-        }
-        m_resampPosSys -= sysFramesToConsume;
-    }
+//--------------------------------------------------------------------------------------------------
 
-    size_t micFramesToConsume = static_cast<size_t>(m_resampPosMic);
-    if (micFramesToConsume > 0)
+void WinCaptureThread::pushPacket(
+    const float *data, UINT32 frames, UINT32 channels, PolyphaseResampler &resampler, RingBuffer &fifo)
+{
+    //  Auf Stereo bringen: Mono wird auf beide Seiten gelegt, weitere Kanäle werden ignoriert.
+    m_stereoIn.resize(size_t (frames) * BlockChannels);
+    for (UINT32 i = 0; i < frames; ++i)
     {
-        m_fifoMicL.consume(micFramesToConsume);
-        if (m_nativeChannelsMic > 1)
-        {
-            m_fifoMicR.consume(micFramesToConsume);
-        }
-        m_resampPosMic -= micFramesToConsume;
+        m_stereoIn[2 * i] = data[i * channels];
+        m_stereoIn[2 * i + 1] = (channels > 1) ? data[i * channels + 1] : data[i * channels];
     }
 
-    msleep(5);
+    //  Polyphasen-Resampling auf 48 kHz; der Filterzustand bleibt zwischen den Paketen erhalten.
+    m_resampled.resize(size_t (resampler.maxOutputFrames(int (frames))) * BlockChannels);
+    const int outFrames = resampler.process(m_stereoIn.data(), int (frames), m_resampled.data());
+    fifo.write(m_resampled.data(), size_t (outFrames) * BlockChannels);
 }
 
 //--------------------------------------------------------------------------------------------------
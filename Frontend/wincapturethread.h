@@ -7,9 +7,12 @@
 #define WINCAPTURETHREAD_H
 
 #include "capturethread.h"
+#include "polyphaseresampler.h"
 #include "ringbuffer.h"
 #include <audioclient.h>
+#include <memory>
 #include <mmdeviceapi.h>
+#include <vector>
 
 /**
  * @brief Eine konkrete Implementierung von CaptureThread für Windows-Systeme.
@@ -17,8 +20,9 @@
  * Diese Klasse nutzt die Windows Audio Session API (WASAPI) zur Aufnahme von Audio.
  * Sie initialisiert zwei separate Audio-Clients: einen für das Standard-Ausgabegerät
  * im Loopback-Modus (um System-Sounds aufzunehmen) und einen für das Standard-Eingabegerät
- * (Mikrofon). Die Daten beider Streams werden in Ringpuffern zwischengespeichert,
- * resampelt, gemischt und dann zur weiteren Verarbeitung gesendet.
+ * (Mikrofon). Die Daten beider Streams werden mit einem PolyphaseResampler auf 48 kHz
+ * gebracht, in Ringpuffern zwischengespeichert, gemischt und dann zur weiteren
+ * Verarbeitung gesendet.
  */
 class WinCaptureThread : public CaptureThread
 {
@@ -60,6 +64,20 @@ protected:
     void cleanupCapture() override;
 
 private:
+    /**
+     * @brief Bringt ein WASAPI-Paket auf 48 kHz Stereo und schreibt es in einen Ringpuffer.
+     * @param data Die interleavten float-Samples des Pakets.
+     * @param frames Anzahl der Frames im Paket.
+     * @param channels Native Kanalanzahl des Geräts.
+     * @param resampler Der Resampler des Geräts (behält seinen Zustand zwischen den Paketen).
+     * @param fifo Der Ziel-Ringpuffer.
+     */
+    void pushPacket (const float *data,
+                     UINT32 frames,
+                     UINT32 channels,
+                     PolyphaseResampler &resampler,
+                     RingBuffer &fifo);
+
     // --- COM-Interfaces für System-Audio (Loopback) ---
     IAudioClient *m_audioClientSys = nullptr; ///< Der WASAPI-Client für das Ausgabe-Gerät.
     IAudioCaptureClient *m_captureClientSys
@@ -79,22 +97,27 @@ private:
     LARGE_INTEGER m_lastTime;        ///< Letzter Zeitstempel für die Delta-Zeit-Berechnung.
     double m_sampleAccumulator
         = 0.0; ///< Akkumulator für eine fließkomma-genaue Frame-Zählung beim Resampling.
-    double m_resampPosMic = 0.0; ///< Aktuelle Leseposition im Mikrofon-Ringpuffer.
-    double m_resampPosSys = 0.0; ///< Aktuelle Leseposition im System-Audio-Ringpuffer.
+    std::unique_ptr<PolyphaseResampler> m_resamplerSys; ///< Wandelt System-Audio auf 48 kHz Stereo.
+    std::unique_ptr<PolyphaseResampler> m_resamplerMic; ///< Wandelt Mikrofon-Audio auf 48 kHz Stereo.
+    std::vector<float> m_stereoIn;  ///< Auf Stereo gebrachtes Paket mit nativer Abtastrate.
+    std::vector<float> m_resampled; ///< Resampeltes Paket (48 kHz Stereo).
     const int m_pollingIntervalMs
         = 10; ///< Das Intervall in ms, in dem neue Audiodaten abgefragt werden.
 
     // --- Ringpuffer ---
-    RingBuffer m_fifoSysL; ///< Ringpuffer für den linken Kanal des System-Audios.
-    RingBuffer m_fifoMicL; ///< Ringpuffer für den linken Kanal des Mikrofons.
-    RingBuffer m_fifoSysR; ///< Ringpuffer für den rechten Kanal des System-Audios.
-    RingBuffer m_fifoMicR; ///< Ringpuffer für den rechten Kanal des Mikrofons.
+    RingBuffer m_fifoSys; ///< Ringpuffer für das System-Audio (48 kHz, interleavtes Stereo).
+    RingBuffer m_fifoMic; ///< Ringpuffer für das Mikrofon (48 kHz, interleavtes Stereo).
 
     // --- Geräte-Eigenschaften ---
     UINT32 m_nativeSampleRateSys = 0; ///< Native Abtastrate des System-Audio-Geräts.
     UINT32 m_nativeChannelsSys = 0;   ///< Native Kanalanzahl des System-Audio-Geräts.
     UINT32 m_nativeSampleRateMic = 0; ///< Native Abtastrate des Mikrofons.
     UINT32 m_nativeChannelsMic = 0;   ///< Native Kanalanzahl des Mikrofons.
+
+    // --- Ausgabe ---
+    std::vector<float> m_bufSys; ///< Resampelte Stereo-Frames des System-Audios (ein Block).
+    std::vector<float> m_bufMic; ///< Resampelte Stereo-Frames des Mikrofons (ein Block).
+    std::vector<float> m_bufMix; ///< Ersatzpuffer, falls kein Block im Pool frei ist.
 };
 
 #endif // WINCAPTURETHREAD_H